@@ -0,0 +1,179 @@
+//
+//  SPAssetLoader.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 16.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import <Sparrow/SparrowBase.h>
+#import <Sparrow/SPAnimatable.h>
+#import <Sparrow/SPMacros.h>
+
+@class SPTextureOptions;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// The block that is called when an asset has been loaded. On success, `asset` is an `SPTexture`,
+/// `SPTextureAtlas`, `SPBitmapFont` or `SPSound` (depending on the method that created the
+/// request); otherwise, `error` describes the problem.
+typedef void (^SPAssetLoadingBlock)(id __nullable asset, NSError *__nullable error);
+
+/** ------------------------------------------------------------------------------------------------
+
+ An SPAssetRequest represents an asset that was queued in an `SPAssetLoader`. Use it to change
+ the priority of a request while it is waiting, or to cancel it.
+
+------------------------------------------------------------------------------------------------- */
+
+@interface SPAssetRequest : NSObject
+
+/// Cancels the request. Its `onComplete` block will not be called, even if the asset has
+/// already been loaded in the background.
+- (void)cancel;
+
+/// The path that was passed to the loader.
+@property (nonatomic, readonly) NSString *path;
+
+/// Requests with a higher priority are decoded first; requests with equal priority are decoded in
+/// the order they were added. Changing the priority only has an effect while the request is
+/// still waiting for a worker.
+@property (nonatomic, assign) NSInteger priority;
+
+/// Indicates if the request has been cancelled.
+@property (nonatomic, readonly) BOOL isCancelled;
+
+/// Indicates if the `onComplete` block of the request has been called.
+@property (nonatomic, readonly) BOOL isComplete;
+
+@end
+
+/** ------------------------------------------------------------------------------------------------
+
+ An SPAssetLoader loads textures, texture atlases, bitmap fonts and sounds in the background,
+ in parallel, without stalling the main thread.
+
+ Loading is split into stages:
+
+ * **Decoding:** A number of worker threads (one per CPU core, by default) read and decode the
+   files: images are decompressed into pixels, atlas and font files are parsed, sounds are read.
+   Requests are picked by priority.
+ * **Uploading:** Decoded textures are uploaded to the GPU in the resource queue of the view
+   controller (see `executeInResourceQueue:`). Each frame, the loader only starts uploading as
+   many textures as fit into its `uploadBudget`, so that a burst of finished textures does not
+   cause a hitch.
+ * **Completion:** The `onComplete` blocks of all requests that finished since the last frame
+   are called at once, on the main thread, followed by `onProgress`.
+
+ The loader is driven by the frames of a juggler; add it to one to start loading:
+
+	SPAssetLoader *loader = [SPAssetLoader assetLoader];
+	[Sparrow.juggler addObject:loader];
+
+	[loader loadTextureAtlasFromFile:@"atlas.xml" priority:10 onComplete:^(id atlas, NSError *error)
+	{
+	    _atlas = [atlas retain];
+	}];
+
+	loader.onProgress = ^{ _progressBar.ratio = loader.progress; };
+
+ Textures are added to the same cache that `[SPTexture initWithContentsOfFile:]` uses, so a
+ texture that was loaded with the loader won't be loaded again when it's referenced later.
+
+ The loader also keeps a few statistics (bytes and time per stage) that help to find the right
+ budget for a game.
+
+------------------------------------------------------------------------------------------------- */
+
+@interface SPAssetLoader : NSObject <SPAnimatable>
+
+/// --------------------
+/// @name Initialization
+/// --------------------
+
+/// Initializes a loader with a certain number of decoding threads. _Designated Initializer_.
+- (instancetype)initWithNumWorkers:(NSInteger)numWorkers;
+
+/// Initializes a loader with one decoding thread per active CPU core.
+- (instancetype)init;
+
+/// Factory method.
++ (instancetype)assetLoader;
+
+/// -------------
+/// @name Methods
+/// -------------
+
+/// Loads a texture (an image, PVR or KTX file). The asset passed to the callback is an `SPTexture`.
+- (SPAssetRequest *)loadTextureFromFile:(NSString *)path generateMipmaps:(BOOL)mipmaps
+                               priority:(NSInteger)priority onComplete:(SPAssetLoadingBlock)onComplete;
+
+/// Loads a texture with certain options (see `SPTextureOptions`); `nil` uses the defaults.
+- (SPAssetRequest *)loadTextureFromFile:(NSString *)path options:(nullable SPTextureOptions *)options
+                               priority:(NSInteger)priority onComplete:(SPAssetLoadingBlock)onComplete;
+
+/// Loads a texture without mipmaps and with default priority.
+- (SPAssetRequest *)loadTextureFromFile:(NSString *)path onComplete:(SPAssetLoadingBlock)onComplete;
+
+/// Loads a texture atlas (XML or binary) and the texture it references. The asset passed to the
+/// callback is an `SPTextureAtlas`.
+- (SPAssetRequest *)loadTextureAtlasFromFile:(NSString *)path priority:(NSInteger)priority
+                                  onComplete:(SPAssetLoadingBlock)onComplete;
+
+/// Loads a bitmap font (XML or binary) and the texture it references. The asset passed to the
+/// callback is an `SPBitmapFont`; it is not registered at `SPTextField`.
+- (SPAssetRequest *)loadBitmapFontFromFile:(NSString *)path priority:(NSInteger)priority
+                                onComplete:(SPAssetLoadingBlock)onComplete;
+
+/// Loads a sound. The asset passed to the callback is an `SPSound`.
+- (SPAssetRequest *)loadSoundFromFile:(NSString *)path priority:(NSInteger)priority
+                           onComplete:(SPAssetLoadingBlock)onComplete;
+
+/// Cancels all requests that have not been completed yet.
+- (void)cancelAllRequests;
+
+/// ----------------
+/// @name Properties
+/// ----------------
+
+/// The number of threads that decode assets.
+@property (nonatomic, readonly) NSInteger numWorkers;
+
+/// The maximum number of texture bytes that start uploading per frame. A single texture that
+/// exceeds the budget is still uploaded, but on its own. (Default: 4 MB)
+@property (nonatomic, assign) NSUInteger uploadBudget;
+
+/// A block that is called after each frame in which at least one request was completed.
+@property (nonatomic, copy, nullable) SPCallbackBlock onProgress;
+
+/// The ratio of completed (or cancelled) requests since the loader was last idle, between
+/// 0 and 1. An idle loader reports 1.
+@property (nonatomic, readonly) float progress;
+
+/// The number of requests that have not been completed or cancelled yet.
+@property (nonatomic, readonly) NSInteger numPendingRequests;
+
+/// The number of bytes the workers have decoded (pixels of textures, raw files of PVR textures).
+@property (nonatomic, readonly) uint64_t numBytesDecoded;
+
+/// The number of texture bytes that were uploaded to the GPU.
+@property (nonatomic, readonly) uint64_t numBytesUploaded;
+
+/// The total time (in seconds) the workers have spent loading assets.
+@property (nonatomic, readonly) double decodeTime;
+
+/// The total time (in seconds) spent uploading textures, including the wait for the GPU.
+@property (nonatomic, readonly) double uploadTime;
+
+/// The average number of bytes a single worker decodes per second.
+@property (nonatomic, readonly) double decodeThroughput;
+
+/// The average number of bytes uploaded per second.
+@property (nonatomic, readonly) double uploadThroughput;
+
+@end
+
+NS_ASSUME_NONNULL_END
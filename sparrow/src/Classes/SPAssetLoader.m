@@ -0,0 +1,704 @@
+//
+//  SPAssetLoader.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 16.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SparrowClass.h"
+#import "SPAssetLoader.h"
+#import "SPBitmapFont_Internal.h"
+#import "SPContext.h"
+#import "SPMacros.h"
+#import "SPOpenGL.h"
+#import "SPSound.h"
+#import "SPTextureAtlas_Internal.h"
+#import "SPTexture_Internal.h"
+#import "SPTextureOptions.h"
+#import "SPUtils.h"
+#import "SPViewController.h"
+
+#import <QuartzCore/QuartzCore.h>
+#import <pthread.h>
+
+#define DEFAULT_UPLOAD_BUDGET (4 * 1024 * 1024)
+
+typedef NS_ENUM(uint8_t, SPAssetType)
+{
+    SPAssetTypeTexture,
+    SPAssetTypeTextureAtlas,
+    SPAssetTypeBitmapFont,
+    SPAssetTypeSound
+};
+
+// --- private interfaces --------------------------------------------------------------------------
+
+@interface SPAssetRequest ()
+{
+  @package
+    // set on creation, read-only afterwards
+    SPAssetType _type;
+    NSString *_path;
+    SPTextureOptions *_options;
+    SPAssetLoadingBlock _onComplete;
+
+    // owned by whichever stage currently holds the request
+    NSString *_texturePath;
+    SPDecodedTexture *_decodedTexture;
+    SPTexture *_texture;
+    id _asset;
+    NSError *_error;
+
+    // main thread only
+    SPAssetLoader *_loader; // weak; nil after completion or cancellation
+    BOOL _isCancelled;
+    BOOL _isComplete;
+
+    // guarded by the loader's mutex
+    NSInteger _priority;
+}
+
+- (instancetype)initWithLoader:(SPAssetLoader *)loader type:(SPAssetType)type path:(NSString *)path
+                       options:(SPTextureOptions *)options priority:(NSInteger)priority
+                    onComplete:(SPAssetLoadingBlock)onComplete;
+
+@end
+
+@interface SPAssetLoader ()
+
+- (void)cancelRequest:(SPAssetRequest *)request;
+- (void)setPriority:(NSInteger)priority ofRequest:(SPAssetRequest *)request;
+
+@end
+
+// --- class implementation ------------------------------------------------------------------------
+
+@implementation SPAssetRequest
+
+- (instancetype)initWithLoader:(SPAssetLoader *)loader type:(SPAssetType)type path:(NSString *)path
+                       options:(SPTextureOptions *)options priority:(NSInteger)priority
+                    onComplete:(SPAssetLoadingBlock)onComplete
+{
+    if ((self = [super init]))
+    {
+        _loader = loader;
+        _type = type;
+        _path = [path copy];
+        _options = [options copy];
+        _priority = priority;
+        _onComplete = [onComplete copy];
+    }
+    return self;
+}
+
+- (instancetype)init
+{
+    SP_USE_DESIGNATED_INITIALIZER(initWithLoader:type:path:options:priority:onComplete:);
+    return nil;
+}
+
+- (void)dealloc
+{
+    [_path release];
+    [_options release];
+    [_onComplete release];
+    [_texturePath release];
+    [_decodedTexture release];
+    [_texture release];
+    [_asset release];
+    [_error release];
+    [super dealloc];
+}
+
+- (void)cancel
+{
+    [_loader cancelRequest:self];
+}
+
+- (NSInteger)priority
+{
+    return _priority;
+}
+
+- (void)setPriority:(NSInteger)priority
+{
+    if (_loader) [_loader setPriority:priority ofRequest:self];
+    else         _priority = priority;
+}
+
+- (NSString *)path
+{
+    return _path;
+}
+
+- (BOOL)isCancelled
+{
+    return _isCancelled;
+}
+
+- (BOOL)isComplete
+{
+    return _isComplete;
+}
+
+@end
+
+@implementation SPAssetLoader
+{
+    pthread_mutex_t _mutex;
+
+    // guarded by '_mutex'
+    SP_GENERIC(NSMutableArray, SPAssetRequest*) *_waiting;   // waiting for a worker
+    SP_GENERIC(NSMutableArray, SPAssetRequest*) *_finishing; // texture uploaded, waiting for a worker
+    SP_GENERIC(NSMutableArray, SPAssetRequest*) *_decoded;   // waiting for the upload stage
+    SP_GENERIC(NSMutableArray, SPAssetRequest*) *_completed; // waiting for delivery
+    NSInteger _numActiveWorkers;
+    BOOL _isUploading;
+    uint64_t _numBytesDecoded;
+    uint64_t _numBytesUploaded;
+    double _decodeTime;
+    double _uploadTime;
+
+    // main thread only
+    SP_GENERIC(NSMutableArray, SPAssetRequest*) *_requests;
+    NSInteger _numRequests;
+    NSInteger _numFinishedRequests;
+    NSInteger _numWorkers;
+    NSUInteger _uploadBudget;
+    SPCallbackBlock _onProgress;
+}
+
+// --- c functions ---
+
+static NSError *errorWithException(NSException *exception)
+{
+    NSMutableDictionary *userInfo = [NSMutableDictionary dictionaryWithDictionary:exception.userInfo];
+    if (exception.reason) userInfo[NSLocalizedDescriptionKey] = exception.reason;
+    return [NSError errorWithDomain:exception.name code:0 userInfo:userInfo];
+}
+
+static Class assetClassForType(SPAssetType type)
+{
+    return type == SPAssetTypeTextureAtlas ? [SPTextureAtlas class] : [SPBitmapFont class];
+}
+
+static SPAssetRequest *nextRequest(SPAssetLoader *self)
+{
+    // requests that are waiting to be finished come first: their texture is already in memory.
+    // Otherwise, the first request with the highest priority wins (the array is in FIFO order).
+    // Returns a retained request. The mutex must be locked.
+
+    SPAssetRequest *request = nil;
+
+    if (self->_finishing.count)
+    {
+        request = [self->_finishing[0] retain];
+        [self->_finishing removeObjectAtIndex:0];
+    }
+    else if (self->_waiting.count)
+    {
+        NSInteger numWaiting = self->_waiting.count;
+        NSInteger bestIndex = 0;
+
+        request = self->_waiting[0];
+
+        for (NSInteger i=1; i<numWaiting; ++i)
+        {
+            SPAssetRequest *candidate = self->_waiting[i];
+            if (candidate->_priority > request->_priority)
+            {
+                bestIndex = i;
+                request = candidate;
+            }
+        }
+
+        [request retain];
+        [self->_waiting removeObjectAtIndex:bestIndex];
+    }
+
+    return request;
+}
+
+static void finishRequest(SPAssetRequest *request)
+{
+    if (request->_type == SPAssetTypeTexture)
+        request->_asset = [request->_texture retain];
+    else
+        request->_asset = [[assetClassForType(request->_type) alloc]
+                           initWithContentsOfFile:request->_path texture:request->_texture];
+}
+
+static BOOL decodeRequest(SPAssetRequest *request)
+{
+    // returns YES if the request has to pass the upload stage
+
+    switch (request->_type)
+    {
+        case SPAssetTypeSound:
+            request->_asset = [[SPSound alloc] initWithContentsOfFile:request->_path];
+            return NO;
+
+        case SPAssetTypeTexture:
+            // cached under the original path, just like in 'SPTexture initWithContentsOfFile:'
+            request->_texturePath = [request->_path copy];
+            break;
+
+        default:
+            request->_texturePath = [[assetClassForType(request->_type)
+                                      texturePathForContentsOfFile:request->_path] retain];
+            break;
+    }
+
+    SPTexture *cachedTexture = [SPTexture cachedTextureForPath:request->_texturePath];
+    if (cachedTexture)
+    {
+        request->_texture = [cachedTexture retain];
+        finishRequest(request);
+        return NO;
+    }
+
+    NSString *absolutePath = [SPUtils absolutePathToFile:request->_texturePath];
+    if (!absolutePath)
+        [NSException raise:SPExceptionFileNotFound format:@"File '%@' not found", request->_texturePath];
+
+    request->_decodedTexture = [[SPDecodedTexture alloc] initWithContentsOfFile:absolutePath
+                                                                        options:request->_options];
+    return YES;
+}
+
+static void processRequest(SPAssetLoader *self, SPAssetRequest *request)
+{
+    double startTime = CACurrentMediaTime();
+    BOOL needsUpload = NO;
+
+    @try
+    {
+        if (request->_texture) finishRequest(request);
+        else needsUpload = decodeRequest(request);
+    }
+    @catch (NSException *exception)
+    {
+        request->_error = [errorWithException(exception) retain];
+        needsUpload = NO;
+    }
+
+    double decodeTime = CACurrentMediaTime() - startTime;
+
+    pthread_mutex_lock(&self->_mutex);
+
+    self->_decodeTime += decodeTime;
+    self->_numBytesDecoded += request->_decodedTexture.numBytes;
+
+    // the cancellation flag is set on the main thread; at worst, a cancelled texture is uploaded.
+    if (needsUpload && !request->_isCancelled) [self->_decoded addObject:request];
+    else             [self->_completed addObject:request];
+
+    pthread_mutex_unlock(&self->_mutex);
+}
+
+static void startWorkers(SPAssetLoader *self)
+{
+    // the mutex must be locked
+
+    NSInteger numQueued = self->_waiting.count + self->_finishing.count;
+
+    while (self->_numActiveWorkers < self->_numWorkers && numQueued-- > 0)
+    {
+        ++self->_numActiveWorkers;
+
+        dispatch_async(dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0), ^
+        {
+            while (YES)
+            {
+                pthread_mutex_lock(&self->_mutex);
+                SPAssetRequest *request = nextRequest(self);
+                if (!request) --self->_numActiveWorkers;
+                pthread_mutex_unlock(&self->_mutex);
+
+                if (!request) break;
+
+                @autoreleasepool
+                {
+                    processRequest(self, request);
+                    [request release];
+                }
+            }
+        });
+    }
+}
+
+static void uploadRequests(SPAssetLoader *self, NSArray *batch)
+{
+    // executed in the resource queue (or on the main thread, if there is no view controller)
+
+    double startTime = CACurrentMediaTime();
+    uint64_t numBytes = 0;
+    GLsync waitUntilTexturesLoaded = nil;
+    SPContext *context = [SPContext currentContext];
+
+    for (SPAssetRequest *request in batch)
+    {
+        @try
+        {
+            // the texture might have been loaded by another request in the meantime
+            SPTexture *texture = [SPTexture cachedTextureForPath:request->_texturePath];
+
+            if (!texture)
+            {
+                texture = [request->_decodedTexture createTexture];
+                numBytes += request->_decodedTexture.numBytes;
+                [SPTexture cacheTexture:texture forPath:request->_texturePath];
+            }
+
+            request->_texture = [texture retain];
+        }
+        @catch (NSException *exception)
+        {
+            request->_error = [errorWithException(exception) retain];
+        }
+
+        SP_RELEASE_AND_NIL(request->_decodedTexture);
+    }
+
+    if (context.multiThreaded)
+    {
+        waitUntilTexturesLoaded = glFenceSyncAPPLE(GL_SYNC_GPU_COMMANDS_COMPLETE_APPLE, 0);
+        glClientWaitSyncAPPLE(waitUntilTexturesLoaded, GL_SYNC_FLUSH_COMMANDS_BIT_APPLE,
+                              GL_TIMEOUT_IGNORED_APPLE);
+        glDeleteSync(waitUntilTexturesLoaded);
+    }
+
+    double uploadTime = CACurrentMediaTime() - startTime;
+
+    pthread_mutex_lock(&self->_mutex);
+
+    self->_uploadTime += uploadTime;
+    self->_numBytesUploaded += numBytes;
+    self->_isUploading = NO;
+
+    for (SPAssetRequest *request in batch)
+    {
+        if (request->_type == SPAssetTypeTexture || request->_error)
+        {
+            SP_RELEASE_AND_RETAIN(request->_asset, request->_texture);
+            [self->_completed addObject:request];
+        }
+        else [self->_finishing addObject:request];
+    }
+
+    startWorkers(self);
+    pthread_mutex_unlock(&self->_mutex);
+}
+
+static void requestFinished(SPAssetLoader *self, SPAssetRequest *request)
+{
+    request->_loader = nil;
+    [self->_requests removeObjectIdenticalTo:request];
+    ++self->_numFinishedRequests;
+}
+
+#pragma mark Initialization
+
+- (instancetype)initWithNumWorkers:(NSInteger)numWorkers
+{
+    if ((self = [super init]))
+    {
+        pthread_mutex_init(&_mutex, NULL);
+
+        _waiting   = [[NSMutableArray alloc] init];
+        _finishing = [[NSMutableArray alloc] init];
+        _decoded   = [[NSMutableArray alloc] init];
+        _completed = [[NSMutableArray alloc] init];
+        _requests  = [[NSMutableArray alloc] init];
+
+        _numWorkers = MAX(1, numWorkers);
+        _uploadBudget = DEFAULT_UPLOAD_BUDGET;
+    }
+    return self;
+}
+
+- (instancetype)init
+{
+    return [self initWithNumWorkers:[NSProcessInfo processInfo].activeProcessorCount];
+}
+
+- (void)dealloc
+{
+    // workers retain the loader, so none of them can be active any longer
+    for (SPAssetRequest *request in _requests)
+        request->_loader = nil;
+
+    pthread_mutex_destroy(&_mutex);
+
+    [_waiting release];
+    [_finishing release];
+    [_decoded release];
+    [_completed release];
+    [_requests release];
+    [_onProgress release];
+    [super dealloc];
+}
+
++ (instancetype)assetLoader
+{
+    return [[[self alloc] init] autorelease];
+}
+
+#pragma mark Methods
+
+- (SPAssetRequest *)loadTextureFromFile:(NSString *)path generateMipmaps:(BOOL)mipmaps
+                               priority:(NSInteger)priority onComplete:(SPAssetLoadingBlock)onComplete
+{
+    SPTextureOptions *options = [SPTextureOptions textureOptions];
+    options.generateMipmaps = mipmaps;
+    return [self loadTextureFromFile:path options:options priority:priority onComplete:onComplete];
+}
+
+- (SPAssetRequest *)loadTextureFromFile:(NSString *)path options:(SPTextureOptions *)options
+                               priority:(NSInteger)priority onComplete:(SPAssetLoadingBlock)onComplete
+{
+    return [self addRequestWithType:SPAssetTypeTexture path:path options:options priority:priority
+                         onComplete:onComplete];
+}
+
+- (SPAssetRequest *)loadTextureFromFile:(NSString *)path onComplete:(SPAssetLoadingBlock)onComplete
+{
+    return [self loadTextureFromFile:path generateMipmaps:NO priority:0 onComplete:onComplete];
+}
+
+- (SPAssetRequest *)loadTextureAtlasFromFile:(NSString *)path priority:(NSInteger)priority
+                                  onComplete:(SPAssetLoadingBlock)onComplete
+{
+    return [self addRequestWithType:SPAssetTypeTextureAtlas path:path options:nil priority:priority
+                         onComplete:onComplete];
+}
+
+- (SPAssetRequest *)loadBitmapFontFromFile:(NSString *)path priority:(NSInteger)priority
+                                onComplete:(SPAssetLoadingBlock)onComplete
+{
+    return [self addRequestWithType:SPAssetTypeBitmapFont path:path options:nil priority:priority
+                         onComplete:onComplete];
+}
+
+- (SPAssetRequest *)loadSoundFromFile:(NSString *)path priority:(NSInteger)priority
+                           onComplete:(SPAssetLoadingBlock)onComplete
+{
+    return [self addRequestWithType:SPAssetTypeSound path:path options:nil priority:priority
+                         onComplete:onComplete];
+}
+
+- (void)cancelAllRequests
+{
+    for (SPAssetRequest *request in [[_requests copy] autorelease])
+        [self cancelRequest:request];
+}
+
+#pragma mark SPAnimatable
+
+- (void)advanceTime:(double)passedTime
+{
+    [self startUploads];
+    [self deliverCompletedRequests];
+}
+
+#pragma mark Private
+
+- (SPAssetRequest *)addRequestWithType:(SPAssetType)type path:(NSString *)path
+                               options:(SPTextureOptions *)options priority:(NSInteger)priority
+                            onComplete:(SPAssetLoadingBlock)onComplete
+{
+    SPAssetRequest *request = [[SPAssetRequest alloc] initWithLoader:self type:type path:path
+                               options:options priority:priority onComplete:onComplete];
+
+    [_requests addObject:request];
+    ++_numRequests;
+
+    pthread_mutex_lock(&_mutex);
+    [_waiting addObject:request];
+    startWorkers(self);
+    pthread_mutex_unlock(&_mutex);
+
+    return [request autorelease];
+}
+
+- (void)cancelRequest:(SPAssetRequest *)request
+{
+    if (request->_loader != self) return;
+
+    pthread_mutex_lock(&_mutex);
+    [_waiting removeObjectIdenticalTo:request];
+    [_finishing removeObjectIdenticalTo:request];
+    [_decoded removeObjectIdenticalTo:request];
+    pthread_mutex_unlock(&_mutex);
+
+    // a worker or the upload stage might still hold the request; delivery will skip it.
+    request->_isCancelled = YES;
+    requestFinished(self, request);
+}
+
+- (void)setPriority:(NSInteger)priority ofRequest:(SPAssetRequest *)request
+{
+    pthread_mutex_lock(&_mutex);
+    request->_priority = priority;
+    pthread_mutex_unlock(&_mutex);
+}
+
+- (void)startUploads
+{
+    SP_GENERIC(NSMutableArray, SPAssetRequest*) *batch = nil;
+
+    pthread_mutex_lock(&_mutex);
+
+    if (!_isUploading && _decoded.count)
+    {
+        // the budget is spent by the batch that starts in this frame; the next batch only starts
+        // when this one has reached the GPU.
+
+        NSUInteger numBytes = 0;
+        NSInteger numRequests = 0;
+        NSInteger numDecoded = _decoded.count;
+
+        while (numRequests < numDecoded)
+        {
+            SPAssetRequest *request = _decoded[numRequests];
+            NSUInteger numRequestBytes = request->_decodedTexture.numBytes;
+
+            if (numRequests && numBytes + numRequestBytes > _uploadBudget) break;
+
+            numBytes += numRequestBytes;
+            ++numRequests;
+        }
+
+        NSRange range = NSMakeRange(0, numRequests);
+        batch = [[_decoded subarrayWithRange:range] mutableCopy];
+        [_decoded removeObjectsInRange:range];
+        _isUploading = YES;
+    }
+
+    pthread_mutex_unlock(&_mutex);
+
+    if (!batch) return;
+
+    SPViewController *controller = Sparrow.currentController;
+
+    if (controller)
+    {
+        [self retain]; // released after the upload
+
+        [controller executeInResourceQueue:^
+        {
+            uploadRequests(self, batch);
+            [batch release];
+            [self release];
+        }];
+    }
+    else
+    {
+        uploadRequests(self, batch);
+        [batch release];
+    }
+}
+
+- (void)deliverCompletedRequests
+{
+    pthread_mutex_lock(&_mutex);
+    SP_GENERIC(NSMutableArray, SPAssetRequest*) *completed = _completed;
+    _completed = [[NSMutableArray alloc] init];
+    pthread_mutex_unlock(&_mutex);
+
+    BOOL hasDelivered = NO;
+
+    for (SPAssetRequest *request in completed)
+    {
+        if (request->_isCancelled) continue;
+
+        request->_isComplete = YES;
+        requestFinished(self, request);
+        hasDelivered = YES;
+
+        @try
+        {
+            if (request->_onComplete) request->_onComplete(request->_asset, request->_error);
+        }
+        @finally
+        {
+            SP_RELEASE_AND_NIL(request->_onComplete);
+            SP_RELEASE_AND_NIL(request->_asset);
+            SP_RELEASE_AND_NIL(request->_texture);
+        }
+    }
+
+    [completed release];
+
+    if (hasDelivered && _onProgress)
+        _onProgress();
+
+    if (!_requests.count)
+        _numRequests = _numFinishedRequests = 0;
+}
+
+#pragma mark Properties
+
+- (float)progress
+{
+    return _numRequests ? (float)_numFinishedRequests / _numRequests : 1.0f;
+}
+
+- (NSInteger)numPendingRequests
+{
+    return _requests.count;
+}
+
+- (uint64_t)numBytesDecoded
+{
+    pthread_mutex_lock(&_mutex);
+    uint64_t numBytes = _numBytesDecoded;
+    pthread_mutex_unlock(&_mutex);
+    return numBytes;
+}
+
+- (uint64_t)numBytesUploaded
+{
+    pthread_mutex_lock(&_mutex);
+    uint64_t numBytes = _numBytesUploaded;
+    pthread_mutex_unlock(&_mutex);
+    return numBytes;
+}
+
+- (double)decodeTime
+{
+    pthread_mutex_lock(&_mutex);
+    double time = _decodeTime;
+    pthread_mutex_unlock(&_mutex);
+    return time;
+}
+
+- (double)uploadTime
+{
+    pthread_mutex_lock(&_mutex);
+    double time = _uploadTime;
+    pthread_mutex_unlock(&_mutex);
+    return time;
+}
+
+- (double)decodeThroughput
+{
+    double time = self.decodeTime;
+    return time > 0.0 ? self.numBytesDecoded / time : 0.0;
+}
+
+- (double)uploadThroughput
+{
+    double time = self.uploadTime;
+    return time > 0.0 ? self.numBytesUploaded / time : 0.0;
+}
+
+@synthesize numWorkers = _numWorkers;
+@synthesize uploadBudget = _uploadBudget;
+@synthesize onProgress = _onProgress;
+
+@end
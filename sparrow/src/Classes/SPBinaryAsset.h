@@ -0,0 +1,155 @@
+//
+//  SPBinaryAsset.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 14.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SparrowBase.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/** ------------------------------------------------------------------------------------------------
+
+ Binary assets are compiled versions of the XML files that describe texture atlases and bitmap
+ fonts. They are stored as "sidecars" next to the XML files they were created from, with the
+ extension `spb` instead of the original one (e.g. `atlas@2x.xml` -> `atlas@2x.spb`).
+
+ All data is stored in fixed-size little-endian records, so a file can be memory-mapped and its
+ tables read in place, without parsing any text:
+
+    header | type specific header fields | tables | string table
+
+ Each table is referenced by the byte offset of its first record and the number of records;
+ strings are stored as UTF-8 bytes in the string table at the end of the file. The header also
+ contains the size and hash of the XML file a binary asset was created from; when the XML file
+ changes, the binary asset is ignored until it is converted again.
+
+------------------------------------------------------------------------------------------------- */
+
+SP_EXTERN NSString *const SPBinaryAssetExtension;
+
+typedef NS_ENUM(uint32_t, SPBinaryAssetType)
+{
+    SPBinaryAssetTypeAtlas = 'SPTA',
+    SPBinaryAssetTypeFont  = 'SPBF',
+};
+
+/// A string in the string table.
+typedef struct
+{
+    uint32_t offset;    // relative to the start of the string table
+    uint32_t length;    // in bytes
+} SPBinaryString;
+
+typedef struct
+{
+    uint32_t type;
+    uint32_t version;
+    uint64_t sourceSize;
+    uint64_t sourceHash;
+    uint32_t stringsOffset;
+    uint32_t stringsLength;
+} SPBinaryAssetHeader;
+
+typedef struct
+{
+    SPBinaryAssetHeader header;
+    SPBinaryString imagePath;
+    uint32_t numRegions;
+    uint32_t regionsOffset;
+} SPBinaryAtlasHeader;
+
+/// All values are in pixels, just like in the XML file. A frame with a width or height of zero
+/// means that the region does not have a frame.
+typedef struct
+{
+    SPBinaryString name;
+    float x, y, width, height;
+    float frameX, frameY, frameWidth, frameHeight;
+    uint32_t rotated;
+} SPBinaryRegion;
+
+typedef struct
+{
+    SPBinaryAssetHeader header;
+    SPBinaryString face;
+    SPBinaryString pageFile;
+    float size;
+    float lineHeight;
+    float baseline;
+    uint32_t smooth;
+    uint32_t numGlyphs;
+    uint32_t glyphsOffset;
+    uint32_t numKernings;
+    uint32_t kerningsOffset;
+} SPBinaryFontHeader;
+
+typedef struct
+{
+    int32_t charID;
+    float x, y, width, height;
+    float xOffset, yOffset, xAdvance;
+} SPBinaryGlyph;
+
+typedef struct
+{
+    int32_t first;
+    int32_t second;
+    float amount;
+} SPBinaryKerning;
+
+/// Returns the path of the binary asset that belongs to an XML file.
+SP_EXTERN NSString *SPBinaryAssetPathForFile(NSString *xmlPath);
+
+/// Finds the binary asset of an XML file (relative paths are resolved like in `SPUtils`). Returns
+/// its memory-mapped contents if it was created from the current version of the XML file, or if
+/// only the binary asset exists. Returns nil if the XML file should be parsed instead. The
+/// absolute path of the file that was found (binary or XML) is stored in `absolutePath`. Raises an
+/// exception if neither file exists or if the binary asset is corrupt.
+SP_EXTERN NSData *_Nullable SPBinaryAssetLoad(NSString *path, SPBinaryAssetType type,
+                                              NSString *_Nonnull *_Nonnull absolutePath);
+
+/// Returns a pointer to a table of a loaded binary asset, raising an exception if the table does
+/// not fit into the data.
+SP_EXTERN const void *SPBinaryAssetTable(NSData *data, uint32_t offset, uint32_t count,
+                                         size_t recordSize);
+
+/// Returns a copy of a string from the string table of a loaded binary asset.
+SP_EXTERN NSString *SPBinaryAssetString(NSData *data, SPBinaryString string);
+
+/** ------------------------------------------------------------------------------------------------
+
+ An SPBinaryAssetWriter assembles a binary asset in memory. Add tables and strings, fill in the
+ type specific header fields, and write the file; the common header fields and the string table
+ are taken care of.
+
+------------------------------------------------------------------------------------------------- */
+
+@interface SPBinaryAssetWriter : NSObject
+
+/// Initializes a writer for an asset of a certain type, created from the given XML data. The
+/// header size includes the common `SPBinaryAssetHeader`.
+- (instancetype)initWithType:(SPBinaryAssetType)type sourceData:(NSData *)sourceData
+                  headerSize:(size_t)headerSize;
+
+/// Adds a string to the string table; equal strings are stored only once.
+- (SPBinaryString)addString:(NSString *)string;
+
+/// Appends a table and returns its offset.
+- (uint32_t)appendTable:(const void *)records count:(NSInteger)count recordSize:(size_t)recordSize;
+
+/// Writes the asset to a file (atomically).
+- (void)writeToFile:(NSString *)path;
+
+/// The type specific header (starting with the common `SPBinaryAssetHeader`), to be filled in
+/// before writing the file.
+@property (nonatomic, readonly) void *header;
+
+@end
+
+NS_ASSUME_NONNULL_END
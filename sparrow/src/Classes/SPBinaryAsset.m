@@ -0,0 +1,235 @@
+//
+//  SPBinaryAsset.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 14.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPBinaryAsset.h"
+#import "SPMacros.h"
+#import "SPUtils.h"
+
+NSString *const SPBinaryAssetExtension = @"spb";
+
+#define BINARY_ASSET_VERSION 1
+
+// --- C functions ---------------------------------------------------------------------------------
+
+static uint64_t hashBytes(const void *bytes, NSUInteger length)
+{
+    // 64 bit FNV-1a
+    const uint8_t *data = bytes;
+    uint64_t hash = 0xcbf29ce484222325ULL;
+
+    for (NSUInteger i=0; i<length; ++i)
+    {
+        hash ^= data[i];
+        hash *= 0x100000001b3ULL;
+    }
+
+    return hash;
+}
+
+static NSData *mapFile(NSString *path)
+{
+    NSError *error = nil;
+    NSData *data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:&error];
+
+    if (!data)
+        [NSException raise:SPExceptionFileInvalid format:@"could not read %@. Error: %@",
+         path, error.localizedDescription];
+
+    return data;
+}
+
+static void validateAsset(NSData *data, SPBinaryAssetType type, NSString *path)
+{
+    const SPBinaryAssetHeader *header = data.bytes;
+
+    if (data.length < sizeof(SPBinaryAssetHeader) || header->type != type)
+        [NSException raise:SPExceptionFileInvalid format:@"wrong binary asset type: %@", path];
+
+    if (header->version != BINARY_ASSET_VERSION)
+        [NSException raise:SPExceptionFileInvalid format:@"unsupported binary asset version %d: %@",
+         header->version, path];
+
+    if ((uint64_t)header->stringsOffset + header->stringsLength > data.length)
+        [NSException raise:SPExceptionFileInvalid format:@"corrupt binary asset: %@", path];
+}
+
+NSString *SPBinaryAssetPathForFile(NSString *xmlPath)
+{
+    return [[xmlPath stringByDeletingPathExtension] stringByAppendingPathExtension:SPBinaryAssetExtension];
+}
+
+NSData *SPBinaryAssetLoad(NSString *path, SPBinaryAssetType type, NSString **absolutePath)
+{
+    NSString *xmlPath = [SPUtils absolutePathToFile:path];
+    NSString *binaryPath = xmlPath ? SPBinaryAssetPathForFile(xmlPath) :
+                                     [SPUtils absolutePathToFile:SPBinaryAssetPathForFile(path)];
+
+    if (!xmlPath && !binaryPath)
+        [NSException raise:SPExceptionFileNotFound format:@"file not found: %@", path];
+
+    if (!xmlPath)
+    {
+        NSData *binaryData = mapFile(binaryPath);
+        validateAsset(binaryData, type, binaryPath);
+        *absolutePath = binaryPath;
+        return binaryData;
+    }
+
+    *absolutePath = xmlPath;
+
+    if (![SPUtils fileExistsAtPath:binaryPath])
+        return nil;
+
+    NSData *binaryData = mapFile(binaryPath);
+    validateAsset(binaryData, type, binaryPath);
+
+    // the binary asset is only up to date if it was created from exactly this XML file
+    const SPBinaryAssetHeader *header = binaryData.bytes;
+    NSData *xmlData = mapFile(xmlPath);
+
+    if (header->sourceSize != xmlData.length ||
+        header->sourceHash != hashBytes(xmlData.bytes, xmlData.length))
+        return nil;
+
+    return binaryData;
+}
+
+const void *SPBinaryAssetTable(NSData *data, uint32_t offset, uint32_t count, size_t recordSize)
+{
+    if (offset % 4 || (uint64_t)offset + (uint64_t)count * recordSize > data.length)
+        [NSException raise:SPExceptionFileInvalid format:@"corrupt binary asset (invalid table)"];
+
+    return (const uint8_t *)data.bytes + offset;
+}
+
+NSString *SPBinaryAssetString(NSData *data, SPBinaryString string)
+{
+    const SPBinaryAssetHeader *header = data.bytes;
+
+    if ((uint64_t)string.offset + string.length > header->stringsLength)
+        [NSException raise:SPExceptionFileInvalid format:@"corrupt binary asset (invalid string)"];
+
+    const uint8_t *bytes = (const uint8_t *)data.bytes + header->stringsOffset + string.offset;
+    NSString *result = [[NSString alloc] initWithBytes:bytes length:string.length
+                                              encoding:NSUTF8StringEncoding];
+    if (!result)
+        [NSException raise:SPExceptionFileInvalid format:@"corrupt binary asset (invalid string)"];
+
+    return [result autorelease];
+}
+
+// --- class implementation ------------------------------------------------------------------------
+
+@implementation SPBinaryAssetWriter
+{
+    SPBinaryAssetType _type;
+    uint64_t _sourceSize;
+    uint64_t _sourceHash;
+    NSMutableData *_header;
+    NSMutableData *_tables;
+    NSMutableData *_strings;
+    SP_GENERIC(NSMutableDictionary, NSString*, NSNumber*) *_stringOffsets;
+}
+
+#pragma mark Initialization
+
+- (instancetype)initWithType:(SPBinaryAssetType)type sourceData:(NSData *)sourceData
+                  headerSize:(size_t)headerSize
+{
+    if (headerSize < sizeof(SPBinaryAssetHeader) || headerSize % 8)
+        [NSException raise:SPExceptionInvalidOperation format:@"invalid header size: %d", (int)headerSize];
+
+    if ((self = [super init]))
+    {
+        _type = type;
+        _sourceSize = sourceData.length;
+        _sourceHash = hashBytes(sourceData.bytes, sourceData.length);
+        _header = [[NSMutableData alloc] initWithLength:headerSize];
+        _tables = [[NSMutableData alloc] init];
+        _strings = [[NSMutableData alloc] init];
+        _stringOffsets = [[NSMutableDictionary alloc] init];
+    }
+    return self;
+}
+
+- (instancetype)init
+{
+    SP_USE_DESIGNATED_INITIALIZER(initWithType:sourceData:headerSize:);
+    return nil;
+}
+
+- (void)dealloc
+{
+    [_header release];
+    [_tables release];
+    [_strings release];
+    [_stringOffsets release];
+    [super dealloc];
+}
+
+#pragma mark Methods
+
+- (SPBinaryString)addString:(NSString *)string
+{
+    NSData *utf8 = [string ?: @"" dataUsingEncoding:NSUTF8StringEncoding];
+    NSNumber *offset = _stringOffsets[string ?: @""];
+
+    if (!offset)
+    {
+        offset = @(_strings.length);
+        _stringOffsets[string ?: @""] = offset;
+        [_strings appendData:utf8];
+    }
+
+    return (SPBinaryString){ .offset = offset.unsignedIntValue, .length = (uint32_t)utf8.length };
+}
+
+- (uint32_t)appendTable:(const void *)records count:(NSInteger)count recordSize:(size_t)recordSize
+{
+    uint32_t offset = (uint32_t)(_header.length + _tables.length);
+    [_tables appendBytes:records length:count * recordSize];
+
+    // keep all tables aligned to 4 bytes
+    NSUInteger padding = (4 - _tables.length % 4) % 4;
+    if (padding) [_tables increaseLengthBy:padding];
+
+    return offset;
+}
+
+- (void)writeToFile:(NSString *)path
+{
+    SPBinaryAssetHeader *header = _header.mutableBytes;
+    header->type = _type;
+    header->version = BINARY_ASSET_VERSION;
+    header->sourceSize = _sourceSize;
+    header->sourceHash = _sourceHash;
+    header->stringsOffset = (uint32_t)(_header.length + _tables.length);
+    header->stringsLength = (uint32_t)_strings.length;
+
+    NSMutableData *data = [NSMutableData dataWithCapacity:header->stringsOffset + _strings.length];
+    [data appendData:_header];
+    [data appendData:_tables];
+    [data appendData:_strings];
+
+    NSError *error = nil;
+    if (![data writeToFile:path options:NSDataWritingAtomic error:&error])
+        [NSException raise:SPExceptionFileInvalid format:@"could not write %@. Error: %@",
+         path, error.localizedDescription];
+}
+
+#pragma mark Properties
+
+- (void *)header
+{
+    return _header.mutableBytes;
+}
+
+@end
@@ -39,7 +39,9 @@ NS_ASSUME_NONNULL_BEGIN
 /// @name Methods
 /// -------------
 
-/// Adds kerning information relative to a specific other character ID.
+/// Adds kerning information relative to a specific other character ID. Note that bitmap fonts
+/// arrange text with their own kerning table, which picks up the kernings of a char when it is
+/// added to the font; use `[SPBitmapFont addKerning:fromChar:toChar:]` to change it later.
 - (void)addKerning:(float)amount toChar:(int)charID;
 
 /// Retrieve kerning information relative to the given character ID.
@@ -9,7 +9,7 @@
 //  it under the terms of the Simplified BSD License.
 //
 
-#import "SPBitmapChar.h"
+#import "SPBitmapChar_Internal.h"
 #import "SPImage.h"
 #import "SPMacros.h"
 #import "SPTexture.h"
@@ -21,7 +21,25 @@
     float _xOffset;
     float _yOffset;
     float _xAdvance;
-    NSMutableDictionary *_kernings;
+    int *_kerningCharIDs;       // sorted, so that lookups can use a binary search
+    float *_kerningAmounts;
+    NSInteger _numKernings;
+}
+
+static NSInteger kerningIndex(SPBitmapChar *self, int charID)
+{
+    // returns the index of 'charID', or the index it would have to be inserted at
+    NSInteger low = 0;
+    NSInteger high = self->_numKernings;
+
+    while (low < high)
+    {
+        NSInteger mid = (low + high) / 2;
+        if (self->_kerningCharIDs[mid] < charID) low = mid + 1;
+        else high = mid;
+    }
+
+    return low;
 }
 
 #pragma mark Initialization
@@ -36,7 +54,6 @@
         _xOffset = xOffset;
         _yOffset = yOffset;
         _xAdvance = xAdvance;
-		_kernings = nil;
     }
     return self;
 }
@@ -55,7 +72,8 @@
 - (void)dealloc
 {
     [_texture release];
-    [_kernings release];
+    free(_kerningCharIDs);
+    free(_kerningAmounts);
     [super dealloc];
 }
 
@@ -63,16 +81,32 @@
 
 - (void)addKerning:(float)amount toChar:(int)charID
 {
-    if (!_kernings)
-        _kernings = [[NSMutableDictionary alloc] init];    
+    NSInteger index = kerningIndex(self, charID);
+
+    if (index == _numKernings || _kerningCharIDs[index] != charID)
+    {
+        _kerningCharIDs = realloc(_kerningCharIDs, sizeof(int) * (_numKernings + 1));
+        _kerningAmounts = realloc(_kerningAmounts, sizeof(float) * (_numKernings + 1));
 
-	_kernings[@(charID)] = @(amount);
+        NSInteger numMoved = _numKernings - index;
+        memmove(_kerningCharIDs + index + 1, _kerningCharIDs + index, sizeof(int) * numMoved);
+        memmove(_kerningAmounts + index + 1, _kerningAmounts + index, sizeof(float) * numMoved);
+
+        _kerningCharIDs[index] = charID;
+        ++_numKernings;
+    }
+
+    _kerningAmounts[index] = amount;
 }
 
 - (float)kerningToChar:(int)charID
 {
-	NSNumber *amount = (NSNumber *)_kernings[@(charID)];
-	return [amount floatValue];
+    NSInteger index = kerningIndex(self, charID);
+
+    if (index < _numKernings && _kerningCharIDs[index] == charID)
+        return _kerningAmounts[index];
+    else
+        return 0.0f;
 }
 
 - (SPImage *)createImage
@@ -80,6 +114,14 @@
     return [SPImage imageWithTexture:_texture];
 }
 
+#pragma mark Internal
+
+- (void)enumerateKerningsWithBlock:(void (^)(int charID, float amount))block
+{
+    for (NSInteger i=0; i<_numKernings; ++i)
+        block(_kerningCharIDs[i], _kerningAmounts[i]);
+}
+
 #pragma mark Properties
 
 - (float)width
@@ -0,0 +1,23 @@
+//
+//  SPBitmapChar_Internal.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 10.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPBitmapChar.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface SPBitmapChar (Internal)
+
+/// Calls the block for each kerning of the char, passing the ID of the preceding char.
+- (void)enumerateKerningsWithBlock:(void (^)(int charID, float amount))block;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -43,6 +43,17 @@ SP_EXTERN NSString *const SPBitmapFontMiniName;
 	  </kernings>
 	</font>
   
+ Glyphs of the Basic Multilingual Plane are stored in a two-level page table, and kerning pairs
+ in a hash table keyed by both char IDs; so the lookups done while arranging text neither box
+ numbers nor send messages. Arranged text is written into reusable buffers, and the most recent
+ layouts are cached, so redrawing an unchanged text (or switching back to a recent one) does not
+ repeat the layout.
+
+ To speed up loading, a font file can be converted into Sparrow's binary format with
+ `convertXmlFile:toBinaryFile:`. When `initWithContentsOfFile:` finds an up-to-date binary
+ file with the extension `spb` next to the XML file, it reads the glyphs and kernings from
+ the memory-mapped binary file instead of parsing the XML (see SPTextureAtlas for details).
+
  _You don't have to use this class directly in most cases. SPTextField contains methods that
  handle bitmap fonts for you._
  
@@ -67,6 +78,10 @@ SP_EXTERN NSString *const SPBitmapFontMiniName;
 /// Initializes a bitmap font by parsing an XML file and loading the texture that is specified there.
 - (instancetype)initWithContentsOfFile:(NSString *)path;
 
+/// Converts a font XML file into the binary font format and returns the path of the binary file.
+/// If `binaryPath` is nil, it is stored next to the XML file, with the extension `spb`.
++ (NSString *)convertXmlFile:(NSString *)xmlPath toBinaryFile:(nullable NSString *)binaryPath;
+
 /// Initializes a bitmap font with an integrated, very small font, which is useful for debug output.
 - (instancetype)initWithMiniFont;
 
@@ -77,10 +92,18 @@ SP_EXTERN NSString *const SPBitmapFontMiniName;
 /// Returns a single bitmap char with a certain character ID.
 - (SPBitmapChar *)charByID:(int)charID;
 
-/// Adds a bitmap char with a certain character ID.
+/// Adds a bitmap char with a certain character ID. Kerning information of the char is copied
+/// into the font's kerning table.
 - (void)addBitmapChar:(SPBitmapChar *)bitmapChar charID:(int)charID;
 
-/// Returns a vector containing all the character IDs that are contained in this font.
+/// Adds kerning information for a pair of chars: `amount` is added to the x-position of the char
+/// `second` when it directly follows the char `first`.
+- (void)addKerning:(float)amount fromChar:(int)first toChar:(int)second;
+
+/// Returns the kerning of a pair of chars, or zero if there is none.
+- (float)kerningFromChar:(int)first toChar:(int)second;
+
+/// Returns an array containing all the character IDs that are contained in this font.
 - (SP_GENERIC(NSArray, NSNumber*) *)allCharIDs;
 
 /// Checks whether a provided string can be displayed with the font.
@@ -10,8 +10,9 @@
 //
 
 #import "SparrowClass.h"
-#import "SPBitmapFont.h"
-#import "SPBitmapChar.h"
+#import "SPBitmapFont_Internal.h"
+#import "SPBitmapChar_Internal.h"
+#import "SPBinaryAsset.h"
 #import "SPDisplayObject.h"
 #import "SPImage.h"
 #import "SPNSExtensions.h"
@@ -23,6 +24,7 @@
 #import "SPTextField.h"
 #import "SPTexture.h"
 #import "SPUtils.h"
+#import "SPXMLReader.h"
 
 NSString *const SPBitmapFontMiniName = @"mini";
 
@@ -31,30 +33,42 @@ NSString *const SPBitmapFontMiniName = @"mini";
 #define CHAR_NEWLINE         10
 #define CHAR_CARRIAGE_RETURN 13
 
-// --- helper class --------------------------------------------------------------------------------
+#define CHAR_PAGE_SHIFT       8
+#define CHAR_PAGE_MASK     0xff
+#define NUM_CHAR_PAGES      256 // pages of 256 chars cover the Basic Multilingual Plane
+#define MAX_PAGED_CHAR_ID 0xffff
 
-@interface SPCharLocation : SPPoolObject
+#define KERNING_EMPTY_KEY UINT64_MAX
 
-- (instancetype)initWithChar:(SPBitmapChar *)bitmapChar;
+#define LAYOUT_CACHE_SIZE 8
 
-@property (nonatomic, assign) SPBitmapChar* bitmapChar;
-@property (nonatomic) float scale;
-@property (nonatomic) float x;
-@property (nonatomic) float y;
-
-@end
-
-@implementation SPCharLocation
+typedef struct
+{
+    uint64_t key;   // (first << 32) | second
+    float amount;
+} SPKerningPair;
 
-- (instancetype)initWithChar:(SPBitmapChar *)bitmapChar
+typedef struct
 {
-    if ((self = [super init]))
-        _bitmapChar = bitmapChar;
-    
-    return self;
-}
+    NSString *text;
+    NSUInteger textHash;
+    float width;
+    float height;
+    float fontSize;
+    float leading;
+    SPHAlign hAlign;
+    SPVAlign vAlign;
+    BOOL autoScale;
+    BOOL kerning;
+    float scale;
+    SPGlyphPlacement *glyphs;
+    NSInteger numGlyphs;
+    NSInteger capacity;
+    NSUInteger layoutID;
+    NSUInteger lastUse;
+} SPCachedLayout;
 
-@end
+static NSUInteger nextLayoutID = 1;
 
 // --- class implementation ------------------------------------------------------------------------
 
@@ -62,13 +76,372 @@ NSString *const SPBitmapFontMiniName = @"mini";
 {
     NSString *_name;
     SPTexture *_texture;
-    SP_GENERIC(NSMutableDictionary, NSNumber*, SPBitmapChar*) *_chars;
+    SPBitmapChar **_charPages[NUM_CHAR_PAGES]; // allocated on demand
+    SP_GENERIC(NSMutableDictionary, NSNumber*, SPBitmapChar*) *_extraChars; // beyond the BMP
+    SPKerningPair *_kernings;   // open addressing with linear probing
+    NSUInteger _kerningCapacity; // always a power of two
+    NSUInteger _numKernings;
     float _size;
     float _lineHeight;
     float _baseline;
     float _offsetX;
     float _offsetY;
     SPImage *_helperImage;
+
+    // scratch buffers used while arranging text; they only ever grow
+    unichar *_charBuffer;
+    SPGlyphPlacement *_glyphBuffer;
+    NSInteger *_lineStarts;
+    NSInteger _bufferCapacity;
+    NSInteger _numGlyphs;
+    NSInteger _numLines;
+
+    SPCachedLayout _layoutCache[LAYOUT_CACHE_SIZE];
+    NSUInteger _layoutClock;
+    NSUInteger _version;
+}
+
+SP_INLINE SPBitmapChar *getChar(SPBitmapFont *self, int charID)
+{
+    if (charID >= 0 && charID <= MAX_PAGED_CHAR_ID)
+    {
+        SPBitmapChar **page = self->_charPages[charID >> CHAR_PAGE_SHIFT];
+        return page ? page[charID & CHAR_PAGE_MASK] : nil;
+    }
+    else return self->_extraChars[@(charID)];
+}
+
+static void setChar(SPBitmapFont *self, SPBitmapChar *bitmapChar, int charID)
+{
+    if (charID >= 0 && charID <= MAX_PAGED_CHAR_ID)
+    {
+        SPBitmapChar ***page = &self->_charPages[charID >> CHAR_PAGE_SHIFT];
+        if (!*page) *page = calloc(CHAR_PAGE_MASK + 1, sizeof(SPBitmapChar *));
+        SP_RELEASE_AND_RETAIN((*page)[charID & CHAR_PAGE_MASK], bitmapChar);
+    }
+    else
+    {
+        if (!self->_extraChars) self->_extraChars = [[NSMutableDictionary alloc] init];
+        self->_extraChars[@(charID)] = bitmapChar;
+    }
+}
+
+static void addCharInPixels(SPBitmapFont *self, int charID, float x, float y, float width,
+                            float height, float xOffset, float yOffset, float xAdvance)
+{
+    SPTexture *fontTexture = self->_texture;
+    float scale = fontTexture.scale;
+
+    SPRectangle *region = [[SPRectangle alloc] initWithX:x / scale + fontTexture.frame.x
+                                                       y:y / scale + fontTexture.frame.y
+                                                   width:width / scale height:height / scale];
+    SPSubTexture *texture = [[SPSubTexture alloc] initWithRegion:region ofTexture:fontTexture];
+    SPBitmapChar *bitmapChar = [[SPBitmapChar alloc] initWithID:charID texture:texture
+                                                        xOffset:xOffset / scale
+                                                        yOffset:yOffset / scale
+                                                       xAdvance:xAdvance / scale];
+    setChar(self, bitmapChar, charID);
+
+    [region release];
+    [texture release];
+    [bitmapChar release];
+}
+
+static BOOL isSmoothingDisabled(const SPXMLElement *infoElement)
+{
+    SPXMLSlice smooth = SPXMLElementAttribute(infoElement, "smooth");
+    return smooth.length == 1 && smooth.bytes[0] == '0';
+}
+
+SP_INLINE uint64_t kerningKey(int first, int second)
+{
+    return ((uint64_t)(uint32_t)first << 32) | (uint32_t)second;
+}
+
+SP_INLINE NSUInteger kerningSlot(uint64_t key, NSUInteger capacity)
+{
+    return (NSUInteger)((key * 0x9e3779b97f4a7c15ull) >> 32) & (capacity - 1);
+}
+
+static BOOL insertKerning(SPKerningPair *kernings, NSUInteger capacity, uint64_t key, float amount)
+{
+    // returns YES if the key was not yet part of the table
+    NSUInteger slot = kerningSlot(key, capacity);
+    while (kernings[slot].key != KERNING_EMPTY_KEY && kernings[slot].key != key)
+        slot = (slot + 1) & (capacity - 1);
+
+    BOOL isNew = kernings[slot].key == KERNING_EMPTY_KEY;
+    kernings[slot].key = key;
+    kernings[slot].amount = amount;
+    return isNew;
+}
+
+static void setKerning(SPBitmapFont *self, int first, int second, float amount)
+{
+    uint64_t key = kerningKey(first, second);
+    if (key == KERNING_EMPTY_KEY) return;
+
+    // keep the load factor below 1/2, so that probe sequences stay short
+    if ((self->_numKernings + 1) * 2 > self->_kerningCapacity)
+    {
+        NSUInteger oldCapacity = self->_kerningCapacity;
+        NSUInteger newCapacity = MAX(64, oldCapacity * 2);
+        SPKerningPair *oldKernings = self->_kernings;
+        SPKerningPair *newKernings = malloc(sizeof(SPKerningPair) * newCapacity);
+
+        for (NSUInteger i=0; i<newCapacity; ++i)
+            newKernings[i].key = KERNING_EMPTY_KEY;
+
+        for (NSUInteger i=0; i<oldCapacity; ++i)
+            if (oldKernings[i].key != KERNING_EMPTY_KEY)
+                insertKerning(newKernings, newCapacity, oldKernings[i].key, oldKernings[i].amount);
+
+        free(oldKernings);
+        self->_kernings = newKernings;
+        self->_kerningCapacity = newCapacity;
+    }
+
+    if (insertKerning(self->_kernings, self->_kerningCapacity, key, amount))
+        ++self->_numKernings;
+}
+
+static void addKerning(SPBitmapFont *self, int first, int second, float amount)
+{
+    // the second char keeps a copy, which is what '-[SPBitmapChar kerningToChar:]' returns
+    setKerning(self, first, second, amount);
+    [getChar(self, second) addKerning:amount toChar:first];
+}
+
+SP_INLINE float getKerning(SPBitmapFont *self, int first, int second)
+{
+    if (!self->_numKernings || first < 0) return 0.0f;
+
+    uint64_t key = kerningKey(first, second);
+    SPKerningPair *kernings = self->_kernings;
+    NSUInteger mask = self->_kerningCapacity - 1;
+    NSUInteger slot = kerningSlot(key, self->_kerningCapacity);
+
+    while (kernings[slot].key != KERNING_EMPTY_KEY)
+    {
+        if (kernings[slot].key == key) return kernings[slot].amount;
+        slot = (slot + 1) & mask;
+    }
+
+    return 0.0f;
+}
+
+static void clearLayoutCache(SPBitmapFont *self)
+{
+    ++self->_version;
+
+    for (int i=0; i<LAYOUT_CACHE_SIZE; ++i)
+    {
+        SPCachedLayout *layout = &self->_layoutCache[i];
+        SP_RELEASE_AND_NIL(layout->text);
+        layout->lastUse = 0;
+    }
+}
+
+static SPCachedLayout *cachedLayout(SPBitmapFont *self, NSString *text, NSUInteger textHash,
+                                    float width, float height, float size,
+                                    SPHAlign hAlign, SPVAlign vAlign, BOOL autoScale,
+                                    BOOL kerning, float leading)
+{
+    for (int i=0; i<LAYOUT_CACHE_SIZE; ++i)
+    {
+        SPCachedLayout *layout = &self->_layoutCache[i];
+
+        if (layout->text && layout->textHash == textHash &&
+            layout->width == width && layout->height == height && layout->fontSize == size &&
+            layout->hAlign == hAlign && layout->vAlign == vAlign &&
+            layout->autoScale == autoScale && layout->kerning == kerning &&
+            layout->leading == leading && [layout->text isEqualToString:text])
+        {
+            return layout;
+        }
+    }
+
+    return NULL;
+}
+
+static SPCachedLayout *leastRecentlyUsedLayout(SPBitmapFont *self)
+{
+    SPCachedLayout *result = &self->_layoutCache[0];
+
+    for (int i=1; i<LAYOUT_CACHE_SIZE; ++i)
+        if (self->_layoutCache[i].lastUse < result->lastUse)
+            result = &self->_layoutCache[i];
+
+    return result;
+}
+
+static void ensureBufferCapacity(SPBitmapFont *self, NSInteger numChars)
+{
+    if (numChars <= self->_bufferCapacity) return;
+
+    NSInteger capacity = MAX(numChars, self->_bufferCapacity * 2);
+    self->_charBuffer  = realloc(self->_charBuffer,  sizeof(unichar) * capacity);
+    self->_glyphBuffer = realloc(self->_glyphBuffer, sizeof(SPGlyphPlacement) * capacity);
+    self->_lineStarts  = realloc(self->_lineStarts,  sizeof(NSInteger) * (capacity + 1));
+    self->_bufferCapacity = capacity;
+}
+
+static BOOL arrangeLines(SPBitmapFont *self, NSInteger numChars, float containerWidth,
+                         float containerHeight, BOOL kerning, float leading)
+{
+    // Arranges the chars in '_charBuffer' line by line (unscaled), writing the glyphs into
+    // '_glyphBuffer' and the index of the first glyph of each line into '_lineStarts'.
+    // Returns NO if the text did not fit into the container.
+
+    const unichar *chars = self->_charBuffer;
+    SPGlyphPlacement *glyphs = self->_glyphBuffer;
+    NSInteger *lineStarts = self->_lineStarts;
+    NSInteger numGlyphs = 0;
+    NSInteger numLines = 0;
+    NSInteger lineStart = 0;
+    NSInteger lastWhiteSpace = -1;
+    int lastCharID = -1;
+    float currentX = 0.0f;
+    float currentY = 0.0f;
+    float lineHeight = self->_lineHeight;
+    BOOL finished = NO;
+
+    for (NSInteger i=0; i<numChars; ++i)
+    {
+        BOOL lineFull = NO;
+        int charID = chars[i];
+        SPBitmapChar *bitmapChar = getChar(self, charID);
+
+        if (charID == CHAR_NEWLINE || charID == CHAR_CARRIAGE_RETURN)
+        {
+            lineFull = YES;
+        }
+        else if (!bitmapChar)
+        {
+            SPLog(@"Missing character: %d", charID);
+        }
+        else
+        {
+            if (charID == CHAR_SPACE || charID == CHAR_TAB)
+                lastWhiteSpace = i;
+
+            if (kerning)
+                currentX += getKerning(self, lastCharID, charID);
+
+            SPGlyphPlacement *glyph = &glyphs[numGlyphs++];
+            glyph->bitmapChar = bitmapChar;
+            glyph->x = currentX + bitmapChar.xOffset;
+            glyph->y = currentY + bitmapChar.yOffset;
+
+            currentX += bitmapChar.xAdvance;
+            lastCharID = charID;
+
+            if (glyph->x + bitmapChar.width > containerWidth)
+            {
+                // remove characters and add them again to next line
+                NSInteger numCharsToRemove = lastWhiteSpace == -1 ? 1 : i - lastWhiteSpace;
+                numCharsToRemove = MIN(numCharsToRemove, numGlyphs - lineStart);
+                numGlyphs -= numCharsToRemove;
+
+                if (numGlyphs == lineStart)
+                    break;
+
+                i -= numCharsToRemove;
+                lineFull = YES;
+            }
+        }
+
+        if (i == numChars - 1)
+        {
+            lineStarts[numLines++] = lineStart;
+            finished = YES;
+        }
+        else if (lineFull)
+        {
+            lineStarts[numLines++] = lineStart;
+
+            if (lastWhiteSpace == i && numGlyphs > lineStart)
+                --numGlyphs;
+
+            if (currentY + leading + (2 * lineHeight) <= containerHeight)
+            {
+                lineStart = numGlyphs;
+                currentX = 0.0f;
+                currentY += lineHeight + leading;
+                lastWhiteSpace = -1;
+                lastCharID = -1;
+            }
+            else
+            {
+                break;
+            }
+        }
+    }
+
+    lineStarts[numLines] = numGlyphs;
+    self->_numGlyphs = numGlyphs;
+    self->_numLines = numLines;
+
+    return finished;
+}
+
+static BOOL arrangeLinesAtSize(SPBitmapFont *self, NSInteger numChars, float width, float height,
+                               float size, BOOL kerning, float leading)
+{
+    float scale = size / self->_size;
+    float containerHeight = height / scale;
+
+    self->_numGlyphs = self->_numLines = 0;
+    self->_lineStarts[0] = 0;
+
+    if (self->_lineHeight <= containerHeight)
+        return arrangeLines(self, numChars, width / scale, containerHeight, kerning, leading);
+    else
+        return NO;
+}
+
+static void alignLines(SPBitmapFont *self, float scale, float containerWidth, float containerHeight,
+                       SPHAlign hAlign, SPVAlign vAlign)
+{
+    // moves the glyphs into their final, scaled position, dropping those that are invisible
+
+    SPGlyphPlacement *glyphs = self->_glyphBuffer;
+    NSInteger *lineStarts = self->_lineStarts;
+    NSInteger numLines = self->_numLines;
+    NSInteger numVisibleGlyphs = 0;
+    float bottom = numLines * self->_lineHeight;
+    int yOffset = 0;
+
+    if (vAlign == SPVAlignBottom)      yOffset =  containerHeight - bottom;
+    else if (vAlign == SPVAlignCenter) yOffset = (containerHeight - bottom) / 2;
+
+    for (NSInteger l=0; l<numLines; ++l)
+    {
+        NSInteger lineStart = lineStarts[l];
+        NSInteger lineEnd = lineStarts[l+1];
+        if (lineStart == lineEnd) continue;
+
+        int xOffset = 0;
+        SPGlyphPlacement *lastGlyph = &glyphs[lineEnd - 1];
+        float right = lastGlyph->x - lastGlyph->bitmapChar.xOffset + lastGlyph->bitmapChar.xAdvance;
+
+        if (hAlign == SPHAlignRight)       xOffset =  containerWidth - right;
+        else if (hAlign == SPHAlignCenter) xOffset = (containerWidth - right) / 2;
+
+        for (NSInteger i=lineStart; i<lineEnd; ++i)
+        {
+            SPGlyphPlacement glyph = glyphs[i];
+
+            if (glyph.bitmapChar.width > 0 && glyph.bitmapChar.height > 0)
+            {
+                glyph.x = scale * (glyph.x + xOffset + self->_offsetX);
+                glyph.y = scale * (glyph.y + yOffset + self->_offsetY);
+                glyphs[numVisibleGlyphs++] = glyph;
+            }
+        }
+    }
+
+    self->_numGlyphs = numVisibleGlyphs;
 }
 
 #pragma mark Initialization
@@ -87,7 +460,6 @@ NSString *const SPBitmapFontMiniName = @"mini";
         
         _name = @"unknown";
         _lineHeight = _size = _baseline = SPDefaultFontSize;
-        _chars = [[NSMutableDictionary alloc] init];
         _texture = texture ? [texture retain] : [self textureReferencedByXmlData:data];
         _helperImage = [[SPImage alloc] initWithTexture:_texture];
         
@@ -97,6 +469,22 @@ NSString *const SPBitmapFontMiniName = @"mini";
     return self;
 }
 
+- (instancetype)initWithName:(NSString *)name size:(float)size lineHeight:(float)lineHeight
+                    baseline:(float)baseline texture:(SPTexture *)texture
+{
+    if ((self = [super init]))
+    {
+        _name = [name copy];
+        _size = size;
+        _lineHeight = lineHeight;
+        _baseline = baseline;
+        _texture = [texture retain];
+        _helperImage = [[SPImage alloc] initWithTexture:_texture];
+    }
+
+    return self;
+}
+
 - (instancetype)initWithContentsOfData:(NSData *)data
 {
     return [self initWithContentsOfData:data texture:nil];
@@ -104,19 +492,64 @@ NSString *const SPBitmapFontMiniName = @"mini";
 
 - (instancetype)initWithContentsOfFile:(NSString *)path texture:(SPTexture *)texture
 {
-    NSString *absolutePath = [SPUtils absolutePathToFile:path];
-    if (!absolutePath) [NSException raise:SPExceptionFileNotFound format:@"file not found: %@", path];
-    NSData *xmlData = [NSData dataWithContentsOfFile:absolutePath];
+    NSString *absolutePath = nil;
+    NSData *binaryData = SPBinaryAssetLoad(path, SPBinaryAssetTypeFont, &absolutePath);
+    NSString *folder = [absolutePath stringByDeletingLastPathComponent];
+
+    if (binaryData)
+        return [self initWithBinaryData:binaryData folder:folder texture:texture];
+
+    NSData *xmlData = [NSData dataWithContentsOfFile:absolutePath options:NSDataReadingMappedIfSafe
+                                               error:nil];
 
     if (!texture)
-    {
-        NSString *folder = [absolutePath stringByDeletingLastPathComponent];
         texture = [self textureReferencedByXmlData:xmlData inFolder:folder];
-    }
     
     return [self initWithContentsOfData:xmlData texture:texture];
 }
 
+- (instancetype)initWithBinaryData:(NSData *)data folder:(NSString *)folder texture:(SPTexture *)texture
+{
+    const SPBinaryFontHeader *header = data.bytes;
+
+    if (data.length < sizeof(SPBinaryFontHeader))
+        [NSException raise:SPExceptionFileInvalid format:@"corrupt binary font in %@", folder];
+
+    if (!texture)
+    {
+        NSString *filename = SPBinaryAssetString(data, header->pageFile);
+        texture = [SPTexture textureWithContentsOfFile:[folder stringByAppendingPathComponent:filename]];
+    }
+
+    float scale = texture.scale;
+
+    if ((self = [self initWithName:SPBinaryAssetString(data, header->face) size:header->size / scale
+                        lineHeight:header->lineHeight / scale baseline:header->baseline / scale
+                           texture:texture]))
+    {
+        if (!header->smooth)
+            self.smoothing = SPTextureSmoothingNone;
+
+        // glyphs and kernings are read right from the mapped file
+        const SPBinaryGlyph *glyphs = SPBinaryAssetTable(data, header->glyphsOffset,
+                                                         header->numGlyphs, sizeof(SPBinaryGlyph));
+        const SPBinaryKerning *kernings = SPBinaryAssetTable(data, header->kerningsOffset,
+                                                             header->numKernings, sizeof(SPBinaryKerning));
+
+        for (uint32_t i=0; i<header->numGlyphs; ++i)
+        {
+            const SPBinaryGlyph *g = &glyphs[i];
+            addCharInPixels(self, g->charID, g->x, g->y, g->width, g->height,
+                            g->xOffset, g->yOffset, g->xAdvance);
+        }
+
+        for (uint32_t i=0; i<header->numKernings; ++i)
+            addKerning(self, kernings[i].first, kernings[i].second, kernings[i].amount / scale);
+    }
+
+    return self;
+}
+
 - (instancetype)initWithContentsOfFile:(NSString *)path
 {
     return [self initWithContentsOfFile:path texture:nil];
@@ -132,11 +565,116 @@ NSString *const SPBitmapFontMiniName = @"mini";
     return [self init];
 }
 
++ (NSString *)convertXmlFile:(NSString *)xmlPath toBinaryFile:(NSString *)binaryPath
+{
+    NSString *path = [SPUtils absolutePathToFile:xmlPath];
+    if (!path) [NSException raise:SPExceptionFileNotFound format:@"file not found: %@", xmlPath];
+    if (!binaryPath) binaryPath = SPBinaryAssetPathForFile(path);
+
+    NSData *xmlData = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:nil];
+    NSMutableData *glyphs = [NSMutableData data];
+    NSMutableData *kernings = [NSMutableData data];
+    SPBinaryAssetWriter *writer = [[SPBinaryAssetWriter alloc] initWithType:SPBinaryAssetTypeFont
+                                   sourceData:xmlData headerSize:sizeof(SPBinaryFontHeader)];
+    SPBinaryFontHeader *header = writer.header;
+    header->size = header->lineHeight = header->baseline = SPDefaultFontSize;
+    header->smooth = 1;
+
+    SPXMLReader *reader = [[SPXMLReader alloc] initWithData:xmlData];
+    BOOL success = [reader parseElementsWithBlock:^(const SPXMLElement *element, BOOL *stop)
+    {
+        if (SPXMLElementHasName(element, "char"))
+        {
+            SPBinaryGlyph glyph = {
+                .charID = SPXMLElementInt(element, "id"),
+                .x = SPXMLElementFloat(element, "x"),
+                .y = SPXMLElementFloat(element, "y"),
+                .width = SPXMLElementFloat(element, "width"),
+                .height = SPXMLElementFloat(element, "height"),
+                .xOffset = SPXMLElementFloat(element, "xoffset"),
+                .yOffset = SPXMLElementFloat(element, "yoffset"),
+                .xAdvance = SPXMLElementFloat(element, "xadvance")
+            };
+
+            [glyphs appendBytes:&glyph length:sizeof(SPBinaryGlyph)];
+        }
+        else if (SPXMLElementHasName(element, "kerning"))
+        {
+            SPBinaryKerning kerning = {
+                .first = SPXMLElementInt(element, "first"),
+                .second = SPXMLElementInt(element, "second"),
+                .amount = SPXMLElementFloat(element, "amount")
+            };
+
+            [kernings appendBytes:&kerning length:sizeof(SPBinaryKerning)];
+        }
+        else if (SPXMLElementHasName(element, "info"))
+        {
+            header->face = [writer addString:SPXMLElementString(element, "face")];
+            header->size = SPXMLElementFloat(element, "size");
+            header->smooth = !isSmoothingDisabled(element);
+        }
+        else if (SPXMLElementHasName(element, "common"))
+        {
+            header->lineHeight = SPXMLElementFloat(element, "lineHeight");
+            header->baseline = SPXMLElementFloat(element, "base");
+        }
+        else if (SPXMLElementHasName(element, "page"))
+        {
+            if (SPXMLElementInt(element, "id") != 0)
+                [NSException raise:SPExceptionFileInvalid
+                            format:@"Bitmap fonts with multiple pages are not supported"];
+
+            header->pageFile = [writer addString:SPXMLElementString(element, "file")];
+        }
+    }];
+
+    NSString *errorMessage = [[reader.errorMessage retain] autorelease];
+    [reader release];
+
+    if (!success)
+    {
+        [writer release];
+        [NSException raise:SPExceptionDataInvalid format:@"Error parsing font XML: %@", errorMessage];
+    }
+
+    header->numGlyphs = (uint32_t)(glyphs.length / sizeof(SPBinaryGlyph));
+    header->glyphsOffset = [writer appendTable:glyphs.bytes count:header->numGlyphs
+                                    recordSize:sizeof(SPBinaryGlyph)];
+    header->numKernings = (uint32_t)(kernings.length / sizeof(SPBinaryKerning));
+    header->kerningsOffset = [writer appendTable:kernings.bytes count:header->numKernings
+                                      recordSize:sizeof(SPBinaryKerning)];
+    [writer writeToFile:binaryPath];
+    [writer release];
+
+    return binaryPath;
+}
+
 - (void)dealloc
 {
     [_name release];
     [_texture release];
-    [_chars release];
+    for (int i=0; i<NUM_CHAR_PAGES; ++i)
+    {
+        SPBitmapChar **page = _charPages[i];
+        if (!page) continue;
+
+        for (int j=0; j<=CHAR_PAGE_MASK; ++j)
+            [page[j] release];
+
+        free(page);
+    }
+
+    clearLayoutCache(self);
+
+    for (int i=0; i<LAYOUT_CACHE_SIZE; ++i)
+        free(_layoutCache[i].glyphs);
+
+    free(_charBuffer);
+    free(_glyphBuffer);
+    free(_lineStarts);
+    free(_kernings);
+    [_extraChars release];
     [_helperImage release];
     [super dealloc];
 }
@@ -145,17 +683,48 @@ NSString *const SPBitmapFontMiniName = @"mini";
 
 - (SPBitmapChar *)charByID:(int)charID
 {
-    return _chars[@(charID)];
+    return getChar(self, charID);
 }
 
 - (void)addBitmapChar:(SPBitmapChar *)bitmapChar charID:(int)charID
 {
-    _chars[@(charID)] = bitmapChar;
+    clearLayoutCache(self);
+    setChar(self, bitmapChar, charID);
+
+    [bitmapChar enumerateKerningsWithBlock:^(int firstCharID, float amount)
+    {
+        setKerning(self, firstCharID, charID, amount);
+    }];
+}
+
+- (void)addKerning:(float)amount fromChar:(int)first toChar:(int)second
+{
+    clearLayoutCache(self);
+    addKerning(self, first, second, amount);
+}
+
+- (float)kerningFromChar:(int)first toChar:(int)second
+{
+    return getKerning(self, first, second);
 }
 
 - (SP_GENERIC(NSArray, NSNumber*) *)allCharIDs
 {
-    return _chars.allKeys;
+    SP_GENERIC(NSMutableArray, NSNumber*) *charIDs = [NSMutableArray array];
+
+    for (int i=0; i<NUM_CHAR_PAGES; ++i)
+    {
+        SPBitmapChar **page = _charPages[i];
+        if (!page) continue;
+
+        for (int j=0; j<=CHAR_PAGE_MASK; ++j)
+            if (page[j]) [charIDs addObject:@((i << CHAR_PAGE_SHIFT) | j)];
+    }
+
+    if (_extraChars)
+        [charIDs addObjectsFromArray:_extraChars.allKeys];
+
+    return charIDs;
 }
 
 - (BOOL)hasCharsInString:(NSString *)string
@@ -167,7 +736,7 @@ NSString *const SPBitmapFontMiniName = @"mini";
         int charID = [string characterAtIndex:i];
         
         if (charID != CHAR_SPACE && charID != CHAR_TAB && charID != CHAR_NEWLINE &&
-            charID != CHAR_CARRIAGE_RETURN && ![self charByID:charID])
+            charID != CHAR_CARRIAGE_RETURN && !getChar(self, charID))
         {
             return NO;
         }
@@ -182,17 +751,18 @@ NSString *const SPBitmapFontMiniName = @"mini";
                           autoScale:(BOOL)autoScale kerning:(BOOL)kerning
                             leading:(float)leading
 {
-    SP_GENERIC(NSMutableArray, SPCharLocation*) *charLocations = [self arrangeCharsInAreaWithWidth:width height:height
-		text:text fontSize:size hAlign:hAlign vAlign:vAlign autoScale:autoScale kerning:kerning leading:leading];
-
+    SPBitmapFontLayout layout = [self layoutText:text width:width height:height fontSize:size
+                                          hAlign:hAlign vAlign:vAlign autoScale:autoScale
+                                         kerning:kerning leading:leading];
     SPSprite *sprite = [SPSprite sprite];
 
-    for (SPCharLocation *charLocation in charLocations)
+    for (NSInteger i=0; i<layout.numGlyphs; ++i)
     {
-        SPImage *charImage = [charLocation.bitmapChar createImage];
-        charImage.x = charLocation.x;
-        charImage.y = charLocation.y;
-        charImage.scaleX = charImage.scaleY = charLocation.scale;
+        const SPGlyphPlacement *glyph = &layout.glyphs[i];
+        SPImage *charImage = [glyph->bitmapChar createImage];
+        charImage.x = glyph->x;
+        charImage.y = glyph->y;
+        charImage.scaleX = charImage.scaleY = layout.scale;
         charImage.color = color;
         [sprite addChild:charImage];
     }
@@ -206,28 +776,192 @@ NSString *const SPBitmapFontMiniName = @"mini";
             autoScale:(BOOL)autoScale kerning:(BOOL)kerning
               leading:(float)leading
 {
-    SP_GENERIC(NSMutableArray, SPCharLocation*) *charLocations = [self arrangeCharsInAreaWithWidth:width height:height
-		text:text fontSize:size hAlign:hAlign vAlign:vAlign autoScale:autoScale kerning:kerning leading:leading];
+    SPBitmapFontLayout layout = [self layoutText:text width:width height:height fontSize:size
+                                          hAlign:hAlign vAlign:vAlign autoScale:autoScale
+                                         kerning:kerning leading:leading];
 
-    _helperImage.color = color;
+    [self fillQuadBatch:quadBatch withLayout:layout color:color];
+}
+
+#pragma mark Internal
+
++ (NSString *)texturePathForContentsOfFile:(NSString *)path
+{
+    NSString *absolutePath = nil;
+    NSData *binaryData = SPBinaryAssetLoad(path, SPBinaryAssetTypeFont, &absolutePath);
+    NSString *folder = [absolutePath stringByDeletingLastPathComponent];
+    __block NSString *filename = nil;
+
+    if (binaryData)
+    {
+        if (binaryData.length < sizeof(SPBinaryFontHeader))
+            [NSException raise:SPExceptionFileInvalid format:@"corrupt binary font: %@", absolutePath];
+
+        const SPBinaryFontHeader *header = binaryData.bytes;
+        filename = SPBinaryAssetString(binaryData, header->pageFile);
+    }
+    else
+    {
+        NSData *xmlData = [NSData dataWithContentsOfFile:absolutePath options:NSDataReadingMappedIfSafe
+                                                   error:nil];
+        SPXMLReader *reader = [[SPXMLReader alloc] initWithData:xmlData];
+        [reader parseElementsWithBlock:^(const SPXMLElement *element, BOOL *stop)
+        {
+            if (SPXMLElementHasName(element, "page"))
+            {
+                filename = SPXMLElementString(element, "file");
+                *stop = YES;
+            }
+        }];
+        [reader release];
+    }
+
+    if (!filename)
+        [NSException raise:SPExceptionDataInvalid format:@"Font XML did not contain path to texture"];
+
+    return [folder stringByAppendingPathComponent:filename];
+}
+
+- (SPBitmapFontLayout)layoutText:(NSString *)text width:(float)width height:(float)height
+                        fontSize:(float)size hAlign:(SPHAlign)hAlign vAlign:(SPVAlign)vAlign
+                       autoScale:(BOOL)autoScale kerning:(BOOL)kerning leading:(float)leading
+{
+    if (!text) text = @"";
+    if (size < 0) size *= -_size;
+
+    NSUInteger textHash = text.hash;
+    SPCachedLayout *layout = cachedLayout(self, text, textHash, width, height, size,
+                                          hAlign, vAlign, autoScale, kerning, leading);
+    if (!layout)
+    {
+        NSInteger numChars = text.length;
+        ensureBufferCapacity(self, MAX(1, numChars));
+        [text getCharacters:_charBuffer range:NSMakeRange(0, numChars)];
+
+        float finalSize = size;
+        _numGlyphs = _numLines = 0;
+
+        if (numChars)
+        {
+            BOOL finished = arrangeLinesAtSize(self, numChars, width, height, size, kerning, leading);
+
+            if (autoScale && !finished)
+            {
+                // find the biggest size (in steps of one point) at which the text fits
+                NSInteger low = 1;
+                NSInteger high = MAX(1, (NSInteger)size);
+
+                while (low < high)
+                {
+                    NSInteger mid = (low + high) / 2;
+                    if (arrangeLinesAtSize(self, numChars, width, height, size - mid, kerning, leading))
+                        high = mid;
+                    else
+                        low = mid + 1;
+                }
+
+                finalSize = size - low;
+                arrangeLinesAtSize(self, numChars, width, height, finalSize, kerning, leading);
+            }
+
+            float scale = finalSize / _size;
+            alignLines(self, scale, width / scale, height / scale, hAlign, vAlign);
+        }
 
-    if (charLocations.count > 8192)
+        layout = leastRecentlyUsedLayout(self);
+
+        if (layout->capacity < _numGlyphs)
+        {
+            layout->capacity = _numGlyphs;
+            layout->glyphs = realloc(layout->glyphs, sizeof(SPGlyphPlacement) * _numGlyphs);
+        }
+
+        if (_numGlyphs)
+            memcpy(layout->glyphs, _glyphBuffer, sizeof(SPGlyphPlacement) * _numGlyphs);
+
+        SP_RELEASE_AND_COPY(layout->text, text);
+        layout->textHash = textHash;
+        layout->width = width;
+        layout->height = height;
+        layout->fontSize = size;
+        layout->hAlign = hAlign;
+        layout->vAlign = vAlign;
+        layout->autoScale = autoScale;
+        layout->kerning = kerning;
+        layout->leading = leading;
+        layout->scale = finalSize / _size;
+        layout->numGlyphs = _numGlyphs;
+        layout->layoutID = nextLayoutID++;
+    }
+
+    layout->lastUse = ++_layoutClock;
+
+    return (SPBitmapFontLayout){ layout->glyphs, layout->numGlyphs, layout->scale, layout->layoutID };
+}
+
+- (void)fillQuadBatch:(SPQuadBatch *)quadBatch withLayout:(SPBitmapFontLayout)layout
+                color:(uint)color
+{
+    if (layout.numGlyphs > 8192)
         [NSException raise:SPExceptionInvalidOperation
                     format:@"Bitmap font text is limited to 8192 characters"];
 
-    for (SPCharLocation *charLocation in charLocations)
+    _helperImage.color = color;
+    _helperImage.scaleX = _helperImage.scaleY = layout.scale;
+
+    for (NSInteger i=0; i<layout.numGlyphs; ++i)
     {
-        _helperImage.texture = charLocation.bitmapChar.texture;
-        _helperImage.x = charLocation.x;
-        _helperImage.y = charLocation.y;
-        _helperImage.scaleX = _helperImage.scaleY = charLocation.scale;
+        const SPGlyphPlacement *glyph = &layout.glyphs[i];
+        _helperImage.texture = glyph->bitmapChar.texture;
+        _helperImage.x = glyph->x;
+        _helperImage.y = glyph->y;
         [_helperImage readjustSize];
         [quadBatch addQuad:_helperImage];
     }
 }
 
+- (void)updateQuadBatch:(SPQuadBatch *)quadBatch withLayout:(SPBitmapFontLayout)layout
+                  range:(NSRange)range color:(uint)color
+{
+    _helperImage.color = color;
+    _helperImage.scaleX = _helperImage.scaleY = layout.scale;
+
+    for (NSInteger i=range.location; i<NSMaxRange(range); ++i)
+    {
+        const SPGlyphPlacement *glyph = &layout.glyphs[i];
+        _helperImage.texture = glyph->bitmapChar.texture;
+        _helperImage.x = glyph->x;
+        _helperImage.y = glyph->y;
+        [_helperImage readjustSize];
+        [quadBatch setQuad:_helperImage atIndex:i];
+    }
+}
+
+- (NSUInteger)version
+{
+    return _version;
+}
+
 #pragma mark Properties
 
+- (void)setLineHeight:(float)lineHeight
+{
+    clearLayoutCache(self);
+    _lineHeight = lineHeight;
+}
+
+- (void)setOffsetX:(float)offsetX
+{
+    clearLayoutCache(self);
+    _offsetX = offsetX;
+}
+
+- (void)setOffsetY:(float)offsetY
+{
+    clearLayoutCache(self);
+    _offsetY = offsetY;
+}
+
 - (SPTextureSmoothing)smoothing
 {
     return _texture.smoothing;
@@ -249,26 +983,26 @@ NSString *const SPBitmapFontMiniName = @"mini";
 - (SPTexture *)textureReferencedByXmlData:(NSData *)data inFolder:(NSString *)folder
 {
     __block SPTexture *texture = nil;
-    NSXMLParser *parser = [[NSXMLParser alloc] initWithData:data];
+    SPXMLReader *reader = [[SPXMLReader alloc] initWithData:data];
     
-    [parser parseElementsWithBlock:^(NSString *elementName, NSDictionary *attributes)
+    [reader parseElementsWithBlock:^(const SPXMLElement *element, BOOL *stop)
     {
-        if ([elementName isEqualToString:@"page"])
+        if (SPXMLElementHasName(element, "page"))
         {
-            int id = [[attributes valueForKey:@"id"] intValue];
+            int id = SPXMLElementInt(element, "id");
             if (id != 0) [NSException raise:SPExceptionFileInvalid
                                      format:@"Bitmap fonts with multiple pages are not supported"];
             
-            NSString *filename = [attributes valueForKey:@"file"];
+            NSString *filename = SPXMLElementString(element, "file");
             NSString *absolutePath = [folder stringByAppendingPathComponent:filename];
             texture = [[SPTexture alloc] initWithContentsOfFile:absolutePath];
             
             // that's all info we need at this time.
-            [parser abortParsing];
+            *stop = YES;
         }
     }];
 
-    [parser release];
+    [reader release];
     
     if (!texture)
         [NSException raise:SPExceptionDataInvalid format:@"Font XML did not contain path to texture"];
@@ -281,222 +1015,53 @@ NSString *const SPBitmapFontMiniName = @"mini";
     if (!_texture)
         [NSException raise:SPExceptionInvalidOperation format:@"Font parsing requires texture to be set"];
     
-    NSXMLParser *parser = [[NSXMLParser alloc] initWithData:data];
-    BOOL success = [parser parseElementsWithBlock:^(NSString *elementName, NSDictionary *attributes)
+    SPXMLReader *reader = [[SPXMLReader alloc] initWithData:data];
+    BOOL success = [reader parseElementsWithBlock:^(const SPXMLElement *element, BOOL *stop)
     {
         float scale = _texture.scale;
         
-        if ([elementName isEqualToString:@"char"])
+        if (SPXMLElementHasName(element, "char"))
         {
-            int charID = [[attributes valueForKey:@"id"] intValue];
-            
-            SPRectangle *region = [[SPRectangle alloc] init];
-            region.x = [[attributes valueForKey:@"x"] floatValue] / scale + _texture.frame.x;
-            region.y = [[attributes valueForKey:@"y"] floatValue] / scale + _texture.frame.y;
-            region.width = [[attributes valueForKey:@"width"] floatValue] / scale;
-            region.height = [[attributes valueForKey:@"height"] floatValue] / scale;
-
-            SPSubTexture *texture = [[SPSubTexture alloc] initWithRegion:region ofTexture:_texture];
-            
-            float xOffset = [[attributes valueForKey:@"xoffset"] floatValue] / scale;
-            float yOffset = [[attributes valueForKey:@"yoffset"] floatValue] / scale;
-            float xAdvance = [[attributes valueForKey:@"xadvance"] floatValue] / scale;
-            
-            SPBitmapChar *bitmapChar = [[SPBitmapChar alloc] initWithID:charID texture:texture
-                                                                xOffset:xOffset yOffset:yOffset
-                                                               xAdvance:xAdvance];
-
-            _chars[@(charID)] = bitmapChar;
-
-            [region release];
-            [texture release];
-            [bitmapChar release];
+            addCharInPixels(self, SPXMLElementInt(element, "id"),
+                            SPXMLElementFloat(element, "x"),
+                            SPXMLElementFloat(element, "y"),
+                            SPXMLElementFloat(element, "width"),
+                            SPXMLElementFloat(element, "height"),
+                            SPXMLElementFloat(element, "xoffset"),
+                            SPXMLElementFloat(element, "yoffset"),
+                            SPXMLElementFloat(element, "xadvance"));
         }
-        else if ([elementName isEqualToString:@"kerning"])
+        else if (SPXMLElementHasName(element, "kerning"))
         {
-            int first  = [[attributes valueForKey:@"first"] intValue];
-            int second = [[attributes valueForKey:@"second"] intValue];
-            float amount = [[attributes valueForKey:@"amount"] floatValue] / scale;
-            [[self charByID:second] addKerning:amount toChar:first];
+            int first  = SPXMLElementInt(element, "first");
+            int second = SPXMLElementInt(element, "second");
+            float amount = SPXMLElementFloat(element, "amount") / scale;
+            addKerning(self, first, second, amount);
         }
-        else if ([elementName isEqualToString:@"info"])
+        else if (SPXMLElementHasName(element, "info"))
         {
-            _name = [[attributes valueForKey:@"face"] copy];
-            _size = [[attributes valueForKey:@"size"] floatValue] / scale;
+            SP_RELEASE_AND_RETAIN(_name, SPXMLElementString(element, "face"));
+            _size = SPXMLElementFloat(element, "size") / scale;
             
-            if ([[attributes valueForKey:@"smooth"] isEqualToString:@"0"])
+            if (isSmoothingDisabled(element))
                 self.smoothing = SPTextureSmoothingNone;
         }
-        else if ([elementName isEqualToString:@"common"])
+        else if (SPXMLElementHasName(element, "common"))
         {
-            _lineHeight = [[attributes valueForKey:@"lineHeight"] floatValue] / scale;
-            _baseline = [[attributes valueForKey:@"base"] floatValue] / scale;
+            _lineHeight = SPXMLElementFloat(element, "lineHeight") / scale;
+            _baseline = SPXMLElementFloat(element, "base") / scale;
         }
     }];
 
-    [parser release];
+    NSString *errorMessage = [[reader.errorMessage retain] autorelease];
+    [reader release];
     
     if (!success)
-        [NSException raise:SPExceptionDataInvalid format:@"Error parsing font XML: %@",
-                     parser.parserError.localizedDescription];
+        [NSException raise:SPExceptionDataInvalid format:@"Error parsing font XML: %@", errorMessage];
     
     return success;
 }
 
-- (SP_GENERIC(NSMutableArray, SPCharLocation*) *)arrangeCharsInAreaWithWidth:(float)width height:(float)height
-                                                            text:(NSString *)text fontSize:(float)size
-                                                          hAlign:(SPHAlign)hAlign vAlign:(SPVAlign)vAlign
-                                                       autoScale:(BOOL)autoScale kerning:(BOOL)kerning
-                                                         leading:(float)leading
-
-{
-    if (text.length == 0) return [NSMutableArray array];
-    if (size < 0) size *= -_size;
-    
-    SP_GENERIC(NSMutableArray, SP_GENERIC(NSMutableArray, SPCharLocation*)*) *lines = nil;
-    float scale = 0.0f;
-    float containerWidth = 0.0f;
-    float containerHeight = 0.0f;
-    BOOL finished = NO;
-    
-    while (!finished)
-    {
-        lines = [NSMutableArray array];
-        scale = size / _size;
-        containerWidth  = width  / scale;
-        containerHeight = height / scale;
-        
-        if (_lineHeight <= containerHeight)
-        {
-            int lastWhiteSpace = -1;
-            int lastCharID = -1;
-            int numChars = (int)text.length;
-            float currentX = 0;
-            float currentY = 0;
-            SP_GENERIC(NSMutableArray, SPCharLocation*) *currentLine = [NSMutableArray array];
-            
-            for (int i=0; i<numChars; i++)
-            {
-                BOOL lineFull = NO;
-                int charID = [text characterAtIndex:i];
-                SPBitmapChar *bitmapChar = [self charByID:charID];
-                
-                if (charID == CHAR_NEWLINE || charID == CHAR_CARRIAGE_RETURN)
-                {
-                    lineFull = YES;
-                }
-                else if (!bitmapChar)
-                {
-                    SPLog(@"Missing character: %d", charID);
-                }
-                else
-                {
-                    if (charID == CHAR_SPACE || charID == CHAR_TAB)
-                        lastWhiteSpace = i;
-                    
-                    if (kerning)
-                        currentX += [bitmapChar kerningToChar:lastCharID];
-                    
-                    SPCharLocation *charLocation = [[SPCharLocation alloc] initWithChar:bitmapChar];
-                    charLocation.x = currentX + bitmapChar.xOffset;
-                    charLocation.y = currentY + bitmapChar.yOffset;
-
-                    [currentLine addObject:charLocation];
-                    [charLocation release];
-                    
-                    currentX += bitmapChar.xAdvance;
-                    lastCharID = charID;
-                    
-                    if (charLocation.x + bitmapChar.width > containerWidth)
-                    {
-                        // remove characters and add them again to next line
-                        int numCharsToRemove = lastWhiteSpace == -1 ? 1 : i - lastWhiteSpace;
-                        int removeIndex = (int)currentLine.count - numCharsToRemove;
-                        
-                        [currentLine removeObjectsInRange:NSMakeRange(removeIndex, numCharsToRemove)];
-                        
-                        if (currentLine.count == 0)
-                            break;
-                        
-                        i -= numCharsToRemove;
-                        lineFull = YES;
-                    }
-                }
-                
-                if (i == numChars - 1)
-                {
-                    [lines addObject:currentLine];
-                    finished = YES;
-                }
-                else if (lineFull)
-                {
-                    [lines addObject:currentLine];
-                    
-                    if (lastWhiteSpace == i)
-                        [currentLine removeLastObject];
-                    
-                    if (currentY + leading + (2 * _lineHeight) <= containerHeight)
-                    {
-                        currentLine = [NSMutableArray array];
-                        currentX = 0.0f;
-                        currentY += _lineHeight + leading;
-                        lastWhiteSpace = -1;
-                        lastCharID = -1;
-                    }
-                    else
-                    {
-                        break;
-                    }
-                }
-            } // for each char
-        } // if (_lineHeight < containerHeight)
-        
-        if (autoScale && !finished)
-        {
-            size -= 1;
-            [lines removeAllObjects];
-        }
-        else
-        {
-            finished = YES;
-        }
-    } // while (!finished)
-    
-    SP_GENERIC(NSMutableArray, SPCharLocation*) *finalLocations = [NSMutableArray array];
-    int numLines = (int)lines.count;
-    float bottom = numLines * _lineHeight;
-    int yOffset = 0;
-    
-    if (vAlign == SPVAlignBottom)      yOffset =  containerHeight - bottom;
-    else if (vAlign == SPVAlignCenter) yOffset = (containerHeight - bottom) / 2;
-    
-    for (NSArray *line in lines)
-    {
-        int numChars = (int)line.count;
-        if (!numChars) continue;
-        
-        int xOffset = 0;
-        SPCharLocation *lastLocation = [line lastObject];
-        float right = lastLocation.x - lastLocation.bitmapChar.xOffset
-                                     + lastLocation.bitmapChar.xAdvance;
-        
-        if (hAlign == SPHAlignRight)       xOffset =  containerWidth - right;
-        else if (hAlign == SPHAlignCenter) xOffset = (containerWidth - right) / 2;
-        
-        for (SPCharLocation *charLocation in line)
-        {
-            charLocation.x = scale * (charLocation.x + xOffset + _offsetX);
-            charLocation.y = scale * (charLocation.y + yOffset + _offsetY);
-            charLocation.scale = scale;
-            
-            if (charLocation.bitmapChar.width > 0 && charLocation.bitmapChar.height > 0)
-                [finalLocations addObject:charLocation];
-        }
-    }
-    
-    return finalLocations;
-}
-
 #pragma mark Mini Font
 
 NSString *MiniFontXmlDataBase64 =
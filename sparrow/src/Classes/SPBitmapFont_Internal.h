@@ -0,0 +1,65 @@
+//
+//  SPBitmapFont_Internal.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 11.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPBitmapFont.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// The position of one glyph of an arranged text, already scaled to the requested font size.
+typedef struct
+{
+    __unsafe_unretained SPBitmapChar *bitmapChar;
+    float x;
+    float y;
+} SPGlyphPlacement;
+
+/// The result of arranging a text. The glyphs are owned by the font and stay valid until the
+/// font is modified or arranges another text.
+typedef struct
+{
+    const SPGlyphPlacement *glyphs;
+    NSInteger numGlyphs;
+    float scale;
+    NSUInteger layoutID; // identical layouts (served from the cache) share the same ID
+} SPBitmapFontLayout;
+
+@interface SPBitmapFont (Internal)
+
+/// Returns the absolute path of the texture a font file (XML or binary) refers to, reading only
+/// as much of the file as necessary.
++ (NSString *)texturePathForContentsOfFile:(NSString *)path;
+
+/// Initializes an empty font with the given metrics; chars are added with `addBitmapChar:charID:`.
+- (instancetype)initWithName:(NSString *)name size:(float)size lineHeight:(float)lineHeight
+                    baseline:(float)baseline texture:(SPTexture *)texture;
+
+/// Arranges the glyphs of a text within the given area. The most recent layouts are cached, so
+/// asking for the same text with the same parameters again does not repeat the work.
+- (SPBitmapFontLayout)layoutText:(NSString *)text width:(float)width height:(float)height
+                        fontSize:(float)size hAlign:(SPHAlign)hAlign vAlign:(SPVAlign)vAlign
+                       autoScale:(BOOL)autoScale kerning:(BOOL)kerning leading:(float)leading;
+
+/// Adds the quads of previously arranged glyphs to a quad batch.
+- (void)fillQuadBatch:(SPQuadBatch *)quadBatch withLayout:(SPBitmapFontLayout)layout
+                color:(uint)color;
+
+/// Overwrites the quads in a certain range of a quad batch with the glyphs at the same indices
+/// of a layout.
+- (void)updateQuadBatch:(SPQuadBatch *)quadBatch withLayout:(SPBitmapFontLayout)layout
+                  range:(NSRange)range color:(uint)color;
+
+/// Incremented whenever chars, kernings or metrics of the font change. Glyph placements of an
+/// older version may reference chars that no longer exist.
+@property (nonatomic, readonly) NSUInteger version;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -10,6 +10,7 @@
 //
 
 #import <Sparrow/SparrowBase.h>
+#import <Sparrow/SPTexture.h>
 
 NS_ASSUME_NONNULL_BEGIN
 
@@ -111,6 +112,14 @@ typedef NS_ENUM(NSInteger, SPRenderingAPI)
 /// Makes the specified context the current rendering context for the calling thread.
 + (BOOL)setCurrentContext:(nullable SPContext *)context;
 
+/// Indicates if the context supports a certain OpenGL extension, e.g.
+/// `GL_KHR_texture_compression_astc_ldr`.
+- (BOOL)supportsExtension:(NSString *)extension;
+
+/// Indicates if textures of a certain format can be created in this context. `ETC2` and `EAC`
+/// formats require OpenGL ES 3, `ASTC` formats the extension `GL_KHR_texture_compression_astc_ldr`.
+- (BOOL)supportsTextureFormat:(SPTextureFormat)format;
+
 /// ----------------
 /// @name Properties
 /// ----------------
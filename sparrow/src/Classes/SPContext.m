@@ -57,6 +57,7 @@ static SPRenderingAPI toSPRenderingAPI[] = {
     SP_GENERIC(NSMapTable, SPTexture*, SPFrameBuffer*) *_frameBuffers;
     SPFrameBuffer *_backBuffer;
     CGRect _prevDrawableRect;
+    NSSet *_extensions;
 }
 
 + (void)initialize
@@ -140,6 +141,7 @@ static SPRenderingAPI toSPRenderingAPI[] = {
     [_nativeContext release];
     [_renderTexture release];
     [_data release];
+    [_extensions release];
     
     [super dealloc];
 }
@@ -348,6 +350,38 @@ static SPRenderingAPI toSPRenderingAPI[] = {
     return [EAGLContext setCurrentContext:nil];
 }
 
+- (BOOL)supportsExtension:(NSString *)extension
+{
+    @synchronized (self)
+    {
+        if (!_extensions)
+        {
+            // the query requires this context to be current; no state is changed, so the previous
+            // context can simply be restored afterwards.
+            EAGLContext *prevContext = [EAGLContext currentContext];
+            [EAGLContext setCurrentContext:_nativeContext];
+
+            const char *extensions = (const char *)glGetString(GL_EXTENSIONS);
+            NSString *string = extensions ? @(extensions) : @"";
+            _extensions = [[NSSet alloc] initWithArray:[string componentsSeparatedByString:@" "]];
+
+            [EAGLContext setCurrentContext:prevContext];
+        }
+
+        return [_extensions containsObject:extension];
+    }
+}
+
+- (BOOL)supportsTextureFormat:(SPTextureFormat)format
+{
+    if (format >= SPTextureFormatASTC4x4 && format <= SPTextureFormatASTC12x12)
+        return [self supportsExtension:@"GL_KHR_texture_compression_astc_ldr"];
+    else if (format >= SPTextureFormatETC2RGB && format <= SPTextureFormatEACRG11)
+        return _API == SPRenderingAPIOpenGLES3;
+    else
+        return YES;
+}
+
 #pragma mark Properties
 
 - (id)sharegroup
@@ -20,15 +20,19 @@ NS_ASSUME_NONNULL_BEGIN
  
  An SPDelayedInvocation can be used to execute code at some time in the future.
  
- It can work in two ways: first, as a proxy object that will forward any method invocations
- to a certain target. Second, it can simply execute an Objective-C block. Either way, the
- provided code is executed with a given delay.
+ It can work in three ways: first, as a proxy object that will forward any method invocations
+ to a certain target. Second, it can simply execute an Objective-C block. Third, it can call a
+ single method with (at most) one argument directly, which avoids the overhead of capturing an
+ `NSInvocation`. Either way, the provided code is executed with a given delay.
  
  The easiest way to delay an invocation is by calling [SPJuggler delayInvocationAtTarget:byTime:].
  This method will create a delayed invocation for you, adding it to the juggler right away.
  
- SPDelayedCall dispatches an Event of type `SPEventTypeRemoveFromJuggler` when it is finished,
- so that the juggler automatically removes it when it's no longer needed.
+ A juggler does not advance its delayed invocations every frame. It keeps them in a timer wheel
+ instead, so that only those that are due cost any time; that makes it cheap to schedule
+ thousands of them. When an invocation is finished, it is removed from its juggler
+ automatically; it dispatches an event of type `SPEventTypeRemoveFromJuggler` if somebody is
+ listening.
  
 ------------------------------------------------------------------------------------------------- */
 
@@ -51,12 +55,21 @@ NS_ASSUME_NONNULL_BEGIN
 /// Initializes the delayed invocation of a block.
 - (instancetype)initWithDelay:(double)time block:(SPCallbackBlock)block;
 
+/// Initializes a delayed invocation that calls a method of the target, passing `object` as its
+/// only argument. The method must take either no argument or a single object.
+- (instancetype)initWithTarget:(id)target selector:(SEL)selector object:(nullable id)object
+                         delay:(double)time;
+
 /// Factory method.
 + (instancetype)invocationWithTarget:(id)target delay:(double)time;
 
 /// Factory method.
 + (instancetype)invocationWithDelay:(double)time block:(SPCallbackBlock)block;
 
+/// Factory method.
++ (instancetype)invocationWithTarget:(id)target selector:(SEL)selector object:(nullable id)object
+                               delay:(double)time;
+
 /// ----------------
 /// @name Properties
 /// ----------------
@@ -10,9 +10,19 @@
 //
 
 #import "SPDelayedInvocation.h"
+#import "SPJuggler_Internal.h"
+
+// --- private interface ---------------------------------------------------------------------------
+
+@interface SPDelayedInvocation () <SPJugglerSchedulable>
+
+@end
+
+// --- class implementation ------------------------------------------------------------------------
 
 @implementation SPDelayedInvocation
 {
+    SPJugglerLink _jugglerLink;
     id _target;
     
     NSInteger _repeatCount;
@@ -21,6 +31,8 @@
     
     SPCallbackBlock _block;
     NSMutableArray *_invocations;
+    SEL _selector;
+    id _argument;
 }
 
 #pragma mark Initialization
@@ -53,6 +65,17 @@
     return [self initWithTarget:nil delay:time block:block];
 }
 
+- (instancetype)initWithTarget:(id)target selector:(SEL)selector object:(id)object delay:(double)time
+{
+    if ((self = [self initWithTarget:nil delay:time block:NULL]))
+    {
+        _target = [target retain];
+        _selector = selector;
+        _argument = [object retain];
+    }
+    return self;
+}
+
 - (instancetype)init
 {
     SP_USE_DESIGNATED_INITIALIZER(initWithTarget:delay:block:);
@@ -64,6 +87,7 @@
     [_target release];
     [_block release];
     [_invocations release];
+    [_argument release];
     [super dealloc];
 }
 
@@ -77,6 +101,11 @@
     return [[[self alloc] initWithDelay:time block:block] autorelease];
 }
 
++ (instancetype)invocationWithTarget:(id)target selector:(SEL)selector object:(id)object delay:(double)time
+{
+    return [[[self alloc] initWithTarget:target selector:selector object:object delay:time] autorelease];
+}
+
 #pragma mark NSObject
 
 - (NSMethodSignature *)methodSignatureForSelector:(SEL)aSelector
@@ -96,19 +125,64 @@
     }
 }
 
+#pragma mark SPJugglerLinkable
+
+- (SPJugglerLink *)jugglerLink
+{
+    return &_jugglerLink;
+}
+
+#pragma mark SPJugglerSchedulable
+
+- (double)timeUntilDue
+{
+    return self.isComplete ? INFINITY : _totalTime - _currentTime;
+}
+
+- (void)jugglerDidReachDueTime:(double)passedTime
+{
+    _currentTime = _totalTime;
+    [self invoke];
+
+    if (_repeatCount == 0 || _repeatCount > 1)
+    {
+        if (_repeatCount > 0) --_repeatCount;
+
+        // keep the interval steady, but never fire more than once per frame
+        _currentTime = MIN(passedTime, _totalTime);
+        [_jugglerLink.juggler rescheduleObject:self dueIn:_totalTime - _currentTime];
+    }
+    else
+    {
+        [_jugglerLink.juggler objectDidComplete:self];
+        if ([self hasEventListenerForTypeID:SPEventTypeIDRemoveFromJuggler])
+            [self dispatchEventWithType:SPEventTypeRemoveFromJuggler];
+    }
+}
+
 #pragma mark SPAnimatable
 
 - (void)advanceTime:(double)seconds
 {
-    self.currentTime = _currentTime + seconds;
+    self.currentTime = self.currentTime + seconds;
 }
 
 #pragma mark Properties
 
+- (double)currentTime
+{
+    // while waiting in a juggler's timer wheel, the time is derived from the due time
+    if (_jugglerLink.list && isfinite(_jugglerLink.dueTime))
+        return MIN(_totalTime, _totalTime - (_jugglerLink.dueTime - _jugglerLink.juggler.elapsedTime));
+    else
+        return _currentTime;
+}
+
 - (void)setCurrentTime:(double)currentTime
 {
-    double previousTime = _currentTime;    
+    double previousTime = self.currentTime;
     _currentTime = MIN(_totalTime, currentTime);
+    [_jugglerLink.juggler rescheduleObject:self dueIn:_totalTime - _currentTime];
     
     if (previousTime < _totalTime && _currentTime >= _totalTime)
     {
@@ -124,7 +198,9 @@
         else
         {
             [self invoke];
-            [self dispatchEventWithType:SPEventTypeRemoveFromJuggler];
+            [_jugglerLink.juggler objectDidComplete:self];
+            if ([self hasEventListenerForTypeID:SPEventTypeIDRemoveFromJuggler])
+                [self dispatchEventWithType:SPEventTypeRemoveFromJuggler];
         }
     }
 }
@@ -133,13 +209,14 @@
 
 - (BOOL)isComplete
 {
-    return _repeatCount == 1 && _currentTime >= _totalTime;
+    return _repeatCount == 1 && self.currentTime >= _totalTime;
 }
 
 #pragma mark Private
 
 - (void)invoke
 {
+    if (_selector) [_target performSelector:_selector withObject:_argument];
     if (_invocations) [_invocations makeObjectsPerformSelector:@selector(invoke)];
     if (_block) _block();
 }
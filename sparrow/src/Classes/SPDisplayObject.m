@@ -12,7 +12,7 @@
 #import "SparrowClass.h"
 #import "SPBlendMode.h"
 #import "SPDisplayObject_Internal.h"
-#import "SPDisplayObjectContainer.h"
+#import "SPDisplayObjectContainer_Internal.h"
 #import "SPEnterFrameEvent.h"
 #import "SPEventDispatcher_Internal.h"
 #import "SPMacros.h"
@@ -24,6 +24,12 @@
 #import "SPTouchEvent.h"
 #import "SPPoint3D.h"
 
+// --- transform recording -------------------------------------------------------------------------
+
+static SPTransformRecorder transformRecorder = NULL;
+static void *transformRecorderContext = NULL;
+static uint currentRecordingID = 0;
+
 // --- class implementation ------------------------------------------------------------------------
 
 @implementation SPDisplayObject
@@ -52,6 +58,7 @@
     
     SPDisplayObject *_mask;
     BOOL _isMask;
+    uint _recordingID;
 }
 
 // --- helpers -------------------------------------------------------------------------------------
@@ -93,6 +100,80 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
     return commonParent;
 }
 
+static void updateDescendantListeners(SPDisplayObject *object, SPEventTypeID typeID, NSInteger count)
+{
+    // containers keep track of the listeners in their subtree, so that broadcasts can skip
+    // branches nobody is listening in.
+
+    SPDisplayObjectContainer *container = [object isKindOfClass:[SPDisplayObjectContainer class]] ?
+        (SPDisplayObjectContainer *)object : object->_parent;
+
+    [container addDescendantListeners:count forTypeID:typeID];
+}
+
+SP_INLINE void willChangeTransform(SPDisplayObject *object)
+{
+    // each object is passed to the recorder only once per recording, before its first change
+    if (transformRecorder && object->_recordingID != currentRecordingID)
+    {
+        SPDisplayObjectTransform transform;
+        SPDisplayObjectGetTransform(object, &transform);
+        object->_recordingID = currentRecordingID;
+        transformRecorder(object, &transform, transformRecorderContext);
+    }
+
+    object->_orientationChanged = YES;
+}
+
+void SPDisplayObjectWillChangeTransform(SPDisplayObject *object)
+{
+    willChangeTransform(object);
+}
+
+void SPDisplayObjectStartRecordingTransforms(SPTransformRecorder recorder, void *context)
+{
+    transformRecorder = recorder;
+    transformRecorderContext = context;
+    ++currentRecordingID;
+}
+
+void SPDisplayObjectStopRecordingTransforms(void)
+{
+    transformRecorder = NULL;
+    transformRecorderContext = NULL;
+}
+
+void SPDisplayObjectGetTransform(SPDisplayObject *object, SPDisplayObjectTransform *transform)
+{
+    transform->x = object->_x;
+    transform->y = object->_y;
+    transform->scaleX = object->_scaleX;
+    transform->scaleY = object->_scaleY;
+    transform->rotation = object->_rotation;
+    transform->pivotX = object->_pivotX;
+    transform->pivotY = object->_pivotY;
+    transform->skewX = object->_skewX;
+    transform->skewY = object->_skewY;
+}
+
+void SPDisplayObjectSetTransform(SPDisplayObject *object, const SPDisplayObjectTransform *transform)
+{
+    SPDisplayObjectTransform current;
+    SPDisplayObjectGetTransform(object, &current);
+    if (memcmp(&current, transform, sizeof(SPDisplayObjectTransform)) == 0) return;
+
+    willChangeTransform(object);
+    object->_x = transform->x;
+    object->_y = transform->y;
+    object->_scaleX = transform->scaleX;
+    object->_scaleY = transform->scaleY;
+    object->_rotation = transform->rotation;
+    object->_pivotX = transform->pivotX;
+    object->_pivotY = transform->pivotY;
+    object->_skewX = transform->skewX;
+    object->_skewY = transform->skewY;
+}
+
 #pragma mark Initialization
 
 - (instancetype)init
@@ -109,6 +190,7 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
         _transformationMatrix = [[SPMatrix alloc] init];
         _orientationChanged = NO;
         _blendMode = SPBlendModeAuto;
+        _recordingID = currentRecordingID; // objects created while recording are not recorded
     }
     return self;
 }
@@ -143,7 +225,7 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
 - (void)alignPivotX:(SPHAlign)hAlign pivotY:(SPVAlign)vAlign
 {
     SPRectangle* bounds = [self boundsInSpace:self];
-    _orientationChanged = YES;
+    willChangeTransform(self);
 
     switch (hAlign)
     {
@@ -430,7 +512,7 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
 
 - (void)dispatchEvent:(SPEvent *)event
 {
-    if (event.type == SPEventTypeRemovedFromStage && !self.stage)
+    if (event.typeID == SPEventTypeIDRemovedFromStage && !self.stage)
         return; // special check to avoid double-dispatch of RfS-event
     else
         [super dispatchEvent:event];
@@ -439,23 +521,30 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
 // To avoid looping through the complete display tree each frame to find out who's listening to
 // SPEventTypeEnterFrame events, we manage a list of them manually in the SPStage class.
 
-- (void)addEventListener:(id)listener forType:(NSString *)eventType
+- (void)addEventListener:(id)listener forTypeID:(SPEventTypeID)typeID
 {
-    if ([eventType isEqualToString:SPEventTypeEnterFrame] && ![self hasEventListenerForType:SPEventTypeEnterFrame])
+    if (typeID == SPEventTypeIDEnterFrame && ![self hasEventListenerForTypeID:SPEventTypeIDEnterFrame])
     {
         [self addEventListener:@selector(addEnterFrameListenerToStage) atObject:self forType:SPEventTypeAddedToStage];
         [self addEventListener:@selector(removeEnterFrameListenerFromStage) atObject:self forType:SPEventTypeRemovedFromStage];
         if (self.stage) [self addEnterFrameListenerToStage];
     }
 
-    [super addEventListener:listener forType:eventType];
+    BOOL hadListener = [self hasEventListenerForTypeID:typeID];
+    [super addEventListener:listener forTypeID:typeID];
+
+    if (!hadListener) updateDescendantListeners(self, typeID, 1);
 }
 
-- (void)removeEventListenersForType:(NSString *)eventType withTarget:(id)object andSelector:(SEL)selector orBlock:(SPEventBlock)block
+- (void)removeEventListenersForTypeID:(SPEventTypeID)typeID withTarget:(id)object andSelector:(SEL)selector orBlock:(SPEventBlock)block
 {
-    [super removeEventListenersForType:eventType withTarget:object andSelector:selector orBlock:block];
+    BOOL hadListener = [self hasEventListenerForTypeID:typeID];
+    [super removeEventListenersForTypeID:typeID withTarget:object andSelector:selector orBlock:block];
+
+    if (hadListener && ![self hasEventListenerForTypeID:typeID])
+        updateDescendantListeners(self, typeID, -1);
 
-    if ([eventType isEqualToString:SPEventTypeEnterFrame] && ![self hasEventListenerForType:SPEventTypeEnterFrame])
+    if (typeID == SPEventTypeIDEnterFrame && ![self hasEventListenerForTypeID:SPEventTypeIDEnterFrame])
     {
         [self removeEventListener:@selector(addEnterFrameListenerToStage) atObject:self forType:SPEventTypeAddedToStage];
         [self removeEventListener:@selector(removeEnterFrameListenerFromStage) atObject:self forType:SPEventTypeRemovedFromStage];
@@ -479,8 +568,8 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
 {
     if (value != _x)
     {
+        willChangeTransform(self);
         _x = value;
-        _orientationChanged = YES;
     }
 }
 
@@ -488,8 +577,8 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
 {
     if (value != _y)
     {
+        willChangeTransform(self);
         _y = value;
-        _orientationChanged = YES;
     }
 }
 
@@ -505,8 +594,8 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
 {
     if (value != _scaleX || value != _scaleY)
     {
+        willChangeTransform(self);
         _scaleX = _scaleY = value;
-        _orientationChanged = YES;
     }
 }
 
@@ -514,8 +603,8 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
 {
     if (value != _scaleX)
     {
+        willChangeTransform(self);
         _scaleX = value;
-        _orientationChanged = YES;
     }
 }
 
@@ -523,8 +612,8 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
 {
     if (value != _scaleY)
     {
+        willChangeTransform(self);
         _scaleY = value;
-        _orientationChanged = YES;
     }
 }
 
@@ -532,8 +621,8 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
 {
     if (value != _skewX)
     {
+        willChangeTransform(self);
         _skewX = value;
-        _orientationChanged = YES;
     }
 }
 
@@ -541,8 +630,8 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
 {
     if (value != _skewY)
     {
+        willChangeTransform(self);
         _skewY = value;
-        _orientationChanged = YES;
     }
 }
 
@@ -550,8 +639,8 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
 {
     if (value != _pivotX)
     {
+        willChangeTransform(self);
         _pivotX = value;
-        _orientationChanged = YES;
     }
 }
 
@@ -559,8 +648,8 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
 {
     if (value != _pivotY)
     {
+        willChangeTransform(self);
         _pivotY = value;
-        _orientationChanged = YES;
     }
 }
 
@@ -593,15 +682,8 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
 
 - (void)setRotation:(float)value
 {
-    // move to equivalent value in range [0 deg, 360 deg] without a loop
-    value = fmod(value, TWO_PI);
-    
-    // move to [-180 deg, +180 deg]
-    if (value < -PI) value += TWO_PI;
-    if (value >  PI) value -= TWO_PI;
-    
-    _rotation = value;
-    _orientationChanged = YES;
+    willChangeTransform(self);
+    _rotation = SPDisplayObjectNormalizeRotation(value);
 }
 
 - (void)setAlpha:(float)value
@@ -702,6 +784,7 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
 {
     static const float PI_Q = PI / 4.0f;
 
+    willChangeTransform(self);
     _orientationChanged = NO;
     [_transformationMatrix copyFromMatrix:matrix];
     
@@ -763,8 +846,12 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
     if (ancestor == self)
         [NSException raise:SPExceptionInvalidOperation 
                     format:@"An object cannot be added as a child to itself or one of its children"];
-    else
+    else if (parent != _parent)
+    {
+        [_parent addDescendantListenersOfObject:self factor:-1];
         _parent = parent; // only assigned, not retained (to avoid a circular reference).
+        [_parent addDescendantListenersOfObject:self factor:1];
+    }
 }
 
 - (void)setIs3D:(BOOL)is3D
@@ -772,4 +859,68 @@ static SPDisplayObject *findCommonParent(SPDisplayObject *object1, SPDisplayObje
     _is3D = is3D;
 }
 
+- (SPDisplayObjectField)fieldForProperty:(NSString *)property
+{
+    enum { numNames = SPDisplayObjectFieldAlpha + 1 };
+    static NSString *const names[numNames] = {
+        @"x", @"y", @"scaleX", @"scaleY", @"rotation",
+        @"pivotX", @"pivotY", @"skewX", @"skewY", @"alpha"
+    };
+    static SEL getters[numNames];
+    static SEL setters[numNames];
+    static dispatch_once_t once;
+
+    dispatch_once(&once, ^
+    {
+        for (int i=0; i<numNames; ++i)
+        {
+            NSString *setterName = [NSString stringWithFormat:@"set%@%@:",
+                                    [[names[i] substringToIndex:1] uppercaseString],
+                                    [names[i] substringFromIndex:1]];
+            getters[i] = NSSelectorFromString(names[i]);
+            setters[i] = NSSelectorFromString(setterName);
+        }
+    });
+
+    Class objectClass = [self class];
+    Class baseClass = [SPDisplayObject class];
+
+    for (int i=0; i<numNames; ++i)
+    {
+        if ([property isEqualToString:names[i]])
+        {
+            // subclasses that override an accessor might rely on it being called
+            if ([objectClass instanceMethodForSelector:getters[i]] ==
+                    [baseClass instanceMethodForSelector:getters[i]] &&
+                [objectClass instanceMethodForSelector:setters[i]] ==
+                    [baseClass instanceMethodForSelector:setters[i]])
+                return (SPDisplayObjectField)i;
+            else
+                break;
+        }
+    }
+
+    return SPDisplayObjectFieldNone;
+}
+
+- (float *)storageOfField:(SPDisplayObjectField)field
+{
+    switch (field)
+    {
+        case SPDisplayObjectFieldX:        return &_x;
+        case SPDisplayObjectFieldY:        return &_y;
+        case SPDisplayObjectFieldScaleX:   return &_scaleX;
+        case SPDisplayObjectFieldScaleY:   return &_scaleY;
+        case SPDisplayObjectFieldRotation: return &_rotation;
+        case SPDisplayObjectFieldPivotX:   return &_pivotX;
+        case SPDisplayObjectFieldPivotY:   return &_pivotY;
+        case SPDisplayObjectFieldSkewX:    return &_skewX;
+        case SPDisplayObjectFieldSkewY:    return &_skewY;
+        case SPDisplayObjectFieldAlpha:    return &_alpha;
+        default:
+            [NSException raise:SPExceptionIndexOutOfBounds format:@"invalid field: %ld", (long)field];
+            return NULL;
+    }
+}
+
 @end
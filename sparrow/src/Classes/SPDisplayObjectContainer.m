@@ -12,6 +12,7 @@
 #import "SPDisplayObjectContainer_Internal.h"
 #import "SPDisplayObject_Internal.h"
 #import "SPEnterFrameEvent.h"
+#import "SPEventDispatcher_Internal.h"
 #import "SPEvent_Internal.h"
 #import "SPFragmentFilter.h"
 #import "SPMacros.h"
@@ -20,28 +21,87 @@
 #import "SPRectangle.h"
 #import "SPRenderSupport.h"
 
+// --- helper structs ------------------------------------------------------------------------------
+
+typedef struct
+{
+    SPEventTypeID typeID;
+    NSInteger count;
+}
+SPListenerCount;
+
 // --- class implementation ------------------------------------------------------------------------
 
 @implementation SPDisplayObjectContainer
 {
     SP_GENERIC(NSMutableArray, SPDisplayObject*) *_children;
     BOOL _touchGroup;
+
+    // the number of objects in this subtree (including 'self') that listen to a certain type
+    SPListenerCount *_listenerCounts;
+    NSInteger _numListenerCounts;
+    NSInteger _listenerCountCapacity;
 }
 
 // --- c functions ---
 
-static void getDescendantEventListeners(SPDisplayObject *object, NSString *eventType,
+static NSInteger getListenerCount(SPDisplayObjectContainer *container, SPEventTypeID typeID)
+{
+    for (NSInteger i=0; i<container->_numListenerCounts; ++i)
+        if (container->_listenerCounts[i].typeID == typeID)
+            return container->_listenerCounts[i].count;
+
+    return 0;
+}
+
+static void addListenerCount(SPDisplayObjectContainer *container, SPEventTypeID typeID, NSInteger count)
+{
+    SPListenerCount *counts = container->_listenerCounts;
+    NSInteger numCounts = container->_numListenerCounts;
+    NSInteger index = 0;
+
+    while (index < numCounts && counts[index].typeID != typeID)
+        ++index;
+
+    if (index < numCounts)
+    {
+        counts[index].count += count;
+        if (counts[index].count <= 0)
+            counts[index] = counts[--container->_numListenerCounts];
+    }
+    else if (count > 0)
+    {
+        if (numCounts == container->_listenerCountCapacity)
+        {
+            container->_listenerCountCapacity = MAX(4, numCounts * 2);
+            container->_listenerCounts = counts = realloc(counts,
+                sizeof(SPListenerCount) * container->_listenerCountCapacity);
+        }
+
+        counts[container->_numListenerCounts++] = (SPListenerCount){ typeID, count };
+    }
+}
+
+static void getDescendantEventListeners(SPDisplayObject *object, SPEventTypeID typeID,
                                         SP_GENERIC(NSMutableArray, SPDisplayObject*) *listeners)
 {
     // some events (ENTER_FRAME, ADDED_TO_STAGE, etc.) are dispatched very often and traverse
     // the entire display tree -- thus, it pays off handling them in their own c function.
-    
-    if ([object hasEventListenerForType:eventType])
-        [listeners addObject:object];
+    // Subtrees without any listeners for the event type are skipped completely.
     
     if ([object isKindOfClass:[SPDisplayObjectContainer class]])
-        for (SPDisplayObject *child in ((SPDisplayObjectContainer *)object)->_children)
-            getDescendantEventListeners(child, eventType, listeners);
+    {
+        SPDisplayObjectContainer *container = (SPDisplayObjectContainer *)object;
+        if (!getListenerCount(container, typeID)) return;
+        
+        if ([object hasEventListenerForTypeID:typeID])
+            [listeners addObject:object];
+        
+        for (SPDisplayObject *child in container->_children)
+            getDescendantEventListeners(child, typeID, listeners);
+    }
+    else if ([object hasEventListenerForTypeID:typeID])
+        [listeners addObject:object];
 }
 
 #pragma mark Initialization
@@ -62,6 +122,7 @@ static void getDescendantEventListeners(SPDisplayObject *object, NSString *event
     // 'self' is becoming invalid; thus, we have to remove any references to it.
     [_children makeObjectsPerformSelector:@selector(setParent:) withObject:nil];
     [_children release];
+    free(_listenerCounts);
     [super dealloc];
 }
 
@@ -331,7 +392,7 @@ static void getDescendantEventListeners(SPDisplayObject *object, NSString *event
     // the event listeners might modify the display tree, which could make the loop crash.
     // thus, we collect them in a list and iterate over that list instead.
     NSMutableArray *listeners = [[NSMutableArray alloc] init];
-    [self appendDescendantEventListenersOfObject:self withEventType:event.type toArray:listeners];
+    [self appendDescendantEventListenersOfObject:self withEventTypeID:event.typeID toArray:listeners];
     
     event.target = self;
     for (SPEventDispatcher *listener in listeners)
@@ -342,7 +403,7 @@ static void getDescendantEventListeners(SPDisplayObject *object, NSString *event
 
 - (void)broadcastEventWithType:(NSString *)type
 {
-    SPEvent *event = [[SPEvent alloc] initWithType:type bubbles:NO];
+    SPEvent *event = [[SPEvent allocFromPool] initWithType:type bubbles:NO];
     [self broadcastEvent:event];
     [event release];
 }
@@ -362,10 +423,41 @@ static void getDescendantEventListeners(SPDisplayObject *object, NSString *event
 
 @implementation SPDisplayObjectContainer (Internal)
 
-- (void)appendDescendantEventListenersOfObject:(SPDisplayObject *)object withEventType:(NSString *)type
+- (void)appendDescendantEventListenersOfObject:(SPDisplayObject *)object withEventTypeID:(SPEventTypeID)typeID
                                        toArray:(SP_GENERIC(NSMutableArray, SPDisplayObject*) *)listeners
 {
-    getDescendantEventListeners(object, type, listeners);
+    getDescendantEventListeners(object, typeID, listeners);
+}
+
+- (NSInteger)numDescendantListenersForTypeID:(SPEventTypeID)typeID
+{
+    return getListenerCount(self, typeID);
+}
+
+- (void)addDescendantListeners:(NSInteger)count forTypeID:(SPEventTypeID)typeID
+{
+    for (SPDisplayObjectContainer *container = self; container; container = container.parent)
+        addListenerCount(container, typeID, count);
+}
+
+- (void)addDescendantListenersOfObject:(SPDisplayObject *)object factor:(NSInteger)factor
+{
+    // adds (factor 1) or subtracts (factor -1) the listeners of an object's subtree to / from
+    // this container and all its ancestors. Called when the object is added or removed.
+
+    if ([object isKindOfClass:[SPDisplayObjectContainer class]])
+    {
+        SPDisplayObjectContainer *container = (SPDisplayObjectContainer *)object;
+        for (NSInteger i=0; i<container->_numListenerCounts; ++i)
+            [self addDescendantListeners:container->_listenerCounts[i].count * factor
+                               forTypeID:container->_listenerCounts[i].typeID];
+    }
+    else
+    {
+        NSInteger numTypeIDs = [object numEventTypeIDs];
+        for (NSInteger i=0; i<numTypeIDs; ++i)
+            [self addDescendantListeners:factor forTypeID:[object eventTypeIDAtIndex:i]];
+    }
 }
 
 @end
@@ -15,9 +15,13 @@ NS_ASSUME_NONNULL_BEGIN
 @interface SPDisplayObjectContainer (Internal)
 
 - (void)appendDescendantEventListenersOfObject:(SPDisplayObject *)object
-                                 withEventType:(NSString *)type
+                               withEventTypeID:(SPEventTypeID)typeID
                                        toArray:(SP_GENERIC(NSMutableArray, SPDisplayObject*) *)listeners;
 
+- (NSInteger)numDescendantListenersForTypeID:(SPEventTypeID)typeID;
+- (void)addDescendantListeners:(NSInteger)count forTypeID:(SPEventTypeID)typeID;
+- (void)addDescendantListenersOfObject:(SPDisplayObject *)object factor:(NSInteger)factor;
+
 @end
 
 NS_ASSUME_NONNULL_END
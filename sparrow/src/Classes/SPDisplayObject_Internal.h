@@ -10,14 +10,85 @@
 //
 
 #import "SPDisplayObject.h"
+#import "SPMacros.h"
 
 NS_ASSUME_NONNULL_BEGIN
 
+/// The fields of a display object that tweens may write directly, bypassing the setters.
+typedef NS_ENUM(NSInteger, SPDisplayObjectField)
+{
+    SPDisplayObjectFieldNone = -1,
+    SPDisplayObjectFieldX,
+    SPDisplayObjectFieldY,
+    SPDisplayObjectFieldScaleX,
+    SPDisplayObjectFieldScaleY,
+    SPDisplayObjectFieldRotation,
+    SPDisplayObjectFieldPivotX,
+    SPDisplayObjectFieldPivotY,
+    SPDisplayObjectFieldSkewX,
+    SPDisplayObjectFieldSkewY,
+    SPDisplayObjectFieldAlpha,
+};
+
+/// Moves an angle (in radians) into the range [-PI, PI], like the `rotation` setter does.
+SP_INLINE float SPDisplayObjectNormalizeRotation(float value)
+{
+    // move to equivalent value in range [0 deg, 360 deg] without a loop
+    value = fmodf(value, TWO_PI);
+
+    // move to [-180 deg, +180 deg]
+    if (value < -PI) value += TWO_PI;
+    if (value >  PI) value -= TWO_PI;
+
+    return value;
+}
+
+/// The fields that make up the transformation matrix of a display object.
+typedef struct
+{
+    float x, y;
+    float scaleX, scaleY;
+    float rotation;
+    float pivotX, pivotY;
+    float skewX, skewY;
+} SPDisplayObjectTransform;
+
+/// Copies the transform fields of an object.
+SP_EXTERN void SPDisplayObjectGetTransform(SPDisplayObject *object, SPDisplayObjectTransform *transform);
+
+/// Writes the transform fields of an object, bypassing the setters. The transformation matrix
+/// is only marked as outdated if a value actually changed.
+SP_EXTERN void SPDisplayObjectSetTransform(SPDisplayObject *object,
+                                           const SPDisplayObjectTransform *transform);
+
+/// Marks the transformation matrix of an object as outdated and records its current transform
+/// (see below). Call this right *before* writing any of its transform fields directly.
+SP_EXTERN void SPDisplayObjectWillChangeTransform(SPDisplayObject *object);
+
+/// A function that receives the transform of an object before it is changed.
+typedef void (*SPTransformRecorder)(SPDisplayObject *object,
+                                    const SPDisplayObjectTransform *transform, void *context);
+
+/// Passes every display object to the recorder right before its transform changes for the
+/// first time after this call; objects created in the meantime are skipped. Only one recording
+/// can be active, and it must not overlap with changes on other threads.
+SP_EXTERN void SPDisplayObjectStartRecordingTransforms(SPTransformRecorder recorder, void *context);
+
+/// Stops the active recording.
+SP_EXTERN void SPDisplayObjectStopRecordingTransforms(void);
+
 @interface SPDisplayObject (Internal)
 
 - (void)setParent:(nullable SPDisplayObjectContainer *)parent;
 - (void)setIs3D:(BOOL)is3D;
 
+/// Returns the field backing a property, or `SPDisplayObjectFieldNone` if there is none or the
+/// class of the object overrides the property's accessors.
+- (SPDisplayObjectField)fieldForProperty:(NSString *)property;
+
+/// Returns a pointer to the storage of a field. The pointer is valid as long as the object lives.
+- (float *)storageOfField:(SPDisplayObjectField)field;
+
 @end
 
 NS_ASSUME_NONNULL_END
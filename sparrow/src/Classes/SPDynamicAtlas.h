@@ -0,0 +1,118 @@
+//
+//  SPDynamicAtlas.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 18.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import <Sparrow/SparrowBase.h>
+#import <Sparrow/SPTexture.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/** ------------------------------------------------------------------------------------------------
+
+ An SPDynamicAtlas packs images into shared texture pages at runtime. Images that are loaded
+ one by one (e.g. downloaded avatars or UI elements) would otherwise get a texture of their own,
+ and each of them would interrupt a batch; packed into a few pages, they can be rendered with a
+ few draw calls.
+
+ Images are placed with a "MaxRects" packer and returned as sub textures. Each page only contains
+ images of the same format, scale factor and alpha mode. Every image is surrounded by a border
+ that repeats its edge pixels, so that filtering does not pull in its neighbours.
+
+	SPDynamicAtlas *atlas = [SPDynamicAtlas sharedAtlas];
+	SPTexture *avatar = [atlas addImage:image forKey:@"avatar-42"];
+
+ The easiest way to use an atlas is via `SPTextureOptions`; textures that are loaded with such
+ options are added to the atlas, keyed by their path:
+
+	SPTextureOptions *options = [SPTextureOptions textureOptions];
+	options.atlas = [SPDynamicAtlas sharedAtlas];
+
+	SPTexture *icon = [SPTexture textureWithContentsOfFile:@"icon.png" options:options];
+
+ Images that are too big for a page, compressed textures and textures with mipmaps are not
+ packed; the loading calls then create a standalone texture instead.
+
+ The atlas keeps its textures until they are removed. Removing textures leaves holes that new
+ images can use; when the pages get too fragmented, call `defragment` to repack all textures
+ into as few pages as possible. That creates new sub textures: the old ones stay valid (keeping
+ their old page alive) until they are released, so it's best to defragment at a point where
+ the textures are fetched again anyway, e.g. when switching scenes.
+
+ The atlas keeps a copy of its pages in main memory, so that images can be added and moved
+ without reading back from the GPU. All methods that add images require a current OpenGL context;
+ they may be called from any thread.
+
+------------------------------------------------------------------------------------------------- */
+
+@interface SPDynamicAtlas : NSObject
+
+/// --------------------
+/// @name Initialization
+/// --------------------
+
+/// Initializes an atlas with pages of a certain size (in pixels). _Designated Initializer_.
+- (instancetype)initWithPageSize:(NSInteger)pageSize;
+
+/// Initializes an atlas with pages of 1024x1024 pixels.
+- (instancetype)init;
+
+/// Returns an atlas that is shared by the whole app.
++ (SPDynamicAtlas *)sharedAtlas;
+
+/// -------------
+/// @name Methods
+/// -------------
+
+/// Adds an image to the atlas and returns the texture that shows it. A texture with the same key
+/// is replaced. Returns nil if the image does not fit on a page.
+- (nullable SPTexture *)addImage:(UIImage *)image forKey:(NSString *)key;
+
+/// Adds raw pixels in an uncompressed format to the atlas and returns the texture that shows
+/// them. Rows have to be tightly packed; width and height are expected in pixels. A texture with
+/// the same key is replaced. Returns nil if the format is compressed or if the pixels don't fit
+/// on a page.
+- (nullable SPTexture *)addPixels:(const void *)pixels width:(NSInteger)width height:(NSInteger)height
+                            scale:(float)scale format:(SPTextureFormat)format
+               premultipliedAlpha:(BOOL)pma forKey:(NSString *)key;
+
+/// Returns the texture that was added with a certain key, or nil if there is none.
+- (nullable SPTexture *)textureForKey:(NSString *)key;
+
+/// Removes a texture from the atlas, making its area available for other images. Textures that
+/// are still in use stay valid, but their area may be overwritten.
+- (void)removeTextureForKey:(NSString *)key;
+
+/// Removes all textures and pages.
+- (void)removeAllTextures;
+
+/// Repacks all textures into new pages, largest first. Afterwards, `textureForKey:` returns
+/// new sub textures; the old ones keep their old pages alive until they are released.
+- (void)defragment;
+
+/// ----------------
+/// @name Properties
+/// ----------------
+
+/// The width and height of the pages in pixels.
+@property (nonatomic, readonly) NSInteger pageSize;
+
+/// The number of pages that are currently in use.
+@property (nonatomic, readonly) NSInteger numPages;
+
+/// The number of textures in the atlas.
+@property (nonatomic, readonly) NSInteger numTextures;
+
+/// The ratio of the page area that is occupied by textures (including their borders), between
+/// 0 and 1. A low ratio indicates that the atlas should be defragmented.
+@property (nonatomic, readonly) float fillRatio;
+
+@end
+
+NS_ASSUME_NONNULL_END
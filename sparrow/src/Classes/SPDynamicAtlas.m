@@ -0,0 +1,638 @@
+//
+//  SPDynamicAtlas.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 18.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPDynamicAtlas.h"
+#import "SPGLTexture_Internal.h"
+#import "SPMacros.h"
+#import "SPRectangle.h"
+#import "SPSubTexture.h"
+#import "SPTexture_Internal.h"
+
+#import <pthread.h>
+
+#define DEFAULT_PAGE_SIZE 1024
+#define BORDER               1 // pixels around each image, repeating its edges
+
+typedef struct
+{
+    NSInteger x;
+    NSInteger y;
+    NSInteger width;
+    NSInteger height;
+} SPPackerRect;
+
+// --- C functions ---------------------------------------------------------------------------------
+
+static BOOL rectsIntersect(SPPackerRect a, SPPackerRect b)
+{
+    return a.x < b.x + b.width  && a.x + a.width  > b.x &&
+           a.y < b.y + b.height && a.y + a.height > b.y;
+}
+
+static BOOL rectContainsRect(SPPackerRect outer, SPPackerRect inner)
+{
+    return inner.x >= outer.x && inner.x + inner.width  <= outer.x + outer.width &&
+           inner.y >= outer.y && inner.y + inner.height <= outer.y + outer.height;
+}
+
+// --- helper classes ------------------------------------------------------------------------------
+
+/// A texture page with a "MaxRects" packer: it keeps a list of the maximal free rectangles, which
+/// may overlap. New images are placed into the free rectangle that leaves the shortest side over
+/// ("best short side fit"). The pixels are kept in memory, so that new images can be uploaded
+/// without touching the rest of the texture.
+@interface SPDynamicAtlasPage : NSObject
+
+- (instancetype)initWithSize:(NSInteger)size format:(SPTextureFormat)format
+                       scale:(float)scale premultipliedAlpha:(BOOL)pma;
+- (BOOL)addPixels:(const void *)pixels width:(NSInteger)width height:(NSInteger)height
+           stride:(NSInteger)stride border:(NSInteger)border rect:(SPPackerRect *)rect;
+- (void)removeRect:(SPPackerRect)rect;
+- (const void *)pixelsAtX:(NSInteger)x y:(NSInteger)y;
+- (void)upload;
+- (BOOL)isCompatibleWithFormat:(SPTextureFormat)format scale:(float)scale premultipliedAlpha:(BOOL)pma;
+
+@property (nonatomic, readonly) SPGLTexture *texture;
+@property (nonatomic, readonly) NSInteger bytesPerPixel;
+@property (nonatomic, readonly) NSInteger stride;
+@property (nonatomic, readonly) NSInteger usedArea;
+@property (nonatomic, readonly) NSInteger numRects;
+
+@end
+
+@implementation SPDynamicAtlasPage
+{
+    SPGLTexture *_texture;
+    uchar *_pixels;
+    NSInteger _size;
+    NSInteger _bytesPerPixel;
+    NSInteger _usedArea;
+    NSInteger _numRects;
+    SPPackerRect *_freeRects;
+    NSInteger _numFreeRects;
+    NSInteger _freeRectsCapacity;
+    NSInteger _dirtyTop;     // the range of rows that was changed since the last upload
+    NSInteger _dirtyBottom;
+}
+
+@synthesize texture = _texture;
+@synthesize bytesPerPixel = _bytesPerPixel;
+@synthesize usedArea = _usedArea;
+@synthesize numRects = _numRects;
+
+// --- c functions ---
+
+static void addFreeRect(SPDynamicAtlasPage *self, SPPackerRect rect)
+{
+    if (self->_numFreeRects == self->_freeRectsCapacity)
+    {
+        self->_freeRectsCapacity = MAX(16, self->_freeRectsCapacity * 2);
+        self->_freeRects = realloc(self->_freeRects, self->_freeRectsCapacity * sizeof(SPPackerRect));
+    }
+
+    self->_freeRects[self->_numFreeRects++] = rect;
+}
+
+static void removeFreeRectAtIndex(SPDynamicAtlasPage *self, NSInteger index)
+{
+    self->_freeRects[index] = self->_freeRects[--self->_numFreeRects];
+}
+
+static BOOL findPosition(SPDynamicAtlasPage *self, NSInteger width, NSInteger height,
+                         SPPackerRect *result)
+{
+    NSInteger bestShortSide = NSIntegerMax;
+    NSInteger bestLongSide = NSIntegerMax;
+
+    for (NSInteger i=0; i<self->_numFreeRects; ++i)
+    {
+        SPPackerRect freeRect = self->_freeRects[i];
+        if (freeRect.width < width || freeRect.height < height) continue;
+
+        NSInteger leftoverX = freeRect.width - width;
+        NSInteger leftoverY = freeRect.height - height;
+        NSInteger shortSide = MIN(leftoverX, leftoverY);
+        NSInteger longSide  = MAX(leftoverX, leftoverY);
+
+        if (shortSide < bestShortSide || (shortSide == bestShortSide && longSide < bestLongSide))
+        {
+            *result = (SPPackerRect){ freeRect.x, freeRect.y, width, height };
+            bestShortSide = shortSide;
+            bestLongSide = longSide;
+        }
+    }
+
+    return bestShortSide != NSIntegerMax;
+}
+
+static void pruneFreeRects(SPDynamicAtlasPage *self)
+{
+    // remove all free rectangles that are contained in another one
+    for (NSInteger i=0; i<self->_numFreeRects; ++i)
+    {
+        for (NSInteger j=i+1; j<self->_numFreeRects; ++j)
+        {
+            if (rectContainsRect(self->_freeRects[j], self->_freeRects[i]))
+            {
+                removeFreeRectAtIndex(self, i--);
+                break;
+            }
+            else if (rectContainsRect(self->_freeRects[i], self->_freeRects[j]))
+                removeFreeRectAtIndex(self, j--);
+        }
+    }
+}
+
+static void placeRect(SPDynamicAtlasPage *self, SPPackerRect used)
+{
+    // every free rectangle that overlaps the new one is replaced by the (up to four) maximal
+    // rectangles that remain around it
+    NSInteger numRects = self->_numFreeRects;
+
+    for (NSInteger i=0; i<numRects; )
+    {
+        SPPackerRect freeRect = self->_freeRects[i];
+
+        if (!rectsIntersect(freeRect, used))
+        {
+            ++i;
+            continue;
+        }
+
+        NSInteger freeRight  = freeRect.x + freeRect.width;
+        NSInteger freeBottom = freeRect.y + freeRect.height;
+        NSInteger usedRight  = used.x + used.width;
+        NSInteger usedBottom = used.y + used.height;
+
+        if (used.y > freeRect.y)
+            addFreeRect(self, (SPPackerRect){ freeRect.x, freeRect.y,
+                                              freeRect.width, used.y - freeRect.y });
+        if (usedBottom < freeBottom)
+            addFreeRect(self, (SPPackerRect){ freeRect.x, usedBottom, freeRect.width, freeBottom - usedBottom });
+        if (used.x > freeRect.x)
+            addFreeRect(self, (SPPackerRect){ freeRect.x, freeRect.y,
+                                              used.x - freeRect.x, freeRect.height });
+        if (usedRight < freeRight)
+            addFreeRect(self, (SPPackerRect){ usedRight, freeRect.y, freeRight - usedRight, freeRect.height });
+
+        // move the last of the original rectangles into the gap; new ones were appended behind
+        self->_freeRects[i] = self->_freeRects[numRects - 1];
+        self->_freeRects[numRects - 1] = self->_freeRects[--self->_numFreeRects];
+        --numRects;
+    }
+
+    pruneFreeRects(self);
+}
+
+static void mergeFreeRects(SPDynamicAtlasPage *self)
+{
+    // joins free rectangles that share a complete edge, so that removed areas can be reused
+    // for bigger images
+    BOOL merged = YES;
+
+    while (merged)
+    {
+        merged = NO;
+
+        for (NSInteger i=0; i<self->_numFreeRects && !merged; ++i)
+        {
+            for (NSInteger j=i+1; j<self->_numFreeRects && !merged; ++j)
+            {
+                SPPackerRect a = self->_freeRects[i];
+                SPPackerRect b = self->_freeRects[j];
+
+                if (a.x == b.x && a.width == b.width &&
+                    (a.y + a.height == b.y || b.y + b.height == a.y))
+                {
+                    self->_freeRects[i] = (SPPackerRect){ a.x, MIN(a.y, b.y), a.width,
+                                                          a.height + b.height };
+                    merged = YES;
+                }
+                else if (a.y == b.y && a.height == b.height &&
+                         (a.x + a.width == b.x || b.x + b.width == a.x))
+                {
+                    self->_freeRects[i] = (SPPackerRect){ MIN(a.x, b.x), a.y, a.width + b.width,
+                                                          a.height };
+                    merged = YES;
+                }
+
+                if (merged) removeFreeRectAtIndex(self, j);
+            }
+        }
+    }
+}
+
+static void markDirty(SPDynamicAtlasPage *self, SPPackerRect rect)
+{
+    self->_dirtyTop = MIN(self->_dirtyTop, rect.y);
+    self->_dirtyBottom = MAX(self->_dirtyBottom, rect.y + rect.height);
+}
+
+#pragma mark Initialization
+
+- (instancetype)initWithSize:(NSInteger)size format:(SPTextureFormat)format
+                       scale:(float)scale premultipliedAlpha:(BOOL)pma
+{
+    if ((self = [super init]))
+    {
+        _size = size;
+        _bytesPerPixel = SPTextureFormatSizeOfLevel(format, 1, 1);
+        _pixels = calloc(size * size * _bytesPerPixel, 1);
+        _dirtyTop = size;
+
+        addFreeRect(self, (SPPackerRect){ 0, 0, size, size });
+
+        SPTextureProperties properties = {
+            .format = format,
+            .scale  = scale,
+            .width  = size,
+            .height = size,
+            .numMipmaps = 0,
+            .generateMipmaps = NO,
+            .premultipliedAlpha = pma
+        };
+
+        _texture = [[SPGLTexture alloc] initWithData:_pixels properties:properties];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    free(_pixels);
+    free(_freeRects);
+    [_texture release];
+    [super dealloc];
+}
+
+#pragma mark Methods
+
+- (BOOL)addPixels:(const void *)pixels width:(NSInteger)width height:(NSInteger)height
+           stride:(NSInteger)stride border:(NSInteger)border rect:(SPPackerRect *)rect
+{
+    NSInteger bpp = _bytesPerPixel;
+    NSInteger pageStride = _size * bpp;
+    NSInteger outerWidth = width + 2 * border;
+
+    if (!findPosition(self, outerWidth, height + 2 * border, rect))
+        return NO;
+
+    placeRect(self, *rect);
+
+    uchar *origin = _pixels + rect->y * pageStride + rect->x * bpp;
+    uchar *target = origin + border * pageStride + border * bpp;
+
+    for (NSInteger y=0; y<height; ++y)
+    {
+        uchar *row = target + y * pageStride;
+        memcpy(row, (const uchar *)pixels + y * stride, width * bpp);
+
+        for (NSInteger b=1; b<=border; ++b)
+        {
+            memcpy(row - b * bpp, row, bpp);
+            memcpy(row + (width - 1 + b) * bpp, row + (width - 1) * bpp, bpp);
+        }
+    }
+
+    for (NSInteger b=0; b<border; ++b)
+    {
+        memcpy(origin + b * pageStride, origin + border * pageStride, outerWidth * bpp);
+        memcpy(origin + (border + height + b) * pageStride,
+               origin + (border + height - 1) * pageStride, outerWidth * bpp);
+    }
+
+    _usedArea += rect->width * rect->height;
+    ++_numRects;
+    markDirty(self, *rect);
+
+    return YES;
+}
+
+- (void)removeRect:(SPPackerRect)rect
+{
+    NSInteger pageStride = _size * _bytesPerPixel;
+    uchar *origin = _pixels + rect.y * pageStride + rect.x * _bytesPerPixel;
+
+    for (NSInteger y=0; y<rect.height; ++y)
+        memset(origin + y * pageStride, 0, rect.width * _bytesPerPixel);
+
+    addFreeRect(self, rect);
+    mergeFreeRects(self);
+    pruneFreeRects(self);
+
+    _usedArea -= rect.width * rect.height;
+    --_numRects;
+    markDirty(self, rect);
+}
+
+- (const void *)pixelsAtX:(NSInteger)x y:(NSInteger)y
+{
+    return _pixels + (y * _size + x) * _bytesPerPixel;
+}
+
+- (void)upload
+{
+    if (_dirtyTop >= _dirtyBottom) return;
+
+    [_texture uploadRowsFrom:_dirtyTop count:_dirtyBottom - _dirtyTop
+                      pixels:_pixels + _dirtyTop * _size * _bytesPerPixel];
+
+    _dirtyTop = _size;
+    _dirtyBottom = 0;
+}
+
+- (BOOL)isCompatibleWithFormat:(SPTextureFormat)format scale:(float)scale premultipliedAlpha:(BOOL)pma
+{
+    return _texture.format == format && _texture.scale == scale && _texture.premultipliedAlpha == pma;
+}
+
+#pragma mark Properties
+
+- (NSInteger)stride
+{
+    return _size * _bytesPerPixel;
+}
+
+@end
+
+/// A texture in the atlas: the page it's placed on, and its area (including the border).
+@interface SPDynamicAtlasEntry : NSObject
+
+@property (nonatomic, retain) SPDynamicAtlasPage *page;
+@property (nonatomic, retain) SPTexture *texture;
+@property (nonatomic, assign) SPPackerRect rect;
+
+@end
+
+@implementation SPDynamicAtlasEntry
+
+- (void)dealloc
+{
+    [_page release];
+    [_texture release];
+    [super dealloc];
+}
+
+@end
+
+// --- class implementation ------------------------------------------------------------------------
+
+@implementation SPDynamicAtlas
+{
+    SP_GENERIC(NSMutableDictionary, NSString*, SPDynamicAtlasEntry*) *_entries;
+    SP_GENERIC(NSMutableArray, SPDynamicAtlasPage*) *_pages;
+    NSInteger _pageSize;
+    pthread_mutex_t _mutex;
+}
+
+#pragma mark Initialization
+
+- (instancetype)initWithPageSize:(NSInteger)pageSize
+{
+    if ((self = [super init]))
+    {
+        _pageSize = pageSize;
+        _entries = [[NSMutableDictionary alloc] init];
+        _pages = [[NSMutableArray alloc] init];
+        pthread_mutex_init(&_mutex, NULL);
+    }
+    return self;
+}
+
+- (instancetype)init
+{
+    return [self initWithPageSize:DEFAULT_PAGE_SIZE];
+}
+
+- (void)dealloc
+{
+    pthread_mutex_destroy(&_mutex);
+    [_entries release];
+    [_pages release];
+    [super dealloc];
+}
+
++ (SPDynamicAtlas *)sharedAtlas
+{
+    static SPDynamicAtlas *sharedAtlas = nil;
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^{ sharedAtlas = [[SPDynamicAtlas alloc] init]; });
+    return sharedAtlas;
+}
+
+#pragma mark Methods
+
+- (SPTexture *)addImage:(UIImage *)image forKey:(NSString *)key
+{
+    SPDecodedTexture *decodedTexture = [[SPDecodedTexture alloc]
+        initWithWidth:image.size.width height:image.size.height generateMipmaps:NO
+                scale:image.scale draw:^(CGContextRef context)
+                {
+                    [image drawAtPoint:CGPointMake(0, 0)];
+                }];
+
+    SPTexture *texture = [decodedTexture addToAtlas:self forKey:key];
+    [decodedTexture release];
+    return texture;
+}
+
+- (SPTexture *)addPixels:(const void *)pixels width:(NSInteger)width height:(NSInteger)height
+                   scale:(float)scale format:(SPTextureFormat)format
+      premultipliedAlpha:(BOOL)pma forKey:(NSString *)key
+{
+    if (SPTextureFormatIsCompressed(format) || width < 1 || height < 1 ||
+        width + 2 * BORDER > _pageSize || height + 2 * BORDER > _pageSize)
+        return nil;
+
+    SPTexture *texture = nil;
+    pthread_mutex_lock(&_mutex);
+
+    @try
+    {
+        [self removeEntryForKey:key];
+
+        NSInteger stride = width * SPTextureFormatSizeOfLevel(format, 1, 1);
+        SPDynamicAtlasEntry *entry = [self addPixels:pixels width:width height:height stride:stride
+                                              border:BORDER scale:scale format:format
+                                  premultipliedAlpha:pma];
+        [entry.page upload];
+
+        _entries[key] = entry;
+        texture = entry.texture;
+    }
+    @finally
+    {
+        pthread_mutex_unlock(&_mutex);
+    }
+
+    return texture;
+}
+
+- (SPTexture *)textureForKey:(NSString *)key
+{
+    pthread_mutex_lock(&_mutex);
+    SPTexture *texture = [[_entries[key].texture retain] autorelease];
+    pthread_mutex_unlock(&_mutex);
+
+    return texture;
+}
+
+- (void)removeTextureForKey:(NSString *)key
+{
+    pthread_mutex_lock(&_mutex);
+    [self removeEntryForKey:key];
+    pthread_mutex_unlock(&_mutex);
+}
+
+- (void)removeAllTextures
+{
+    pthread_mutex_lock(&_mutex);
+    [_entries removeAllObjects];
+    [_pages removeAllObjects];
+    pthread_mutex_unlock(&_mutex);
+}
+
+- (void)defragment
+{
+    pthread_mutex_lock(&_mutex);
+
+    // Big textures are placed first; that gives the packer the best chance to fill the
+    // gaps with the small ones. The old pages are released as soon as their last texture is.
+
+    NSArray *keys = [_entries keysSortedByValueUsingComparator:
+                     ^NSComparisonResult(SPDynamicAtlasEntry *entry1, SPDynamicAtlasEntry *entry2)
+    {
+        NSInteger area1 = entry1.rect.width * entry1.rect.height;
+        NSInteger area2 = entry2.rect.width * entry2.rect.height;
+        if (area1 > area2) return NSOrderedAscending;
+        if (area1 < area2) return NSOrderedDescending;
+        return NSOrderedSame;
+    }];
+
+    SP_GENERIC(NSMutableDictionary, NSString*, SPDynamicAtlasEntry*) *oldEntries = _entries;
+    _entries = [[NSMutableDictionary alloc] init];
+    [_pages removeAllObjects];
+
+    for (NSString *key in keys)
+    {
+        SPDynamicAtlasEntry *oldEntry = oldEntries[key];
+        SPDynamicAtlasPage *oldPage = oldEntry.page;
+        SPGLTexture *glTexture = oldPage.texture;
+        SPPackerRect rect = oldEntry.rect;
+
+        // the border is copied along with the pixels
+        _entries[key] = [self addPixels:[oldPage pixelsAtX:rect.x y:rect.y]
+                                  width:rect.width height:rect.height stride:oldPage.stride
+                                 border:0 scale:glTexture.scale format:glTexture.format
+                     premultipliedAlpha:glTexture.premultipliedAlpha];
+    }
+
+    for (SPDynamicAtlasPage *page in _pages)
+        [page upload];
+
+    [oldEntries release];
+    pthread_mutex_unlock(&_mutex);
+}
+
+#pragma mark Private
+
+- (SPDynamicAtlasEntry *)addPixels:(const void *)pixels width:(NSInteger)width height:(NSInteger)height
+                            stride:(NSInteger)stride border:(NSInteger)border scale:(float)scale
+                            format:(SPTextureFormat)format premultipliedAlpha:(BOOL)pma
+{
+    SPPackerRect rect;
+    SPDynamicAtlasPage *targetPage = nil;
+
+    for (SPDynamicAtlasPage *page in _pages)
+    {
+        if ([page isCompatibleWithFormat:format scale:scale premultipliedAlpha:pma] &&
+            [page addPixels:pixels width:width height:height stride:stride border:border rect:&rect])
+        {
+            targetPage = page;
+            break;
+        }
+    }
+
+    if (!targetPage)
+    {
+        targetPage = [[[SPDynamicAtlasPage alloc] initWithSize:_pageSize format:format
+                                                         scale:scale premultipliedAlpha:pma] autorelease];
+        [_pages addObject:targetPage];
+        [targetPage addPixels:pixels width:width height:height stride:stride border:border rect:&rect];
+    }
+
+    // the region excludes the border
+    SPRectangle *region = [SPRectangle rectangleWithX:(rect.x + BORDER) / scale
+                                                    y:(rect.y + BORDER) / scale
+                                                width:(rect.width  - 2 * BORDER) / scale
+                                               height:(rect.height - 2 * BORDER) / scale];
+
+    SPDynamicAtlasEntry *entry = [[SPDynamicAtlasEntry alloc] init];
+    entry.page = targetPage;
+    entry.rect = rect;
+    entry.texture = [SPTexture textureWithRegion:region ofTexture:targetPage.texture];
+    return [entry autorelease];
+}
+
+- (void)removeEntryForKey:(NSString *)key
+{
+    SPDynamicAtlasEntry *entry = _entries[key];
+    if (!entry) return;
+
+    SPDynamicAtlasPage *page = entry.page;
+    [page removeRect:entry.rect];
+
+    if (page.numRects == 0) [_pages removeObjectIdenticalTo:page];
+    else                    [page upload];
+
+    [_entries removeObjectForKey:key];
+}
+
+#pragma mark Properties
+
+- (NSInteger)pageSize
+{
+    return _pageSize;
+}
+
+- (NSInteger)numPages
+{
+    pthread_mutex_lock(&_mutex);
+    NSInteger numPages = _pages.count;
+    pthread_mutex_unlock(&_mutex);
+
+    return numPages;
+}
+
+- (NSInteger)numTextures
+{
+    pthread_mutex_lock(&_mutex);
+    NSInteger numTextures = _entries.count;
+    pthread_mutex_unlock(&_mutex);
+
+    return numTextures;
+}
+
+- (float)fillRatio
+{
+    pthread_mutex_lock(&_mutex);
+
+    NSInteger usedArea = 0;
+    for (SPDynamicAtlasPage *page in _pages)
+        usedArea += page.usedArea;
+
+    NSInteger totalArea = _pages.count * _pageSize * _pageSize;
+    pthread_mutex_unlock(&_mutex);
+
+    return totalArea ? (float)usedArea / totalArea : 0.0f;
+}
+
+@end
@@ -25,6 +25,38 @@ SP_EXTERN NSString *const SPEventTypeFlatten;
 SP_EXTERN NSString *const SPEventTypeRender;
 SP_EXTERN NSString *const SPEventTypePress;
 
+/// Event types are interned: each event type string is mapped to a small integer that is used
+/// internally to look up listeners. Sparrow's built-in event types have fixed IDs; custom types
+/// are assigned an ID the first time they are used.
+typedef NS_ENUM(NSUInteger, SPEventTypeID)
+{
+    SPEventTypeIDNone,
+    SPEventTypeIDAdded,
+    SPEventTypeIDAddedToStage,
+    SPEventTypeIDRemoved,
+    SPEventTypeIDRemovedFromStage,
+    SPEventTypeIDRemoveFromJuggler,
+    SPEventTypeIDCompleted,
+    SPEventTypeIDTriggered,
+    SPEventTypeIDFlatten,
+    SPEventTypeIDRender,
+    SPEventTypeIDPress,
+    SPEventTypeIDEnterFrame,
+    SPEventTypeIDTouch,
+    SPEventTypeIDResize,
+    SPEventTypeIDFirstCustom
+};
+
+/// Returns the ID of an event type, registering the type if it has not been used before.
+SP_EXTERN SPEventTypeID SPEventTypeIDFromString(NSString *type);
+
+/// Returns the ID of an event type without registering it, or `SPEventTypeIDNone` if the type
+/// has not been used before.
+SP_EXTERN SPEventTypeID SPEventTypeIDFromRegisteredString(NSString *type);
+
+/// Returns the event type string that belongs to a certain ID, or `nil` if the ID is unknown.
+SP_EXTERN NSString *_Nullable SPEventTypeStringFromID(SPEventTypeID typeID);
+
 @class SPEventDispatcher;
 
 /** ------------------------------------------------------------------------------------------------
@@ -44,6 +76,11 @@ SP_EXTERN NSString *const SPEventTypePress;
  Furthermore, the event class contains methods that can stop the event from being processed by
  other listeners - either completely or at the next bubble stage.
  
+ Events that Sparrow creates internally (e.g. via `dispatchEventWithType:`, broadcasts, touch
+ and enter frame events) are taken from a pool. An event only returns to the pool when it is
+ deallocated, i.e. after the last strong reference is gone. Thus, it's safe to keep a reference
+ to such an event; weak references become `nil` as usual.
+ 
 ------------------------------------------------------------------------------------------------- */
 
 @interface SPEvent : NSObject
@@ -87,6 +124,9 @@ SP_EXTERN NSString *const SPEventTypePress;
 /// A string that identifies the event.
 @property (nonatomic, readonly) NSString *type; 
 
+/// The interned ID of the event type.
+@property (nonatomic, readonly) SPEventTypeID typeID;
+
 /// Indicates if event will bubble.
 @property (nonatomic, readonly) BOOL bubbles;
 
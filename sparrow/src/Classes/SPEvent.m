@@ -9,10 +9,16 @@
 //  it under the terms of the Simplified BSD License.
 //
 
+#import "SPEnterFrameEvent.h"
 #import "SPEvent.h"
 #import "SPEventDispatcher.h"
 #import "SPEvent_Internal.h"
 #import "SPMacros.h"
+#import "SPResizeEvent.h"
+#import "SPTouchEvent.h"
+
+#import <objc/runtime.h>
+#import <pthread.h>
 
 // --- event types ---------------------------------------------------------------------------------
 
@@ -27,6 +33,138 @@ NSString *const SPEventTypeFlatten              = @"SPEventTypeFlatten";
 NSString *const SPEventTypeRender               = @"SPEventTypeRender";
 NSString *const SPEventTypePress                = @"SPEventTypePress";
 
+// --- event type interning ------------------------------------------------------------------------
+
+static NSString *builtInEventTypes[SPEventTypeIDFirstCustom];
+static SP_GENERIC(NSMutableDictionary, NSString*, NSNumber*) *eventTypeIDs = nil;
+static SP_GENERIC(NSMutableArray, NSString*) *eventTypes = nil;
+static pthread_mutex_t eventTypeMutex = PTHREAD_MUTEX_INITIALIZER;
+
+static void initEventTypes(void)
+{
+    static dispatch_once_t once;
+    dispatch_once(&once, ^
+    {
+        builtInEventTypes[SPEventTypeIDNone]               = @"";
+        builtInEventTypes[SPEventTypeIDAdded]              = SPEventTypeAdded;
+        builtInEventTypes[SPEventTypeIDAddedToStage]       = SPEventTypeAddedToStage;
+        builtInEventTypes[SPEventTypeIDRemoved]            = SPEventTypeRemoved;
+        builtInEventTypes[SPEventTypeIDRemovedFromStage]   = SPEventTypeRemovedFromStage;
+        builtInEventTypes[SPEventTypeIDRemoveFromJuggler]  = SPEventTypeRemoveFromJuggler;
+        builtInEventTypes[SPEventTypeIDCompleted]          = SPEventTypeCompleted;
+        builtInEventTypes[SPEventTypeIDTriggered]          = SPEventTypeTriggered;
+        builtInEventTypes[SPEventTypeIDFlatten]            = SPEventTypeFlatten;
+        builtInEventTypes[SPEventTypeIDRender]             = SPEventTypeRender;
+        builtInEventTypes[SPEventTypeIDPress]              = SPEventTypePress;
+        builtInEventTypes[SPEventTypeIDEnterFrame]         = SPEventTypeEnterFrame;
+        builtInEventTypes[SPEventTypeIDTouch]              = SPEventTypeTouch;
+        builtInEventTypes[SPEventTypeIDResize]             = SPEventTypeResize;
+
+        eventTypeIDs = [[NSMutableDictionary alloc] init];
+        eventTypes = [[NSMutableArray alloc] initWithCapacity:SPEventTypeIDFirstCustom];
+
+        for (NSUInteger i=0; i<SPEventTypeIDFirstCustom; ++i)
+        {
+            eventTypeIDs[builtInEventTypes[i]] = @(i);
+            [eventTypes addObject:builtInEventTypes[i]];
+        }
+    });
+}
+
+SPEventTypeID SPEventTypeIDFromString(NSString *type)
+{
+    initEventTypes();
+
+    // the built-in types are almost always passed via their constants,
+    // so we can find them without hashing the string.
+    for (NSUInteger i=1; i<SPEventTypeIDFirstCustom; ++i)
+        if (type == builtInEventTypes[i]) return i;
+
+    pthread_mutex_lock(&eventTypeMutex);
+
+    NSNumber *typeID = eventTypeIDs[type];
+    if (!typeID)
+    {
+        typeID = @(eventTypes.count);
+        NSString *internedType = [type copy];
+        [eventTypes addObject:internedType];
+        eventTypeIDs[internedType] = typeID;
+        [internedType release];
+    }
+
+    pthread_mutex_unlock(&eventTypeMutex);
+
+    return typeID.unsignedIntegerValue;
+}
+
+SPEventTypeID SPEventTypeIDFromRegisteredString(NSString *type)
+{
+    initEventTypes();
+
+    for (NSUInteger i=1; i<SPEventTypeIDFirstCustom; ++i)
+        if (type == builtInEventTypes[i]) return i;
+
+    pthread_mutex_lock(&eventTypeMutex);
+    NSNumber *typeID = eventTypeIDs[type];
+    pthread_mutex_unlock(&eventTypeMutex);
+
+    return typeID ? typeID.unsignedIntegerValue : SPEventTypeIDNone;
+}
+
+NSString *SPEventTypeStringFromID(SPEventTypeID typeID)
+{
+    initEventTypes();
+
+    if (typeID < SPEventTypeIDFirstCustom)
+        return builtInEventTypes[typeID];
+
+    pthread_mutex_lock(&eventTypeMutex);
+    NSString *type = typeID < eventTypes.count ? eventTypes[typeID] : nil;
+    pthread_mutex_unlock(&eventTypeMutex);
+
+    return type;
+}
+
+// --- event pool ----------------------------------------------------------------------------------
+
+// Events that are dispatched very often (enter frame, touch, added/removed, etc.) are taken
+// from a small pool per event class. Just like with SPPoolObject, an event only returns to the
+// pool on its final release: 'dealloc' destroys the instance (which clears weak references to
+// it), but keeps its memory, which 'allocFromPool' then turns into a new instance.
+
+#define EVENT_POOL_CAPACITY    16
+#define EVENT_POOL_MAX_CLASSES 8
+
+typedef struct
+{
+    Class eventClass;
+    NSInteger numEvents;
+    void *memory[EVENT_POOL_CAPACITY];
+}
+SPEventPool;
+
+static SPEventPool *getEventPool(Class eventClass, BOOL create)
+{
+    // the pools are not thread-safe; events dispatched on other threads are not pooled.
+    static SPEventPool eventPools[EVENT_POOL_MAX_CLASSES];
+
+    if (!pthread_main_np())
+        return NULL;
+
+    for (NSInteger i=0; i<EVENT_POOL_MAX_CLASSES; ++i)
+    {
+        SPEventPool *pool = &eventPools[i];
+        if (pool->eventClass == eventClass) return pool;
+        else if (!pool->eventClass && create)
+        {
+            pool->eventClass = eventClass;
+            return pool;
+        }
+    }
+
+    return NULL;
+}
+
 // --- class implementation ------------------------------------------------------------------------
 
 @implementation SPEvent
@@ -34,6 +172,7 @@ NSString *const SPEventTypePress                = @"SPEventTypePress";
     SPEventDispatcher *__weak _target;
     SPEventDispatcher *__weak _currentTarget;
     NSString *_type;
+    SPEventTypeID _typeID;
     id _data;
     BOOL _stopsImmediatePropagation;
     BOOL _stopsPropagation;
@@ -46,7 +185,8 @@ NSString *const SPEventTypePress                = @"SPEventTypePress";
 {
     if ((self = [super init]))
     {
-        _type = [[NSString alloc] initWithString:type];
+        _type = [type copy];
+        _typeID = SPEventTypeIDFromString(type);
         _data = [data retain];
         _bubbles = bubbles;
     }
@@ -72,6 +212,16 @@ NSString *const SPEventTypePress                = @"SPEventTypePress";
 {
     [_data release];
     [_type release];
+
+    // only classes that were allocated from the pool have one
+    SPEventPool *pool = getEventPool(object_getClass(self), NO);
+    if (pool && pool->numEvents < EVENT_POOL_CAPACITY)
+    {
+        objc_destructInstance(self);
+        pool->memory[pool->numEvents++] = self;
+        return;
+    }
+
     [super dealloc];
 }
 
@@ -116,6 +266,18 @@ NSString *const SPEventTypePress                = @"SPEventTypePress";
 
 @implementation SPEvent (Internal)
 
++ (instancetype)allocFromPool
+{
+    SPEventPool *pool = getEventPool(self, YES);
+    if (pool && pool->numEvents)
+    {
+        void *memory = pool->memory[--pool->numEvents];
+        memset(memory, 0, class_getInstanceSize(self));
+        return objc_constructInstance(self, memory);
+    }
+    else return [self alloc];
+}
+
 - (BOOL)stopsImmediatePropagation
 { 
     return _stopsImmediatePropagation;
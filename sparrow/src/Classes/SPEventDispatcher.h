@@ -25,7 +25,8 @@ typedef void (^SPEventBlock)(id event);
  
  An event dispatcher can dispatch events (objects of type SPEvent or one of its subclasses) 
  to objects that have registered themselves as listeners. A string (the event type) is used to 
- identify different events.
+ identify different events. Internally, each event type is mapped to an integer ID (see
+ `SPEventTypeIDFromString`), so that listeners can be looked up without comparing strings.
  
  Here is a sample:
  
@@ -99,6 +100,9 @@ typedef void (^SPEventBlock)(id event);
 /// Returns if there are listeners registered for a certain event type.
 - (BOOL)hasEventListenerForType:(NSString *)eventType;
 
+/// Returns if there are listeners registered for the event type with a certain ID.
+- (BOOL)hasEventListenerForTypeID:(SPEventTypeID)typeID;
+
 @end
 
 NS_ASSUME_NONNULL_END
@@ -17,18 +17,91 @@
 #import "SPMacros.h"
 #import "SPNSExtensions.h"
 
+// --- listener storage --------------------------------------------------------------------------
+
+#define NUM_INLINE_ENTRIES 2
+
+typedef struct
+{
+    SPEventTypeID typeID;
+    SP_GENERIC(NSArray, SPEventListener*) *listeners;
+}
+SPListenerEntry;
+
 // --- class implementation ------------------------------------------------------------------------
 
 @implementation SPEventDispatcher
 {
-    SP_GENERIC(NSMutableDictionary, NSString*, SP_GENERIC(NSArray, SPEventListener*)*) *_eventListeners;
+    // Most objects listen to just one or two event types. Thus, listeners are stored in a small
+    // array keyed by type ID, which is searched linearly and lives inside the object until it
+    // needs to grow.
+
+    SPListenerEntry _inlineEntries[NUM_INLINE_ENTRIES];
+    SPListenerEntry *_heapEntries;
+    NSInteger _numEntries;
+    NSInteger _capacity;
+}
+
+// --- c functions ---
+
+static inline SPListenerEntry *getEntries(SPEventDispatcher *self)
+{
+    return self->_heapEntries ? self->_heapEntries : self->_inlineEntries;
+}
+
+static inline SP_GENERIC(NSArray, SPEventListener*) *getListeners(SPEventDispatcher *self,
+                                                                  SPEventTypeID typeID)
+{
+    SPListenerEntry *entries = getEntries(self);
+    for (NSInteger i=0; i<self->_numEntries; ++i)
+        if (entries[i].typeID == typeID) return entries[i].listeners;
+
+    return nil;
+}
+
+static void setListeners(SPEventDispatcher *self, SPEventTypeID typeID,
+                         SP_GENERIC(NSArray, SPEventListener*) *listeners)
+{
+    SPListenerEntry *entries = getEntries(self);
+    NSInteger index = 0;
+
+    while (index < self->_numEntries && entries[index].typeID != typeID)
+        ++index;
+
+    if (index < self->_numEntries)
+    {
+        [listeners retain];
+        [entries[index].listeners release];
+
+        if (listeners) entries[index].listeners = listeners;
+        else           entries[index] = entries[--self->_numEntries]; // order is irrelevant
+    }
+    else if (listeners)
+    {
+        NSInteger capacity = self->_heapEntries ? self->_capacity : NUM_INLINE_ENTRIES;
+        if (self->_numEntries == capacity)
+        {
+            SPListenerEntry *newEntries = malloc(sizeof(SPListenerEntry) * capacity * 2);
+            memcpy(newEntries, entries, sizeof(SPListenerEntry) * self->_numEntries);
+            free(self->_heapEntries);
+
+            entries = self->_heapEntries = newEntries;
+            self->_capacity = capacity * 2;
+        }
+
+        entries[self->_numEntries++] = (SPListenerEntry){ typeID, [listeners retain] };
+    }
 }
 
 #pragma mark Initialization
 
 - (void)dealloc
 {
-    [_eventListeners release];
+    SPListenerEntry *entries = getEntries(self);
+    for (NSInteger i=0; i<_numEntries; ++i)
+        [entries[i].listeners release];
+
+    free(_heapEntries);
     [super dealloc];
 }
 
@@ -37,35 +110,38 @@
 - (void)addEventListenerForType:(NSString *)eventType block:(SPEventBlock)block
 {
     SPEventListener *listener = [[SPEventListener alloc] initWithBlock:block];
-    [self addEventListener:listener forType:eventType];
+    [self addEventListener:listener forTypeID:SPEventTypeIDFromString(eventType)];
     [listener release];
 }
 
 - (void)addEventListener:(SEL)selector atObject:(id)object forType:(NSString *)eventType
 {
     SPEventListener *listener = [[SPEventListener alloc] initWithTarget:object selector:selector];
-    [self addEventListener:listener forType:eventType];
+    [self addEventListener:listener forTypeID:SPEventTypeIDFromString(eventType)];
     [listener release];
 }
 
 - (void)removeEventListener:(SEL)selector atObject:(id)object forType:(NSString *)eventType
 {
-    [self removeEventListenersForType:eventType withTarget:object andSelector:selector orBlock:nil];
+    [self removeEventListenersForTypeID:SPEventTypeIDFromString(eventType)
+                             withTarget:object andSelector:selector orBlock:nil];
 }
 
 - (void)removeEventListenersAtObject:(id)object forType:(NSString *)eventType
 {
-    [self removeEventListenersForType:eventType withTarget:object andSelector:nil orBlock:nil];
+    [self removeEventListenersForTypeID:SPEventTypeIDFromString(eventType)
+                             withTarget:object andSelector:nil orBlock:nil];
 }
 
 - (void)removeEventListenerForType:(NSString *)eventType block:(SPEventBlock)block;
 {
-    [self removeEventListenersForType:eventType withTarget:nil andSelector:nil orBlock:block];
+    [self removeEventListenersForTypeID:SPEventTypeIDFromString(eventType)
+                             withTarget:nil andSelector:nil orBlock:block];
 }
 
 - (void)dispatchEvent:(SPEvent *)event
 {
-    SP_GENERIC(NSArray, SPEventListener*) *listeners = _eventListeners[event.type];
+    SP_GENERIC(NSArray, SPEventListener*) *listeners = getListeners(self, event.typeID);
     if (!event.bubbles && !listeners) return; // no need to do anything.
 
     [self retain]; // the event listener could release 'self', so we have to make sure that it
@@ -118,7 +194,7 @@
 {
     if ([self hasEventListenerForType:type])
     {
-        SPEvent* event = [[SPEvent alloc] initWithType:type bubbles:NO];
+        SPEvent *event = [[SPEvent allocFromPool] initWithType:type bubbles:NO];
         [self dispatchEvent:event];
         [event release];
     }
@@ -133,7 +209,7 @@
 {
     if (bubbles || [self hasEventListenerForType:type])
     {
-        SPEvent* event = [[SPEvent alloc] initWithType:type bubbles:bubbles data:data];
+        SPEvent *event = [[SPEvent allocFromPool] initWithType:type bubbles:bubbles data:data];
         [self dispatchEvent:event];
         [event release];
     }
@@ -141,7 +217,18 @@
 
 - (BOOL)hasEventListenerForType:(NSString *)eventType
 {
-    return _eventListeners[eventType] != nil;
+    if (!_numEntries) return NO;
+
+    // don't register the type just to find out that nobody listens to it
+    SPEventTypeID typeID = SPEventTypeIDFromRegisteredString(eventType);
+    if (typeID == SPEventTypeIDNone && eventType.length) return NO;
+
+    return getListeners(self, typeID) != nil;
+}
+
+- (BOOL)hasEventListenerForTypeID:(SPEventTypeID)typeID
+{
+    return getListeners(self, typeID) != nil;
 }
 
 @end
@@ -150,34 +237,30 @@
 
 @implementation SPEventDispatcher (Internal)
 
-- (void)addEventListener:(SPEventListener *)listener forType:(NSString *)eventType
+- (void)addEventListener:(SPEventListener *)listener forTypeID:(SPEventTypeID)typeID
 {
-    if (!_eventListeners)
-        _eventListeners = [[NSMutableDictionary alloc] init];
-
     // When an event listener is added or removed, a new NSArray object is created, instead of
     // changing the array. The reason for this is that we can avoid creating a copy of the NSArray
     // in the "dispatchEvent"-method, which is called far more often than
     // "add"- and "removeEventListener".
 
-    SP_GENERIC(NSArray, SPEventListener*) *listeners = _eventListeners[eventType];
+    SP_GENERIC(NSArray, SPEventListener*) *listeners = getListeners(self, typeID);
     if (!listeners)
     {
         listeners = [[NSArray alloc] initWithObjects:listener, nil];
-        _eventListeners[eventType] = listeners;
+        setListeners(self, typeID, listeners);
         [listeners release];
     }
     else
     {
-        listeners = [listeners arrayByAddingObject:listener];
-        _eventListeners[eventType] = listeners;
+        setListeners(self, typeID, [listeners arrayByAddingObject:listener]);
     }
 }
 
-- (void)removeEventListenersForType:(NSString *)eventType withTarget:(id)object
-                        andSelector:(SEL)selector orBlock:(SPEventBlock)block
+- (void)removeEventListenersForTypeID:(SPEventTypeID)typeID withTarget:(id)object
+                          andSelector:(SEL)selector orBlock:(SPEventBlock)block
 {
-    SP_GENERIC(NSArray, SPEventListener*) *listeners = _eventListeners[eventType];
+    SP_GENERIC(NSArray, SPEventListener*) *listeners = getListeners(self, typeID);
     if (listeners)
     {
         SP_GENERIC(NSMutableArray, SPEventListener*) *remainingListeners = [[NSMutableArray alloc] init];
@@ -187,11 +270,19 @@
                 [remainingListeners addObject:listener];
         }
 
-        if (remainingListeners.count == 0) [_eventListeners removeObjectForKey:eventType];
-        else _eventListeners[eventType] = remainingListeners;
-
+        setListeners(self, typeID, remainingListeners.count ? remainingListeners : nil);
         [remainingListeners release];
     }
 }
 
+- (NSInteger)numEventTypeIDs
+{
+    return _numEntries;
+}
+
+- (SPEventTypeID)eventTypeIDAtIndex:(NSInteger)index
+{
+    return getEntries(self)[index].typeID;
+}
+
 @end
@@ -16,9 +16,12 @@ NS_ASSUME_NONNULL_BEGIN
 
 @interface SPEventDispatcher (Internal)
 
-- (void)addEventListener:(SPEventListener *)listener forType:(NSString *)eventType;
-- (void)removeEventListenersForType:(NSString *)eventType withTarget:(nullable id)object
-                        andSelector:(nullable SEL)selector orBlock:(nullable SPEventBlock)block;
+- (void)addEventListener:(SPEventListener *)listener forTypeID:(SPEventTypeID)typeID;
+- (void)removeEventListenersForTypeID:(SPEventTypeID)typeID withTarget:(nullable id)object
+                          andSelector:(nullable SEL)selector orBlock:(nullable SPEventBlock)block;
+
+- (NSInteger)numEventTypeIDs;
+- (SPEventTypeID)eventTypeIDAtIndex:(NSInteger)index;
 
 @end
 
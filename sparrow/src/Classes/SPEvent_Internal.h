@@ -15,6 +15,10 @@ NS_ASSUME_NONNULL_BEGIN
 
 @interface SPEvent (Internal)
 
+/// Allocates an event, reusing the memory of a deallocated one if possible. Once the event is
+/// released for the last time, its memory returns to the pool.
++ (instancetype)allocFromPool;
+
 - (BOOL)stopsImmediatePropagation;
 - (BOOL)stopsPropagation;
 
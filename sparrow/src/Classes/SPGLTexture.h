@@ -58,6 +58,17 @@ typedef struct
 /// Initializes a PVR texture with with a certain scale factor.
 - (instancetype)initWithPVRData:(SPPVRData *)pvrData scale:(float)scale;
 
+/// ----------------
+/// @name Properties
+/// ----------------
+
+/// The estimated GPU memory of the texture in bytes, including its mipmaps.
+@property (nonatomic, readonly) NSUInteger numBytes;
+
+/// Indicates if the texture is currently deleted from the GPU. It will be reloaded from its file
+/// the next time it is rendered.
+@property (nonatomic, readonly) BOOL isEvicted;
+
 @end
 
 NS_ASSUME_NONNULL_END
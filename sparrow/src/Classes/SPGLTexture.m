@@ -16,6 +16,116 @@
 #import "SPOpenGL.h"
 #import "SPPVRData.h"
 #import "SPRectangle.h"
+#import "SPTexture_Internal.h"
+#import "SPTextureOptions.h"
+
+#import <pthread.h>
+
+#define MAX_MIPMAP_LEVELS 32
+
+// --- C functions ---------------------------------------------------------------------------------
+
+typedef struct
+{
+    GLenum glFormat;    // the internal format, for compressed textures
+    GLenum glType;      // zero for compressed textures
+    int bitsPerPixel;   // uncompressed formats and PVRTC
+    int blockWidth;     // block compressed formats (ETC2, EAC, ASTC)
+    int blockHeight;
+    int bytesPerBlock;
+} SPFormatInfo;
+
+static SPFormatInfo getFormatInfo(SPTextureFormat format)
+{
+    static const int astcBlockSizes[][2] = {
+        {  4,  4 }, {  5,  4 }, {  5,  5 }, {  6,  5 }, {  6,  6 }, {  8,  5 }, {  8,  6 },
+        {  8,  8 }, { 10,  5 }, { 10,  6 }, { 10,  8 }, { 10, 10 }, { 12, 10 }, { 12, 12 }
+    };
+
+    if (format >= SPTextureFormatASTC4x4 && format <= SPTextureFormatASTC12x12)
+    {
+        NSInteger index = format - SPTextureFormatASTC4x4;
+        return (SPFormatInfo){ GL_COMPRESSED_RGBA_ASTC_4x4_KHR + (GLenum)index, 0, 0,
+                               astcBlockSizes[index][0], astcBlockSizes[index][1], 16 };
+    }
+
+    switch (format)
+    {
+        default:
+        case SPTextureFormatRGBA:       return (SPFormatInfo){ GL_RGBA, GL_UNSIGNED_BYTE, 32 };
+        case SPTextureFormatAlpha:      return (SPFormatInfo){ GL_ALPHA, GL_UNSIGNED_BYTE, 8 };
+        case SPTextureFormat565:        return (SPFormatInfo){ GL_RGB, GL_UNSIGNED_SHORT_5_6_5, 16 };
+        case SPTextureFormat888:        return (SPFormatInfo){ GL_RGB, GL_UNSIGNED_BYTE, 24 };
+        case SPTextureFormat5551:       return (SPFormatInfo){ GL_RGBA, GL_UNSIGNED_SHORT_5_5_5_1, 16 };
+        case SPTextureFormat4444:       return (SPFormatInfo){ GL_RGBA, GL_UNSIGNED_SHORT_4_4_4_4, 16 };
+        case SPTextureFormatAI88:       return (SPFormatInfo){ GL_LUMINANCE_ALPHA, GL_UNSIGNED_BYTE, 16 };
+        case SPTextureFormatI8:         return (SPFormatInfo){ GL_LUMINANCE, GL_UNSIGNED_BYTE, 8 };
+        case SPTextureFormatPvrtcRGBA2: return (SPFormatInfo){ GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG, 0, 2 };
+        case SPTextureFormatPvrtcRGB2:  return (SPFormatInfo){ GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG, 0, 2 };
+        case SPTextureFormatPvrtcRGBA4: return (SPFormatInfo){ GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG, 0, 4 };
+        case SPTextureFormatPvrtcRGB4:  return (SPFormatInfo){ GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG, 0, 4 };
+        case SPTextureFormatETC2RGB:    return (SPFormatInfo){ GL_COMPRESSED_RGB8_ETC2, 0, 0, 4, 4, 8 };
+        case SPTextureFormatETC2RGBA:   return (SPFormatInfo){ GL_COMPRESSED_RGBA8_ETC2_EAC, 0, 0, 4, 4, 16 };
+        case SPTextureFormatEACR11:     return (SPFormatInfo){ GL_COMPRESSED_R11_EAC, 0, 0, 4, 4, 8 };
+        case SPTextureFormatEACRG11:    return (SPFormatInfo){ GL_COMPRESSED_RG11_EAC, 0, 0, 4, 4, 16 };
+        case SPTextureFormatETC2RGBA1:
+            return (SPFormatInfo){ GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2, 0, 0, 4, 4, 8 };
+    }
+}
+
+NSUInteger SPTextureFormatSizeOfLevel(SPTextureFormat format, NSInteger width, NSInteger height)
+{
+    SPFormatInfo info = getFormatInfo(format);
+
+    if (info.blockWidth)
+    {
+        NSInteger numBlocksX = (width  + info.blockWidth  - 1) / info.blockWidth;
+        NSInteger numBlocksY = (height + info.blockHeight - 1) / info.blockHeight;
+        return numBlocksX * numBlocksY * info.bytesPerBlock;
+    }
+    else if (info.glType == 0)
+    {
+        // PVRTC data always covers at least 2x2 blocks of 8x4 (2 bpp) or 4x4 (4 bpp) pixels
+        NSInteger minWidth = info.bitsPerPixel == 2 ? 16 : 8;
+        return MAX(width, minWidth) * MAX(height, 8) * info.bitsPerPixel / 8;
+    }
+    else return width * height * info.bitsPerPixel / 8;
+}
+
+BOOL SPTextureFormatIsCompressed(SPTextureFormat format)
+{
+    return getFormatInfo(format).glType == 0;
+}
+
+static NSUInteger sizeOfTexture(SPTextureFormat format, NSInteger width, NSInteger height, BOOL mipmaps)
+{
+    NSUInteger size = SPTextureFormatSizeOfLevel(format, width, height);
+
+    while (mipmaps && (width > 1 || height > 1))
+    {
+        width  = MAX(1, width  / 2);
+        height = MAX(1, height / 2);
+        size += SPTextureFormatSizeOfLevel(format, width, height);
+    }
+
+    return size;
+}
+
+// --- GPU memory ----------------------------------------------------------------------------------
+
+// Textures may be created and destroyed on any thread, so the bookkeeping is guarded by a mutex.
+// The frame counter is only touched on the main thread, where textures are rendered.
+
+static pthread_mutex_t memoryMutex = PTHREAD_MUTEX_INITIALIZER;
+static CFMutableSetRef reloadableTextures = NULL; // not retained
+static uint64_t currentFrame = 1;
+static uint64_t memoryBudget = 0;
+static uint64_t totalNumBytes = 0;
+static NSInteger numTextures = 0;
+static NSInteger numEvictions = 0;
+static NSInteger numReloads = 0;
+
+// --- class implementation ------------------------------------------------------------------------
 
 @implementation SPGLTexture
 {
@@ -29,15 +139,88 @@
     BOOL _premultipliedAlpha;
     BOOL _mipmaps;
     BOOL _usedAsRenderTexture;
+    NSUInteger _numBytes;
+    NSString *_reloadPath;
+    SPTextureOptions *_reloadOptions;
+    uint64_t _lastUseFrame;
 }
 
-@synthesize name = _name;
 @synthesize repeat = _repeat;
 @synthesize premultipliedAlpha = _premultipliedAlpha;
 @synthesize scale = _scale;
 @synthesize format = _format;
 @synthesize mipmaps = _mipmaps;
 @synthesize smoothing = _smoothing;
+@synthesize numBytes = _numBytes;
+
+// --- c functions ---
+
+static void applyParameters(SPGLTexture *self)
+{
+    // the setters only touch GL when the value changes
+    BOOL repeat = self->_repeat;
+    SPTextureSmoothing smoothing = self->_smoothing;
+
+    self->_repeat = !repeat;
+    self->_smoothing = smoothing == SPTextureSmoothingNone ? SPTextureSmoothingBilinear :
+                                                             SPTextureSmoothingNone;
+    self.repeat = repeat;
+    self.smoothing = smoothing;
+}
+
+static void evictTexture(SPGLTexture *self)
+{
+    // requires the memory mutex
+    glDeleteTextures(1, &self->_name);
+    self->_name = 0;
+    totalNumBytes -= self->_numBytes;
+    ++numEvictions;
+}
+
+static void reloadTexture(SPGLTexture *self)
+{
+    SPGLTexture *texture = nil;
+
+    @try
+    {
+        SPDecodedTexture *decodedTexture = [[[SPDecodedTexture alloc]
+            initWithContentsOfFile:self->_reloadPath options:self->_reloadOptions] autorelease];
+        texture = [decodedTexture createGLTexture];
+    }
+    @catch (NSException *exception)
+    {
+        SPLog(@"Could not reload texture '%@': %@", self->_reloadPath, exception.reason);
+    }
+
+    pthread_mutex_lock(&memoryMutex);
+
+    if (texture && texture->_format == self->_format && texture->_numBytes == self->_numBytes)
+    {
+        // take over the new texture name; its memory is already accounted for
+        self->_name = texture->_name;
+        texture->_name = 0;
+        ++numReloads;
+    }
+    else
+    {
+        // the file is gone or has changed; the texture stays empty from now on
+        CFSetRemoveValue(reloadableTextures, self);
+        SP_RELEASE_AND_NIL(self->_reloadPath);
+        SP_RELEASE_AND_NIL(self->_reloadOptions);
+    }
+
+    pthread_mutex_unlock(&memoryMutex);
+
+    if (self->_name) applyParameters(self);
+}
+
+static int compareLastUse(const void *a, const void *b)
+{
+    uint64_t lastUseA = (*(SPGLTexture *const *)a)->_lastUseFrame;
+    uint64_t lastUseB = (*(SPGLTexture *const *)b)->_lastUseFrame;
+
+    return lastUseA < lastUseB ? -1 : (lastUseA > lastUseB ? 1 : 0);
+}
 
 #pragma mark Initialization
 
@@ -55,6 +238,12 @@
         _scale = scale;
         _premultipliedAlpha = pma;
         _format = format;
+        _numBytes = sizeOfTexture(format, _width, _height, mipmaps);
+
+        pthread_mutex_lock(&memoryMutex);
+        if (_name) totalNumBytes += _numBytes;
+        ++numTextures;
+        pthread_mutex_unlock(&memoryMutex);
 
         _repeat = YES; // force first update
         self.repeat = NO;
@@ -66,121 +255,27 @@
 
 - (instancetype)initWithData:(const void *)imgData properties:(SPTextureProperties)properties
 {
-    GLenum glTexType = GL_UNSIGNED_BYTE;
-    GLenum glTexFormat;
-    GLuint glTexName;
-    int bitsPerPixel;
-    BOOL compressed = NO;
-    
-    switch (properties.format)
-    {
-        default:
-        case SPTextureFormatRGBA:
-            bitsPerPixel = 32;
-            glTexFormat = GL_RGBA;
-            break;
-        case SPTextureFormatAlpha:
-            bitsPerPixel = 8;
-            glTexFormat = GL_ALPHA;
-            break;
-        case SPTextureFormatPvrtcRGBA2:
-            compressed = YES;
-            bitsPerPixel = 2;
-            glTexFormat = GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG;
-            break;
-        case SPTextureFormatPvrtcRGB2:
-            compressed = YES;
-            bitsPerPixel = 2;
-            glTexFormat = GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG;
-            break;
-        case SPTextureFormatPvrtcRGBA4:
-            compressed = YES;
-            bitsPerPixel = 4;
-            glTexFormat = GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG;
-            break;
-        case SPTextureFormatPvrtcRGB4:
-            compressed = YES;
-            bitsPerPixel = 4;
-            glTexFormat = GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG;
-            break;
-        case SPTextureFormat565:
-            bitsPerPixel = 16;
-            glTexFormat = GL_RGB;
-            glTexType = GL_UNSIGNED_SHORT_5_6_5;
-            break;
-        case SPTextureFormat888:
-            bitsPerPixel = 24;
-            glTexFormat = GL_RGB;
-            break;
-        case SPTextureFormat5551:
-            bitsPerPixel = 16;
-            glTexFormat = GL_RGBA;
-            glTexType = GL_UNSIGNED_SHORT_5_5_5_1;
-            break;
-        case SPTextureFormat4444:
-            bitsPerPixel = 16;
-            glTexFormat = GL_RGBA;
-            glTexType = GL_UNSIGNED_SHORT_4_4_4_4;
-            break;
-        case SPTextureFormatAI88:
-            bitsPerPixel = 16;
-            glTexFormat = GL_LUMINANCE_ALPHA;
-            break;
-        case SPTextureFormatI8:
-            bitsPerPixel = 8;
-            glTexFormat = GL_LUMINANCE;
-    }
-    
-    int prevTextureName = 0;
-    glGetIntegerv(GL_TEXTURE_BINDING_2D, &prevTextureName);
-    
-    glGenTextures(1, &glTexName);
-    glBindTexture(GL_TEXTURE_2D, glTexName);
-    
-    if (!compressed)
+    // the mipmaps follow each other directly
+    const void *levels[MAX_MIPMAP_LEVELS] = { NULL };
+    NSInteger levelWidth  = properties.width;
+    NSInteger levelHeight = properties.height;
+
+    if (properties.numMipmaps >= MAX_MIPMAP_LEVELS)
     {
-        int levelWidth  = (int)properties.width;
-        int levelHeight = (int)properties.height;
-        unsigned char *levelData = (unsigned char *)imgData;
-        
-        for (int level=0; level<=properties.numMipmaps; ++level)
-        {
-            int size = levelWidth * levelHeight * bitsPerPixel / 8;
-            glTexImage2D(GL_TEXTURE_2D, level, glTexFormat, levelWidth, levelHeight,
-                         0, glTexFormat, glTexType, levelData);
-            levelData += size;
-            levelWidth  /= 2;
-            levelHeight /= 2;
-        }
-        
-        if (properties.numMipmaps == 0 && properties.generateMipmaps)
-            glGenerateMipmap(GL_TEXTURE_2D);
+        [self release];
+        [NSException raise:SPExceptionInvalidOperation format:@"Too many mipmaps"];
     }
-    else
+
+    for (NSInteger level=0; imgData && level<=properties.numMipmaps; ++level)
     {
-        int levelWidth  = (int)properties.width;
-        int levelHeight = (int)properties.height;
-        unsigned char *levelData = (unsigned char *)imgData;
-        
-        for (int level=0; level<=properties.numMipmaps; ++level)
-        {
-            int size = MAX(32, levelWidth * levelHeight * bitsPerPixel / 8);
-            glCompressedTexImage2D(GL_TEXTURE_2D, level, glTexFormat,
-                                   levelWidth, levelHeight, 0, size, levelData);
-            levelData += size;
-            levelWidth  /= 2;
-            levelHeight /= 2;
-        }
+        levels[level] = imgData;
+        imgData = (const uchar *)imgData +
+                  SPTextureFormatSizeOfLevel(properties.format, levelWidth, levelHeight);
+        levelWidth  = MAX(1, levelWidth  / 2);
+        levelHeight = MAX(1, levelHeight / 2);
     }
-    
-    glBindTexture(GL_TEXTURE_2D, prevTextureName);
-    
-    BOOL containsMipmaps = properties.numMipmaps > 0 || (properties.generateMipmaps && !compressed);
-    
-    return [self initWithName:glTexName format:properties.format
-                        width:properties.width height:properties.height
-              containsMipmaps:containsMipmaps scale:properties.scale
-           premultipliedAlpha:properties.premultipliedAlpha];
+
+    return [self initWithMipmapData:levels properties:properties];
 }
 
 - (instancetype)initWithPVRData:(SPPVRData *)pvrData scale:(float)scale
@@ -190,12 +285,18 @@
         .scale  = scale,
         .width  = pvrData.width,
         .height = pvrData.height,
-        .numMipmaps = pvrData.numMipmaps,
+        .numMipmaps = MIN(pvrData.numMipmaps, MAX_MIPMAP_LEVELS - 1),
         .generateMipmaps = NO,
-        .premultipliedAlpha = NO
+        .premultipliedAlpha = pvrData.premultipliedAlpha
     };
-    
-    return [self initWithData:pvrData.imageData properties:properties];
+
+    // the levels are sliced out of the file data; they don't have to follow each other directly
+    const void *levels[MAX_MIPMAP_LEVELS] = { NULL };
+
+    for (NSInteger level=0; level<=properties.numMipmaps; ++level)
+        levels[level] = [pvrData imageDataOfMipmap:level];
+
+    return [self initWithMipmapData:levels properties:properties];
 }
 
 - (instancetype)init
@@ -208,8 +309,16 @@
 {
     if (_usedAsRenderTexture)
         [SPContext clearFrameBuffersForTexture:self];
+
+    pthread_mutex_lock(&memoryMutex);
+    if (_reloadPath) CFSetRemoveValue(reloadableTextures, self);
+    if (_name) totalNumBytes -= _numBytes;
+    --numTextures;
+    pthread_mutex_unlock(&memoryMutex);
     
     glDeleteTextures(1, &_name);
+    [_reloadPath release];
+    [_reloadOptions release];
     [super dealloc];
 }
 
@@ -281,10 +390,210 @@
     }
 }
 
+#pragma mark Properties
+
+- (uint)name
+{
+    // Every access to the name of a reloadable texture counts as use, and an evicted texture
+    // is reloaded from disk right away. Beware: that includes state checks like the one in
+    // '-[SPQuadBatch isStateChangeWithTinted:...]', which compares the names of two textures.
+    if (_reloadPath)
+    {
+        _lastUseFrame = currentFrame;
+        if (!_name) reloadTexture(self);
+    }
+
+    return _name;
+}
+
+- (BOOL)isEvicted
+{
+    return _reloadPath && !_name;
+}
+
 @end
 
 @implementation SPGLTexture (Internal)
 
+- (instancetype)initWithMipmapData:(const void *const *)levels properties:(SPTextureProperties)properties
+{
+    SPFormatInfo info = getFormatInfo(properties.format);
+    BOOL compressed = info.glType == 0;
+    GLuint glTexName;
+
+    SPContext *context = [SPContext currentContext];
+    if (context && ![context supportsTextureFormat:properties.format])
+    {
+        [self release];
+        [NSException raise:SPExceptionOperationFailed
+                    format:@"Texture format %d is not supported by this device", (int)properties.format];
+    }
+    
+    int prevTextureName = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &prevTextureName);
+    
+    glGenTextures(1, &glTexName);
+    glBindTexture(GL_TEXTURE_2D, glTexName);
+    
+    int levelWidth  = (int)properties.width;
+    int levelHeight = (int)properties.height;
+
+    // the rows are tightly packed, even in formats with one or two bytes per pixel;
+    // SPPVRData removes the row padding of KTX files
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    for (int level=0; level<=properties.numMipmaps; ++level)
+    {
+        if (compressed)
+        {
+            GLsizei size = (GLsizei)SPTextureFormatSizeOfLevel(properties.format, levelWidth, levelHeight);
+            glCompressedTexImage2D(GL_TEXTURE_2D, level, info.glFormat,
+                                   levelWidth, levelHeight, 0, size, levels[level]);
+        }
+        else
+        {
+            glTexImage2D(GL_TEXTURE_2D, level, info.glFormat, levelWidth, levelHeight,
+                         0, info.glFormat, info.glType, levels[level]);
+        }
+
+        levelWidth  = MAX(1, levelWidth  / 2);
+        levelHeight = MAX(1, levelHeight / 2);
+    }
+
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+
+    if (!compressed && properties.numMipmaps == 0 && properties.generateMipmaps)
+        glGenerateMipmap(GL_TEXTURE_2D);
+    
+    glBindTexture(GL_TEXTURE_2D, prevTextureName);
+    
+    BOOL containsMipmaps = properties.numMipmaps > 0 || (properties.generateMipmaps && !compressed);
+    
+    return [self initWithName:glTexName format:properties.format
+                        width:properties.width height:properties.height
+              containsMipmaps:containsMipmaps scale:properties.scale
+           premultipliedAlpha:properties.premultipliedAlpha];
+}
+
+- (void)uploadRowsFrom:(NSInteger)top count:(NSInteger)numRows pixels:(const void *)pixels
+{
+    // GLES 2 can't upload a sub-rectangle of a bigger image, so we upload complete rows
+    SPFormatInfo info = getFormatInfo(_format);
+    int prevTextureName = 0;
+
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &prevTextureName);
+    glBindTexture(GL_TEXTURE_2D, _name);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, (GLint)top, (GLsizei)_width, (GLsizei)numRows,
+                    info.glFormat, info.glType, pixels);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glBindTexture(GL_TEXTURE_2D, prevTextureName);
+}
+
+- (void)makeReloadableWithPath:(NSString *)path options:(SPTextureOptions *)options
+{
+    pthread_mutex_lock(&memoryMutex);
+
+    if (!reloadableTextures)
+        reloadableTextures = CFSetCreateMutable(NULL, 0, NULL);
+
+    CFSetAddValue(reloadableTextures, self);
+    SP_RELEASE_AND_COPY(_reloadPath, path);
+    SP_RELEASE_AND_COPY(_reloadOptions, options);
+    _lastUseFrame = currentFrame;
+
+    pthread_mutex_unlock(&memoryMutex);
+}
+
+- (void)evict
+{
+    pthread_mutex_lock(&memoryMutex);
+    if (_reloadPath && _name) evictTexture(self);
+    pthread_mutex_unlock(&memoryMutex);
+}
+
++ (void)nextFrame
+{
+    // textures that were rendered in the frame that just ended are not evicted
+    pthread_mutex_lock(&memoryMutex);
+    uint64_t numExcessBytes = memoryBudget && totalNumBytes > memoryBudget ?
+                              totalNumBytes - memoryBudget : 0;
+    pthread_mutex_unlock(&memoryMutex);
+
+    if (numExcessBytes) [self evictTexturesWithNumBytes:numExcessBytes];
+    ++currentFrame;
+}
+
++ (void)evictTexturesWithNumBytes:(uint64_t)numBytes
+{
+    pthread_mutex_lock(&memoryMutex);
+
+    CFIndex count = reloadableTextures ? CFSetGetCount(reloadableTextures) : 0;
+    if (count)
+    {
+        SPGLTexture **textures = malloc(count * sizeof(SPGLTexture *));
+        CFSetGetValues(reloadableTextures, (const void **)textures);
+        qsort(textures, count, sizeof(SPGLTexture *), compareLastUse);
+
+        uint64_t numFreedBytes = 0;
+
+        for (CFIndex i=0; i<count && numFreedBytes < numBytes; ++i)
+        {
+            SPGLTexture *texture = textures[i];
+            if (texture->_name && texture->_lastUseFrame < currentFrame)
+            {
+                numFreedBytes += texture->_numBytes;
+                evictTexture(texture);
+            }
+        }
+
+        free(textures);
+    }
+
+    pthread_mutex_unlock(&memoryMutex);
+}
+
++ (uint64_t)memoryBudget
+{
+    return memoryBudget;
+}
+
++ (void)setMemoryBudget:(uint64_t)numBytes
+{
+    memoryBudget = numBytes;
+}
+
++ (SPTextureMemoryStats)memoryStats
+{
+    SPTextureMemoryStats stats = { 0 };
+
+    pthread_mutex_lock(&memoryMutex);
+
+    stats.numBytes = totalNumBytes;
+    stats.numTextures = numTextures;
+    stats.numEvictions = numEvictions;
+    stats.numReloads = numReloads;
+
+    CFIndex count = reloadableTextures ? CFSetGetCount(reloadableTextures) : 0;
+    if (count)
+    {
+        SPGLTexture **textures = malloc(count * sizeof(SPGLTexture *));
+        CFSetGetValues(reloadableTextures, (const void **)textures);
+
+        for (CFIndex i=0; i<count; ++i)
+        {
+            if (textures[i]->_name) stats.numReloadableBytes += textures[i]->_numBytes;
+            else                    stats.numEvictedBytes    += textures[i]->_numBytes;
+        }
+
+        free(textures);
+    }
+
+    pthread_mutex_unlock(&memoryMutex);
+
+    return stats;
+}
+
 - (BOOL)usedAsRenderTexture
 {
     return _usedAsRenderTexture;
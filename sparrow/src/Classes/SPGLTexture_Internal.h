@@ -12,8 +12,41 @@
 #import <Sparrow/SparrowBase.h>
 #import "SPGLTexture.h"
 
+@class SPTextureOptions;
+
+/// Returns the number of bytes a single mipmap level of a certain size occupies.
+SP_EXTERN NSUInteger SPTextureFormatSizeOfLevel(SPTextureFormat format, NSInteger width, NSInteger height);
+
+/// Indicates if a format is uploaded with `glCompressedTexImage2D`.
+SP_EXTERN BOOL SPTextureFormatIsCompressed(SPTextureFormat format);
+
 @interface SPGLTexture (Internal)
 
+/// Initializes a texture with one pointer per mipmap level; the pointers may be NULL.
+- (instancetype)initWithMipmapData:(const void *const *)levels properties:(SPTextureProperties)properties;
+
+/// Replaces a number of complete rows of the base level of an uncompressed texture. The pixels
+/// have to be in the format of the texture.
+- (void)uploadRowsFrom:(NSInteger)top count:(NSInteger)numRows pixels:(const void *)pixels;
+
+/// Makes the texture evictable; it will be reloaded from the given file with the same options.
+- (void)makeReloadableWithPath:(NSString *)path options:(SPTextureOptions *)options;
+
+/// Deletes the texture from the GPU, if it is reloadable.
+- (void)evict;
+
+/// Starts a new frame (for the "least recently rendered" order) and evicts textures if the
+/// memory budget is exceeded.
++ (void)nextFrame;
+
+/// Evicts reloadable textures that were not rendered in the current frame, least recently
+/// rendered first, until at least `numBytes` were freed.
++ (void)evictTexturesWithNumBytes:(uint64_t)numBytes;
+
++ (uint64_t)memoryBudget;
++ (void)setMemoryBudget:(uint64_t)numBytes;
++ (SPTextureMemoryStats)memoryStats;
+
 @property (nonatomic, assign) BOOL usedAsRenderTexture;
 
 @end
@@ -0,0 +1,52 @@
+//
+//  SPGlyphAtlas.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 13.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SparrowBase.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class SPBitmapFont;
+
+/** ------------------------------------------------------------------------------------------------
+
+ An SPGlyphAtlas rasterizes the glyphs of system fonts on demand and packs them into shared
+ texture pages. That way, text fields using those fonts can be displayed with quads, just like
+ bitmap fonts: changing their text does not require a new texture, and all of them can be
+ batched together.
+
+ Each combination of font name, size and traits is represented by a bitmap font, to which chars
+ are added as soon as a text needs them. All glyphs of such a font are kept on the same page.
+ When that page is full, the atlas creates a new bitmap font on a fresh page; text that was
+ composed before keeps using the old one, which is released together with its page when it is
+ no longer displayed.
+
+------------------------------------------------------------------------------------------------- */
+
+@interface SPGlyphAtlas : NSObject
+
+/// Returns the atlas that is shared by all text fields.
++ (SPGlyphAtlas *)sharedAtlas;
+
+/// Returns a bitmap font that contains all glyphs of a text, rasterized with a system font. Returns
+/// nil if the text cannot be displayed that way, e.g. because it contains chars that need complex
+/// text shaping, or because the glyphs don't fit on a page.
+- (nullable SPBitmapFont *)fontWithName:(NSString *)fontName size:(float)size
+                                   bold:(BOOL)bold italic:(BOOL)italic forText:(NSString *)text;
+
+/// Forgets all fonts and pages. Text that has already been composed is not affected.
+- (void)purge;
+
+/// The width and height of new texture pages in pixels. Default: 1024
+@property (nonatomic, assign) NSInteger pageSize;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,435 @@
+//
+//  SPGlyphAtlas.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 13.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SparrowClass.h"
+#import "SPBitmapChar.h"
+#import "SPBitmapFont_Internal.h"
+#import "SPGLTexture.h"
+#import "SPGlyphAtlas.h"
+#import "SPMacros.h"
+#import "SPOpenGL.h"
+#import "SPRectangle.h"
+#import "SPTextField.h"
+
+#import <UIKit/UIKit.h>
+
+#define DEFAULT_PAGE_SIZE   1024
+#define GLYPH_GAP              1 // pixels between glyphs, to avoid bleeding when filtering
+#define MAX_GLYPH_FRACTION     4 // a glyph must not be higher than a quarter of a page
+
+#define CHAR_TAB              9
+#define CHAR_NEWLINE         10
+#define CHAR_CARRIAGE_RETURN 13
+#define CHAR_SPACE           32
+
+// --- helper classes ------------------------------------------------------------------------------
+
+/// A texture page that glyphs are added to row by row ("shelf packing"). The pixels are kept in
+/// memory, so that new glyphs can be uploaded without touching the rest of the texture.
+@interface SPGlyphAtlasPage : NSObject
+
+- (instancetype)initWithSize:(NSInteger)size scale:(float)scale;
+- (nullable SPTexture *)addGlyph:(NSString *)glyph attributes:(NSDictionary *)attributes
+                           width:(float)width height:(float)height padding:(float)padding;
+- (SPTexture *)emptyGlyph;
+- (void)upload;
+
+@property (nonatomic, readonly) SPGLTexture *texture;
+
+@end
+
+@implementation SPGlyphAtlasPage
+{
+    SPGLTexture *_texture;
+    void *_imageData;
+    CGContextRef _context;
+    NSInteger _size;
+    float _scale;
+    NSInteger _shelfX;
+    NSInteger _shelfY;
+    NSInteger _shelfHeight;
+    NSInteger _dirtyTop;     // the range of rows that was changed since the last upload
+    NSInteger _dirtyBottom;
+}
+
+- (instancetype)initWithSize:(NSInteger)size scale:(float)scale
+{
+    if ((self = [super init]))
+    {
+        _size = size;
+        _scale = scale;
+        _imageData = calloc(size * size * 4, 1);
+        _dirtyTop = size;
+
+        CGColorSpaceRef cgColorSpace = CGColorSpaceCreateDeviceRGB();
+        _context = CGBitmapContextCreate(_imageData, size, size, 8, 4 * size, cgColorSpace,
+                                         kCGBitmapByteOrder32Big | kCGImageAlphaPremultipliedLast);
+        CGColorSpaceRelease(cgColorSpace);
+
+        // UIKit referential is upside down - we flip it and apply the scale factor
+        CGContextTranslateCTM(_context, 0.0f, size);
+        CGContextScaleCTM(_context, scale, -scale);
+
+        SPTextureProperties properties = {
+            .format = SPTextureFormatRGBA,
+            .scale  = scale,
+            .width  = size,
+            .height = size,
+            .numMipmaps = 0,
+            .generateMipmaps = NO,
+            .premultipliedAlpha = YES
+        };
+
+        _texture = [[SPGLTexture alloc] initWithData:_imageData properties:properties];
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    CGContextRelease(_context);
+    free(_imageData);
+    [_texture release];
+    [super dealloc];
+}
+
+- (SPTexture *)addGlyph:(NSString *)glyph attributes:(NSDictionary *)attributes
+                  width:(float)width height:(float)height padding:(float)padding
+{
+    NSInteger pixelWidth  = ceilf((width  + 2 * padding) * _scale);
+    NSInteger pixelHeight = ceilf((height + 2 * padding) * _scale);
+
+    if (_shelfX + pixelWidth > _size)
+    {
+        _shelfX = 0;
+        _shelfY += _shelfHeight + GLYPH_GAP;
+        _shelfHeight = 0;
+    }
+
+    if (pixelWidth > _size || _shelfY + pixelHeight > _size)
+        return nil;
+
+    CGRect cell = CGRectMake(_shelfX / _scale, _shelfY / _scale,
+                             pixelWidth / _scale, pixelHeight / _scale);
+
+    CGContextSaveGState(_context);
+    CGContextClipToRect(_context, cell);
+    UIGraphicsPushContext(_context);
+    [glyph drawAtPoint:CGPointMake(cell.origin.x + padding, cell.origin.y + padding)
+        withAttributes:attributes];
+    UIGraphicsPopContext();
+    CGContextRestoreGState(_context);
+
+    _dirtyTop = MIN(_dirtyTop, _shelfY);
+    _dirtyBottom = MAX(_dirtyBottom, _shelfY + pixelHeight);
+    _shelfX += pixelWidth + GLYPH_GAP;
+    _shelfHeight = MAX(_shelfHeight, pixelHeight);
+
+    SPRectangle *region = [SPRectangle rectangleWithX:cell.origin.x y:cell.origin.y
+                                                width:cell.size.width height:cell.size.height];
+    return [SPTexture textureWithRegion:region ofTexture:_texture];
+}
+
+- (SPTexture *)emptyGlyph
+{
+    SPRectangle *region = [SPRectangle rectangleWithX:0 y:0 width:0 height:0];
+    return [SPTexture textureWithRegion:region ofTexture:_texture];
+}
+
+- (void)upload
+{
+    if (_dirtyTop >= _dirtyBottom) return;
+
+    // GLES 2 can't upload a sub-rectangle of a bigger image, so we upload complete rows
+    int prevTextureName = 0;
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &prevTextureName);
+    glBindTexture(GL_TEXTURE_2D, _texture.name);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, (GLint)_dirtyTop, (GLsizei)_size,
+                    (GLsizei)(_dirtyBottom - _dirtyTop), GL_RGBA, GL_UNSIGNED_BYTE,
+                    (unsigned char *)_imageData + _dirtyTop * _size * 4);
+    glBindTexture(GL_TEXTURE_2D, prevTextureName);
+
+    _dirtyTop = _size;
+    _dirtyBottom = 0;
+}
+
+@end
+
+/// A system font at a certain size, together with the bitmap font its glyphs are added to.
+@interface SPGlyphAtlasFont : NSObject
+
+@property (nonatomic, retain) UIFont *font;
+@property (nonatomic, copy) NSDictionary *attributes;
+@property (nonatomic, retain) SPBitmapFont *bitmapFont;
+@property (nonatomic, retain) SPGlyphAtlasPage *page;
+@property (nonatomic, assign) float padding;
+
+@end
+
+@implementation SPGlyphAtlasFont
+
+- (void)dealloc
+{
+    [_font release];
+    [_attributes release];
+    [_bitmapFont release];
+    [_page release];
+    [super dealloc];
+}
+
+@end
+
+// --- class implementation ------------------------------------------------------------------------
+
+@implementation SPGlyphAtlas
+{
+    SP_GENERIC(NSMutableDictionary, NSString*, SPGlyphAtlasFont*) *_fonts;
+    SPGlyphAtlasPage *_currentPage;
+    NSInteger _pageSize;
+}
+
+static BOOL isSimpleChar(unichar c)
+{
+    // Glyphs are rasterized one by one, so we only accept scripts that don't need complex
+    // shaping (no combining marks, no right-to-left text, no surrogate pairs).
+    return  c <  0x0300 ||
+           (c >= 0x0370 && c <= 0x052f) || // Greek, Cyrillic
+           (c >= 0x2010 && c <= 0x2027) || // general punctuation
+           (c >= 0x2030 && c <= 0x205e) ||
+           (c >= 0x20a0 && c <= 0x20cf) || // currency symbols
+           (c >= 0x2100 && c <= 0x214f) || // letterlike symbols
+           (c >= 0x3000 && c <= 0x30ff) || // CJK punctuation, Hiragana, Katakana
+           (c >= 0x4e00 && c <= 0x9fff) || // CJK unified ideographs
+           (c >= 0xac00 && c <= 0xd7a3) || // Hangul syllables
+           (c >= 0xff01 && c <= 0xff60);   // fullwidth forms
+}
+
+#pragma mark Initialization
+
+- (instancetype)init
+{
+    if ((self = [super init]))
+    {
+        _fonts = [[NSMutableDictionary alloc] init];
+        _pageSize = DEFAULT_PAGE_SIZE;
+    }
+    return self;
+}
+
+- (void)dealloc
+{
+    [_fonts release];
+    [_currentPage release];
+    [super dealloc];
+}
+
++ (SPGlyphAtlas *)sharedAtlas
+{
+    static SPGlyphAtlas *sharedAtlas = nil;
+    if (!sharedAtlas) sharedAtlas = [[SPGlyphAtlas alloc] init];
+    return sharedAtlas;
+}
+
+#pragma mark Methods
+
+- (SPBitmapFont *)fontWithName:(NSString *)fontName size:(float)size
+                          bold:(BOOL)bold italic:(BOOL)italic forText:(NSString *)text
+{
+    NSInteger numChars = text.length;
+    for (NSInteger i=0; i<numChars; ++i)
+        if (!isSimpleChar([text characterAtIndex:i])) return nil;
+
+    NSString *key = [NSString stringWithFormat:@"%@-%g-%d%d", fontName, size, bold, italic];
+    SPGlyphAtlasFont *font = _fonts[key];
+
+    if (!font)
+    {
+        font = [self createFontWithName:fontName size:size bold:bold italic:italic];
+        if (!font) return nil;
+        _fonts[key] = font;
+    }
+
+    if (![self addCharsOfText:text toFont:font])
+    {
+        // the font does not fit on a single page; let the text be rendered the classic way
+        [_fonts removeObjectForKey:key];
+        return nil;
+    }
+
+    return font.bitmapFont;
+}
+
+- (void)purge
+{
+    [_fonts removeAllObjects];
+    SP_RELEASE_AND_NIL(_currentPage);
+}
+
+#pragma mark Private
+
+- (SPGlyphAtlasPage *)createPage
+{
+    SPGlyphAtlasPage *page = [[SPGlyphAtlasPage alloc] initWithSize:_pageSize
+                                                              scale:Sparrow.contentScaleFactor];
+    SP_RELEASE_AND_RETAIN(_currentPage, page);
+    return [page autorelease];
+}
+
+- (SPGlyphAtlasFont *)createFontWithName:(NSString *)fontName size:(float)size
+                                    bold:(BOOL)bold italic:(BOOL)italic
+{
+    UIFontDescriptorSymbolicTraits traits = 0;
+    if (bold)   traits |= UIFontDescriptorTraitBold;
+    if (italic) traits |= UIFontDescriptorTraitItalic;
+
+    UIFontDescriptor *fontDescriptor = [[UIFontDescriptor fontDescriptorWithName:fontName size:size]
+                                        fontDescriptorWithSymbolicTraits:traits];
+    UIFont *uiFont = [UIFont fontWithDescriptor:fontDescriptor size:size];
+
+    if (!uiFont)
+    {
+        NSLog(@"Font `%@` not found! Using default font.", fontName);
+
+        fontDescriptor = [[UIFontDescriptor fontDescriptorWithName:SPDefaultFontName size:size]
+                          fontDescriptorWithSymbolicTraits:traits];
+        uiFont = [UIFont fontWithDescriptor:fontDescriptor size:size];
+    }
+
+    float padding = ceilf(size * 0.2f); // room for overhangs, e.g. of italic glyphs
+    float lineHeight = ceilf(uiFont.lineHeight);
+
+    if ((lineHeight + 2 * padding) * Sparrow.contentScaleFactor > _pageSize / MAX_GLYPH_FRACTION)
+        return nil;
+
+    SPGlyphAtlasFont *font = [[SPGlyphAtlasFont alloc] init];
+    font.font = uiFont;
+    font.padding = padding;
+    font.attributes = @{ NSFontAttributeName: uiFont,
+                         NSForegroundColorAttributeName: [UIColor whiteColor] };
+
+    [self moveFont:font toPage:_currentPage ?: [self createPage]];
+    return [font autorelease];
+}
+
+- (void)moveFont:(SPGlyphAtlasFont *)font toPage:(SPGlyphAtlasPage *)page
+{
+    // pages are only appended to, so text that was composed with the previous bitmap font
+    // stays valid; from now on, glyphs are added to a new one.
+
+    UIFont *uiFont = font.font;
+    SPBitmapFont *bitmapFont = [[SPBitmapFont alloc] initWithName:uiFont.fontName
+                                                             size:uiFont.pointSize
+                                                       lineHeight:ceilf(uiFont.lineHeight)
+                                                         baseline:uiFont.ascender
+                                                          texture:page.texture];
+    font.bitmapFont = bitmapFont;
+    font.page = page;
+    [bitmapFont release];
+}
+
+- (BOOL)addCharsOfText:(NSString *)text toFont:(SPGlyphAtlasFont *)font
+{
+    NSInteger numChars = text.length;
+    SPBitmapFont *oldBitmapFont = [[font.bitmapFont retain] autorelease];
+
+    for (NSInteger i=0; i<numChars; ++i)
+    {
+        unichar charID = [text characterAtIndex:i];
+        if (charID == CHAR_NEWLINE || charID == CHAR_CARRIAGE_RETURN) continue;
+        if ([font.bitmapFont charByID:charID]) continue;
+
+        if (![self addChar:charID toFont:font])
+        {
+            // The page is full: move the font to a page with enough room for all its glyphs.
+            // If another font already started a new page, we try that one first.
+            BOOL isEmptyPage = font.page == _currentPage;
+            SPGlyphAtlasPage *page = isEmptyPage ? [self createPage] : _currentPage;
+            NSArray *charIDs = oldBitmapFont.allCharIDs;
+
+            while (YES)
+            {
+                [self moveFont:font toPage:page];
+
+                if ([self addChars:charIDs text:text toFont:font]) break;
+                else if (isEmptyPage) return NO;
+
+                page = [self createPage];
+                isEmptyPage = YES;
+            }
+
+            break;
+        }
+    }
+
+    [font.page upload];
+    return YES;
+}
+
+- (BOOL)addChars:(NSArray *)charIDs text:(NSString *)text toFont:(SPGlyphAtlasFont *)font
+{
+    for (NSNumber *charID in charIDs)
+        if (![self addChar:charID.intValue toFont:font]) return NO;
+
+    NSInteger numChars = text.length;
+    for (NSInteger i=0; i<numChars; ++i)
+    {
+        unichar charID = [text characterAtIndex:i];
+        if (charID == CHAR_NEWLINE || charID == CHAR_CARRIAGE_RETURN) continue;
+        if ([font.bitmapFont charByID:charID]) continue;
+        if (![self addChar:charID toFont:font]) return NO;
+    }
+
+    return YES;
+}
+
+- (BOOL)addChar:(unichar)charID toFont:(SPGlyphAtlasFont *)font
+{
+    NSString *glyph = [NSString stringWithCharacters:&charID length:1];
+    float advance = [glyph sizeWithAttributes:font.attributes].width;
+    float padding = font.padding;
+    SPTexture *texture = nil;
+
+    if (charID == CHAR_SPACE || charID == CHAR_TAB)
+        texture = [font.page emptyGlyph];
+    else
+        texture = [font.page addGlyph:glyph attributes:font.attributes width:advance
+                               height:font.bitmapFont.lineHeight padding:padding];
+
+    if (!texture) return NO;
+
+    BOOL isEmpty = texture.width == 0;
+    SPBitmapChar *bitmapChar = [[SPBitmapChar alloc] initWithID:charID texture:texture
+                                                        xOffset:isEmpty ? 0 : -padding
+                                                        yOffset:isEmpty ? 0 : -padding
+                                                       xAdvance:advance];
+    [font.bitmapFont addBitmapChar:bitmapChar charID:charID];
+    [bitmapChar release];
+
+    return YES;
+}
+
+#pragma mark Properties
+
+- (NSInteger)pageSize
+{
+    return _pageSize;
+}
+
+- (void)setPageSize:(NSInteger)pageSize
+{
+    if (pageSize != _pageSize)
+    {
+        _pageSize = pageSize;
+        [self purge];
+    }
+}
+
+@end
@@ -15,6 +15,7 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@class SPDelayedInvocation;
 @class SPTween;
 
 /** ------------------------------------------------------------------------------------------------
@@ -24,7 +25,13 @@ NS_ASSUME_NONNULL_BEGIN
  A juggler is a simple object. It does no more than saving a list of objects implementing 
  `SPAnimatable` and advancing their time if it is told to do so (by calling its own `advanceTime:`
  method). Furthermore, an object can request to be removed from the juggler by dispatching an
- `SPEventTypeRemoveFromJuggler` event.
+ `SPEventTypeRemoveFromJuggler` event. Tweens and delayed invocations notify their juggler directly
+ instead; they only dispatch that event if somebody is listening for it.
+
+ Objects are kept in a contiguous array. Removals that happen while the juggler advances its
+ objects are deferred until the end of the frame (a removed object is skipped right away), so
+ user code may add and remove objects from within callbacks at any time. Objects added during
+ a frame will be advanced the next frame.
  
  There is a default juggler that you can access from anywhere with the following code:
  
@@ -45,6 +52,14 @@ NS_ASSUME_NONNULL_BEGIN
  Alternatively, you can use the block-based verson of the method:
 
 	[juggler delayInvocationByTime:2.0 block:^{ [object removeFromParent]; };
+
+ Or, cheapest of all, name the method directly:
+
+	[juggler delayInvocationOfSelector:@selector(removeFromParent) atTarget:object
+	                        withObject:nil byTime:2.0];
+
+ Delayed invocations are not advanced every frame, but kept in a timer wheel that only touches
+ those which are due; you can schedule thousands of them without slowing down the juggler.
  
  You can also create tweens easily using the following method:
  
@@ -57,10 +72,6 @@ NS_ASSUME_NONNULL_BEGIN
 ------------------------------------------------------------------------------------------------- */
 
 @interface SPJuggler : NSObject <SPAnimatable>
-{
-  @protected
-    SP_GENERIC(NSMutableOrderedSet, id<SPAnimatable>) *_objects;
-}
 
 /// --------------------
 /// @name Initialization
@@ -83,7 +94,7 @@ NS_ASSUME_NONNULL_BEGIN
 - (void)removeAllObjects;
 
 /// Removes all objects with a `target` property referencing a certain object (e.g. tweens or
-/// delayed invocations).
+/// delayed invocations). Targets are compared by identity, not with `isEqual:`.
 - (void)removeObjectsWithTarget:(id)object;
 
 /// Determines if an object has been added to the juggler.
@@ -100,6 +111,17 @@ NS_ASSUME_NONNULL_BEGIN
 /// Delays the execution of a block by a certain time in seconds.
 - (id)delayInvocationByTime:(double)time block:(SPCallbackBlock)block;
 
+/// Calls a method of the target after a certain time, passing `object` as its only argument.
+/// Other than `delayInvocationAtTarget:byTime:`, this does not need to capture an `NSInvocation`.
+- (SPDelayedInvocation *)delayInvocationOfSelector:(SEL)selector atTarget:(id)target
+                                        withObject:(nullable id)object byTime:(double)time;
+
+/// Calls a method of the target at a specified interval (in seconds), passing `object` as its
+/// only argument. A 'repeatCount' of zero means that it runs indefinitely.
+- (SPDelayedInvocation *)repeatInvocationOfSelector:(SEL)selector atTarget:(id)target
+                                         withObject:(nullable id)object interval:(double)interval
+                                        repeatCount:(NSInteger)repeatCount;
+
 /// Creates a tween to animate the target over 'time' seconds. This method provides a convenient
 /// alternative for creating and adding a tween manually.
 - (SPTween *)tweenWithTarget:(id)target time:(double)time properties:(SP_GENERIC(NSDictionary, NSString*,id) *)properties;
@@ -12,22 +12,362 @@
 #import "SPAnimatable.h"
 #import "SPDelayedInvocation.h"
 #import "SPEventDispatcher.h"
-#import "SPJuggler.h"
+#import "SPJuggler_Internal.h"
 #import "SPTween.h"
 
+#define INITIAL_CAPACITY 16
+
+// timer wheel: 4 levels of 64 slots, with 256 ticks per second. Level 0 covers a quarter
+// second, level 3 about 18 hours; timers that are due even later are cascaded repeatedly.
+#define TICKS_PER_SECOND 256.0
+#define NUM_LEVELS 4
+#define SLOT_BITS 6
+#define NUM_SLOTS (1 << SLOT_BITS)
+#define SLOT_MASK (NUM_SLOTS - 1)
+#define WHEEL_SPAN (1ull << (SLOT_BITS * NUM_LEVELS))
+
+// tolerance when comparing due times, so that accumulated rounding errors can't delay a timer
+#define TIME_EPSILON 1.0e-9
+
+typedef struct
+{
+    id<SPAnimatable> object;
+    SPJugglerLink *link; // NULL for removed objects
+    BOOL ownsLink;
+} SPJugglerEntry;
+
+// Targets are retained, but compared by identity: value types like SPPoint change their hash
+// while they are being tweened, which must not make them unreachable.
+static const CFDictionaryKeyCallBacks targetKeyCallBacks = {
+    0, kCFTypeDictionaryKeyCallBacks.retain, kCFTypeDictionaryKeyCallBacks.release,
+    NULL, NULL, NULL
+};
+
+// --- class implementation ------------------------------------------------------------------------
+
 @implementation SPJuggler
 {
+    SPJugglerEntry *_entries;
+    NSInteger _numEntries;
+    NSInteger _capacity;
+    NSInteger _numRemoved;
+    NSInteger _advanceDepth;
+
+    CFMutableDictionaryRef _foreignLinks; // object -> link, for objects without an embedded link
+    CFMutableDictionaryRef _targetLinks;  // target -> first link with that target
+
+    SPJugglerLink *_wheel[NUM_LEVELS][NUM_SLOTS];
+    SPJugglerLink *_pendingLinks;         // tick has passed, but the exact due time might not
+    SPJugglerLink *_dueLinks;
+    SPJugglerLink *_parkedLinks;          // scheduled objects that are never due
+    NSInteger _numInLevel[NUM_LEVELS];
+    NSInteger _numInWheel;
+    uint64_t _currentTick;
+
     double _elapsedTime;
     float _speed;
 }
 
+static SPJugglerLink *getLink(SPJuggler *self, id object)
+{
+    if ([object respondsToSelector:@selector(jugglerLink)])
+    {
+        SPJugglerLink *link = [(id<SPJugglerLinkable>)object jugglerLink];
+        if (link->juggler == self) return link;
+    }
+
+    return (SPJugglerLink *)CFDictionaryGetValue(self->_foreignLinks, object);
+}
+
+static void linkTarget(SPJuggler *self, SPJugglerLink *link, id target)
+{
+    SPJugglerLink *head = (SPJugglerLink *)CFDictionaryGetValue(self->_targetLinks, target);
+    if (head) head->prevWithTarget = link;
+
+    link->target = target;
+    link->nextWithTarget = head;
+    CFDictionarySetValue(self->_targetLinks, target, link);
+}
+
+static void unlinkTarget(SPJuggler *self, SPJugglerLink *link)
+{
+    if (!link->target) return;
+
+    SPJugglerLink *prev = link->prevWithTarget;
+    SPJugglerLink *next = link->nextWithTarget;
+
+    if (next) next->prevWithTarget = prev;
+
+    if (prev) prev->nextWithTarget = next;
+    else if (next) CFDictionarySetValue(self->_targetLinks, link->target, next);
+    else CFDictionaryRemoveValue(self->_targetLinks, link->target);
+
+    link->target = nil;
+    link->prevWithTarget = link->nextWithTarget = NULL;
+}
+
+static void appendToList(SPJuggler *self, SPJugglerLink **list, NSInteger level, SPJugglerLink *link)
+{
+    SPJugglerLink *head = *list;
+
+    link->list = list;
+    link->level = level;
+    link->nextInList = NULL;
+
+    if (head)
+    {
+        link->prevInList = head->prevInList;
+        head->prevInList->nextInList = link;
+        head->prevInList = link;
+    }
+    else
+    {
+        link->prevInList = link;
+        *list = link;
+    }
+
+    if (level >= 0)
+    {
+        ++self->_numInLevel[level];
+        ++self->_numInWheel;
+    }
+}
+
+static void removeFromList(SPJuggler *self, SPJugglerLink *link)
+{
+    SPJugglerLink **list = link->list;
+    if (!list) return;
+
+    SPJugglerLink *head = *list;
+    SPJugglerLink *prev = link->prevInList;
+    SPJugglerLink *next = link->nextInList;
+
+    if (link == head) *list = next;
+    else prev->nextInList = next;
+
+    if (next) next->prevInList = prev;
+    else if (link != head) head->prevInList = prev;
+
+    if (link->level >= 0)
+    {
+        --self->_numInLevel[link->level];
+        --self->_numInWheel;
+    }
+
+    link->list = NULL;
+    link->level = -1;
+    link->prevInList = link->nextInList = NULL;
+}
+
+static void insertIntoWheel(SPJuggler *self, SPJugglerLink *link)
+{
+    if (!isfinite(link->dueTime))
+    {
+        appendToList(self, &self->_parkedLinks, -1, link);
+        return;
+    }
+
+    uint64_t now  = self->_currentTick;
+    uint64_t tick = (uint64_t)MAX(0.0, floor(link->dueTime * TICKS_PER_SECOND));
+
+    if (tick <= now)
+    {
+        appendToList(self, &self->_pendingLinks, -1, link);
+        return;
+    }
+
+    uint64_t delta = tick - now;
+    if (delta >= WHEEL_SPAN) tick = now + WHEEL_SPAN - 1;
+
+    NSInteger level = 0;
+    while (level < NUM_LEVELS - 1 && delta >= (1ull << (SLOT_BITS * (level + 1)))) ++level;
+
+    NSInteger slot = (tick >> (SLOT_BITS * level)) & SLOT_MASK;
+    appendToList(self, &self->_wheel[level][slot], level, link);
+}
+
+static void cascadeSlot(SPJuggler *self, NSInteger level, NSInteger slot)
+{
+    SPJugglerLink *link;
+    while ((link = self->_wheel[level][slot]))
+    {
+        removeFromList(self, link);
+        insertIntoWheel(self, link);
+    }
+}
+
+static void advanceWheel(SPJuggler *self, uint64_t targetTick)
+{
+    while (self->_currentTick < targetTick)
+    {
+        if (!self->_numInWheel)
+        {
+            self->_currentTick = targetTick;
+            break;
+        }
+
+        uint64_t tick = ++self->_currentTick;
+        NSInteger slot = tick & SLOT_MASK;
+
+        if (slot == 0)
+        {
+            // cascade from the highest level whose slot has just been reached
+            NSInteger level = 1;
+            while (level < NUM_LEVELS - 1 && ((tick >> (SLOT_BITS * level)) & SLOT_MASK) == 0)
+                ++level;
+
+            for (; level > 0; --level)
+                cascadeSlot(self, level, (tick >> (SLOT_BITS * level)) & SLOT_MASK);
+        }
+
+        SPJugglerLink *link;
+        while ((link = self->_wheel[0][slot]))
+        {
+            removeFromList(self, link);
+            appendToList(self, &self->_pendingLinks, -1, link);
+        }
+
+        // nothing to do until the next cascade? jump right to it.
+        if (!self->_numInLevel[0])
+            self->_currentTick = MIN(targetTick, tick | SLOT_MASK);
+    }
+}
+
+static void fireDueLinks(SPJuggler *self)
+{
+    double elapsedTime = self->_elapsedTime;
+    SPJugglerLink *link = self->_pendingLinks;
+
+    while (link)
+    {
+        SPJugglerLink *next = link->nextInList;
+
+        if (link->dueTime <= elapsedTime + TIME_EPSILON)
+        {
+            removeFromList(self, link);
+            appendToList(self, &self->_dueLinks, -1, link);
+        }
+
+        link = next;
+    }
+
+    // objects rescheduled by their callbacks end up in the pending list, never in the due list.
+    while ((link = self->_dueLinks))
+    {
+        removeFromList(self, link);
+
+        id<SPJugglerSchedulable> object = [link->object retain];
+        [object jugglerDidReachDueTime:MAX(0.0, elapsedTime - link->dueTime)];
+        [object release];
+    }
+}
+
+static void removeEntryAtIndex(SPJuggler *self, NSInteger index)
+{
+    SPJugglerEntry *entry = &self->_entries[index];
+    SPJugglerLink *link = entry->link;
+    id object = entry->object;
+
+    unlinkTarget(self, link);
+    link->juggler = nil;
+
+    if (entry->ownsLink)
+    {
+        CFDictionaryRemoveValue(self->_foreignLinks, object);
+        free(link);
+
+        if ([object isKindOfClass:[SPEventDispatcher class]])
+            [(SPEventDispatcher *)object removeEventListenersAtObject:self
+                                         forType:SPEventTypeRemoveFromJuggler];
+    }
+
+    entry->link = NULL;
+    ++self->_numRemoved;
+
+    // while advancing, the object might still be executing; it's released when compacting.
+    if (!self->_advanceDepth)
+    {
+        entry->object = nil;
+        [object autorelease];
+    }
+}
+
+static void compactEntries(SPJuggler *self)
+{
+    SPJugglerEntry *entries = self->_entries;
+    NSInteger numEntries = self->_numEntries;
+    NSInteger numKept = 0;
+
+    for (NSInteger i=0; i<numEntries; ++i)
+    {
+        SPJugglerEntry entry = entries[i];
+
+        if (!entry.link) [entry.object release];
+        else
+        {
+            entry.link->index = numKept;
+            entries[numKept++] = entry;
+        }
+    }
+
+    self->_numEntries = numKept;
+    self->_numRemoved = 0;
+}
+
+static void removeScheduledLink(SPJuggler *self, SPJugglerLink *link)
+{
+    id object = link->object;
+
+    unlinkTarget(self, link);
+    removeFromList(self, link);
+    link->juggler = nil;
+    link->object = nil;
+
+    // the object might just be executing its callback
+    [object autorelease];
+}
+
+static void removeLink(SPJuggler *self, SPJugglerLink *link)
+{
+    if (link->index == SPJugglerIndexScheduled) removeScheduledLink(self, link);
+    else removeEntryAtIndex(self, link->index);
+}
+
+static void forEachScheduledLink(SPJuggler *self, void (^block)(SPJugglerLink *link))
+{
+    SPJugglerLink **lists[NUM_LEVELS * NUM_SLOTS + 3];
+    NSInteger numLists = 0;
+
+    for (NSInteger level=0; level<NUM_LEVELS; ++level)
+        for (NSInteger slot=0; slot<NUM_SLOTS; ++slot)
+            lists[numLists++] = &self->_wheel[level][slot];
+
+    lists[numLists++] = &self->_pendingLinks;
+    lists[numLists++] = &self->_dueLinks;
+    lists[numLists++] = &self->_parkedLinks;
+
+    for (NSInteger i=0; i<numLists; ++i)
+    {
+        SPJugglerLink *link = *lists[i];
+        while (link)
+        {
+            SPJugglerLink *next = link->nextInList;
+            block(link);
+            link = next;
+        }
+    }
+}
+
 #pragma mark Initialization
 
 - (instancetype)init
 {    
     if ((self = [super init]))
     {        
-        _objects = [[NSMutableOrderedSet alloc] init];
+        _capacity = INITIAL_CAPACITY;
+        _entries = malloc(sizeof(SPJugglerEntry) * _capacity);
+        _foreignLinks = CFDictionaryCreateMutable(NULL, 0, NULL, NULL);
+        _targetLinks = CFDictionaryCreateMutable(NULL, 0, &targetKeyCallBacks, NULL);
         _elapsedTime = 0.0;
         _speed = 1.0f;
     }
@@ -36,7 +376,38 @@
 
 - (void)dealloc
 {
-    [_objects release];
+    for (NSInteger i=0; i<_numEntries; ++i)
+    {
+        SPJugglerEntry *entry = &_entries[i];
+
+        if (entry->link)
+        {
+            if (entry->ownsLink)
+            {
+                if ([(id)entry->object isKindOfClass:[SPEventDispatcher class]])
+                    [(SPEventDispatcher *)entry->object removeEventListenersAtObject:self
+                                                    forType:SPEventTypeRemoveFromJuggler];
+                free(entry->link);
+            }
+            else
+            {
+                memset(entry->link, 0, sizeof(SPJugglerLink));
+            }
+        }
+
+        [entry->object release];
+    }
+
+    forEachScheduledLink(self, ^(SPJugglerLink *link)
+    {
+        id object = link->object;
+        memset(link, 0, sizeof(SPJugglerLink));
+        [object release];
+    });
+
+    free(_entries);
+    CFRelease(_foreignLinks);
+    CFRelease(_targetLinks);
     [super dealloc];
 }
 
@@ -49,69 +420,114 @@
 
 - (void)addObject:(id<SPAnimatable>)object
 {
-    if (object && ![_objects containsObject:object])
+    if (!object || getLink(self, object)) return;
+
+    SPJugglerLink *link = NULL;
+    BOOL ownsLink = NO;
+
+    if ([(id)object respondsToSelector:@selector(jugglerLink)])
     {
-        [_objects addObject:object];
-        
+        link = [(id<SPJugglerLinkable>)object jugglerLink];
+        if (link->juggler) link = NULL; // already linked into another juggler
+    }
+
+    if (link && [(id)object respondsToSelector:@selector(jugglerDidReachDueTime:)])
+    {
+        id<SPJugglerSchedulable> schedulable = (id<SPJugglerSchedulable>)object;
+
+        memset(link, 0, sizeof(SPJugglerLink));
+        link->juggler = self;
+        link->index = SPJugglerIndexScheduled;
+        link->object = [schedulable retain];
+        link->dueTime = _elapsedTime + [schedulable timeUntilDue];
+        link->level = -1;
+        insertIntoWheel(self, link);
+
+        if ([(id)object respondsToSelector:@selector(target)])
+        {
+            id target = [(SPDelayedInvocation *)object target];
+            if (target) linkTarget(self, link, target);
+        }
+
+        return;
+    }
+
+    if (!link)
+    {
+        link = malloc(sizeof(SPJugglerLink));
+        ownsLink = YES;
+        CFDictionarySetValue(_foreignLinks, object, link);
+
         if ([(id)object isKindOfClass:[SPEventDispatcher class]])
             [(SPEventDispatcher *)object addEventListener:@selector(onRemove:) atObject:self
                                                   forType:SPEventTypeRemoveFromJuggler];
     }
+
+    if (!_advanceDepth && _numRemoved && (_numRemoved * 2 > _numEntries || _numEntries == _capacity))
+        compactEntries(self);
+
+    if (_numEntries == _capacity)
+    {
+        _capacity *= 2;
+        _entries = realloc(_entries, sizeof(SPJugglerEntry) * _capacity);
+    }
+
+    memset(link, 0, sizeof(SPJugglerLink));
+    link->juggler = self;
+    link->index = _numEntries;
+
+    _entries[_numEntries++] = (SPJugglerEntry){ [object retain], link, ownsLink };
+
+    if ([(id)object respondsToSelector:@selector(target)])
+    {
+        id target = [(SPTween *)object target];
+        if (target) linkTarget(self, link, target);
+    }
 }
 
 - (void)onRemove:(SPEvent *)event
 {
-    [self removeObject:(id<SPAnimatable>)[[event.target retain] autorelease]];
+    id<SPAnimatable> object = (id<SPAnimatable>)event.target;
+    [self removeObject:object];
 
-    if ([event.target isKindOfClass:[SPTween class]])
+    if ([(id)object isKindOfClass:[SPTween class]])
     {
-        SPTween *tween = (SPTween *)event.target;
+        SPTween *tween = (SPTween *)object;
         if (tween.isComplete) [self addObject:tween.nextTween];
     }
 }
 
 - (void)removeObject:(id<SPAnimatable>)object
 {
-    [_objects removeObject:object];
-    
-    if ([(id)object isKindOfClass:[SPEventDispatcher class]])
-        [(SPEventDispatcher *)object removeEventListenersAtObject:self
-                                     forType:SPEventTypeRemoveFromJuggler];
+    SPJugglerLink *link = object ? getLink(self, object) : NULL;
+    if (link) removeLink(self, link);
 }
 
 - (void)removeAllObjects
 {
-    for (id object in _objects)
-    {
-        if ([(id)object isKindOfClass:[SPEventDispatcher class]])
-            [(SPEventDispatcher *)object removeEventListenersAtObject:self
-                                         forType:SPEventTypeRemoveFromJuggler];
-    }
-    
-    [_objects removeAllObjects];
+    for (NSInteger i=0; i<_numEntries; ++i)
+        if (_entries[i].link) removeEntryAtIndex(self, i);
+
+    forEachScheduledLink(self, ^(SPJugglerLink *link) { removeScheduledLink(self, link); });
+
+    if (!_advanceDepth) compactEntries(self);
 }
 
 - (void)removeObjectsWithTarget:(id)object
 {
-    SEL targetSel = @selector(target);
-    SP_GENERIC(NSMutableOrderedSet, id<SPAnimatable>) *remainingObjects = [[NSMutableOrderedSet alloc] init];
-    
-    for (id currentObject in _objects)
+    SPJugglerLink *link = object ? (SPJugglerLink *)CFDictionaryGetValue(_targetLinks, object) : NULL;
+
+    while (link)
     {
-        if (![currentObject respondsToSelector:targetSel] || ![[(SPTween *)currentObject target] isEqual:object])
-            [remainingObjects addObject:currentObject];
-        else if ([(id)currentObject isKindOfClass:[SPEventDispatcher class]])
-            [(SPEventDispatcher *)currentObject removeEventListenersAtObject:self
-                                                forType:SPEventTypeRemoveFromJuggler];
+        SPJugglerLink *next = link->nextWithTarget;
+        removeLink(self, link);
+        link = next;
     }
-
-    SP_RELEASE_AND_RETAIN(_objects, remainingObjects);
-    [remainingObjects release];
 }
 
 - (BOOL)containsObject:(id<SPAnimatable>)object
 {
-    return [_objects containsObject:object];
+    return object && getLink(self, object);
 }
 
 - (id)delayInvocationAtTarget:(id)target byTime:(double)time
@@ -136,6 +552,26 @@
     return delayedInv;
 }
 
+- (SPDelayedInvocation *)delayInvocationOfSelector:(SEL)selector atTarget:(id)target
+                                        withObject:(id)object byTime:(double)time
+{
+    SPDelayedInvocation *delayedInv = [SPDelayedInvocation invocationWithTarget:target
+                                        selector:selector object:object delay:time];
+    [self addObject:delayedInv];
+    return delayedInv;
+}
+
+- (SPDelayedInvocation *)repeatInvocationOfSelector:(SEL)selector atTarget:(id)target
+                                         withObject:(id)object interval:(double)interval
+                                        repeatCount:(NSInteger)repeatCount
+{
+    SPDelayedInvocation *delayedInv = [SPDelayedInvocation invocationWithTarget:target
+                                        selector:selector object:object delay:interval];
+    delayedInv.repeatCount = repeatCount;
+    [self addObject:delayedInv];
+    return delayedInv;
+}
+
 - (SPTween *)tweenWithTarget:(id)target time:(double)time properties:(SP_GENERIC(NSDictionary, NSString*,id) *)properties
 {
     SPTween *tween = [SPTween tweenWithTarget:target time:time];
@@ -157,6 +593,26 @@
     return tween;
 }
 
+#pragma mark Internal
+
+- (void)objectDidComplete:(id<SPAnimatable>)object
+{
+    [self removeObject:object];
+
+    if ([(id)object isKindOfClass:[SPTween class]])
+        [self addObject:[(SPTween *)object nextTween]];
+}
+
+- (void)rescheduleObject:(id<SPJugglerSchedulable>)object dueIn:(double)time
+{
+    SPJugglerLink *link = [object jugglerLink];
+    if (link->juggler != self || link->index != SPJugglerIndexScheduled) return;
+
+    removeFromList(self, link);
+    link->dueTime = _elapsedTime + time;
+    insertIntoWheel(self, link);
+}
+
 #pragma mark SPAnimatable
 
 - (void)advanceTime:(double)seconds
@@ -170,13 +626,23 @@
     {
         _elapsedTime += seconds;
 
-        // we need work with a copy, since user-code could modify the collection while enumerating
-        SP_GENERIC(NSArray, id<SPAnimatable>) *objectsCopy = [[_objects array] copy];
+        // objects removed while we iterate are only marked as such; we compact the array
+        // afterwards. Objects added in the meantime are appended and not advanced this frame.
+        NSInteger numEntries = _numEntries;
+        ++_advanceDepth;
+
+        for (NSInteger i=0; i<numEntries; ++i)
+        {
+            SPJugglerEntry entry = _entries[i];
+            if (entry.link) [entry.object advanceTime:seconds];
+        }
 
-        for (id<SPAnimatable> object in objectsCopy)
-            [object advanceTime:seconds];
+        // scheduled objects are only touched when they are (nearly) due
+        advanceWheel(self, (uint64_t)floor(_elapsedTime * TICKS_PER_SECOND));
+        if (_pendingLinks) fireDueLinks(self);
 
-        [objectsCopy release];
+        if (--_advanceDepth == 0 && _numRemoved)
+            compactEntries(self);
     }
 }
 
@@ -0,0 +1,70 @@
+//
+//  SPJuggler_Internal.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 09.05.09.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPJuggler.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// The index of objects that are not part of the juggler's object array, but wait in its timer wheel.
+static const NSInteger SPJugglerIndexScheduled = -1;
+
+/// The bookkeeping data a juggler stores per object. Tweens and delayed invocations embed one
+/// of these, which lets the juggler find, unlink and notify them without any table lookups.
+typedef struct SPJugglerLink
+{
+    SPJuggler *__nullable juggler;                  // not retained
+    NSInteger index;                                // slot in the juggler's object array
+    id __nullable target;                           // not retained
+    struct SPJugglerLink *__nullable prevWithTarget;
+    struct SPJugglerLink *__nullable nextWithTarget;
+
+    // scheduled objects only
+    id __nullable object;                           // retained while it is scheduled
+    double dueTime;                                 // in the juggler's elapsed time
+    NSInteger level;                                // level in the timer wheel, -1 if none
+    struct SPJugglerLink *__nullable *__nullable list;
+    struct SPJugglerLink *__nullable prevInList;    // the head of a list points to its tail
+    struct SPJugglerLink *__nullable nextInList;
+} SPJugglerLink;
+
+/// Implemented by animatables that embed an `SPJugglerLink`.
+@protocol SPJugglerLinkable <SPAnimatable>
+
+- (SPJugglerLink *)jugglerLink;
+
+@end
+
+/// Implemented by linkable objects that only need to act at a certain point in time. Instead of
+/// advancing them every frame, the juggler keeps them in a timer wheel until they are due.
+@protocol SPJugglerSchedulable <SPJugglerLinkable>
+
+/// The time (in seconds) until the object wants to be notified; `INFINITY` for never.
+- (double)timeUntilDue;
+
+/// Called when the object is due. `passedTime` is the time that has passed since then. The
+/// object has to either reschedule itself or report completion.
+- (void)jugglerDidReachDueTime:(double)passedTime;
+
+@end
+
+@interface SPJuggler (Internal)
+
+/// Called by a linked object when it has finished. Removes it from the juggler (and adds the
+/// `nextTween` of finished tweens) without dispatching an `SPEventTypeRemoveFromJuggler` event.
+- (void)objectDidComplete:(id<SPAnimatable>)object;
+
+/// Moves a scheduled object to a new due time, `time` seconds from now. Has no effect on objects
+/// that are not scheduled by this juggler.
+- (void)rescheduleObject:(id<SPJugglerSchedulable>)object dueIn:(double)time;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -15,6 +15,7 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
+@class SPMovieTimeline;
 @class SPSoundChannel;
 
 /** ------------------------------------------------------------------------------------------------
@@ -34,6 +35,14 @@ NS_ASSUME_NONNULL_BEGIN
  As any animated object, a movie clip has to be added to a juggler (or have its `advanceTime:` 
  method called regularly) to run.
  
+ The frames are stored in an `SPMovieTimeline`. When you need many clips showing the same
+ animation, let them share one timeline instead of having each of them store the same frames:
+ 
+	SPMovieClip *enemy = [SPMovieClip movieWithTimeline:prototype.timeline];
+ 
+ Shared timelines are copied as soon as one of the clips modifies its frames (copy-on-write).
+ Copies of a movie clip share their timeline, too.
+ 
 ------------------------------------------------------------------------------------------------- */
  
 @interface SPMovieClip : SPImage <SPAnimatable>
@@ -42,7 +51,11 @@ NS_ASSUME_NONNULL_BEGIN
 /// @name Initialization
 /// --------------------
 
-/// Initializes a movie with the first frame and the default number of frames per second. _Designated initializer_.
+/// Initializes a movie that displays the frames of a (possibly shared) timeline.
+/// _Designated initializer_.
+- (instancetype)initWithTimeline:(SPMovieTimeline *)timeline;
+
+/// Initializes a movie with the first frame and the default number of frames per second.
 - (instancetype)initWithFrame:(SPTexture *)texture fps:(float)fps;
 
 /// Initializes a movie with an array of textures and the default number of frames per second.
@@ -54,6 +67,9 @@ NS_ASSUME_NONNULL_BEGIN
 /// Factory method.
 + (instancetype)movieWithFrames:(SP_GENERIC(NSArray, SPTexture*) *)textures fps:(float)fps;
 
+/// Factory method.
++ (instancetype)movieWithTimeline:(SPMovieTimeline *)timeline;
+
 /// --------------------------------
 /// @name Frame Manipulation Methods
 /// --------------------------------
@@ -122,6 +138,10 @@ NS_ASSUME_NONNULL_BEGIN
 /// The number of frames of the clip.
 @property (nonatomic, readonly) NSInteger numFrames;
 
+/// The timeline containing the frames of the clip. Pass it to other clips to share the frames
+/// between them.
+@property (nonatomic, readonly) SPMovieTimeline *timeline;
+
 /// The total duration of the clip in seconds.
 @property (nonatomic, readonly) double totalTime;
 
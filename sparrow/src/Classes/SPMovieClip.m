@@ -11,20 +11,15 @@
 
 #import "SPMacros.h"
 #import "SPMovieClip.h"
+#import "SPMovieTimeline_Internal.h"
 #import "SPSoundChannel.h"
 
-static SPSoundChannel *nullSound = nil;
-
 @implementation SPMovieClip
 {
-    SP_GENERIC(NSMutableArray, SPTexture*) *_textures;
-    SP_GENERIC(NSMutableArray, SPSoundChannel*) *_sounds;
-    SP_GENERIC(NSMutableArray, NSNumber*) *_durations;
-    SP_GENERIC(NSMutableArray, NSNumber*) *_startTimes;
+    SPMovieTimeline *_timeline;
+    BOOL _ownsTimeline; // if not, the timeline might be shared and must be copied before editing
     
-    double _defaultFrameDuration;
     double _currentTime;
-    double _totalTime;
     NSInteger _currentFrame;
     BOOL _loop;
     BOOL _playing;
@@ -32,48 +27,47 @@ static SPSoundChannel *nullSound = nil;
     BOOL _wasStopped;
 }
 
-+ (void)initialize
+static SPMovieTimeline *editableTimeline(SPMovieClip *self)
 {
-    nullSound = (SPSoundChannel *)[NSNull null];
+    if (!self->_ownsTimeline)
+    {
+        SPMovieTimeline *timeline = [[SPMovieTimeline alloc] initWithTimeline:self->_timeline];
+        [self->_timeline release];
+        self->_timeline = timeline;
+        self->_ownsTimeline = YES;
+    }
+    
+    return self->_timeline;
 }
 
 #pragma mark Initialization
 
-- (instancetype)initWithFrames:(SP_GENERIC(NSArray, SPTexture*) *)textures fps:(float)fps
+- (instancetype)initWithTimeline:(SPMovieTimeline *)timeline
 {
-    if (textures.count == 0)
-        [NSException raise:SPExceptionInvalidOperation format:@"empty texture array"];
-    
-    if (fps < 0)
-        [NSException raise:SPExceptionInvalidOperation format:@"Invalid fps: %f", fps];
-    
-    if (self = [super initWithTexture:textures[0]])
+    if (self = [super initWithTexture:[timeline textureAtIndex:0]])
     {
-        NSInteger numFrames = textures.count;
-        
-        _defaultFrameDuration = 1.0f / fps;
+        _timeline = [timeline retain];
         _loop = YES;
         _playing = YES;
         _currentTime = 0.0;
         _currentFrame = 0;
         _wasStopped = YES;
-        _textures = [textures mutableCopy];
-        _sounds = [[NSMutableArray alloc] initWithCapacity:numFrames];
-        _durations = [[NSMutableArray alloc] initWithCapacity:numFrames];
-        _startTimes = [[NSMutableArray alloc] initWithCapacity:numFrames];
-        _totalTime = _defaultFrameDuration * numFrames;
-        
-        for (int i=0; i<numFrames; ++i)
-        {
-            _sounds[i] = nullSound;
-            _durations[i] = @(_defaultFrameDuration);
-            _startTimes[i] = @(i * _defaultFrameDuration);
-        }
     }
     
     return self;
 }
 
+- (instancetype)initWithFrames:(SP_GENERIC(NSArray, SPTexture*) *)textures fps:(float)fps
+{
+    SPMovieTimeline *timeline = [[SPMovieTimeline alloc] initWithTextures:textures fps:fps];
+    
+    if (self = [self initWithTimeline:timeline])
+        _ownsTimeline = YES; // nobody else knows about it
+    
+    [timeline release];
+    return self;
+}
+
 - (instancetype)initWithFrame:(SPTexture *)texture fps:(float)fps
 {
     return [self initWithFrames:@[texture] fps:fps];
@@ -86,10 +80,7 @@ static SPSoundChannel *nullSound = nil;
 
 - (void)dealloc
 {
-    [_textures release];
-    [_sounds release];
-    [_durations release];
-    [_startTimes release];
+    [_timeline release];
     [super dealloc];
 }
 
@@ -103,6 +94,11 @@ static SPSoundChannel *nullSound = nil;
     return [[[self alloc] initWithFrames:textures fps:fps] autorelease];
 }
 
++ (instancetype)movieWithTimeline:(SPMovieTimeline *)timeline
+{
+    return [[[self alloc] initWithTimeline:timeline] autorelease];
+}
+
 #pragma mark Frame Manipulation Methods
 
 - (void)addFrameWithTexture:(SPTexture *)texture
@@ -122,7 +118,7 @@ static SPSoundChannel *nullSound = nil;
 
 - (void)addFrameWithTexture:(SPTexture *)texture atIndex:(NSInteger)frameID
 {
-    [self addFrameWithTexture:texture duration:_defaultFrameDuration atIndex:frameID];
+    [self addFrameWithTexture:texture duration:_timeline.defaultFrameDuration atIndex:frameID];
 }
 
 - (void)addFrameWithTexture:(SPTexture *)texture duration:(double)duration atIndex:(NSInteger)frameID
@@ -133,14 +129,8 @@ static SPSoundChannel *nullSound = nil;
 - (void)addFrameWithTexture:(SPTexture *)texture duration:(double)duration
                       sound:(SPSoundChannel *)sound atIndex:(NSInteger)frameID
 {
-    [_textures insertObject:texture atIndex:frameID];
-    [_durations insertObject:@(duration) atIndex:frameID];
-    [_sounds insertObject:sound ?: nullSound atIndex:frameID];
-    
-    if (frameID > 0 && frameID == self.numFrames)
-        [_startTimes addObject:@([_startTimes[frameID-1] doubleValue] + [_durations[frameID-1] doubleValue])];
-    else
-        [self updateStartTimes];
+    [editableTimeline(self) insertFrameWithTexture:texture duration:duration sound:sound
+                                           atIndex:frameID];
 }
 
 - (void)removeFrameAtIndex:(NSInteger)frameID
@@ -151,19 +141,12 @@ static SPSoundChannel *nullSound = nil;
     if (self.numFrames == 1)
         [NSException raise:SPExceptionInvalidOperation format:@"Movie clip must not be empty"];
     
-    [_textures removeObjectAtIndex:frameID];
-    [_durations removeObjectAtIndex:frameID];
-    [_sounds removeObjectAtIndex:frameID];
-    
-    [self updateStartTimes];
+    [editableTimeline(self) removeFrameAtIndex:frameID];
 }
 
 - (SPTexture *)textureAtIndex:(NSInteger)frameID
 {
-    if (frameID < 0 || frameID >= self.numFrames)
-        [NSException raise:SPExceptionIndexOutOfBounds format:@"Invalid frame id"];
-    
-    return _textures[frameID];
+    return [_timeline textureAtIndex:frameID];
 }
 
 - (void)setTexture:(SPTexture *)texture atIndex:(NSInteger)frameID
@@ -171,17 +154,12 @@ static SPSoundChannel *nullSound = nil;
     if (frameID < 0 || frameID >= self.numFrames)
         [NSException raise:SPExceptionIndexOutOfBounds format:@"Invalid frame id"];
     
-    _textures[frameID] = texture;
+    [editableTimeline(self) setTexture:texture atIndex:frameID];
 }
 
 - (SPSoundChannel *)soundAtIndex:(NSInteger)frameID
 {
-    if (frameID < 0 || frameID >= self.numFrames)
-        [NSException raise:SPExceptionIndexOutOfBounds format:@"Invalid frame id"];
-    
-    id sound = _sounds[frameID];
-    if (nullSound != sound) return sound;
-    else return nil;
+    return [_timeline soundAtIndex:frameID];
 }
 
 - (void)setSound:(SPSoundChannel *)sound atIndex:(NSInteger)frameID
@@ -189,15 +167,12 @@ static SPSoundChannel *nullSound = nil;
     if (frameID < 0 || frameID >= self.numFrames)
         [NSException raise:SPExceptionIndexOutOfBounds format:@"Invalid frame id"];
     
-    _sounds[frameID] = sound ?: nullSound;
+    [editableTimeline(self) setSound:sound atIndex:frameID];
 }
 
 - (double)durationAtIndex:(NSInteger)frameID
 {
-    if (frameID < 0 || frameID >= self.numFrames)
-        [NSException raise:SPExceptionIndexOutOfBounds format:@"Invalid frame id"];
-    
-    return [_durations[frameID] doubleValue];
+    return [_timeline durationAtIndex:frameID];
 }
 
 - (void)setDuration:(double)duration atIndex:(NSInteger)frameID
@@ -205,19 +180,14 @@ static SPSoundChannel *nullSound = nil;
     if (frameID < 0 || frameID >= self.numFrames)
         [NSException raise:SPExceptionIndexOutOfBounds format:@"Invalid frame id"];
     
-    _durations[frameID] = @(duration);
-    [self updateStartTimes];
+    [editableTimeline(self) setDuration:duration atIndex:frameID];
 }
 
 - (void)reverseFrames
 {
-    SP_RELEASE_AND_COPY_MUTABLE(_textures,  [[_textures  reverseObjectEnumerator] allObjects]);
-    SP_RELEASE_AND_COPY_MUTABLE(_sounds,    [[_sounds    reverseObjectEnumerator] allObjects]);
-    SP_RELEASE_AND_COPY_MUTABLE(_durations, [[_durations reverseObjectEnumerator] allObjects]);
+    [editableTimeline(self) reverseFrames];
     
-    [self updateStartTimes];
-    
-    _currentTime = _totalTime - _currentTime;
+    _currentTime = self.totalTime - _currentTime;
     _currentFrame = self.numFrames - _currentFrame - 1;
 }
 
@@ -242,31 +212,23 @@ static SPSoundChannel *nullSound = nil;
 
 #pragma mark Private
 
-- (void)updateStartTimes
-{
-    NSInteger numFrames = self.numFrames;
-    
-    [_startTimes removeAllObjects];
-    _startTimes[0] = @0;
-    
-    for (int i=1; i<numFrames; ++i)
-        _startTimes[i] = @([_startTimes[i-1] doubleValue] + [_durations[i-1] doubleValue]);
-    
-    _totalTime = [_startTimes[numFrames-1] doubleValue] + [_durations[numFrames-1] doubleValue];
-}
-
 - (void)updateCurrentFrame
 {
-    self.texture = _textures[_currentFrame];
+    self.texture = [_timeline textureAtIndex:_currentFrame];
 }
 
 - (void)playSound:(NSInteger)frame
 {
     if (_muted) return;
+    [[_timeline soundAtIndex:frame] play];
+}
+
+- (void)playSoundsFrom:(NSInteger)firstFrame to:(NSInteger)lastFrame
+{
+    if (_muted || !_timeline.hasSounds) return;
     
-    SPSoundChannel *sound = _sounds[frame];
-    if (nullSound != sound)
-        [sound play];
+    for (NSInteger i=firstFrame; i<=lastFrame; ++i)
+        [[_timeline soundAtIndex:i] play];
 }
 
 #pragma mark SPAnimatable
@@ -275,7 +237,9 @@ static SPSoundChannel *nullSound = nil;
 {
     if (!_playing || passedTime <= 0.0) return;
     
-    NSInteger finalFrame;
+    SPMovieTimeline *timeline = _timeline;
+    double totalTime = timeline.totalTime;
+    NSInteger finalFrame = timeline.numFrames - 1;
     NSInteger previousFrame = _currentFrame;
     double restTime = 0.0;
     BOOL dispatchCompleteEvent = NO;
@@ -289,50 +253,51 @@ static SPSoundChannel *nullSound = nil;
         [self playSound:_currentFrame];
     }
     
-    if (_loop && _currentTime >= _totalTime)
+    if (_loop && _currentTime >= totalTime)
     {
         _currentTime = 0.0;
         _currentFrame = 0;
     }
     
-    if (_currentTime < _totalTime)
+    if (_currentTime < totalTime)
     {
         _currentTime += passedTime;
-        finalFrame = _textures.count - 1;
         
-        while (_currentTime > ([_startTimes[_currentFrame] doubleValue] + [_durations[_currentFrame] doubleValue]))
+        while (_currentTime > totalTime)
         {
-            if (_currentFrame == finalFrame)
+            // we passed the end: every remaining frame has been entered.
+            [self playSoundsFrom:_currentFrame + 1 to:finalFrame];
+            
+            if (_loop && ![self hasEventListenerForType:SPEventTypeCompleted])
             {
-                if (_loop && ![self hasEventListenerForType:SPEventTypeCompleted])
-                {
-                    _currentTime -= _totalTime;
-                    _currentFrame = 0;
-                }
-                else
-                {
-                    restTime = _currentTime - _totalTime;
-                    dispatchCompleteEvent = true;
-                    _currentFrame = finalFrame;
-                    _currentTime = _totalTime;
-                    break;
-                }
+                _currentTime -= totalTime;
+                _currentFrame = 0;
+                [self playSound:0];
             }
             else
             {
-                _currentFrame++;
+                restTime = _currentTime - totalTime;
+                dispatchCompleteEvent = true;
+                _currentFrame = finalFrame;
+                _currentTime = totalTime;
+                break;
             }
-            
-            [self playSound:_currentFrame];
+        }
+        
+        if (!dispatchCompleteEvent)
+        {
+            NSInteger frame = [timeline frameAtTime:_currentTime startingAtFrame:_currentFrame];
+            [self playSoundsFrom:_currentFrame + 1 to:frame];
+            _currentFrame = frame;
         }
         
         // special case when we reach *exactly* the total time.
-        if (_currentFrame == finalFrame && _currentTime == _totalTime)
+        if (_currentFrame == finalFrame && _currentTime == totalTime)
             dispatchCompleteEvent = true;
     }
     
     if (_currentFrame != previousFrame)
-        self.texture = _textures[_currentFrame];
+        self.texture = [timeline textureAtIndex:_currentFrame];
     
     if (dispatchCompleteEvent)
         [self dispatchEventWithType:SPEventTypeCompleted];
@@ -345,48 +310,56 @@ static SPSoundChannel *nullSound = nil;
 
 - (NSInteger)numFrames
 {
-    return _textures.count;
+    return _timeline.numFrames;
+}
+
+- (double)totalTime
+{
+    return _timeline.totalTime;
+}
+
+- (SPMovieTimeline *)timeline
+{
+    _ownsTimeline = NO; // from now on, it's shared
+    return _timeline;
 }
 
 - (void)setCurrentFrame:(NSInteger)value
 {
+    _currentTime = [_timeline startTimeAtIndex:value];
     _currentFrame = value;
-    _currentTime = 0.0;
     
-    for (int i=0; i<value; ++i)
-        _currentTime += [self durationAtIndex:i];
-    
-    self.texture = _textures[_currentFrame];
+    self.texture = [_timeline textureAtIndex:_currentFrame];
     if (_playing && !_wasStopped) [self playSound:_currentFrame];
 }
 
 - (float)fps
 {
-	return (float)(1.0 / _defaultFrameDuration);
+	return (float)(1.0 / _timeline.defaultFrameDuration);
 }
 
 - (void)setFps:(float)fps
 {
     float newFrameDuration = (fps == 0.0f ? INT_MAX : 1.0 / fps);
-	float acceleration = newFrameDuration / _defaultFrameDuration;
+	float acceleration = newFrameDuration / _timeline.defaultFrameDuration;
     _currentTime *= acceleration;
-    _defaultFrameDuration = newFrameDuration;
-
-	for (NSInteger i=0; i<self.numFrames; ++i)
-		[self setDuration:[self durationAtIndex:i] * acceleration atIndex:i];
+    
+    SPMovieTimeline *timeline = editableTimeline(self);
+    timeline.defaultFrameDuration = newFrameDuration;
+    [timeline scaleDurationsBy:acceleration];
 }
 
 - (BOOL)isPlaying
 {
     if (_playing)
-        return _loop || _currentTime < _totalTime;
+        return _loop || _currentTime < self.totalTime;
     else
         return NO;
 }
 
 - (BOOL)isComplete
 {
-    return !_loop && _currentTime >= _totalTime;
+    return !_loop && _currentTime >= self.totalTime;
 }
 
 #pragma mark NSCopying
@@ -395,18 +368,16 @@ static SPSoundChannel *nullSound = nil;
 {
     SPMovieClip *movie = [super copyWithZone:zone];
     
-    SP_RELEASE_AND_COPY_MUTABLE(movie->_textures, _textures);
-    SP_RELEASE_AND_COPY_MUTABLE(movie->_durations, _durations);
-    SP_RELEASE_AND_COPY_MUTABLE(movie->_sounds, _sounds);
+    // both clips share the timeline now; the first one to edit it creates a copy.
+    SP_RELEASE_AND_RETAIN(movie->_timeline, _timeline);
+    movie->_ownsTimeline = _ownsTimeline = NO;
     
-    movie->_defaultFrameDuration = _defaultFrameDuration;
     movie->_currentTime = _currentTime;
     movie->_loop = _loop;
     movie->_playing = _playing;
     movie->_muted = _muted;
     movie->_currentFrame = _currentFrame;
     
-    [movie updateStartTimes];
     [movie updateCurrentFrame];
     
     return movie;
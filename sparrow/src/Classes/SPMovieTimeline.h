@@ -0,0 +1,90 @@
+//
+//  SPMovieTimeline.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 09.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import <Sparrow/SparrowBase.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class SPSoundChannel;
+@class SPTexture;
+
+/** ------------------------------------------------------------------------------------------------
+
+ An SPMovieTimeline contains the frames of a movie clip: their textures, durations and sounds.
+
+ Timelines are immutable, which allows any number of movie clips to share the same one. That's
+ useful when there are many instances of the same animation (think of a horde of enemies):
+ instead of each clip storing its own copy of the frames, they all reference a single timeline.
+
+	SPMovieTimeline *walk = [SPMovieTimeline timelineWithTextures:textures fps:12];
+
+	for (int i=0; i<1000; ++i)
+	    [enemies addChild:[SPMovieClip movieWithTimeline:walk]];
+
+ Modifying the frames of a movie clip that shares its timeline will create a private copy of
+ the timeline for that clip; the others are not affected. You can also share the timeline of an
+ existing clip through its `timeline` property.
+
+ The start times of all frames are stored in a sorted array, so the frame at a certain time is
+ found with a binary search.
+
+------------------------------------------------------------------------------------------------- */
+
+@interface SPMovieTimeline : NSObject <NSCopying>
+
+/// --------------------
+/// @name Initialization
+/// --------------------
+
+/// Initializes a timeline with an array of textures, each of them displayed for `1 / fps`
+/// seconds. _Designated Initializer_.
+- (instancetype)initWithTextures:(SP_GENERIC(NSArray, SPTexture*) *)textures fps:(float)fps;
+
+/// Factory method.
++ (instancetype)timelineWithTextures:(SP_GENERIC(NSArray, SPTexture*) *)textures fps:(float)fps;
+
+/// -------------
+/// @name Methods
+/// -------------
+
+/// Returns the texture of a frame at a certain index.
+- (SPTexture *)textureAtIndex:(NSInteger)frameID;
+
+/// Returns the sound of a frame at a certain index.
+- (nullable SPSoundChannel *)soundAtIndex:(NSInteger)frameID;
+
+/// Returns the duration (in seconds) of a frame at a certain index.
+- (double)durationAtIndex:(NSInteger)frameID;
+
+/// Returns the time (in seconds) at which a certain frame starts.
+- (double)startTimeAtIndex:(NSInteger)frameID;
+
+/// Returns the index of the frame that is displayed at a certain time. A frame is displayed from
+/// (excluding) its start time up to (including) its end time; times outside the timeline are
+/// clamped to the first or last frame.
+- (NSInteger)frameAtTime:(double)time;
+
+/// ----------------
+/// @name Properties
+/// ----------------
+
+/// The number of frames.
+@property (nonatomic, readonly) NSInteger numFrames;
+
+/// The total duration of all frames in seconds.
+@property (nonatomic, readonly) double totalTime;
+
+/// The default number of frames per second, used for frames that are added without a duration.
+@property (nonatomic, readonly) float fps;
+
+@end
+
+NS_ASSUME_NONNULL_END
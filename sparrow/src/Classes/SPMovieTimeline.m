@@ -0,0 +1,307 @@
+//
+//  SPMovieTimeline.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 09.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPMacros.h"
+#import "SPMovieTimeline_Internal.h"
+#import "SPSoundChannel.h"
+#import "SPTexture.h"
+
+// --- class implementation ------------------------------------------------------------------------
+
+@implementation SPMovieTimeline
+{
+    SPTexture **_textures;
+    SPSoundChannel **_sounds;   // NULL entries for frames without sound
+    double *_durations;
+    double *_startTimes;        // numFrames + 1 entries; the last one is the total time
+    NSInteger _numFrames;
+    NSInteger _capacity;
+    NSInteger _numSounds;
+    double _defaultFrameDuration;
+}
+
+static void setCapacity(SPMovieTimeline *self, NSInteger capacity)
+{
+    self->_capacity = capacity;
+    self->_textures   = realloc(self->_textures,   sizeof(SPTexture *) * capacity);
+    self->_sounds     = realloc(self->_sounds,     sizeof(SPSoundChannel *) * capacity);
+    self->_durations  = realloc(self->_durations,  sizeof(double) * capacity);
+    self->_startTimes = realloc(self->_startTimes, sizeof(double) * (capacity + 1));
+}
+
+static void updateStartTimes(SPMovieTimeline *self, NSInteger fromFrame)
+{
+    double *startTimes = self->_startTimes;
+    double *durations = self->_durations;
+
+    if (fromFrame == 0) startTimes[0] = 0.0;
+
+    for (NSInteger i=MAX(fromFrame, 0); i<self->_numFrames; ++i)
+        startTimes[i+1] = startTimes[i] + durations[i];
+}
+
+static void validateFrameID(SPMovieTimeline *self, NSInteger frameID)
+{
+    if (frameID < 0 || frameID >= self->_numFrames)
+        [NSException raise:SPExceptionIndexOutOfBounds format:@"Invalid frame id"];
+}
+
+#pragma mark Initialization
+
+- (instancetype)initWithTextures:(SP_GENERIC(NSArray, SPTexture*) *)textures fps:(float)fps
+{
+    if (textures.count == 0)
+        [NSException raise:SPExceptionInvalidOperation format:@"empty texture array"];
+
+    if (fps < 0)
+        [NSException raise:SPExceptionInvalidOperation format:@"Invalid fps: %f", fps];
+
+    if ((self = [super init]))
+    {
+        _numFrames = textures.count;
+        _defaultFrameDuration = 1.0f / fps;
+        setCapacity(self, _numFrames);
+
+        for (NSInteger i=0; i<_numFrames; ++i)
+        {
+            _textures[i] = [textures[i] retain];
+            _sounds[i] = nil;
+            _durations[i] = _defaultFrameDuration;
+        }
+
+        updateStartTimes(self, 0);
+    }
+    return self;
+}
+
+- (instancetype)initWithTimeline:(SPMovieTimeline *)timeline
+{
+    if ((self = [super init]))
+    {
+        _numFrames = timeline->_numFrames;
+        _numSounds = timeline->_numSounds;
+        _defaultFrameDuration = timeline->_defaultFrameDuration;
+        setCapacity(self, _numFrames);
+
+        memcpy(_durations,  timeline->_durations,  sizeof(double) * _numFrames);
+        memcpy(_startTimes, timeline->_startTimes, sizeof(double) * (_numFrames + 1));
+
+        for (NSInteger i=0; i<_numFrames; ++i)
+        {
+            _textures[i] = [timeline->_textures[i] retain];
+            _sounds[i] = [timeline->_sounds[i] retain];
+        }
+    }
+    return self;
+}
+
+- (instancetype)init
+{
+    SP_USE_DESIGNATED_INITIALIZER(initWithTextures:fps:);
+    return nil;
+}
+
+- (void)dealloc
+{
+    for (NSInteger i=0; i<_numFrames; ++i)
+    {
+        [_textures[i] release];
+        [_sounds[i] release];
+    }
+
+    free(_textures);
+    free(_sounds);
+    free(_durations);
+    free(_startTimes);
+    [super dealloc];
+}
+
++ (instancetype)timelineWithTextures:(SP_GENERIC(NSArray, SPTexture*) *)textures fps:(float)fps
+{
+    return [[[self alloc] initWithTextures:textures fps:fps] autorelease];
+}
+
+#pragma mark Methods
+
+- (SPTexture *)textureAtIndex:(NSInteger)frameID
+{
+    validateFrameID(self, frameID);
+    return _textures[frameID];
+}
+
+- (SPSoundChannel *)soundAtIndex:(NSInteger)frameID
+{
+    validateFrameID(self, frameID);
+    return _sounds[frameID];
+}
+
+- (double)durationAtIndex:(NSInteger)frameID
+{
+    validateFrameID(self, frameID);
+    return _durations[frameID];
+}
+
+- (double)startTimeAtIndex:(NSInteger)frameID
+{
+    validateFrameID(self, frameID);
+    return _startTimes[frameID];
+}
+
+- (NSInteger)frameAtTime:(double)time
+{
+    return [self frameAtTime:time startingAtFrame:0];
+}
+
+#pragma mark Internal
+
+- (NSInteger)frameAtTime:(double)time startingAtFrame:(NSInteger)frameID
+{
+    // find the first frame that ends at or after 'time' (frame 'i' ends at '_startTimes[i+1]')
+    NSInteger low = MAX(0, MIN(frameID, _numFrames - 1));
+    NSInteger high = _numFrames - 1;
+
+    while (low < high)
+    {
+        NSInteger mid = (low + high) / 2;
+        if (_startTimes[mid+1] < time) low = mid + 1;
+        else high = mid;
+    }
+
+    return low;
+}
+
+- (void)insertFrameWithTexture:(SPTexture *)texture duration:(double)duration
+                         sound:(SPSoundChannel *)sound atIndex:(NSInteger)frameID
+{
+    if (frameID < 0 || frameID > _numFrames)
+        [NSException raise:SPExceptionIndexOutOfBounds format:@"Invalid frame id"];
+
+    if (_numFrames == _capacity)
+        setCapacity(self, MAX(4, _capacity * 2));
+
+    NSInteger numMoved = _numFrames - frameID;
+    memmove(_textures  + frameID + 1, _textures  + frameID, sizeof(SPTexture *) * numMoved);
+    memmove(_sounds    + frameID + 1, _sounds    + frameID, sizeof(SPSoundChannel *) * numMoved);
+    memmove(_durations + frameID + 1, _durations + frameID, sizeof(double) * numMoved);
+
+    _textures[frameID] = [texture retain];
+    _sounds[frameID] = [sound retain];
+    _durations[frameID] = duration;
+    if (sound) ++_numSounds;
+
+    ++_numFrames;
+    updateStartTimes(self, frameID);
+}
+
+- (void)removeFrameAtIndex:(NSInteger)frameID
+{
+    validateFrameID(self, frameID);
+
+    [_textures[frameID] release];
+    if (_sounds[frameID]) --_numSounds;
+    [_sounds[frameID] release];
+
+    NSInteger numMoved = _numFrames - frameID - 1;
+    memmove(_textures  + frameID, _textures  + frameID + 1, sizeof(SPTexture *) * numMoved);
+    memmove(_sounds    + frameID, _sounds    + frameID + 1, sizeof(SPSoundChannel *) * numMoved);
+    memmove(_durations + frameID, _durations + frameID + 1, sizeof(double) * numMoved);
+
+    --_numFrames;
+    updateStartTimes(self, frameID);
+}
+
+- (void)setTexture:(SPTexture *)texture atIndex:(NSInteger)frameID
+{
+    validateFrameID(self, frameID);
+    SP_RELEASE_AND_RETAIN(_textures[frameID], texture);
+}
+
+- (void)setSound:(SPSoundChannel *)sound atIndex:(NSInteger)frameID
+{
+    validateFrameID(self, frameID);
+
+    if (_sounds[frameID]) --_numSounds;
+    if (sound) ++_numSounds;
+
+    SP_RELEASE_AND_RETAIN(_sounds[frameID], sound);
+}
+
+- (void)setDuration:(double)duration atIndex:(NSInteger)frameID
+{
+    validateFrameID(self, frameID);
+
+    _durations[frameID] = duration;
+    updateStartTimes(self, frameID);
+}
+
+- (void)scaleDurationsBy:(double)factor
+{
+    for (NSInteger i=0; i<_numFrames; ++i)
+        _durations[i] *= factor;
+
+    updateStartTimes(self, 0);
+}
+
+- (void)reverseFrames
+{
+    for (NSInteger i=0, j=_numFrames-1; i<j; ++i, --j)
+    {
+        SPTexture *texture = _textures[i];
+        _textures[i] = _textures[j];
+        _textures[j] = texture;
+
+        SPSoundChannel *sound = _sounds[i];
+        _sounds[i] = _sounds[j];
+        _sounds[j] = sound;
+
+        double duration = _durations[i];
+        _durations[i] = _durations[j];
+        _durations[j] = duration;
+    }
+
+    updateStartTimes(self, 0);
+}
+
+#pragma mark NSCopying
+
+- (instancetype)copyWithZone:(NSZone *)zone
+{
+    return [self retain];
+}
+
+#pragma mark Properties
+
+- (double)totalTime
+{
+    return _startTimes[_numFrames];
+}
+
+- (float)fps
+{
+    return (float)(1.0 / _defaultFrameDuration);
+}
+
+- (double)defaultFrameDuration
+{
+    return _defaultFrameDuration;
+}
+
+- (void)setDefaultFrameDuration:(double)defaultFrameDuration
+{
+    _defaultFrameDuration = defaultFrameDuration;
+}
+
+- (BOOL)hasSounds
+{
+    return _numSounds > 0;
+}
+
+@end
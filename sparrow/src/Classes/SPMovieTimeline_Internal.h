@@ -0,0 +1,44 @@
+//
+//  SPMovieTimeline_Internal.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 09.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPMovieTimeline.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Timelines are only modified by the movie clip that owns them exclusively; everybody else
+/// gets to see an immutable object.
+@interface SPMovieTimeline (Internal)
+
+/// Initializes a timeline with copies of the frames of another one.
+- (instancetype)initWithTimeline:(SPMovieTimeline *)timeline;
+
+/// Returns the index of the frame displayed at a certain time, starting the search at a frame
+/// known to end before (or at) that time.
+- (NSInteger)frameAtTime:(double)time startingAtFrame:(NSInteger)frameID;
+
+- (void)insertFrameWithTexture:(SPTexture *)texture duration:(double)duration
+                         sound:(nullable SPSoundChannel *)sound atIndex:(NSInteger)frameID;
+- (void)removeFrameAtIndex:(NSInteger)frameID;
+- (void)setTexture:(SPTexture *)texture atIndex:(NSInteger)frameID;
+- (void)setSound:(nullable SPSoundChannel *)sound atIndex:(NSInteger)frameID;
+- (void)setDuration:(double)duration atIndex:(NSInteger)frameID;
+- (void)scaleDurationsBy:(double)factor;
+- (void)reverseFrames;
+
+/// The duration of frames that are added without one.
+@property (nonatomic, assign) double defaultFrameDuration;
+
+/// Indicates if any frame has a sound.
+@property (nonatomic, readonly) BOOL hasSounds;
+
+@end
+
+NS_ASSUME_NONNULL_END
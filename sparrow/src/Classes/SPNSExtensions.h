@@ -131,6 +131,7 @@ typedef void (^SPXMLElementHandler)(NSString *elementName, SP_GENERIC(NSDictiona
 
 /// Makes XML parsing a whole lot easier by forwarding each element and its attributes to a block,
 /// which is totally sufficient for Sparrow's file formats. Note that the delegate is not used.
+/// Sparrow itself now uses `SPXMLReader`, which parses the same files without creating objects.
 - (BOOL)parseElementsWithBlock:(SPXMLElementHandler)elementHandler;
 
 @end
@@ -310,7 +310,11 @@ static char encodingTable[64] = {
 + (instancetype)dataWithUncompressedContentsOfFile:(NSString *)file
 {
     if ([[file pathExtension] isEqualToString:@"gz"])
-        return [[NSData dataWithContentsOfFile:file] gzipInflate];
+    {
+        NSData *compressedData = [NSData dataWithContentsOfFile:file options:NSDataReadingMappedIfSafe
+                                                          error:nil];
+        return [compressedData gzipInflate];
+    }
     else
         return [NSData dataWithContentsOfFile:file];
 }
@@ -363,8 +367,19 @@ static char encodingTable[64] = {
     
     NSUInteger full_length = [self length];
     NSUInteger half_length = [self length] / 2;
+    NSUInteger initial_length = full_length + half_length;
+
+    // a gzip stream ends with its uncompressed size (modulo 2^32). Starting out with that size
+    // (limited by the maximum deflate ratio), the buffer won't have to grow for regular files.
+    const uchar *bytes = [self bytes];
+    if (full_length > 18 && bytes[0] == 0x1f && bytes[1] == 0x8b)
+    {
+        const uchar *size = bytes + full_length - 4;
+        NSUInteger uncompressed_length = size[0] | size[1] << 8 | size[2] << 16 | (uint)size[3] << 24;
+        if (uncompressed_length) initial_length = MIN(uncompressed_length, full_length * 1032);
+    }
     
-    NSMutableData *decompressed = [NSMutableData dataWithLength:full_length + half_length];
+    NSMutableData *decompressed = [NSMutableData dataWithLength:initial_length];
     BOOL done = NO;
     int status;
     
@@ -395,7 +410,7 @@ static char encodingTable[64] = {
     if (done)
     {
         [decompressed setLength: strm.total_out];
-        return [NSData dataWithData: decompressed];
+        return decompressed;
     }
     else return nil;
 }
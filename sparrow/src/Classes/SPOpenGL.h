@@ -58,6 +58,34 @@ SP_EXTERN const char* sglGetErrorString(uint error);
     #define glIsVertexArray             glIsVertexArrayOES
 #endif
 
+/// compressed texture formats that are missing in older SDKs
+
+#ifndef GL_COMPRESSED_RGBA_ASTC_4x4_KHR
+    #define GL_COMPRESSED_RGBA_ASTC_4x4_KHR     0x93B0
+    #define GL_COMPRESSED_RGBA_ASTC_5x4_KHR     0x93B1
+    #define GL_COMPRESSED_RGBA_ASTC_5x5_KHR     0x93B2
+    #define GL_COMPRESSED_RGBA_ASTC_6x5_KHR     0x93B3
+    #define GL_COMPRESSED_RGBA_ASTC_6x6_KHR     0x93B4
+    #define GL_COMPRESSED_RGBA_ASTC_8x5_KHR     0x93B5
+    #define GL_COMPRESSED_RGBA_ASTC_8x6_KHR     0x93B6
+    #define GL_COMPRESSED_RGBA_ASTC_8x8_KHR     0x93B7
+    #define GL_COMPRESSED_RGBA_ASTC_10x5_KHR    0x93B8
+    #define GL_COMPRESSED_RGBA_ASTC_10x6_KHR    0x93B9
+    #define GL_COMPRESSED_RGBA_ASTC_10x8_KHR    0x93BA
+    #define GL_COMPRESSED_RGBA_ASTC_10x10_KHR   0x93BB
+    #define GL_COMPRESSED_RGBA_ASTC_12x10_KHR   0x93BC
+    #define GL_COMPRESSED_RGBA_ASTC_12x12_KHR   0x93BD
+#endif
+
+#ifndef GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR
+    #define GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR     0x93D0
+    #define GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR   0x93DD
+#endif
+
+#ifndef GL_ETC1_RGB8_OES
+    #define GL_ETC1_RGB8_OES                    0x8D64
+#endif
+
 /// debug utils
 
 #define SP_FORCE_DEBUG_MARKERS 0
@@ -14,7 +14,10 @@
 
 NS_ASSUME_NONNULL_BEGIN
 
-/// A class that can be used to parse PVR texture data.
+/// A class that can be used to parse PVR texture data. Besides legacy PVR (v2) files, it reads
+/// PVR v3, KTX and KTX2 containers with a single 2D texture (including its mipmaps). The mipmaps
+/// are not copied; they point right into the loaded data. The only exception are KTX levels with
+/// padded rows, which are copied, since the rows of all levels are tightly packed.
 @interface SPPVRData : NSObject
 
 /// --------------------
@@ -27,11 +30,32 @@ NS_ASSUME_NONNULL_BEGIN
 /// Initialzes the object with PVR data that's optional GZIP compressed.
 - (instancetype)initWithData:(NSData *)data compressed:(BOOL)isCompressed;
 
+/// Initializes the object with PVR data that's optional GZIP compressed, ignoring a number of
+/// the largest mipmap levels. At least one level is always kept. _Designated Initializer_.
+- (instancetype)initWithData:(NSData *)data compressed:(BOOL)isCompressed
+           numSkippedMipmaps:(NSInteger)numSkippedMipmaps;
+
+/// Initializes the object with the contents of a PVR file; files with the extension `.gz` are
+/// inflated. Uncompressed files are memory-mapped instead of being copied. The path has to
+/// be absolute.
+- (instancetype)initWithContentsOfFile:(NSString *)path;
+
+/// Initializes the object with the contents of a PVR file, ignoring a number of the largest
+/// mipmap levels.
+- (instancetype)initWithContentsOfFile:(NSString *)path numSkippedMipmaps:(NSInteger)numSkippedMipmaps;
+
+/// -------------
+/// @name Methods
+/// -------------
+
+/// Returns a pointer to the raw data of a certain mipmap level (level 0 being the largest).
+- (const void *)imageDataOfMipmap:(NSInteger)level;
+
 /// ----------------
 /// @name Properties
 /// ----------------
 
-/// The width of the PVR texture in pixels.
+/// The width of the PVR texture in pixels (of the largest level that was not skipped).
 @property (nonatomic, readonly) NSInteger width;
 
 /// The height of the PVR texture in pixels.
@@ -43,9 +67,19 @@ NS_ASSUME_NONNULL_BEGIN
 /// The texture format of the PVR texture.
 @property (nonatomic, readonly) SPTextureFormat format;
 
-/// A pointer to the raw image data of the PVR data.
+/// Indicates if the color channels of the texture are premultiplied with its alpha channel.
+/// Only PVR v3 and KTX2 files store that information.
+@property (nonatomic, readonly) BOOL premultipliedAlpha;
+
+/// The number of mipmap levels that were actually skipped.
+@property (nonatomic, readonly) NSInteger numSkippedMipmaps;
+
+/// A pointer to the raw image data of the largest mipmap level.
 @property (nonatomic, readonly) void *imageData;
 
+/// The size of the raw image data in bytes, including all mipmaps.
+@property (nonatomic, readonly) NSUInteger imageDataSize;
+
 @end
 
 NS_ASSUME_NONNULL_END
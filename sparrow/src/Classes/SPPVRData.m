@@ -6,12 +6,18 @@
 //
 //
 
+#import "SPGLTexture_Internal.h"
 #import "SPMacros.h"
-#import "SPPVRData.h"
 #import "SPNSExtensions.h"
+#import "SPOpenGL.h"
+#import "SPPVRData.h"
+
+#import <zlib.h>
 
 // --- PVR structs & enums -------------------------------------------------------------------------
 
+#define MAX_LEVELS 32
+
 #define PVRTEX_IDENTIFIER 0x21525650 // = the characters 'P', 'V', 'R'
 
 typedef struct
@@ -47,11 +53,534 @@ enum PVRPixelType
     OGL_A_8
 };
 
+#define PVR3_IDENTIFIER 0x03525650 // = the characters 'P', 'V', 'R', 3
+#define PVR3_FLAG_PREMULTIPLIED 0x02
+
+typedef struct __attribute__((packed))
+{
+    uint32_t version;         // PVR3_IDENTIFIER
+    uint32_t flags;           // PVR3_FLAG_PREMULTIPLIED
+    uint64_t pixelFormat;     // a compressed format or the channel names & bit counts
+    uint32_t colorSpace;
+    uint32_t channelType;
+    uint32_t height;
+    uint32_t width;
+    uint32_t depth;
+    uint32_t numSurfaces;
+    uint32_t numFaces;
+    uint32_t numMipmaps;      // including the base level
+    uint32_t metaDataSize;
+} PVRTextureHeaderV3;
+
+#define PVR3_PIXEL_FORMAT(c0, c1, c2, c3, b0, b1, b2, b3) \
+    ((uint64_t)(c0)       | (uint64_t)(c1) << 8  | (uint64_t)(c2) << 16 | (uint64_t)(c3) << 24 | \
+     (uint64_t)(b0) << 32 | (uint64_t)(b1) << 40 | (uint64_t)(b2) << 48 | (uint64_t)(b3) << 56)
+
+enum PVR3PixelFormat
+{
+    PVR3_PVRTC_2BPP_RGB = 0,
+    PVR3_PVRTC_2BPP_RGBA,
+    PVR3_PVRTC_4BPP_RGB,
+    PVR3_PVRTC_4BPP_RGBA,
+    PVR3_ETC1 = 6,
+    PVR3_ETC2_RGB = 22,
+    PVR3_ETC2_RGBA,
+    PVR3_ETC2_RGB_A1,
+    PVR3_EAC_R11,
+    PVR3_EAC_RG11,
+    PVR3_ASTC_4x4,
+    PVR3_ASTC_12x12 = 40
+};
+
+// --- KTX structs & enums -------------------------------------------------------------------------
+
+static const uint8_t KTX1_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+static const uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+#define KTX_ENDIANNESS 0x04030201
+#define KTX2_FLAG_PREMULTIPLIED 0x01 // in the flags of the data format descriptor
+
+typedef struct
+{
+    uint8_t  identifier[12];
+    uint32_t endianness;
+    uint32_t glType;          // zero for compressed textures
+    uint32_t glTypeSize;
+    uint32_t glFormat;
+    uint32_t glInternalFormat;
+    uint32_t glBaseInternalFormat;
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t numArrayElements;
+    uint32_t numFaces;
+    uint32_t numMipmaps;      // including the base level; zero to request generated mipmaps
+    uint32_t keyValueDataSize;
+} KTXHeader;
+
+typedef struct
+{
+    uint8_t  identifier[12];
+    uint32_t vkFormat;
+    uint32_t typeSize;
+    uint32_t width;
+    uint32_t height;
+    uint32_t depth;
+    uint32_t numLayers;
+    uint32_t numFaces;
+    uint32_t numLevels;       // including the base level; zero to request generated mipmaps
+    uint32_t supercompressionScheme;
+    uint32_t dfdOffset;       // data format descriptor
+    uint32_t dfdSize;
+    uint32_t kvdOffset;       // key/value data
+    uint32_t kvdSize;
+    uint64_t sgdOffset;       // supercompression global data
+    uint64_t sgdSize;
+} KTX2Header;
+
+typedef struct
+{
+    uint64_t offset;
+    uint64_t size;
+    uint64_t uncompressedSize;
+} KTX2LevelIndex;
+
+enum VkFormat
+{
+    VK_R4G4B4A4 = 2,
+    VK_R5G6B5 = 4,
+    VK_R5G5B5A1 = 6,
+    VK_R8G8B8 = 23,
+    VK_R8G8B8A8 = 37,
+    VK_ETC2_RGB = 147,        // the sRGB variant of each compressed format follows directly
+    VK_ETC2_RGB_A1 = 149,
+    VK_ETC2_RGBA = 151,
+    VK_EAC_R11 = 153,
+    VK_EAC_RG11 = 155,
+    VK_ASTC_4x4 = 157,
+    VK_ASTC_12x12 = 183,
+    VK_PVRTC1_2BPP = 1000054000,
+    VK_PVRTC1_4BPP = 1000054001
+};
+
+// --- C functions ---------------------------------------------------------------------------------
+
+static void validateHeader(const PVRTextureHeader *header, NSUInteger length)
+{
+    if (length < sizeof(PVRTextureHeader) || header->headerSize < sizeof(PVRTextureHeader) ||
+        (uint64_t)header->headerSize + header->textureDataSize > length)
+        [NSException raise:SPExceptionDataInvalid format:@"Invalid PVR data"];
+}
+
+static BOOL formatFromPVR3(uint64_t pixelFormat, SPTextureFormat *format)
+{
+    if (pixelFormat >= PVR3_ASTC_4x4 && pixelFormat <= PVR3_ASTC_12x12)
+    {
+        *format = SPTextureFormatASTC4x4 + (NSInteger)(pixelFormat - PVR3_ASTC_4x4);
+        return YES;
+    }
+
+    switch (pixelFormat)
+    {
+        case PVR3_PVRTC_2BPP_RGB:  *format = SPTextureFormatPvrtcRGB2;  return YES;
+        case PVR3_PVRTC_2BPP_RGBA: *format = SPTextureFormatPvrtcRGBA2; return YES;
+        case PVR3_PVRTC_4BPP_RGB:  *format = SPTextureFormatPvrtcRGB4;  return YES;
+        case PVR3_PVRTC_4BPP_RGBA: *format = SPTextureFormatPvrtcRGBA4; return YES;
+        case PVR3_ETC1:
+        case PVR3_ETC2_RGB:        *format = SPTextureFormatETC2RGB;    return YES;
+        case PVR3_ETC2_RGBA:       *format = SPTextureFormatETC2RGBA;   return YES;
+        case PVR3_ETC2_RGB_A1:     *format = SPTextureFormatETC2RGBA1;  return YES;
+        case PVR3_EAC_R11:         *format = SPTextureFormatEACR11;     return YES;
+        case PVR3_EAC_RG11:        *format = SPTextureFormatEACRG11;    return YES;
+        case PVR3_PIXEL_FORMAT('r', 'g', 'b', 'a', 8, 8, 8, 8): *format = SPTextureFormatRGBA;  return YES;
+        case PVR3_PIXEL_FORMAT('r', 'g', 'b', 0, 8, 8, 8, 0):   *format = SPTextureFormat888;   return YES;
+        case PVR3_PIXEL_FORMAT('r', 'g', 'b', 0, 5, 6, 5, 0):   *format = SPTextureFormat565;   return YES;
+        case PVR3_PIXEL_FORMAT('r', 'g', 'b', 'a', 5, 5, 5, 1): *format = SPTextureFormat5551;  return YES;
+        case PVR3_PIXEL_FORMAT('r', 'g', 'b', 'a', 4, 4, 4, 4): *format = SPTextureFormat4444;  return YES;
+        case PVR3_PIXEL_FORMAT('a', 0, 0, 0, 8, 0, 0, 0):       *format = SPTextureFormatAlpha; return YES;
+        case PVR3_PIXEL_FORMAT('l', 0, 0, 0, 8, 0, 0, 0):       *format = SPTextureFormatI8;    return YES;
+        case PVR3_PIXEL_FORMAT('l', 'a', 0, 0, 8, 8, 0, 0):     *format = SPTextureFormatAI88;  return YES;
+        default: return NO;
+    }
+}
+
+static BOOL formatFromKTX(const KTXHeader *header, SPTextureFormat *format)
+{
+    uint32_t internalFormat = header->glInternalFormat;
+
+    if (header->glType)
+    {
+        switch (header->glFormat)
+        {
+            case GL_RGBA:
+                if      (header->glType == GL_UNSIGNED_BYTE)          *format = SPTextureFormatRGBA;
+                else if (header->glType == GL_UNSIGNED_SHORT_4_4_4_4) *format = SPTextureFormat4444;
+                else if (header->glType == GL_UNSIGNED_SHORT_5_5_5_1) *format = SPTextureFormat5551;
+                else return NO;
+                return YES;
+            case GL_RGB:
+                if      (header->glType == GL_UNSIGNED_BYTE)          *format = SPTextureFormat888;
+                else if (header->glType == GL_UNSIGNED_SHORT_5_6_5)   *format = SPTextureFormat565;
+                else return NO;
+                return YES;
+            case GL_ALPHA:           *format = SPTextureFormatAlpha; break;
+            case GL_LUMINANCE:       *format = SPTextureFormatI8;    break;
+            case GL_LUMINANCE_ALPHA: *format = SPTextureFormatAI88;  break;
+            default: return NO;
+        }
+
+        return header->glType == GL_UNSIGNED_BYTE;
+    }
+
+    if (internalFormat >= GL_COMPRESSED_RGBA_ASTC_4x4_KHR &&
+        internalFormat <= GL_COMPRESSED_RGBA_ASTC_12x12_KHR)
+    {
+        *format = SPTextureFormatASTC4x4 + (internalFormat - GL_COMPRESSED_RGBA_ASTC_4x4_KHR);
+        return YES;
+    }
+    else if (internalFormat >= GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR &&
+             internalFormat <= GL_COMPRESSED_SRGB8_ALPHA8_ASTC_12x12_KHR)
+    {
+        *format = SPTextureFormatASTC4x4 + (internalFormat - GL_COMPRESSED_SRGB8_ALPHA8_ASTC_4x4_KHR);
+        return YES;
+    }
+
+    switch (internalFormat)
+    {
+        case GL_COMPRESSED_RGB_PVRTC_2BPPV1_IMG:  *format = SPTextureFormatPvrtcRGB2;  return YES;
+        case GL_COMPRESSED_RGBA_PVRTC_2BPPV1_IMG: *format = SPTextureFormatPvrtcRGBA2; return YES;
+        case GL_COMPRESSED_RGB_PVRTC_4BPPV1_IMG:  *format = SPTextureFormatPvrtcRGB4;  return YES;
+        case GL_COMPRESSED_RGBA_PVRTC_4BPPV1_IMG: *format = SPTextureFormatPvrtcRGBA4; return YES;
+        case GL_ETC1_RGB8_OES:
+        case GL_COMPRESSED_RGB8_ETC2:
+        case GL_COMPRESSED_SRGB8_ETC2:            *format = SPTextureFormatETC2RGB;    return YES;
+        case GL_COMPRESSED_RGBA8_ETC2_EAC:
+        case GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC: *format = SPTextureFormatETC2RGBA;   return YES;
+        case GL_COMPRESSED_RGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+        case GL_COMPRESSED_SRGB8_PUNCHTHROUGH_ALPHA1_ETC2:
+                                                  *format = SPTextureFormatETC2RGBA1;  return YES;
+        case GL_COMPRESSED_R11_EAC:               *format = SPTextureFormatEACR11;     return YES;
+        case GL_COMPRESSED_RG11_EAC:              *format = SPTextureFormatEACRG11;    return YES;
+        default: return NO;
+    }
+}
+
+static BOOL formatFromKTX2(uint32_t vkFormat, SPTextureFormat *format)
+{
+    // sRGB data is sampled just like the data of other image files, i.e. without conversion
+
+    if (vkFormat >= VK_ASTC_4x4 && vkFormat <= VK_ASTC_12x12 + 1)
+    {
+        *format = SPTextureFormatASTC4x4 + (vkFormat - VK_ASTC_4x4) / 2;
+        return YES;
+    }
+
+    switch (vkFormat)
+    {
+        case VK_R8G8B8A8:         *format = SPTextureFormatRGBA;       return YES;
+        case VK_R8G8B8:           *format = SPTextureFormat888;        return YES;
+        case VK_R5G6B5:           *format = SPTextureFormat565;        return YES;
+        case VK_R5G5B5A1:         *format = SPTextureFormat5551;       return YES;
+        case VK_R4G4B4A4:         *format = SPTextureFormat4444;       return YES;
+        case VK_ETC2_RGB:
+        case VK_ETC2_RGB + 1:     *format = SPTextureFormatETC2RGB;    return YES;
+        case VK_ETC2_RGB_A1:
+        case VK_ETC2_RGB_A1 + 1:  *format = SPTextureFormatETC2RGBA1;  return YES;
+        case VK_ETC2_RGBA:
+        case VK_ETC2_RGBA + 1:    *format = SPTextureFormatETC2RGBA;   return YES;
+        case VK_EAC_R11:          *format = SPTextureFormatEACR11;     return YES;
+        case VK_EAC_RG11:         *format = SPTextureFormatEACRG11;    return YES;
+        case VK_PVRTC1_2BPP:      *format = SPTextureFormatPvrtcRGBA2; return YES;
+        case VK_PVRTC1_4BPP:      *format = SPTextureFormatPvrtcRGBA4; return YES;
+        default: return NO;
+    }
+}
+
+static NSData *inflateData(NSData *compressedData)
+{
+    // Finds out the size of the inflated data and allocates it right away; the stream is then
+    // inflated into that buffer. Other than 'gzipInflate', this never has to grow (and copy) its
+    // output, so only one copy of the texture is ever kept in memory. GZIP files store the size
+    // in their trailer; for plain zlib streams, it's taken from the legacy PVR header.
+
+    const uint8_t *input = compressedData.bytes;
+    NSUInteger inputLength = compressedData.length;
+
+    z_stream stream = { 0 };
+    stream.next_in = (Bytef *)input;
+    stream.avail_in = (uInt)inputLength;
+
+    if (inflateInit2(&stream, 15 + 32) != Z_OK) // auto-detect gzip or zlib header
+        [NSException raise:SPExceptionDataInvalid format:@"Could not inflate PVR data"];
+
+    PVRTextureHeader header;
+    uint8_t *bytes = NULL;
+    size_t length = 0;
+    int status = Z_OK;
+
+    if (inputLength > 18 && input[0] == 0x1f && input[1] == 0x8b)
+    {
+        // the trailer stores the size modulo 2^32; a manipulated value can't do any harm,
+        // the container is validated afterwards.
+        const uint8_t *trailer = input + inputLength - 4;
+        length = trailer[0] | trailer[1] << 8 | trailer[2] << 16 | (uint32_t)trailer[3] << 24;
+        length = MIN(length, (size_t)inputLength * 1032); // maximum deflate ratio
+    }
+    else
+    {
+        stream.next_out = (Bytef *)&header;
+        stream.avail_out = sizeof(PVRTextureHeader);
+
+        while (stream.avail_out && status == Z_OK)
+            status = inflate(&stream, Z_NO_FLUSH);
+
+        if (!stream.avail_out && header.headerSize >= sizeof(PVRTextureHeader))
+            length = (size_t)header.headerSize + header.textureDataSize;
+    }
+
+    size_t offset = stream.total_out;
+    if (length > offset) bytes = malloc(length);
+
+    if (bytes)
+    {
+        memcpy(bytes, &header, offset);
+        stream.next_out = bytes + offset;
+        stream.avail_out = (uInt)(length - offset);
+
+        while (stream.avail_out && status == Z_OK)
+            status = inflate(&stream, Z_NO_FLUSH);
+    }
+
+    inflateEnd(&stream);
+
+    if (!bytes || stream.avail_out || (status != Z_OK && status != Z_STREAM_END))
+    {
+        free(bytes);
+        [NSException raise:SPExceptionDataInvalid format:@"Invalid compressed PVR data"];
+    }
+
+    return [NSData dataWithBytesNoCopy:bytes length:length freeWhenDone:YES];
+}
+
 // --- class implementation ------------------------------------------------------------------------
 
 @implementation SPPVRData
 {
     NSData *_data;
+    NSInteger _width;
+    NSInteger _height;
+    NSInteger _numMipmaps;
+    NSInteger _numSkippedMipmaps;
+    SPTextureFormat _format;
+    BOOL _premultipliedAlpha;
+    const void *_levels[MAX_LEVELS];
+    uchar *_packedLevels;
+}
+
+// --- c functions ---
+
+static void raiseInvalidData(NSString *reason)
+{
+    [NSException raise:SPExceptionDataInvalid format:@"Invalid texture data: %@", reason];
+}
+
+static void setupLevels(SPPVRData *self, NSInteger width, NSInteger height, NSInteger numLevels)
+{
+    if (width < 1 || height < 1)
+        raiseInvalidData(@"empty texture");
+    else if (numLevels > MAX_LEVELS)
+        raiseInvalidData(@"too many mipmaps");
+
+    self->_width = width;
+    self->_height = height;
+    self->_numMipmaps = MAX(1, numLevels) - 1;
+}
+
+static void setLevel(SPPVRData *self, NSInteger level, uint64_t offset, uint64_t size)
+{
+    NSInteger width  = MAX(1, self->_width  >> level);
+    NSInteger height = MAX(1, self->_height >> level);
+
+    if (size < SPTextureFormatSizeOfLevel(self->_format, width, height) ||
+        offset > self->_data.length || size > self->_data.length - offset)
+        raiseInvalidData([NSString stringWithFormat:@"mipmap %ld is truncated", (long)level]);
+
+    self->_levels[level] = (const uchar *)self->_data.bytes + offset;
+}
+
+static void setContiguousLevels(SPPVRData *self, uint64_t offset)
+{
+    for (NSInteger level=0; level<=self->_numMipmaps; ++level)
+    {
+        uint64_t size = SPTextureFormatSizeOfLevel(self->_format, MAX(1, self->_width >> level),
+                                                   MAX(1, self->_height >> level));
+        setLevel(self, level, offset, size);
+        offset += size;
+    }
+}
+
+static void packKTXRows(SPPVRData *self, const uint32_t *sizes)
+{
+    // KTX pads the rows of uncompressed levels to 4 bytes, while GL (and any conversion) expects
+    // them tightly packed. The levels that actually contain padding are copied without it.
+    if (SPTextureFormatIsCompressed(self->_format)) return;
+
+    NSUInteger numPackedBytes = 0;
+
+    for (NSInteger level=0; level<=self->_numMipmaps; ++level)
+    {
+        NSInteger width  = MAX(1, self->_width  >> level);
+        NSInteger height = MAX(1, self->_height >> level);
+        NSUInteger rowSize = SPTextureFormatSizeOfLevel(self->_format, width, 1);
+        NSUInteger paddedRowSize = (rowSize + 3) & ~3;
+
+        if (rowSize == paddedRowSize) continue;
+        else if (sizes[level] < paddedRowSize * height)
+            raiseInvalidData([NSString stringWithFormat:@"mipmap %ld is truncated", (long)level]);
+
+        numPackedBytes += rowSize * height;
+    }
+
+    if (!numPackedBytes) return;
+
+    self->_packedLevels = malloc(numPackedBytes);
+    if (!self->_packedLevels)
+        [NSException raise:SPExceptionOperationFailed format:@"Could not allocate texture data"];
+
+    uchar *target = self->_packedLevels;
+
+    for (NSInteger level=0; level<=self->_numMipmaps; ++level)
+    {
+        NSInteger width  = MAX(1, self->_width  >> level);
+        NSInteger height = MAX(1, self->_height >> level);
+        NSUInteger rowSize = SPTextureFormatSizeOfLevel(self->_format, width, 1);
+        NSUInteger paddedRowSize = (rowSize + 3) & ~3;
+
+        if (rowSize == paddedRowSize) continue;
+
+        const uchar *source = self->_levels[level];
+        self->_levels[level] = target;
+
+        for (NSInteger row=0; row<height; ++row)
+        {
+            memcpy(target, source, rowSize);
+            target += rowSize;
+            source += paddedRowSize;
+        }
+    }
+}
+
+static void parsePVR2(SPPVRData *self)
+{
+    const PVRTextureHeader *header = self->_data.bytes;
+    validateHeader(header, self->_data.length);
+
+    bool hasAlpha = header->alphaBitMask ? YES : NO;
+
+    switch (header->pfFlags & 0xff)
+    {
+        case OGL_RGB_565:   self->_format = SPTextureFormat565;   break;
+        case OGL_RGB_888:   self->_format = SPTextureFormat888;   break;
+        case OGL_RGBA_5551: self->_format = SPTextureFormat5551;  break;
+        case OGL_RGBA_4444: self->_format = SPTextureFormat4444;  break;
+        case OGL_RGBA_8888: self->_format = SPTextureFormatRGBA;  break;
+        case OGL_A_8:       self->_format = SPTextureFormatAlpha; break;
+        case OGL_I_8:       self->_format = SPTextureFormatI8;    break;
+        case OGL_AI_88:     self->_format = SPTextureFormatAI88;  break;
+        case OGL_PVRTC2:
+            self->_format = hasAlpha ? SPTextureFormatPvrtcRGBA2 : SPTextureFormatPvrtcRGB2;
+            break;
+        case OGL_PVRTC4:
+            self->_format = hasAlpha ? SPTextureFormatPvrtcRGBA4 : SPTextureFormatPvrtcRGB4;
+            break;
+        default:
+            [NSException raise:SPExceptionDataInvalid format:@"Unsupported PVR image format"];
+    }
+
+    setupLevels(self, header->width, header->height, (NSInteger)header->numMipmaps + 1);
+    setContiguousLevels(self, header->headerSize);
+}
+
+static void parsePVR3(SPPVRData *self)
+{
+    const PVRTextureHeaderV3 *header = self->_data.bytes;
+
+    if (self->_data.length < sizeof(PVRTextureHeaderV3))
+        raiseInvalidData(@"PVR header is truncated");
+    else if (header->depth > 1 || header->numSurfaces > 1 || header->numFaces > 1)
+        raiseInvalidData(@"only 2D textures are supported");
+    else if (!formatFromPVR3(header->pixelFormat, &self->_format))
+        [NSException raise:SPExceptionDataInvalid format:@"Unsupported PVR image format"];
+
+    self->_premultipliedAlpha = (header->flags & PVR3_FLAG_PREMULTIPLIED) != 0;
+
+    setupLevels(self, header->width, header->height, header->numMipmaps);
+    setContiguousLevels(self, (uint64_t)sizeof(PVRTextureHeaderV3) + header->metaDataSize);
+}
+
+static void parseKTX(SPPVRData *self)
+{
+    const KTXHeader *header = self->_data.bytes;
+    NSUInteger length = self->_data.length;
+
+    if (length < sizeof(KTXHeader))
+        raiseInvalidData(@"KTX header is truncated");
+    else if (header->endianness != KTX_ENDIANNESS)
+        raiseInvalidData(@"big endian KTX files are not supported");
+    else if (header->depth > 1 || header->numArrayElements > 0 || header->numFaces > 1)
+        raiseInvalidData(@"only 2D textures are supported");
+    else if (!formatFromKTX(header, &self->_format))
+        [NSException raise:SPExceptionDataInvalid format:@"Unsupported KTX image format"];
+
+    setupLevels(self, header->width, header->height, header->numMipmaps);
+
+    // each level is preceded by its size and padded to 4 bytes
+    uint64_t offset = (uint64_t)sizeof(KTXHeader) + header->keyValueDataSize;
+    uint32_t sizes[MAX_LEVELS];
+
+    for (NSInteger level=0; level<=self->_numMipmaps; ++level)
+    {
+        if (offset + sizeof(uint32_t) > length)
+            raiseInvalidData(@"KTX data is truncated");
+
+        memcpy(&sizes[level], (const uchar *)self->_data.bytes + offset, sizeof(uint32_t));
+        setLevel(self, level, offset + sizeof(uint32_t), sizes[level]);
+        offset += sizeof(uint32_t) + ((sizes[level] + 3) & ~3);
+    }
+
+    packKTXRows(self, sizes);
+}
+
+static void parseKTX2(SPPVRData *self)
+{
+    const KTX2Header *header = self->_data.bytes;
+    const uchar *bytes = self->_data.bytes;
+    NSUInteger length = self->_data.length;
+
+    if (length < sizeof(KTX2Header))
+        raiseInvalidData(@"KTX2 header is truncated");
+    else if (header->supercompressionScheme)
+        raiseInvalidData(@"supercompressed KTX2 files are not supported");
+    else if (header->depth > 1 || header->numLayers > 0 || header->numFaces > 1)
+        raiseInvalidData(@"only 2D textures are supported");
+    else if (!formatFromKTX2(header->vkFormat, &self->_format))
+        [NSException raise:SPExceptionDataInvalid format:@"Unsupported KTX2 image format"];
+
+    setupLevels(self, header->width, header->height, header->numLevels);
+
+    if (sizeof(KTX2Header) + (self->_numMipmaps + 1) * sizeof(KTX2LevelIndex) > length)
+        raiseInvalidData(@"KTX2 level index is truncated");
+
+    const KTX2LevelIndex *index = (const KTX2LevelIndex *)(bytes + sizeof(KTX2Header));
+
+    for (NSInteger level=0; level<=self->_numMipmaps; ++level)
+        setLevel(self, level, index[level].offset, index[level].size);
+
+    // the flags are found in the basic block of the data format descriptor
+    uint64_t flagsOffset = (uint64_t)header->dfdOffset + 15;
+
+    if (header->dfdSize >= 16 && flagsOffset < length)
+        self->_premultipliedAlpha = (bytes[flagsOffset] & KTX2_FLAG_PREMULTIPLIED) != 0;
 }
 
 #pragma mark Initialization
@@ -62,55 +591,120 @@ enum PVRPixelType
 }
 
 - (instancetype)initWithData:(NSData *)data compressed:(BOOL)isCompressed
+{
+    return [self initWithData:data compressed:isCompressed numSkippedMipmaps:0];
+}
+
+- (instancetype)initWithData:(NSData *)data compressed:(BOOL)isCompressed
+           numSkippedMipmaps:(NSInteger)numSkippedMipmaps
 {
     if ((self = [super init]))
     {
-        if (isCompressed) _data = [[data gzipInflate] retain];
-        else              _data =  [data retain];
-        
-        PVRTextureHeader *header = (PVRTextureHeader *)[_data bytes];
-        bool hasAlpha = header->alphaBitMask ? YES : NO;
-        
-        _width      = header->width;
-        _height     = header->height;
-        _numMipmaps = header->numMipmaps;
-        
-        switch (header->pfFlags & 0xff)
+        @try
+        {
+            if (isCompressed) _data = [inflateData(data) retain];
+            else              _data = [data retain];
+
+            const uchar *bytes = _data.bytes;
+            NSUInteger length = _data.length;
+
+            if (length >= 12 && memcmp(bytes, KTX1_IDENTIFIER, 12) == 0)
+                parseKTX(self);
+            else if (length >= 12 && memcmp(bytes, KTX2_IDENTIFIER, 12) == 0)
+                parseKTX2(self);
+            else if (length >= 4 && *(const uint32_t *)bytes == PVR3_IDENTIFIER)
+                parsePVR3(self);
+            else
+                parsePVR2(self);
+        }
+        @catch (NSException *exception)
+        {
+            [self release];
+            @throw;
+        }
+
+        // skipping the largest levels just means ignoring them
+        _numSkippedMipmaps = MAX(0, MIN(numSkippedMipmaps, _numMipmaps));
+
+        if (_numSkippedMipmaps)
         {
-            case OGL_RGB_565:   _format = SPTextureFormat565;   break;
-            case OGL_RGB_888:   _format = SPTextureFormat888;   break;
-            case OGL_RGBA_5551: _format = SPTextureFormat5551;  break;
-            case OGL_RGBA_4444: _format = SPTextureFormat4444;  break;
-            case OGL_RGBA_8888: _format = SPTextureFormatRGBA;  break;
-            case OGL_A_8:       _format = SPTextureFormatAlpha; break;
-            case OGL_I_8:       _format = SPTextureFormatI8;    break;
-            case OGL_AI_88:     _format = SPTextureFormatAI88;  break;
-            case OGL_PVRTC2:
-                _format = hasAlpha ? SPTextureFormatPvrtcRGBA2 : SPTextureFormatPvrtcRGB2;
-                break;
-            case OGL_PVRTC4:
-                _format = hasAlpha ? SPTextureFormatPvrtcRGBA4 : SPTextureFormatPvrtcRGB4;
-                break;
-            default:
-                [NSException raise:SPExceptionDataInvalid format:@"Unsupported PVR image format"];
-                return nil;
+            memmove(_levels, _levels + _numSkippedMipmaps,
+                    (_numMipmaps + 1 - _numSkippedMipmaps) * sizeof(const void *));
+
+            _width  = MAX(1, _width  >> _numSkippedMipmaps);
+            _height = MAX(1, _height >> _numSkippedMipmaps);
+            _numMipmaps -= _numSkippedMipmaps;
         }
     }
     return self;
 }
 
+- (instancetype)initWithContentsOfFile:(NSString *)path
+{
+    return [self initWithContentsOfFile:path numSkippedMipmaps:0];
+}
+
+- (instancetype)initWithContentsOfFile:(NSString *)path numSkippedMipmaps:(NSInteger)numSkippedMipmaps
+{
+    // Uncompressed files are mapped into memory; their pages are read by GL right from the file
+    // system cache. Compressed files are mapped as well, and inflated with a single allocation.
+
+    NSError *error = nil;
+    NSData *data = [[NSData alloc] initWithContentsOfFile:path options:NSDataReadingMappedIfSafe
+                                                    error:&error];
+    if (!data)
+    {
+        [self release];
+        [NSException raise:SPExceptionFileNotFound format:@"Could not read %@. Error: %@",
+         path, error.localizedDescription];
+    }
+
+    BOOL isCompressed = [[path lowercaseString] hasSuffix:@".gz"];
+
+    @try
+    {
+        self = [self initWithData:data compressed:isCompressed numSkippedMipmaps:numSkippedMipmaps];
+    }
+    @finally
+    {
+        [data release];
+    }
+
+    return self;
+}
+
 - (void)dealloc
 {
+    free(_packedLevels);
     [_data release];
     [super dealloc];
 }
 
+#pragma mark Methods
+
+- (const void *)imageDataOfMipmap:(NSInteger)level
+{
+    if (level < 0 || level > _numMipmaps)
+        [NSException raise:SPExceptionIndexOutOfBounds format:@"Invalid mipmap level: %ld", (long)level];
+
+    return _levels[level];
+}
+
 #pragma mark Properties
 
 - (void *)imageData
 {
-    PVRTextureHeader *header = (PVRTextureHeader *)[_data bytes];
-    return (uchar *)header + header->headerSize;
+    return (void *)_levels[0];
+}
+
+- (NSUInteger)imageDataSize
+{
+    NSUInteger size = 0;
+
+    for (NSInteger level=0; level<=_numMipmaps; ++level)
+        size += SPTextureFormatSizeOfLevel(_format, MAX(1, _width >> level), MAX(1, _height >> level));
+
+    return size;
 }
 
 @end
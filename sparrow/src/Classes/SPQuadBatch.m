@@ -18,13 +18,15 @@
 #import "SPMatrix.h"
 #import "SPMatrix3D.h"
 #import "SPOpenGL.h"
-#import "SPQuadBatch.h"
+#import "SPQuadBatch_Internal.h"
 #import "SPRenderSupport.h"
 #import "SPSprite.h"
 #import "SPSprite3D.h"
 #import "SPTexture.h"
 #import "SPVertexData.h"
 
+#define MAX_NUM_QUADS 8192 // maximum buffer size; keeps the indices within 16 bit
+
 // --- class implementation ------------------------------------------------------------------------
 
 @implementation SPQuadBatch
@@ -190,10 +192,11 @@
              premultipliedAlpha:(BOOL)pma blendMode:(uint)blendMode numQuads:(NSInteger)numQuads
 {
     if (_numQuads == 0) return NO;
-    else if (_numQuads + numQuads > 8192) return YES; // maximum buffer size
+    else if (_numQuads + numQuads > MAX_NUM_QUADS) return YES; // maximum buffer size
     else if (!_texture && !texture)
         return _premultipliedAlpha != pma || self.blendMode != blendMode;
     else if (_texture && texture)
+        // 'name' reloads evicted textures; that's fine, since they are about to be rendered
         return _tinted != (_forceTinted || tinted || alpha != 1.0f) ||
                _texture.name != texture.name ||
                self.blendMode != blendMode;
@@ -346,6 +349,31 @@
     return [_vertexData boundsAfterTransformation:matrix atIndex:quadID * 4 numVertices:4];
 }
 
+#pragma mark Internal
+
+- (void)replaceQuadsInRange:(NSRange)range withNumQuads:(NSInteger)numQuads
+{
+    if (NSMaxRange(range) > _numQuads)
+        [NSException raise:SPExceptionIndexOutOfBounds format:@"Invalid quad range"];
+
+    NSInteger numMovedQuads = _numQuads - NSMaxRange(range);
+    NSInteger newNumQuads = _numQuads - range.length + numQuads;
+
+    if (newNumQuads > MAX_NUM_QUADS)
+        [NSException raise:SPExceptionInvalidOperation
+                    format:@"A quad batch is limited to %d quads", MAX_NUM_QUADS];
+
+    if (newNumQuads > self.capacity)
+        self.capacity = MIN(MAX(newNumQuads, self.capacity * 2), MAX_NUM_QUADS);
+
+    SPVertex *vertices = _vertexData.vertices;
+    memmove(vertices + (range.location + numQuads) * 4, vertices + NSMaxRange(range) * 4,
+            sizeof(SPVertex) * 4 * numMovedQuads);
+
+    _numQuads = newNumQuads;
+    _syncRequired = YES;
+}
+
 #pragma mark Properties
 
 - (BOOL)tinted
@@ -0,0 +1,26 @@
+//
+//  SPQuadBatch_Internal.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 12.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPQuadBatch.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface SPQuadBatch (Internal)
+
+/// Replaces a range of quads with `numQuads` quads, moving all subsequent quads accordingly.
+/// The new quads are left uninitialized; overwrite them with `setQuad:atIndex:`. The capacity
+/// grows as needed, but never shrinks. Raises an exception if the batch would end up with more
+/// than 8192 quads, the maximum size of a batch with 16 bit indices.
+- (void)replaceQuadsInRange:(NSRange)range withNumQuads:(NSInteger)numQuads;
+
+@end
+
+NS_ASSUME_NONNULL_END
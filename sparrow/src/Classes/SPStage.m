@@ -14,6 +14,7 @@
 #import "SPDisplayObject_Internal.h"
 #import "SPDisplayObjectContainer_Internal.h"
 #import "SPEnterFrameEvent.h"
+#import "SPEvent_Internal.h"
 #import "SPGLTexture.h"
 #import "SPPoint.h"
 #import "SPPress_Internal.h"
@@ -158,13 +159,13 @@
 
 #pragma mark SPDisplayObjectContainer (Internal)
 
-- (void)appendDescendantEventListenersOfObject:(SPDisplayObject *)object withEventType:(NSString *)type
+- (void)appendDescendantEventListenersOfObject:(SPDisplayObject *)object withEventTypeID:(SPEventTypeID)typeID
                                        toArray:(SP_GENERIC(NSMutableArray, SPDisplayObject*) *)listeners
 {
-    if (object == self && [type isEqualToString:SPEventTypeEnterFrame])
+    if (object == self && typeID == SPEventTypeIDEnterFrame)
         [listeners addObjectsFromArray:_enterFrameListeners];
     else
-        [super appendDescendantEventListenersOfObject:object withEventType:type toArray:listeners];
+        [super appendDescendantEventListenersOfObject:object withEventTypeID:typeID toArray:listeners];
 }
 
 #pragma mark Properties
@@ -242,7 +243,8 @@
 
 - (void)advanceTime:(double)passedTime
 {
-    SPEnterFrameEvent *enterFrameEvent = [[SPEnterFrameEvent alloc] initWithType:SPEventTypeEnterFrame passedTime:passedTime];
+    SPEnterFrameEvent *enterFrameEvent = [[SPEnterFrameEvent allocFromPool]
+                                          initWithType:SPEventTypeEnterFrame passedTime:passedTime];
     [self broadcastEvent:enterFrameEvent];
     [enterFrameEvent release];
     
@@ -15,6 +15,7 @@
 #import "SPQuad.h"
 #import "SPStatsDisplay.h"
 #import "SPTextField.h"
+#import "SPTexture.h"
 
 @implementation SPStatsDisplay
 {
@@ -32,7 +33,7 @@
 {
     if ((self = [super init]))
     {
-        SPQuad *background = [[SPQuad alloc] initWithWidth:45 height:17 color:0x0];
+        SPQuad *background = [[SPQuad alloc] initWithWidth:45 height:25 color:0x0];
         [self addChild:background];
         [background release];
         
@@ -80,7 +81,7 @@
 {
     if (!_textField)
     {
-        _textField = [[SPTextField alloc] initWithWidth:48 height:17 text:@""
+        _textField = [[SPTextField alloc] initWithWidth:48 height:25 text:@""
             fontName:SPBitmapFontMiniName fontSize:SPNativeFontSize color:SPColorWhite];
         _textField.hAlign = SPHAlignLeft;
         _textField.vAlign = SPVAlignTop;
@@ -88,8 +89,11 @@
         [self addChild:_textField];
     }
     
-    _textField.text = [NSString stringWithFormat:@"FPS: %ld\nDRW: %ld",
-                       (long)_framesPerSecond, (long)_numDrawCalls];
+    // texture memory in megabytes
+    uint64_t textureMemory = [SPTexture memoryStats].numBytes / (1024 * 1024);
+
+    _textField.text = [NSString stringWithFormat:@"FPS: %ld\nDRW: %ld\nTEX: %ld",
+                       (long)_framesPerSecond, (long)_numDrawCalls, (long)textureMemory];
 }
 
 @end
@@ -54,8 +54,9 @@ typedef NS_OPTIONS(NSInteger, SPTextFieldAutoSize)
  There are two types of fonts that can be displayed:
  
  - Standard iOS fonts. This renders the text with standard iOS fonts like Verdana or Arial. Use this
-   method if you want to keep it simple, and if the text changes not too often. Simply pass the 
-   font name to the corresponding property.
+   method if you want to keep it simple. Simply pass the font name to the corresponding property.
+   If the text changes frequently, consider enabling `usesGlyphAtlas`, which rasterizes each
+   glyph just once and shares it between all text fields.
  - Bitmap fonts. If you need speed or fancy font effects, use a bitmap font instead. That is a 
    font that has its glyphs rendered to a texture atlas. To use it, first register the font with
    the method `registerBitmapFont:`, and then pass the font name to the corresponding 
@@ -157,6 +158,19 @@ typedef NS_OPTIONS(NSInteger, SPTextFieldAutoSize)
 /// Get the bitmap font that was registered under a certain name.
 + (SPBitmapFont *)registeredBitmapFont:(NSString *)name;
 
+/// Indicates if text with standard iOS fonts is composed of glyphs from a shared, dynamically
+/// filled texture atlas, instead of being drawn into a texture of its own. That makes text changes
+/// cheap and allows such text fields to be batched. Underlined or auto-scaled text, and text that
+/// needs complex shaping (e.g. Arabic or emoji), is always drawn into a texture.
+///
+/// Note that composed text looks slightly different from drawn text: each glyph is rasterized
+/// on its own and placed by its advance width, so kerning and ligatures are not applied.
+/// Default: NO
++ (BOOL)usesGlyphAtlas;
+
+/// Enables or disables the glyph atlas for standard iOS fonts (see `usesGlyphAtlas`).
++ (void)setUsesGlyphAtlas:(BOOL)value;
+
 /// ----------------
 /// @name Properties
 /// ----------------
@@ -205,9 +219,9 @@ typedef NS_OPTIONS(NSInteger, SPTextFieldAutoSize)
 @property (nonatomic, assign) SPTextFieldAutoSize autoSize;
 
 /// Indicates if TextField should be batched on rendering. This works only with bitmap
-/// fonts, and it makes sense only for TextFields with no more than 10-15 characters.
-/// Otherwise, the CPU costs will exceed any gains you get from avoiding the additional
-/// draw call. Default: NO
+/// fonts (or standard fonts displayed via the glyph atlas), and it makes sense only for
+/// TextFields with no more than 10-15 characters. Otherwise, the CPU costs will exceed any
+/// gains you get from avoiding the additional draw call. Default: NO
 @property (nonatomic, assign) BOOL batchable;
 
 /// The amount of vertical space (called 'leading') between lines. Default: 0
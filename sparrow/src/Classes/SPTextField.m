@@ -10,12 +10,13 @@
 //
 
 #import "SparrowClass.h"
-#import "SPBitmapFont.h"
+#import "SPBitmapFont_Internal.h"
 #import "SPEnterFrameEvent.h"
 #import "SPGLTexture.h"
+#import "SPGlyphAtlas.h"
 #import "SPImage.h"
 #import "SPQuad.h"
-#import "SPQuadBatch.h"
+#import "SPQuadBatch_Internal.h"
 #import "SPRectangle.h"
 #import "SPStage.h"
 #import "SPSprite.h"
@@ -25,6 +26,8 @@
 
 #import <UIKit/UIKit.h>
 
+#define MAX_NUM_GLYPHS 8192
+
 // --- public constants ----------------------------------------------------------------------------
 
 NSString *const   SPDefaultFontName   = @"Helvetica";
@@ -35,6 +38,7 @@ const float       SPNativeFontSize    = -1;
 // --- bitmap font cache ---------------------------------------------------------------------------
 
 static NSMutableDictionary *bitmapFonts = nil;
+static BOOL usesGlyphAtlas = NO;
 
 // --- helpers -------------------------------------------------------------------------------------
 
@@ -78,6 +82,81 @@ static NSTextAlignment hAlignToTextAlignment[] = {
     
     SPImage *_image;
     SPQuadBatch *_quadBatch;
+    NSUInteger _layoutID;
+    uint _composedColor;
+
+    // the glyphs currently in '_quadBatch', used to update only what changed
+    SPBitmapFont *_composedFont;
+    NSUInteger _composedFontVersion;
+    SPGlyphPlacement *_glyphs;
+    NSInteger _numGlyphs;
+    NSInteger _glyphCapacity;
+    float _glyphScale;
+}
+
+SP_INLINE BOOL isEqualGlyph(const SPGlyphPlacement *glyph1, const SPGlyphPlacement *glyph2)
+{
+    return glyph1->bitmapChar == glyph2->bitmapChar && glyph1->x == glyph2->x && glyph1->y == glyph2->y;
+}
+
+static void updateQuadBatch(SPTextField *self, SPBitmapFont *font, SPBitmapFontLayout layout)
+{
+    // Only the glyphs between the common prefix and suffix of the old and new layout are
+    // rewritten; e.g. when a char is appended or a digit of a counter changes.
+
+    SPQuadBatch *quadBatch = self->_quadBatch;
+    SPGlyphPlacement *oldGlyphs = self->_glyphs;
+    const SPGlyphPlacement *newGlyphs = layout.glyphs;
+    NSInteger numOldGlyphs = self->_numGlyphs;
+    NSInteger numNewGlyphs = layout.numGlyphs;
+
+    // texts that are too long are rejected by 'fillQuadBatch:', which raises an exception
+    BOOL canUpdate = numOldGlyphs && numNewGlyphs && numNewGlyphs <= MAX_NUM_GLYPHS &&
+                     quadBatch.numQuads == numOldGlyphs &&
+                     font == self->_composedFont && font.version == self->_composedFontVersion &&
+                     layout.scale == self->_glyphScale && self->_color == self->_composedColor;
+
+    if (canUpdate)
+    {
+        NSInteger maxCommon = MIN(numOldGlyphs, numNewGlyphs);
+        NSInteger prefix = 0;
+        NSInteger suffix = 0;
+
+        while (prefix < maxCommon && isEqualGlyph(&oldGlyphs[prefix], &newGlyphs[prefix]))
+            ++prefix;
+
+        while (suffix < maxCommon - prefix &&
+               isEqualGlyph(&oldGlyphs[numOldGlyphs - suffix - 1], &newGlyphs[numNewGlyphs - suffix - 1]))
+            ++suffix;
+
+        NSInteger numChangedGlyphs = numNewGlyphs - prefix - suffix;
+
+        [quadBatch replaceQuadsInRange:NSMakeRange(prefix, numOldGlyphs - prefix - suffix)
+                          withNumQuads:numChangedGlyphs];
+        [font updateQuadBatch:quadBatch withLayout:layout
+                        range:NSMakeRange(prefix, numChangedGlyphs) color:self->_color];
+    }
+    else
+    {
+        [quadBatch reset];
+        [font fillQuadBatch:quadBatch withLayout:layout color:self->_color];
+    }
+
+    if (self->_glyphCapacity < numNewGlyphs)
+    {
+        self->_glyphCapacity = numNewGlyphs;
+        self->_glyphs = realloc(self->_glyphs, sizeof(SPGlyphPlacement) * numNewGlyphs);
+    }
+
+    if (numNewGlyphs)
+        memcpy(self->_glyphs, newGlyphs, sizeof(SPGlyphPlacement) * numNewGlyphs);
+
+    SP_RELEASE_AND_RETAIN(self->_composedFont, font);
+    self->_composedFontVersion = font.version;
+    self->_numGlyphs = numNewGlyphs;
+    self->_glyphScale = layout.scale;
+    self->_composedColor = self->_color;
+    self->_layoutID = layout.layoutID;
 }
 
 #pragma mark Initialization
@@ -135,6 +214,8 @@ static NSTextAlignment hAlignToTextAlignment[] = {
     [_border release];
     [_image release];
     [_quadBatch release];
+    [_composedFont release];
+    free(_glyphs);
     [super dealloc];
 }
 
@@ -199,6 +280,16 @@ static NSTextAlignment hAlignToTextAlignment[] = {
     return bitmapFonts[name];
 }
 
++ (BOOL)usesGlyphAtlas
+{
+    return usesGlyphAtlas;
+}
+
++ (void)setUsesGlyphAtlas:(BOOL)value
+{
+    usesGlyphAtlas = value;
+}
+
 #pragma mark SPDisplayObject
 
 - (void)render:(SPRenderSupport *)support
@@ -439,8 +530,22 @@ static NSTextAlignment hAlignToTextAlignment[] = {
 {
     if (_requiresRedraw)
     {
-        if (_isRenderedText) [self createRenderedContents];
-        else                 [self createComposedContents];
+        if (!_isRenderedText)
+        {
+            SPBitmapFont *bitmapFont = bitmapFonts[_fontName];
+            if (!bitmapFont)
+                [NSException raise:SPExceptionInvalidOperation
+                            format:@"bitmap font %@ not registered!", _fontName];
+
+            [self createComposedContentsWithFont:bitmapFont];
+        }
+        else
+        {
+            SPBitmapFont *atlasFont = [self glyphAtlasFont];
+
+            if (atlasFont) [self createComposedContentsWithFont:atlasFont];
+            else           [self createRenderedContents];
+        }
         
         [self updateBorder];
         _requiresRedraw = NO;
@@ -596,30 +701,23 @@ static NSTextAlignment hAlignToTextAlignment[] = {
     }
 }
 
-- (void)createComposedContents
+- (SPBitmapFont *)glyphAtlasFont
+{
+    if (!usesGlyphAtlas || _underline || _autoScale) return nil;
+
+    float fontSize = _fontSize == SPNativeFontSize ? SPDefaultFontSize : _fontSize;
+    return [[SPGlyphAtlas sharedAtlas] fontWithName:_fontName size:fontSize
+                                               bold:_bold italic:_italic forText:_text];
+}
+
+- (void)createComposedContentsWithFont:(SPBitmapFont *)bitmapFont
 {
-    SPBitmapFont *bitmapFont = bitmapFonts[_fontName];
-    if (!bitmapFont)
-        [NSException raise:SPExceptionInvalidOperation 
-                    format:@"bitmap font %@ not registered!", _fontName];
-    
     if (_image)
     {
         [_image removeFromParent];
         SP_RELEASE_AND_NIL(_image);
     }
     
-    if (!_quadBatch)
-    {
-        _quadBatch = [[SPQuadBatch alloc] init];
-        _quadBatch.touchable = false;
-        [self addChild:_quadBatch];
-    }
-    else
-    {
-        [_quadBatch reset];
-    }
-    
     float width  = _hitArea.width;
     float height = _hitArea.height;
     SPHAlign hAlign = _hAlign;
@@ -637,15 +735,27 @@ static NSTextAlignment hAlignToTextAlignment[] = {
         vAlign = SPVAlignTop;
     }
     
-    [bitmapFont fillQuadBatch:_quadBatch withWidth:width height:height
-                         text:_text fontSize:_fontSize color:_color hAlign:hAlign vAlign:vAlign
-                    autoScale:_autoScale kerning:_kerning leading:_leading];
-    
+    SPBitmapFontLayout layout = [bitmapFont layoutText:_text width:width height:height
+                                              fontSize:_fontSize hAlign:hAlign vAlign:vAlign
+                                             autoScale:_autoScale kerning:_kerning leading:_leading];
+
+    // the font caches recent layouts; if we got the one we're already displaying, we're done
+    if (_quadBatch && layout.layoutID == _layoutID && _color == _composedColor)
+        return;
+
+    if (!_quadBatch)
+    {
+        _quadBatch = [[SPQuadBatch alloc] init];
+        _quadBatch.touchable = false;
+        [self addChild:_quadBatch];
+    }
+
+    updateQuadBatch(self, bitmapFont, layout);
     _quadBatch.batchable = _batchable;
     
     if (_autoSize != SPTextFieldAutoSizeNone)
     {
-        _textBounds = [_quadBatch boundsInSpace:_quadBatch];
+        SP_RELEASE_AND_RETAIN(_textBounds, [_quadBatch boundsInSpace:_quadBatch]);
         
         if (self.isHorizontalAutoSize)
             _hitArea.width  = _textBounds.x + _textBounds.width;
@@ -15,6 +15,7 @@ NS_ASSUME_NONNULL_BEGIN
 
 @class SPRectangle;
 @class SPTexture;
+@class SPTextureOptions;
 @class SPGLTexture;
 @class SPVertexData;
 
@@ -31,7 +32,26 @@ typedef NS_ENUM(NSInteger, SPTextureFormat)
     SPTextureFormat5551,
     SPTextureFormat4444,
     SPTextureFormatAI88,
-    SPTextureFormatI8
+    SPTextureFormatI8,
+    SPTextureFormatETC2RGB,
+    SPTextureFormatETC2RGBA,
+    SPTextureFormatETC2RGBA1,
+    SPTextureFormatEACR11,
+    SPTextureFormatEACRG11,
+    SPTextureFormatASTC4x4,
+    SPTextureFormatASTC5x4,
+    SPTextureFormatASTC5x5,
+    SPTextureFormatASTC6x5,
+    SPTextureFormatASTC6x6,
+    SPTextureFormatASTC8x5,
+    SPTextureFormatASTC8x6,
+    SPTextureFormatASTC8x8,
+    SPTextureFormatASTC10x5,
+    SPTextureFormatASTC10x6,
+    SPTextureFormatASTC10x8,
+    SPTextureFormatASTC10x10,
+    SPTextureFormatASTC12x10,
+    SPTextureFormatASTC12x12
 };
 
 typedef NS_ENUM(NSInteger, SPTextureSmoothing)
@@ -41,6 +61,18 @@ typedef NS_ENUM(NSInteger, SPTextureSmoothing)
     SPTextureSmoothingTrilinear
 };
 
+/// Statistics about the GPU memory that is occupied by textures (see `[SPTexture memoryStats]`).
+/// All sizes are estimates based on format, size and mipmaps of the textures.
+typedef struct
+{
+    uint64_t numBytes;              // the memory of all textures that are currently uploaded
+    uint64_t numReloadableBytes;    // the part of 'numBytes' that may be evicted
+    uint64_t numEvictedBytes;       // the memory that was freed by textures that are now evicted
+    NSInteger numTextures;          // the number of textures that currently exist
+    NSInteger numEvictions;         // the total number of evictions
+    NSInteger numReloads;           // the total number of evicted textures that were uploaded again
+} SPTextureMemoryStats;
+
 typedef void (^SPTextureDrawingBlock)(CGContextRef context);
 typedef void (^SPTextureLoadingBlock)(SPTexture *__nullable texture, NSError *__nullable outError);
 
@@ -55,6 +87,12 @@ typedef void (^SPTextureLoadingBlock)(SPTexture *__nullable texture, NSError *__
  contains an alpha channel, and `JPG` (without an alpha channel). You can also load files in 
  the `PVR` format (compressed or uncompressed). That's a special format of the graphics chip of
  iOS devices that is very efficient.
+
+ Besides the legacy PVR (v2) files, Sparrow reads PVR v3, `KTX` and `KTX2` containers. Those may
+ contain `ETC2`/`EAC` textures (requiring OpenGL ES 3) and `ASTC` textures (requiring a device
+ that supports `GL_KHR_texture_compression_astc_ldr`); use `[SPContext supportsTextureFormat:]` to
+ pick the right files for a device. Mipmaps stored in those files are uploaded right from the
+ loaded data; on devices with little memory, `SPTextureOptions` lets you skip the largest levels.
  
  **HD textures**
  
@@ -108,6 +146,15 @@ typedef void (^SPTextureLoadingBlock)(SPTexture *__nullable texture, NSError *__
  
  The texture class itself does not make any use of the frame data. It's up to classes that use
  `SPTexture` to support that feature.
+
+ **GPU memory**
+
+ Sparrow keeps track of the (estimated) GPU memory of all textures; see `memoryStats`. Textures
+ that are loaded from a file with the `reloadable` option (see `SPTextureOptions`) may be evicted
+ from the GPU: when the textures exceed the `memoryBudget`, the ones that were rendered least
+ recently are deleted from the GPU, and when an evicted texture is rendered again, it is
+ transparently reloaded from its file. The view controller evicts reloadable textures when it
+ receives a memory warning, too.
  
 ------------------------------------------------------------------------------------------------- */
 
@@ -147,6 +194,10 @@ typedef void (^SPTextureLoadingBlock)(SPTexture *__nullable texture, NSError *__
 /// uncompressed automatically.
 - (instancetype)initWithContentsOfFile:(NSString *)path generateMipmaps:(BOOL)mipmaps;
 
+/// Initializes a texture with the contents of a file (supported formats: png, jpg, pvr, ktx,
+/// ktx2), loading it with certain options. Passing `nil` uses the default options.
+- (instancetype)initWithContentsOfFile:(NSString *)path options:(nullable SPTextureOptions *)options;
+
 /// Initializes a texture with the contents of a UIImage; no mip maps will be created. The texture
 /// will have the same scale factor as the image.
 - (instancetype)initWithContentsOfImage:(UIImage *)image;
@@ -170,6 +221,9 @@ typedef void (^SPTextureLoadingBlock)(SPTexture *__nullable texture, NSError *__
 /// Factory method.
 + (instancetype)textureWithContentsOfFile:(NSString *)path generateMipmaps:(BOOL)mipmaps;
 
+/// Factory method.
++ (instancetype)textureWithContentsOfFile:(NSString *)path options:(nullable SPTextureOptions *)options;
+
 /// Factory method.
 + (instancetype)textureWithRegion:(SPRectangle *)region ofTexture:(SPTexture *)texture;
 
@@ -247,6 +301,25 @@ typedef void (^SPTextureLoadingBlock)(SPTexture *__nullable texture, NSError *__
 + (void)loadFromSuffixedURL:(NSURL *)url generateMipmaps:(BOOL)mipmaps
                  onComplete:(SPTextureLoadingBlock)callback;
 
+/// ----------------
+/// @name GPU Memory
+/// ----------------
+
+/// The GPU memory (in bytes) that textures should not exceed. When it is exceeded, reloadable
+/// textures that were not rendered in the last frame are evicted, least recently rendered
+/// first. Zero means no limit. (Default: 0)
++ (uint64_t)memoryBudget;
+
+/// Sets the GPU memory budget of textures.
++ (void)setMemoryBudget:(uint64_t)numBytes;
+
+/// Returns statistics about the GPU memory that is occupied by textures.
++ (SPTextureMemoryStats)memoryStats;
+
+/// Evicts all reloadable textures that were not rendered in the last frame. Requires a current
+/// OpenGL context.
++ (void)evictReloadableTextures;
+
 /// ----------------
 /// @name Properties
 /// ----------------
@@ -266,7 +339,9 @@ typedef void (^SPTextureLoadingBlock)(SPTexture *__nullable texture, NSError *__
 /// The SPGLTexture this texture is based on.
 @property (nonatomic, readonly) SPGLTexture *root;
 
-/// The OpenGL texture identifier.
+/// The OpenGL texture identifier. For reloadable textures, accessing it marks the texture as
+/// rendered in the current frame; if the texture is evicted, it is synchronously reloaded from
+/// its file first. Thus, only access it when you're about to render the texture.
 @property (nonatomic, readonly) uint name;
 
 /// Indicates if the alpha values are premultiplied into the RGB values.
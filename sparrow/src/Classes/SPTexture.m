@@ -10,8 +10,9 @@
 //
 
 #import "SparrowClass.h"
-#import "SPGLTexture.h"
+#import "SPGLTexture_Internal.h"
 #import "SPContext.h"
+#import "SPDynamicAtlas.h"
 #import "SPMacros.h"
 #import "SPNSExtensions.h"
 #import "SPOpenGL.h"
@@ -19,112 +20,206 @@
 #import "SPRectangle.h"
 #import "SPStage.h"
 #import "SPSubTexture.h"
-#import "SPTexture.h"
+#import "SPTexture_Internal.h"
+#import "SPTextureConversion.h"
+#import "SPTextureOptions.h"
 #import "SPCache.h"
 #import "SPURLConnection.h"
 #import "SPUtils.h"
 #import "SPVertexData.h"
 
-#pragma mark - SPTexture
-
-static SP_GENERIC(SPCache, NSString*, SPTexture*) *textureCache = nil;
-
-@implementation SPTexture
-
-#pragma mark Initialization
+#pragma mark - SPDecodedTexture
 
-+ (void)initialize
+static BOOL isPVRFile(NSString *path)
 {
-    static dispatch_once_t onceToken;
-    dispatch_once(&onceToken, ^
-    {
-        textureCache = [[[SPCache class] alloc] initWithWeakValues];
-    });
+    // all texture containers are parsed by 'SPPVRData'
+    path = [path lowercaseString];
+    if ([path hasSuffix:@".gz"]) path = [path stringByDeletingPathExtension];
+    return [path hasSuffix:@".pvr"] || [path hasSuffix:@".ktx"] || [path hasSuffix:@".ktx2"];
 }
 
-- (instancetype)init
-{    
-    if ([self isMemberOfClass:[SPTexture class]]) 
-    {
-        return [self initWithWidth:32 height:32];
-    }
-    
-    return [super init];
+@implementation SPDecodedTexture
+{
+    void *_pixels;
+    SPTextureProperties _properties;
+    float _width;
+    float _height;
+    SPPVRData *_pvrData;
+    float _pvrScale;
+    NSUInteger _numBytes;
+    NSString *_reloadPath;
+    SPTextureOptions *_reloadOptions;
+    SPDynamicAtlas *_atlas;
+    NSString *_atlasKey;
 }
 
-- (instancetype)initWithContentsOfFile:(NSString *)path
+@synthesize numBytes = _numBytes;
+
+// --- c functions ---
+
+static BOOL needsConversion(SPTextureOptions *options, BOOL pma)
 {
-    return [self initWithContentsOfFile:path generateMipmaps:NO];
+    return options.format != SPTextureFormatRGBA ||
+           (options.alphaMode == SPTextureAlphaModePremultiplied && !pma) ||
+           (options.alphaMode == SPTextureAlphaModeStraight && pma);
 }
 
-- (instancetype)initWithContentsOfFile:(NSString *)path generateMipmaps:(BOOL)mipmaps
+static void convertPixels(SPDecodedTexture *self, const void *const *levels, SPTextureOptions *options)
 {
-    SPTexture *cachedTexture = textureCache[path];
-    if (cachedTexture)
+    // 'levels' contain RGBA pixels that are described by the current texture properties;
+    // without them, the current pixels are used, with the mipmaps following each other directly
+    SPTextureFormat format = options.format;
+    BOOL sourcePMA = self->_properties.premultipliedAlpha;
+    BOOL pma = options.alphaMode == SPTextureAlphaModeUnchanged ? sourcePMA :
+               options.alphaMode == SPTextureAlphaModePremultiplied;
+
+    if (!SPTextureFormatIsConvertible(format))
+        [NSException raise:SPExceptionInvalidOperation
+                    format:@"Textures can't be converted to format %d", (int)format];
+
+    NSInteger numLevels = self->_properties.numMipmaps + 1;
+    NSInteger width  = self->_properties.width;
+    NSInteger height = self->_properties.height;
+    NSUInteger numBytes = 0;
+
+    for (NSInteger level=0; level<numLevels; ++level)
+        numBytes += SPTextureFormatSizeOfLevel(format, MAX(1, width >> level), MAX(1, height >> level));
+
+    uchar *pixels = malloc(numBytes);
+    if (!pixels)
+        [NSException raise:SPExceptionOperationFailed format:@"Could not allocate texture data"];
+
+    uchar *output = pixels;
+    const uchar *source = self->_pixels;
+
+    for (NSInteger level=0; level<numLevels; ++level)
     {
-        [self release];
-        return [cachedTexture retain];
+        NSInteger levelWidth  = MAX(1, width  >> level);
+        NSInteger levelHeight = MAX(1, height >> level);
+        NSInteger numPixels = levelWidth * levelHeight;
+        const void *input = levels ? levels[level] : source;
+        void *copy = NULL;
+
+        source += numPixels * 4;
+
+        if (pma != sourcePMA)
+        {
+            // the source may be a mapped file, so the alpha mode is changed on a copy
+            copy = malloc(numPixels * 4);
+            if (!copy)
+            {
+                free(pixels);
+                [NSException raise:SPExceptionOperationFailed
+                            format:@"Could not allocate texture data"];
+            }
+
+            memcpy(copy, input, numPixels * 4);
+            input = copy;
+
+            if (pma) SPTexturePremultiplyPixels(copy, numPixels);
+            else     SPTextureUnpremultiplyPixels(copy, numPixels);
+        }
+
+        SPTextureConvertPixels(input, output, levelWidth, levelHeight, format, options.dithering, pma);
+        output += SPTextureFormatSizeOfLevel(format, levelWidth, levelHeight);
+        free(copy);
     }
 
-    NSString *fullPath = [SPUtils absolutePathToFile:path];
-    if (!fullPath)
-        [NSException raise:SPExceptionFileNotFound format:@"File '%@' not found", path];
+    free(self->_pixels);
+    self->_pixels = pixels;
+    self->_numBytes = numBytes;
+    self->_properties.format = format;
+    self->_properties.premultipliedAlpha = pma;
+}
 
-    if ([SPTexture isPVRFile:fullPath])
+- (instancetype)initWithContentsOfFile:(NSString *)path options:(SPTextureOptions *)options
+{
+    if (isPVRFile(path))
     {
-        BOOL isCompressed = [SPTexture isCompressedFile:fullPath];
-        float scale = [fullPath contentScaleFactor];
-        
-        NSData *rawData = [[NSData alloc] initWithContentsOfFile:fullPath];
-        SPPVRData *pvrData = [[SPPVRData alloc] initWithData:rawData compressed:isCompressed];
-        
-        [self release]; // we'll return a subclass!
-        self = [[SPGLTexture alloc] initWithPVRData:pvrData scale:scale];
-
-        [rawData release];
-        [pvrData release];
+        if ((self = [super init]))
+        {
+            if (options.atlas && !options.generateMipmaps)
+            {
+                _atlas = [options.atlas retain];
+                _atlasKey = [path copy];
+            }
+            else if (options.reloadable)
+            {
+                _reloadPath = [path copy];
+                _reloadOptions = [options copy];
+            }
+
+            // each skipped level halves the resolution, so the scale follows to keep the size
+            _pvrData = [[SPPVRData alloc] initWithContentsOfFile:path
+                                               numSkippedMipmaps:options.numSkippedMipmaps];
+            _pvrScale = [path contentScaleFactor] / (1 << _pvrData.numSkippedMipmaps);
+            _numBytes = _pvrData.imageDataSize;
+
+            if (_pvrData.format == SPTextureFormatRGBA &&
+                needsConversion(options, _pvrData.premultipliedAlpha))
+            {
+                // from now on, the converted pixels are used like those of an image
+                const void *levels[_pvrData.numMipmaps + 1];
+                for (NSInteger level=0; level<=_pvrData.numMipmaps; ++level)
+                    levels[level] = [_pvrData imageDataOfMipmap:level];
+
+                _width  = _pvrData.width  / _pvrScale;
+                _height = _pvrData.height / _pvrScale;
+                _properties = (SPTextureProperties){
+                    .format = SPTextureFormatRGBA,
+                    .scale  = _pvrScale,
+                    .width  = _pvrData.width,
+                    .height = _pvrData.height,
+                    .numMipmaps = _pvrData.numMipmaps,
+                    .generateMipmaps = NO,
+                    .premultipliedAlpha = _pvrData.premultipliedAlpha
+                };
+
+                convertPixels(self, levels, options);
+                SP_RELEASE_AND_NIL(_pvrData);
+            }
+        }
+        return self;
     }
     else
     {
         // load image via this crazy workaround to be sure that path is not extended with scale
-        NSData *data = [[NSData alloc] initWithContentsOfFile:fullPath];
+        BOOL mipmaps = options.generateMipmaps;
+        NSData *data = [[NSData alloc] initWithContentsOfFile:path];
         UIImage *image1 = [[UIImage alloc] initWithData:data];
         UIImage *image2 = [[UIImage alloc] initWithCGImage:image1.CGImage
-           scale:[fullPath contentScaleFactor] orientation:UIImageOrientationUp];
-        
-        self = [self initWithContentsOfImage:image2 generateMipmaps:mipmaps];
-        
+           scale:[path contentScaleFactor] orientation:UIImageOrientationUp];
+
+        self = [self initWithWidth:image2.size.width height:image2.size.height
+                   generateMipmaps:mipmaps scale:image2.scale draw:^(CGContextRef context)
+                {
+                    [image2 drawAtPoint:CGPointMake(0, 0)];
+                }];
+
+        if (self && needsConversion(options, YES))
+            convertPixels(self, NULL, options);
+
+        if (self && options.atlas && !mipmaps)
+        {
+            _atlas = [options.atlas retain];
+            _atlasKey = [path copy];
+        }
+        else if (self && options.reloadable)
+        {
+            _reloadPath = [path copy];
+            _reloadOptions = [options copy];
+        }
+
         [image2 release];
         [image1 release];
         [data release];
+        return self;
     }
-
-    textureCache[path] = self;
-    return self;
-}
-
-- (instancetype)initWithWidth:(float)width height:(float)height
-{
-    return [self initWithWidth:width height:height draw:NULL];
-}
-
-- (instancetype)initWithWidth:(float)width height:(float)height draw:(SPTextureDrawingBlock)drawingBlock
-{
-    return [self initWithWidth:width height:height generateMipmaps:NO draw:drawingBlock];
-}
-
-- (instancetype)initWithWidth:(float)width height:(float)height generateMipmaps:(BOOL)mipmaps
-                         draw:(SPTextureDrawingBlock)drawingBlock
-{
-    return [self initWithWidth:width height:height generateMipmaps:mipmaps
-                         scale:Sparrow.contentScaleFactor draw:drawingBlock];
 }
 
 - (instancetype)initWithWidth:(float)width height:(float)height generateMipmaps:(BOOL)mipmaps
                         scale:(float)scale draw:(SPTextureDrawingBlock)drawingBlock
 {
-    [self release]; // class factory - we'll return a subclass!
-    
     NSInteger legalWidth, legalHeight;
     if (mipmaps)
     {
@@ -138,23 +233,35 @@ static SP_GENERIC(SPCache, NSString*, SPTexture*) *textureCache = nil;
     }
     
     if (legalWidth < 1 || legalHeight < 1)
+    {
+        [self release];
         [NSException raise:SPExceptionInvalidOperation
                     format:@"Invalid texture size [%dx%d@%d]."
                            @"Width and height must be greater than or equal to 1.",
                             (int)legalWidth, (int)legalHeight, (int)scale];
+    }
+
+    if (!(self = [super init])) return nil;
     
     CGBitmapInfo bitmapInfo = kCGBitmapByteOrder32Big | kCGImageAlphaPremultipliedLast;
     int bytesPerPixel = 4;
-    
-    void *imageData = calloc(legalWidth * legalHeight * bytesPerPixel, 1);
-    if (!imageData)
+
+    // the mipmaps are stored right behind the image
+    NSInteger numMipmaps = mipmaps ? SPTextureNumMipmaps(legalWidth, legalHeight) : 0;
+
+    for (NSInteger level=0; level<=numMipmaps; ++level)
+        _numBytes += MAX(1, legalWidth >> level) * MAX(1, legalHeight >> level) * bytesPerPixel;
+
+    _pixels = calloc(_numBytes, 1);
+    if (!_pixels)
     {
         SPLog(@"Error allocating image data!");
+        [self release];
         return nil;
     }
     
     CGColorSpaceRef cgColorSpace = CGColorSpaceCreateDeviceRGB();
-    CGContextRef context = CGBitmapContextCreate(imageData, legalWidth, legalHeight, 8, 
+    CGContextRef context = CGBitmapContextCreate(_pixels, legalWidth, legalHeight, 8, 
                                                  bytesPerPixel * legalWidth, cgColorSpace, 
                                                  bitmapInfo);
     CGColorSpaceRelease(cgColorSpace);
@@ -162,6 +269,7 @@ static SP_GENERIC(SPCache, NSString*, SPTexture*) *textureCache = nil;
     if (!context)
     {
         SPLog(@"Error creating CGBitmapContext!");
+        [self release];
         return nil;
     }
     
@@ -176,24 +284,184 @@ static SP_GENERIC(SPCache, NSString*, SPTexture*) *textureCache = nil;
         UIGraphicsPopContext();        
     }
     
-    SPTextureProperties properties = {
+    CGContextRelease(context);
+
+    // on the CPU (and the current thread), instead of 'glGenerateMipmap' on the render thread
+    if (numMipmaps)
+        SPTextureGenerateMipmaps(_pixels, legalWidth, legalHeight, YES);
+
+    _width = width;
+    _height = height;
+    _properties = (SPTextureProperties){
         .format = SPTextureFormatRGBA,
         .scale  = scale,
         .width  = legalWidth,
         .height = legalHeight,
-        .numMipmaps = 0,
-        .generateMipmaps = mipmaps,
+        .numMipmaps = numMipmaps,
+        .generateMipmaps = NO,
         .premultipliedAlpha = YES
     };
+
+    return self;
+}
+
+- (void)dealloc
+{
+    free(_pixels);
+    [_pvrData release];
+    [_reloadPath release];
+    [_reloadOptions release];
+    [_atlas release];
+    [_atlasKey release];
+    [super dealloc];
+}
+
+- (SPTexture *)createTexture
+{
+    if (_atlas)
+    {
+        // files that can't be packed get a texture of their own
+        SPTexture *texture = [self addToAtlas:_atlas forKey:_atlasKey];
+        if (texture) return texture;
+    }
+
+    SPGLTexture *glTexture = [self createGLTexture];
+
+    if (_reloadPath)
+        [glTexture makeReloadableWithPath:_reloadPath options:_reloadOptions];
+
+    if (_pvrData) return glTexture;
+
+    SPRectangle *region = [SPRectangle rectangleWithX:0 y:0 width:_width height:_height];
+    return [SPTexture textureWithRegion:region ofTexture:glTexture];
+}
+
+- (SPGLTexture *)createGLTexture
+{
+    if (_pvrData)
+        return [[[SPGLTexture alloc] initWithPVRData:_pvrData scale:_pvrScale] autorelease];
+    else
+        return [[[SPGLTexture alloc] initWithData:_pixels properties:_properties] autorelease];
+}
+
+- (SPTexture *)addToAtlas:(SPDynamicAtlas *)atlas forKey:(NSString *)key
+{
+    if (_pvrData)
+    {
+        if (_pvrData.numMipmaps) return nil;
+
+        return [atlas addPixels:_pvrData.imageData width:_pvrData.width height:_pvrData.height
+                          scale:_pvrScale format:_pvrData.format
+             premultipliedAlpha:_pvrData.premultipliedAlpha forKey:key];
+    }
+    else if (_properties.numMipmaps) return nil;
+    else
+    {
+        return [atlas addPixels:_pixels width:_properties.width height:_properties.height
+                          scale:_properties.scale format:_properties.format
+             premultipliedAlpha:_properties.premultipliedAlpha forKey:key];
+    }
+}
+
+@end
+
+#pragma mark - SPTexture
+
+static SP_GENERIC(SPCache, NSString*, SPTexture*) *textureCache = nil;
+
+@implementation SPTexture
+
+#pragma mark Initialization
+
++ (void)initialize
+{
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^
+    {
+        textureCache = [[[SPCache class] alloc] initWithWeakValues];
+    });
+}
+
+- (instancetype)init
+{    
+    if ([self isMemberOfClass:[SPTexture class]]) 
+    {
+        return [self initWithWidth:32 height:32];
+    }
     
-    SPGLTexture *glTexture = [[[SPGLTexture alloc]
-                               initWithData:imageData properties:properties] autorelease];
-    
-    CGContextRelease(context);
-    free(imageData);
-    
-    SPRectangle *region = [SPRectangle rectangleWithX:0 y:0 width:width height:height];
-    return [[SPTexture alloc] initWithRegion:region ofTexture:glTexture];
+    return [super init];
+}
+
+- (instancetype)initWithContentsOfFile:(NSString *)path
+{
+    return [self initWithContentsOfFile:path generateMipmaps:NO];
+}
+
+- (instancetype)initWithContentsOfFile:(NSString *)path generateMipmaps:(BOOL)mipmaps
+{
+    SPTextureOptions *options = [SPTextureOptions textureOptions];
+    options.generateMipmaps = mipmaps;
+    return [self initWithContentsOfFile:path options:options];
+}
+
+- (instancetype)initWithContentsOfFile:(NSString *)path options:(SPTextureOptions *)options
+{
+    SPTexture *cachedTexture = textureCache[path];
+    if (cachedTexture)
+    {
+        [self release];
+        return [cachedTexture retain];
+    }
+
+    NSString *fullPath = [SPUtils absolutePathToFile:path];
+    if (!fullPath)
+        [NSException raise:SPExceptionFileNotFound format:@"File '%@' not found", path];
+
+    SPTexture *atlasTexture = [options.atlas textureForKey:fullPath];
+    if (atlasTexture && !options.generateMipmaps)
+    {
+        [self release];
+        return [atlasTexture retain];
+    }
+
+    SPDecodedTexture *decodedTexture = [[SPDecodedTexture alloc] initWithContentsOfFile:fullPath
+                                                                             options:options];
+    [self release]; // we'll return a subclass!
+    self = [[decodedTexture createTexture] retain];
+    [decodedTexture release];
+
+    textureCache[path] = self;
+    return self;
+}
+
+- (instancetype)initWithWidth:(float)width height:(float)height
+{
+    return [self initWithWidth:width height:height draw:NULL];
+}
+
+- (instancetype)initWithWidth:(float)width height:(float)height draw:(SPTextureDrawingBlock)drawingBlock
+{
+    return [self initWithWidth:width height:height generateMipmaps:NO draw:drawingBlock];
+}
+
+- (instancetype)initWithWidth:(float)width height:(float)height generateMipmaps:(BOOL)mipmaps
+                         draw:(SPTextureDrawingBlock)drawingBlock
+{
+    return [self initWithWidth:width height:height generateMipmaps:mipmaps
+                         scale:Sparrow.contentScaleFactor draw:drawingBlock];
+}
+
+- (instancetype)initWithWidth:(float)width height:(float)height generateMipmaps:(BOOL)mipmaps
+                        scale:(float)scale draw:(SPTextureDrawingBlock)drawingBlock
+{
+    [self release]; // class factory - we'll return a subclass!
+
+    SPDecodedTexture *decodedTexture = [[SPDecodedTexture alloc] initWithWidth:width height:height
+                                         generateMipmaps:mipmaps scale:scale draw:drawingBlock];
+    SPTexture *texture = [[decodedTexture createTexture] retain];
+    [decodedTexture release];
+
+    return texture;
 }
 
 - (instancetype)initWithContentsOfImage:(UIImage *)image
@@ -240,6 +508,11 @@ static SP_GENERIC(SPCache, NSString*, SPTexture*) *textureCache = nil;
     return [[[self alloc] initWithContentsOfFile:path generateMipmaps:mipmaps] autorelease];
 }
 
++ (instancetype)textureWithContentsOfFile:(NSString *)path options:(SPTextureOptions *)options
+{
+    return [[[self alloc] initWithContentsOfFile:path options:options] autorelease];
+}
+
 + (instancetype)textureWithRegion:(SPRectangle *)region ofTexture:(SPTexture *)texture
 {
     return [[[self alloc] initWithRegion:region ofTexture:texture] autorelease];
@@ -410,6 +683,28 @@ static SP_GENERIC(SPCache, NSString*, SPTexture*) *textureCache = nil;
     [self loadFromURL:suffixedURL generateMipmaps:mipmaps scale:scale onComplete:callback];
 }
 
+#pragma mark GPU Memory
+
++ (uint64_t)memoryBudget
+{
+    return [SPGLTexture memoryBudget];
+}
+
++ (void)setMemoryBudget:(uint64_t)numBytes
+{
+    [SPGLTexture setMemoryBudget:numBytes];
+}
+
++ (SPTextureMemoryStats)memoryStats
+{
+    return [SPGLTexture memoryStats];
+}
+
++ (void)evictReloadableTextures
+{
+    [SPGLTexture evictTexturesWithNumBytes:UINT64_MAX];
+}
+
 #pragma mark Properties
 
 - (float)width
@@ -494,15 +789,16 @@ static SP_GENERIC(SPCache, NSString*, SPTexture*) *textureCache = nil;
     [NSException raise:SPExceptionAbstractMethod format:@"Override 'setSmoothing' in subclasses."];
 }
 
-+ (BOOL)isPVRFile:(NSString *)path
+#pragma mark Internal
+
++ (SPTexture *)cachedTextureForPath:(NSString *)path
 {
-    path = [path lowercaseString];
-    return [path hasSuffix:@".pvr"] || [path hasSuffix:@".pvr.gz"];
+    return textureCache[path];
 }
 
-+ (BOOL)isCompressedFile:(NSString *)path
++ (void)cacheTexture:(SPTexture *)texture forPath:(NSString *)path
 {
-    return [[path lowercaseString] hasSuffix:@".gz"];
+    textureCache[path] = texture;
 }
 
 @end
@@ -55,6 +55,18 @@ NS_ASSUME_NONNULL_BEGIN
 	<SubTexture name='trimmed' x='0' y='0' height='10' width='10'
 	            frameX='-10' frameY='-10' frameWidth='30' frameHeight='30'/>
  
+ **Binary atlases**
+
+ Parsing XML takes time, which adds up when an app loads lots of atlases at startup. To avoid
+ that, convert the XML file into Sparrow's binary format with `convertXmlFile:toBinaryFile:`
+ (e.g. in the simulator or in a small build tool) and add the resulting `.spb` file next to the
+ XML file. The binary file is memory-mapped and read without any parsing. It is only used as
+ long as the XML file it was created from does not change; you can also omit the XML file
+ completely.
+
+	// creates 'atlas.spb' next to 'atlas.xml'
+	[SPTextureAtlas convertXmlFile:@"/path/to/atlas.xml" toBinaryFile:nil];
+
 ------------------------------------------------------------------------------------------------- */
 
 @interface SPTextureAtlas : NSObject
@@ -75,11 +87,16 @@ NS_ASSUME_NONNULL_BEGIN
 /// Factory Method.
 + (instancetype)atlasWithContentsOfFile:(NSString *)path;
 
+/// Converts an atlas XML file into the binary atlas format and returns the path of the binary
+/// file. If `binaryPath` is nil, it is stored next to the XML file, with the extension `spb`.
++ (NSString *)convertXmlFile:(NSString *)xmlPath toBinaryFile:(nullable NSString *)binaryPath;
+
 /// -------------
 /// @name Methods
 /// -------------
 
-/// Retrieve a subtexture by name. Returns `nil` if it is not found.
+/// Retrieve a subtexture by name. Returns `nil` if it is not found. The subtexture is created
+/// only once per region; subsequent calls return the same object.
 - (nullable SPTexture *)textureByName:(NSString *)name;
 
 /// The region rectangle associated with a specific name.
@@ -92,7 +109,9 @@ NS_ASSUME_NONNULL_BEGIN
 /// (especially useful for `SPMovieClip`).
 - (SP_GENERIC(NSArray, SPTexture*) *)texturesStartingWith:(nullable NSString *)prefix;
 
-/// Returns all texture names that start with a certain string, sorted alphabetically.
+/// Returns all texture names that start with a certain string, sorted alphabetically. The names
+/// are kept in a sorted index, so the time this takes depends on the number of matching names,
+/// not on the size of the atlas.
 - (SP_GENERIC(NSArray, NSString*) *)namesStartingWith:(nullable NSString *)prefix;
 
 /// Creates a region for a subtexture and gives it a name.
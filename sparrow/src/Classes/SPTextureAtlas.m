@@ -10,14 +10,16 @@
 //
 
 #import "SparrowClass.h"
+#import "SPBinaryAsset.h"
 #import "SPGLTexture.h"
 #import "SPMacros.h"
 #import "SPNSExtensions.h"
 #import "SPRectangle.h"
 #import "SPSubTexture.h"
 #import "SPTexture.h"
-#import "SPTextureAtlas.h"
+#import "SPTextureAtlas_Internal.h"
 #import "SPUtils.h"
+#import "SPXMLReader.h"
 
 // --- helper class --------------------------------------------------------------------------------
 
@@ -26,6 +28,7 @@
     SPRectangle *_region;
     SPRectangle *_frame;
     BOOL _rotated;
+    SPSubTexture *_texture;
 }
 
 - (instancetype)initWithRegion:(SPRectangle *)region frame:(SPRectangle *)frame
@@ -34,6 +37,7 @@
 @property (nonatomic, readonly) SPRectangle *region;
 @property (nonatomic, readonly) SPRectangle *frame;
 @property (nonatomic, readonly) BOOL rotated;
+@property (nonatomic, retain) SPSubTexture *texture;
 
 @end
 
@@ -55,6 +59,7 @@
 {
     [_region release];
     [_frame release];
+    [_texture release];
     [super dealloc];
 }
 
@@ -66,10 +71,49 @@
 {
     SPTexture *_atlasTexture;
     SP_GENERIC(NSMutableDictionary, NSString*, SPTextureInfo*) *_textureInfos;
+    SP_GENERIC(NSMutableArray, NSString*) *_sortedNames;   // literal order, for prefix searches
+    SP_GENERIC(NSArray, NSString*) *_names;                // natural order, created on demand
 }
 
 @synthesize texture = _atlasTexture;
 
+static void addRegionInPixels(SPTextureAtlas *self, NSString *name, float x, float y,
+                              float width, float height, float frameX, float frameY,
+                              float frameWidth, float frameHeight, BOOL rotated)
+{
+    float scale = self->_atlasTexture.scale;
+
+    SPRectangle *region = [SPRectangle rectangleWithX:x / scale y:y / scale
+                                                width:width / scale height:height / scale];
+    SPRectangle *frame = nil;
+
+    if (frameWidth && frameHeight)
+        frame = [SPRectangle rectangleWithX:frameX / scale y:frameY / scale
+                                      width:frameWidth / scale height:frameHeight / scale];
+
+    [self addRegion:region withName:name frame:frame rotated:rotated];
+}
+
+static NSUInteger indexOfFirstNameNotBefore(SPTextureAtlas *self, NSString *name)
+{
+    // binary search in the literally sorted names; all names with a common prefix follow each
+    // other, starting at the index returned for the prefix itself.
+    NSArray *sortedNames = self->_sortedNames;
+    NSUInteger low = 0;
+    NSUInteger high = sortedNames.count;
+
+    while (low < high)
+    {
+        NSUInteger mid = (low + high) / 2;
+        if ([sortedNames[mid] compare:name options:NSLiteralSearch] == NSOrderedAscending)
+            low = mid + 1;
+        else
+            high = mid;
+    }
+
+    return low;
+}
+
 #pragma mark Initialization
 
 - (instancetype)initWithContentsOfFile:(NSString *)path texture:(SPTexture *)texture
@@ -77,6 +121,7 @@
     if ((self = [super init]))
     {
         _textureInfos = [[NSMutableDictionary alloc] init];
+        _sortedNames = [[NSMutableArray alloc] init];
         _atlasTexture = [texture retain];
         [self parseAtlasXml:path];
     }
@@ -102,6 +147,8 @@
 {
     [_atlasTexture release];
     [_textureInfos release];
+    [_sortedNames release];
+    [_names release];
     [super dealloc];
 }
 
@@ -110,21 +157,81 @@
     return [[[self alloc] initWithContentsOfFile:path] autorelease];
 }
 
+#pragma mark Binary Conversion
+
++ (NSString *)convertXmlFile:(NSString *)xmlPath toBinaryFile:(NSString *)binaryPath
+{
+    NSString *path = [SPUtils absolutePathToFile:xmlPath];
+    if (!path) [NSException raise:SPExceptionFileNotFound format:@"file not found: %@", xmlPath];
+    if (!binaryPath) binaryPath = SPBinaryAssetPathForFile(path);
+
+    NSData *xmlData = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:nil];
+    NSMutableData *regions = [NSMutableData data];
+    SPBinaryAssetWriter *writer = [[SPBinaryAssetWriter alloc] initWithType:SPBinaryAssetTypeAtlas
+                                   sourceData:xmlData headerSize:sizeof(SPBinaryAtlasHeader)];
+    SPBinaryAtlasHeader *header = writer.header;
+
+    SPXMLReader *reader = [[SPXMLReader alloc] initWithData:xmlData];
+    BOOL success = [reader parseElementsWithBlock:^(const SPXMLElement *element, BOOL *stop)
+    {
+        if (SPXMLElementHasName(element, "SubTexture"))
+        {
+            SPBinaryRegion region = {
+                .name = [writer addString:SPXMLElementString(element, "name")],
+                .x = SPXMLElementFloat(element, "x"),
+                .y = SPXMLElementFloat(element, "y"),
+                .width = SPXMLElementFloat(element, "width"),
+                .height = SPXMLElementFloat(element, "height"),
+                .frameX = SPXMLElementFloat(element, "frameX"),
+                .frameY = SPXMLElementFloat(element, "frameY"),
+                .frameWidth = SPXMLElementFloat(element, "frameWidth"),
+                .frameHeight = SPXMLElementFloat(element, "frameHeight"),
+                .rotated = SPXMLElementBool(element, "rotated")
+            };
+
+            [regions appendBytes:&region length:sizeof(SPBinaryRegion)];
+        }
+        else if (SPXMLElementHasName(element, "TextureAtlas"))
+        {
+            header->imagePath = [writer addString:SPXMLElementString(element, "imagePath")];
+        }
+    }];
+
+    NSString *errorMessage = [[reader.errorMessage retain] autorelease];
+    [reader release];
+
+    if (!success)
+    {
+        [writer release];
+        [NSException raise:SPExceptionFileInvalid format:@"could not parse texture atlas %@. Error: %@",
+         path, errorMessage];
+    }
+
+    header->numRegions = (uint32_t)(regions.length / sizeof(SPBinaryRegion));
+    header->regionsOffset = [writer appendTable:regions.bytes count:header->numRegions
+                                     recordSize:sizeof(SPBinaryRegion)];
+    [writer writeToFile:binaryPath];
+    [writer release];
+
+    return binaryPath;
+}
+
 #pragma mark Methods
 
 - (SPTexture *)textureByName:(NSString *)name
 {
     SPTextureInfo *info = _textureInfos[name];
-    SPSubTexture *texture = nil;
 
-    if (info)
+    if (info && !info.texture)
     {
-        texture = [[SPSubTexture alloc] initWithRegion:info.region frame:info.frame
-                                               rotated:info.rotated ofTexture:_atlasTexture];
-        [texture autorelease];
+        // subtextures are immutable, so each region needs just one
+        SPSubTexture *texture = [[SPSubTexture alloc] initWithRegion:info.region frame:info.frame
+                                                             rotated:info.rotated ofTexture:_atlasTexture];
+        info.texture = texture;
+        [texture release];
     }
 
-    return texture;
+    return info.texture;
 }
 
 - (SPRectangle *)regionByName:(NSString *)name
@@ -152,19 +259,24 @@
 
 - (NSArray *)namesStartingWith:(NSString *)prefix
 {
-    SP_GENERIC(NSMutableArray, NSString*) *names = [NSMutableArray array];
-    
-    if (prefix)
+    if (!prefix.length)
     {
-        for (NSString *name in _textureInfos)
-            if ([name rangeOfString:prefix].location == 0)
-                [names addObject:name];
+        if (!_names)
+            _names = [[_sortedNames sortedArrayUsingSelector:@selector(localizedStandardCompare:)] retain];
+
+        return [[_names retain] autorelease];
     }
-    else
-        [names addObjectsFromArray:[_textureInfos allKeys]];
-    
-    [names sortUsingSelector:@selector(localizedStandardCompare:)];
-    return names;
+
+    NSUInteger numNames = _sortedNames.count;
+    NSUInteger start = indexOfFirstNameNotBefore(self, prefix);
+    NSUInteger end = start;
+
+    while (end < numNames && [_sortedNames[end] hasPrefix:prefix])
+        ++end;
+
+    // the literal order would put 'frame_10' before 'frame_2'
+    NSArray *names = [_sortedNames subarrayWithRange:NSMakeRange(start, end - start)];
+    return [names sortedArrayUsingSelector:@selector(localizedStandardCompare:)];
 }
 
 - (void)addRegion:(SPRectangle *)region withName:(NSString *)name
@@ -180,6 +292,13 @@
 - (void)addRegion:(SPRectangle *)region withName:(NSString *)name frame:(SPRectangle *)frame
           rotated:(BOOL)rotated
 {
+    if (!_textureInfos[name])
+    {
+        name = [[name copy] autorelease];
+        [_sortedNames insertObject:name atIndex:indexOfFirstNameNotBefore(self, name)];
+        SP_RELEASE_AND_NIL(_names);
+    }
+
     SPTextureInfo *info = [[SPTextureInfo alloc] initWithRegion:region frame:frame rotated:rotated];
     _textureInfos[name] = info;
     [info release];
@@ -187,7 +306,51 @@
 
 - (void)removeRegion:(NSString *)name
 {
+    if (!_textureInfos[name]) return;
+
+    [_sortedNames removeObjectAtIndex:indexOfFirstNameNotBefore(self, name)];
     [_textureInfos removeObjectForKey:name];
+    SP_RELEASE_AND_NIL(_names);
+}
+
+#pragma mark Internal
+
++ (NSString *)texturePathForContentsOfFile:(NSString *)path
+{
+    NSString *absolutePath = nil;
+    NSData *binaryData = SPBinaryAssetLoad(path, SPBinaryAssetTypeAtlas, &absolutePath);
+    NSString *folder = [absolutePath stringByDeletingLastPathComponent];
+    __block NSString *filename = nil;
+
+    if (binaryData)
+    {
+        if (binaryData.length < sizeof(SPBinaryAtlasHeader))
+            [NSException raise:SPExceptionFileInvalid format:@"corrupt binary atlas: %@", absolutePath];
+
+        const SPBinaryAtlasHeader *header = binaryData.bytes;
+        filename = SPBinaryAssetString(binaryData, header->imagePath);
+    }
+    else
+    {
+        NSData *xmlData = [NSData dataWithContentsOfFile:absolutePath options:NSDataReadingMappedIfSafe
+                                                   error:nil];
+        SPXMLReader *reader = [[SPXMLReader alloc] initWithData:xmlData];
+        [reader parseElementsWithBlock:^(const SPXMLElement *element, BOOL *stop)
+        {
+            if (SPXMLElementHasName(element, "TextureAtlas"))
+            {
+                filename = SPXMLElementString(element, "imagePath");
+                *stop = YES;
+            }
+        }];
+        [reader release];
+    }
+
+    if (!filename.length)
+        [NSException raise:SPExceptionDataInvalid format:@"Atlas %@ did not contain path to texture",
+         absolutePath];
+
+    return [folder stringByAppendingPathComponent:filename];
 }
 
 #pragma mark Properties
@@ -213,53 +376,76 @@
 {
     if (!relativePath) return;
 
-    NSString *path = [SPUtils absolutePathToFile:relativePath];
-    if (!path) [NSException raise:SPExceptionFileNotFound format:@"file not found: %@", relativePath];
+    NSString *path = nil;
+    NSData *binaryData = SPBinaryAssetLoad(relativePath, SPBinaryAssetTypeAtlas, &path);
+
+    if (binaryData)
+    {
+        [self parseAtlasBinary:binaryData path:path];
+        return;
+    }
 
-    NSData *xmlData = [[NSData alloc] initWithContentsOfFile:path];
-    NSXMLParser *parser = [[NSXMLParser alloc] initWithData:xmlData];
-    [xmlData release];
+    NSData *xmlData = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:nil];
+    SPXMLReader *reader = [[SPXMLReader alloc] initWithData:xmlData];
 
-    BOOL success = [parser parseElementsWithBlock:^(NSString *elementName, NSDictionary *attributes)
+    BOOL success = [reader parseElementsWithBlock:^(const SPXMLElement *element, BOOL *stop)
     {
-        if ([elementName isEqualToString:@"SubTexture"])
+        if (SPXMLElementHasName(element, "SubTexture"))
         {
-            float scale = _atlasTexture.scale;
-
-            NSString *name = attributes[@"name"];
-            float x = [attributes[@"x"] floatValue] / scale;
-            float y = [attributes[@"y"] floatValue] / scale;
-            float width = [attributes[@"width"] floatValue] / scale;
-            float height = [attributes[@"height"] floatValue] / scale;
-            float frameX = [attributes[@"frameX"] floatValue] / scale;
-            float frameY = [attributes[@"frameY"] floatValue] / scale;
-            float frameWidth = [attributes[@"frameWidth"] floatValue] / scale;
-            float frameHeight = [attributes[@"frameHeight"] floatValue] / scale;
-            BOOL  rotated = [attributes[@"rotated"] boolValue];
-
-            SPRectangle *region = [SPRectangle rectangleWithX:x y:y width:width height:height];
-            SPRectangle *frame = nil;
-
-            if (frameWidth && frameHeight)
-                frame = [SPRectangle rectangleWithX:frameX y:frameY width:frameWidth height:frameHeight];
-
-            [self addRegion:region withName:name frame:frame rotated:rotated];
+            addRegionInPixels(self, SPXMLElementString(element, "name"),
+                              SPXMLElementFloat(element, "x"),
+                              SPXMLElementFloat(element, "y"),
+                              SPXMLElementFloat(element, "width"),
+                              SPXMLElementFloat(element, "height"),
+                              SPXMLElementFloat(element, "frameX"),
+                              SPXMLElementFloat(element, "frameY"),
+                              SPXMLElementFloat(element, "frameWidth"),
+                              SPXMLElementFloat(element, "frameHeight"),
+                              SPXMLElementBool(element, "rotated"));
         }
-        else if ([elementName isEqualToString:@"TextureAtlas"] && !_atlasTexture)
+        else if (SPXMLElementHasName(element, "TextureAtlas") && !_atlasTexture)
         {
             // load atlas texture
-            NSString *filename = [attributes valueForKey:@"imagePath"];
+            NSString *filename = SPXMLElementString(element, "imagePath");
             NSString *textureFolder = [path stringByDeletingLastPathComponent];
             NSString *texturePath = [textureFolder stringByAppendingPathComponent:filename];
             _atlasTexture = [[SPTexture alloc] initWithContentsOfFile:texturePath];
         }
     }];
-    
-    [parser release];
+
+    NSString *errorMessage = [[reader.errorMessage retain] autorelease];
+    [reader release];
     
     if (!success)
         [NSException raise:SPExceptionFileInvalid format:@"could not parse texture atlas %@. Error: %@",
-         path, parser.parserError.localizedDescription];
+         path, errorMessage];
+}
+
+- (void)parseAtlasBinary:(NSData *)data path:(NSString *)path
+{
+    const SPBinaryAtlasHeader *header = data.bytes;
+
+    if (data.length < sizeof(SPBinaryAtlasHeader))
+        [NSException raise:SPExceptionFileInvalid format:@"corrupt binary atlas: %@", path];
+
+    if (!_atlasTexture)
+    {
+        NSString *filename = SPBinaryAssetString(data, header->imagePath);
+        NSString *textureFolder = [path stringByDeletingLastPathComponent];
+        NSString *texturePath = [textureFolder stringByAppendingPathComponent:filename];
+        _atlasTexture = [[SPTexture alloc] initWithContentsOfFile:texturePath];
+    }
+
+    // the regions are read right from the mapped file
+    const SPBinaryRegion *regions = SPBinaryAssetTable(data, header->regionsOffset,
+                                                       header->numRegions, sizeof(SPBinaryRegion));
+
+    for (uint32_t i=0; i<header->numRegions; ++i)
+    {
+        const SPBinaryRegion *r = &regions[i];
+        addRegionInPixels(self, SPBinaryAssetString(data, r->name), r->x, r->y, r->width, r->height,
+                          r->frameX, r->frameY, r->frameWidth, r->frameHeight, r->rotated != 0);
+    }
 }
 
 @end
@@ -0,0 +1,24 @@
+//
+//  SPTextureAtlas_Internal.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 16.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPTextureAtlas.h"
+
+NS_ASSUME_NONNULL_BEGIN
+
+@interface SPTextureAtlas (Internal)
+
+/// Returns the absolute path of the texture an atlas file (XML or binary) refers to, reading only
+/// as much of the file as necessary.
++ (NSString *)texturePathForContentsOfFile:(NSString *)path;
+
+@end
+
+NS_ASSUME_NONNULL_END
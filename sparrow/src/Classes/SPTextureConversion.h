@@ -0,0 +1,63 @@
+//
+//  SPTextureConversion.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 19.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import <Sparrow/SparrowBase.h>
+#import <Sparrow/SPMacros.h>
+#import <Sparrow/SPTexture.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Describes how the rounding errors are distributed when pixels are converted into a format
+/// with fewer bits per channel.
+typedef NS_ENUM(NSInteger, SPTextureDithering)
+{
+    /// Each channel is rounded to the nearest value. Gradients show visible bands.
+    SPTextureDitheringNone,
+    /// Adds a 4x4 Bayer pattern before rounding. Fast, with a regular, fine-grained pattern.
+    SPTextureDitheringOrdered,
+    /// Distributes the error of each pixel to its neighbours (Floyd-Steinberg). Looks best for
+    /// photos and gradients, but processes the pixels of a row one after the other.
+    SPTextureDitheringDiffusion
+};
+
+/// Indicates if RGBA pixels (8 bits per channel) can be converted into a certain format. That's
+/// the case for all uncompressed formats.
+SP_EXTERN BOOL SPTextureFormatIsConvertible(SPTextureFormat format);
+
+/// Converts RGBA pixels (8 bits per channel, tightly packed) into another uncompressed format.
+/// `output` must provide room for the converted pixels, which are tightly packed as well.
+/// Formats without color channels use the luminance, formats without alpha ignore it. When
+/// `pma` is set, colors are clamped to the alpha value after rounding, so that they stay valid.
+SP_EXTERN void SPTextureConvertPixels(const void *rgba, void *output, NSInteger width,
+                                      NSInteger height, SPTextureFormat format,
+                                      SPTextureDithering dithering, BOOL pma);
+
+/// Multiplies the color channels of RGBA pixels (8 bits per channel) with their alpha value,
+/// in place. Uses SIMD instructions where possible.
+SP_EXTERN void SPTexturePremultiplyPixels(void *rgba, NSInteger numPixels);
+
+/// Divides the color channels of premultiplied RGBA pixels (8 bits per channel) by their alpha
+/// value, in place. Uses SIMD instructions where possible.
+SP_EXTERN void SPTextureUnpremultiplyPixels(void *rgba, NSInteger numPixels);
+
+/// Returns the number of mipmaps below a texture of a certain size (in pixels), down to 1x1.
+SP_EXTERN NSInteger SPTextureNumMipmaps(NSInteger width, NSInteger height);
+
+/// Calculates all mipmaps of RGBA pixels (8 bits per channel). The levels are stored right
+/// after the original pixels, which must provide room for them; that's the layout that
+/// `SPGLTexture` expects for its `numMipmaps` property.
+///
+/// The colors are expected in sRGB and averaged in linear space, weighted by their alpha value;
+/// thus, mipmaps neither get darker nor show dark halos around transparent areas. Big levels
+/// are split up and calculated on several threads; the function returns when all are finished.
+SP_EXTERN void SPTextureGenerateMipmaps(void *rgba, NSInteger width, NSInteger height, BOOL pma);
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,583 @@
+//
+//  SPTextureConversion.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 19.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPTextureConversion.h"
+
+#import <simd/simd.h>
+
+#define MIN_PARALLEL_PIXELS 16384 // smaller mipmaps are not worth the thread overhead
+#define LINEAR_LUT_SIZE      4096
+
+// Pixels are converted in a common layout: three color channels (or the luminance in the first
+// one) and the alpha value in the last one. Each channel is scaled to its number of bits and
+// rounded; dithering adds an offset (ordered) or the carried error (diffusion) before rounding.
+
+typedef struct
+{
+    vector_float4 maxValues;    // the highest value per channel after conversion; 0 = unused
+    vector_float4 ditherMask;   // 1 for channels that are dithered
+    BOOL luminance;             // the first channel contains the luminance
+} SPConversionInfo;
+
+static const float bayerMatrix[4][4] =
+{
+    {  0,  8,  2, 10 },
+    { 12,  4, 14,  6 },
+    {  3, 11,  1,  9 },
+    { 15,  7, 13,  5 }
+};
+
+static float srgbToLinear[256];
+static uchar linearToSRGB[LINEAR_LUT_SIZE];
+
+// --- C functions ---------------------------------------------------------------------------------
+
+static BOOL getConversionInfo(SPTextureFormat format, SPConversionInfo *info)
+{
+    vector_float4 all = { 1, 1, 1, 1 };
+
+    switch (format)
+    {
+        case SPTextureFormatRGBA:
+            *info = (SPConversionInfo){ { 255, 255, 255, 255 }, all, NO }; return YES;
+        case SPTextureFormat888:
+            *info = (SPConversionInfo){ { 255, 255, 255,   0 }, all, NO }; return YES;
+        case SPTextureFormat565:
+            *info = (SPConversionInfo){ {  31,  63,  31,   0 }, all, NO }; return YES;
+        case SPTextureFormat5551:
+            // dithering a single bit of alpha would only create noise at the edges
+            *info = (SPConversionInfo){ {  31,  31,  31,   1 }, { 1, 1, 1, 0 }, NO }; return YES;
+        case SPTextureFormat4444:
+            *info = (SPConversionInfo){ {  15,  15,  15,  15 }, all, NO }; return YES;
+        case SPTextureFormatAI88:
+            *info = (SPConversionInfo){ { 255,   0,   0, 255 }, all, YES }; return YES;
+        case SPTextureFormatI8:
+            *info = (SPConversionInfo){ { 255,   0,   0,   0 }, all, YES }; return YES;
+        case SPTextureFormatAlpha:
+            *info = (SPConversionInfo){ {   0,   0,   0, 255 }, all, NO }; return YES;
+        default:
+            return NO;
+    }
+}
+
+SP_INLINE vector_float4 loadPixel(const uchar *pixel, const SPConversionInfo *info)
+{
+    vector_float4 value = { pixel[0], pixel[1], pixel[2], pixel[3] };
+
+    if (info->luminance)
+        value.x = vector_dot(value.xyz, (vector_float3){ 0.299f, 0.587f, 0.114f });
+
+    // scaled to the range of the target channels
+    return value * (info->maxValues / 255.0f);
+}
+
+SP_INLINE vector_float4 quantize(vector_float4 value, const SPConversionInfo *info, BOOL pma)
+{
+    vector_float4 maxValues = info->maxValues;
+    vector_float4 result = vector_clamp(vector_floor(value + 0.5f), (vector_float4)0.0f, maxValues);
+
+    if (pma && maxValues.w)
+    {
+        // rounding must not lead to colors that are brighter than the alpha value allows
+        vector_float3 limit = vector_floor(result.w * maxValues.xyz / maxValues.w + 0.5f);
+        result.xyz = vector_min(result.xyz, limit);
+    }
+
+    return result;
+}
+
+SP_INLINE vector_float16 repeatPixel(vector_float4 value)
+{
+    return __builtin_shufflevector(value, value, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3, 0, 1, 2, 3);
+}
+
+SP_INLINE vector_uchar16 quantizePixels(vector_uchar16 pixels, vector_float16 offsets,
+                                        vector_float16 scale, vector_float16 maxValues,
+                                        vector_float16 alphaRatios, BOOL luminance, BOOL pma)
+{
+    // the same as 'loadPixel' and 'quantize', but for four pixels at once
+    vector_float16 value = __builtin_convertvector(pixels, vector_float16);
+
+    if (luminance)
+    {
+        vector_float16 r = __builtin_shufflevector(value, value,  0,  0,  0,  0,  4,  4,  4,  4,
+                                                                  8,  8,  8,  8, 12, 12, 12, 12);
+        vector_float16 g = __builtin_shufflevector(value, value,  1,  1,  1,  1,  5,  5,  5,  5,
+                                                                  9,  9,  9,  9, 13, 13, 13, 13);
+        vector_float16 b = __builtin_shufflevector(value, value,  2,  2,  2,  2,  6,  6,  6,  6,
+                                                                 10, 10, 10, 10, 14, 14, 14, 14);
+        vector_float16 lum = r * 0.299f + g * 0.587f + b * 0.114f;
+        value = __builtin_shufflevector(lum, value,  0, 17, 18, 19,  4, 21, 22, 23,
+                                                     8, 25, 26, 27, 12, 29, 30, 31);
+    }
+
+    vector_float16 result = vector_clamp(vector_floor(value * scale + offsets + 0.5f),
+                                         (vector_float16)0.0f, maxValues);
+    if (pma)
+    {
+        vector_float16 alpha = __builtin_shufflevector(result, result, 3, 3, 3, 3, 7, 7, 7, 7,
+                                                       11, 11, 11, 11, 15, 15, 15, 15);
+        result = vector_min(result, vector_floor(alpha * alphaRatios + 0.5f));
+    }
+
+    return __builtin_convertvector(result, vector_uchar16);
+}
+
+static void storeRow(const uchar *quantized, SPTextureFormat format, uchar *output,
+                     NSInteger index, NSInteger numPixels)
+{
+    // 'quantized' contains one value per channel, like the input; the format is only checked
+    // once per row, which leaves simple loops that the compiler can vectorize.
+    uint16_t *output16 = (uint16_t *)output + index;
+    const uchar *q = quantized;
+
+    switch (format)
+    {
+        case SPTextureFormatRGBA:
+            memcpy(output + index * 4, q, numPixels * 4);
+            break;
+        case SPTextureFormat888:
+            for (NSInteger i=0; i<numPixels; ++i, q += 4)
+                memcpy(output + (index + i) * 3, q, 3);
+            break;
+        case SPTextureFormat565:
+            for (NSInteger i=0; i<numPixels; ++i, q += 4)
+                output16[i] = q[0] << 11 | q[1] << 5 | q[2];
+            break;
+        case SPTextureFormat5551:
+            for (NSInteger i=0; i<numPixels; ++i, q += 4)
+                output16[i] = q[0] << 11 | q[1] << 6 | q[2] << 1 | q[3];
+            break;
+        case SPTextureFormat4444:
+            for (NSInteger i=0; i<numPixels; ++i, q += 4)
+                output16[i] = q[0] << 12 | q[1] << 8 | q[2] << 4 | q[3];
+            break;
+        case SPTextureFormatAI88:
+            for (NSInteger i=0; i<numPixels; ++i, q += 4)
+            {
+                output[(index + i) * 2]     = q[0];
+                output[(index + i) * 2 + 1] = q[3];
+            }
+            break;
+        case SPTextureFormatI8:
+            for (NSInteger i=0; i<numPixels; ++i, q += 4)
+                output[index + i] = q[0];
+            break;
+        default:
+            for (NSInteger i=0; i<numPixels; ++i, q += 4)
+                output[index + i] = q[3];
+            break;
+    }
+}
+
+static void convertOrdered(const uchar *rgba, uchar *output, NSInteger width, NSInteger height,
+                           SPTextureFormat format, const SPConversionInfo *info, BOOL pma,
+                           BOOL dither)
+{
+    // Four pixels are converted at once. They always start at a multiple of four, so they get
+    // one row of the Bayer matrix; its offsets are centered around zero, so that flat areas
+    // keep their average value.
+    vector_float4 maxValues = info->maxValues;
+    vector_float16 offsets[4];
+
+    for (int y=0; y<4; ++y)
+        for (int i=0; i<16; ++i)
+            offsets[y][i] = dither ? ((bayerMatrix[y][i / 4] + 0.5f) / 16.0f - 0.5f) *
+                                     info->ditherMask[i % 4] : 0.0f;
+
+    // with PMA, colors are clamped to the alpha value (and the alpha value to itself)
+    BOOL clampToAlpha = pma && maxValues.w;
+    vector_float4 alphaRatios = clampToAlpha ? maxValues / maxValues.w : (vector_float4)0.0f;
+    alphaRatios.w = 1.0f;
+
+    vector_float16 scale = repeatPixel(maxValues / 255.0f);
+    vector_float16 maxValues16 = repeatPixel(maxValues);
+    vector_float16 alphaRatios16 = repeatPixel(alphaRatios);
+    BOOL luminance = info->luminance;
+
+    uchar *quantized = malloc(width * 4);
+    if (!quantized)
+        [NSException raise:SPExceptionOperationFailed
+                    format:@"Could not allocate the conversion buffer"];
+
+    for (NSInteger y=0; y<height; ++y)
+    {
+        const uchar *row = rgba + y * width * 4;
+        vector_float16 rowOffsets = offsets[y & 3];
+        vector_uchar16 pixels;
+        NSInteger x = 0;
+
+        for (; x + 4 <= width; x += 4)
+        {
+            memcpy(&pixels, row + x * 4, sizeof(pixels));
+            pixels = quantizePixels(pixels, rowOffsets, scale, maxValues16, alphaRatios16,
+                                    luminance, clampToAlpha);
+            memcpy(quantized + x * 4, &pixels, sizeof(pixels));
+        }
+
+        if (x < width)
+        {
+            // the last pixels of the row, padded to four
+            size_t numBytes = (width - x) * 4;
+            pixels = 0;
+            memcpy(&pixels, row + x * 4, numBytes);
+            pixels = quantizePixels(pixels, rowOffsets, scale, maxValues16, alphaRatios16,
+                                    luminance, clampToAlpha);
+            memcpy(quantized + x * 4, &pixels, numBytes);
+        }
+
+        storeRow(quantized, format, output, y * width, width);
+    }
+
+    free(quantized);
+}
+
+static void convertDiffusion(const uchar *rgba, uchar *output, NSInteger width, NSInteger height,
+                             SPTextureFormat format, const SPConversionInfo *info, BOOL pma)
+{
+    // Floyd-Steinberg: the errors of the current and the next row, with a pixel of padding on
+    // both sides, so that the edges don't need special treatment.
+    vector_float4 *errors = calloc((width + 2) * 2, sizeof(vector_float4));
+    uchar *quantized = malloc(width * 4);
+
+    if (!errors || !quantized)
+    {
+        free(errors);
+        free(quantized);
+        [NSException raise:SPExceptionOperationFailed
+                    format:@"Could not allocate the conversion buffer"];
+    }
+
+    vector_float4 *currentErrors = errors;
+    vector_float4 *nextErrors = errors + width + 2;
+
+    for (NSInteger y=0; y<height; ++y)
+    {
+        NSInteger rowIndex = y * width;
+
+        for (NSInteger x=0; x<width; ++x)
+        {
+            vector_float4 value = loadPixel(rgba + (rowIndex + x) * 4, info) + currentErrors[x+1];
+            vector_float4 result = quantize(value, info, pma);
+            vector_float4 error = (value - result) * info->ditherMask;
+            vector_uchar4 q = __builtin_convertvector(result, vector_uchar4);
+
+            currentErrors[x+2] += error * (7.0f / 16.0f);
+            nextErrors[x]      += error * (3.0f / 16.0f);
+            nextErrors[x+1]    += error * (5.0f / 16.0f);
+            nextErrors[x+2]    += error * (1.0f / 16.0f);
+
+            memcpy(quantized + x * 4, &q, 4);
+        }
+
+        storeRow(quantized, format, output, rowIndex, width);
+
+        vector_float4 *swap = currentErrors;
+        currentErrors = nextErrors;
+        nextErrors = swap;
+        memset(nextErrors, 0, (width + 2) * sizeof(vector_float4));
+    }
+
+    free(quantized);
+    free(errors);
+}
+
+// --- mipmaps -------------------------------------------------------------------------------------
+
+static void initGammaTables(void)
+{
+    static dispatch_once_t onceToken;
+    dispatch_once(&onceToken, ^
+    {
+        for (int i=0; i<256; ++i)
+        {
+            float value = i / 255.0f;
+            srgbToLinear[i] = value <= 0.04045f ? value / 12.92f
+                                                : powf((value + 0.055f) / 1.055f, 2.4f);
+        }
+
+        for (int i=0; i<LINEAR_LUT_SIZE; ++i)
+        {
+            float value = i / (LINEAR_LUT_SIZE - 1.0f);
+            float srgb = value <= 0.0031308f ? value * 12.92f
+                                             : 1.055f * powf(value, 1.0f / 2.4f) - 0.055f;
+            linearToSRGB[i] = (uchar)(srgb * 255.0f + 0.5f);
+        }
+    });
+}
+
+SP_INLINE vector_float4 loadLinear(const uchar *pixel, BOOL pma)
+{
+    // returns linear colors, premultiplied with alpha; those can simply be averaged
+    uint alpha = pixel[3];
+    vector_float4 result = 0.0f;
+
+    if (alpha)
+    {
+        for (int c=0; c<3; ++c)
+        {
+            uint straight = pma ? MIN(255, (pixel[c] * 255 + alpha / 2) / alpha) : pixel[c];
+            result[c] = srgbToLinear[straight];
+        }
+
+        result.w = 1.0f;
+        result *= alpha / 255.0f;
+    }
+
+    return result;
+}
+
+SP_INLINE void storeLinear(vector_float4 value, uchar *pixel, BOOL pma)
+{
+    float alpha = value.w;
+
+    if (alpha > 0.0f)
+    {
+        vector_float3 straight = vector_clamp(value.xyz / alpha, (vector_float3)0.0f,
+                                              (vector_float3)1.0f);
+        vector_int3 indices = __builtin_convertvector(straight * (LINEAR_LUT_SIZE - 1.0f) + 0.5f,
+                                                      vector_int3);
+        vector_float3 srgb = { linearToSRGB[indices.x], linearToSRGB[indices.y],
+                               linearToSRGB[indices.z] };
+
+        if (pma) srgb *= alpha;
+
+        pixel[0] = srgb.x + 0.5f;
+        pixel[1] = srgb.y + 0.5f;
+        pixel[2] = srgb.z + 0.5f;
+        pixel[3] = alpha * 255.0f + 0.5f;
+    }
+    else memset(pixel, 0, 4);
+}
+
+static void forEachRow(NSInteger numRows, NSInteger numPixels, void (^block)(NSInteger row))
+{
+    if (numPixels < MIN_PARALLEL_PIXELS)
+    {
+        for (NSInteger row=0; row<numRows; ++row)
+            block(row);
+    }
+    else
+    {
+        // a few bands per core, so that the work is balanced even if a core is busy otherwise
+        NSInteger numBands = MIN(numRows, [[NSProcessInfo processInfo] activeProcessorCount] * 4);
+        NSInteger rowsPerBand = (numRows + numBands - 1) / numBands;
+
+        dispatch_apply(numBands, dispatch_get_global_queue(DISPATCH_QUEUE_PRIORITY_DEFAULT, 0),
+                       ^(size_t band)
+        {
+            NSInteger firstRow = (NSInteger)band * rowsPerBand;
+            NSInteger lastRow = MIN(numRows, firstRow + rowsPerBand);
+
+            for (NSInteger row=firstRow; row<lastRow; ++row)
+                block(row);
+        });
+    }
+}
+
+// --- public functions ----------------------------------------------------------------------------
+
+BOOL SPTextureFormatIsConvertible(SPTextureFormat format)
+{
+    SPConversionInfo info;
+    return getConversionInfo(format, &info);
+}
+
+void SPTextureConvertPixels(const void *rgba, void *output, NSInteger width, NSInteger height,
+                            SPTextureFormat format, SPTextureDithering dithering, BOOL pma)
+{
+    SPConversionInfo info;
+
+    if (!getConversionInfo(format, &info))
+        [NSException raise:SPExceptionInvalidOperation
+                    format:@"Cannot convert pixels to texture format %d", (int)format];
+
+    if (format == SPTextureFormatRGBA)
+    {
+        if (output != rgba) memmove(output, rgba, width * height * 4);
+    }
+    else if (dithering == SPTextureDitheringDiffusion)
+        convertDiffusion(rgba, output, width, height, format, &info, pma);
+    else
+        convertOrdered(rgba, output, width, height, format, &info, pma,
+                       dithering == SPTextureDitheringOrdered);
+}
+
+void SPTexturePremultiplyPixels(void *rgba, NSInteger numPixels)
+{
+    uchar *pixels = rgba;
+    NSInteger i = 0;
+
+    // four pixels at a time; the alpha lanes are multiplied with 255, i.e. they stay the same
+    vector_ushort16 opaque = 255;
+
+    for (; i + 4 <= numPixels; i += 4)
+    {
+        vector_uchar16 bytes;
+        memcpy(&bytes, pixels + i * 4, sizeof(bytes));
+
+        vector_ushort16 color = __builtin_convertvector(bytes, vector_ushort16);
+        vector_ushort16 alpha = __builtin_shufflevector(color, opaque, 3,  3,  3, 16,  7,  7,  7, 16,
+                                                                       11, 11, 11, 16, 15, 15, 15, 16);
+
+        // exact division by 255, rounded
+        vector_ushort16 product = color * alpha + 128;
+        product = (product + (product >> 8)) >> 8;
+
+        bytes = __builtin_convertvector(product, vector_uchar16);
+        memcpy(pixels + i * 4, &bytes, sizeof(bytes));
+    }
+
+    for (; i < numPixels; ++i)
+    {
+        uchar *pixel = pixels + i * 4;
+        uint alpha = pixel[3];
+
+        for (int c=0; c<3; ++c)
+        {
+            uint product = pixel[c] * alpha + 128;
+            pixel[c] = (product + (product >> 8)) >> 8;
+        }
+    }
+}
+
+void SPTextureUnpremultiplyPixels(void *rgba, NSInteger numPixels)
+{
+    uchar *pixels = rgba;
+    NSInteger i = 0;
+
+    vector_float16 opaque = 255.0f;
+    vector_float16 one = 1.0f;
+
+    for (; i + 4 <= numPixels; i += 4)
+    {
+        vector_uchar16 bytes;
+        memcpy(&bytes, pixels + i * 4, sizeof(bytes));
+
+        // transparent pixels have no color left; they become black (like in the loop below)
+        vector_float16 color = __builtin_convertvector(bytes, vector_float16);
+        vector_float16 alpha = __builtin_shufflevector(color, opaque, 3,  3,  3, 16,  7,  7,  7, 16,
+                                                                      11, 11, 11, 16, 15, 15, 15, 16);
+        vector_float16 result = vector_min(color * 255.0f / vector_max(alpha, one) + 0.5f, opaque);
+        result = vector_select(result, (vector_float16)0.0f, alpha == 0.0f);
+
+        bytes = __builtin_convertvector(result, vector_uchar16);
+        memcpy(pixels + i * 4, &bytes, sizeof(bytes));
+    }
+
+    for (; i < numPixels; ++i)
+    {
+        uchar *pixel = pixels + i * 4;
+        uint alpha = pixel[3];
+
+        for (int c=0; c<3; ++c)
+            pixel[c] = alpha ? MIN(255, (pixel[c] * 255 + alpha / 2) / alpha) : 0;
+    }
+}
+
+NSInteger SPTextureNumMipmaps(NSInteger width, NSInteger height)
+{
+    NSInteger numMipmaps = 0;
+
+    while (width > 1 || height > 1)
+    {
+        width  = MAX(1, width  / 2);
+        height = MAX(1, height / 2);
+        ++numMipmaps;
+    }
+
+    return numMipmaps;
+}
+
+void SPTextureGenerateMipmaps(void *rgba, NSInteger width, NSInteger height, BOOL pma)
+{
+    if (width <= 1 && height <= 1) return;
+
+    initGammaTables();
+
+    // Each level is calculated from the linear values of the previous one, which are kept as
+    // floats; that way, rounding errors don't add up from level to level. The first level is
+    // calculated right from the sRGB pixels, so that the floats only need a quarter of the
+    // original size (plus a sixteenth for the level after that).
+
+    uchar *pixels = rgba;
+    NSInteger mipWidth  = MAX(1, width  / 2);
+    NSInteger mipHeight = MAX(1, height / 2);
+    vector_float4 *source = malloc(mipWidth * mipHeight * sizeof(vector_float4));
+    vector_float4 *target = malloc(MAX(1, mipWidth / 2) * MAX(1, mipHeight / 2) *
+                                   sizeof(vector_float4));
+    if (!source || !target)
+    {
+        free(source);
+        free(target);
+        [NSException raise:SPExceptionOperationFailed format:@"Could not allocate mipmap buffers"];
+    }
+
+    uchar *output = pixels + width * height * 4;
+    BOOL firstLevel = YES;
+
+    while (width > 1 || height > 1)
+    {
+        NSInteger sourceWidth = width;
+        NSInteger lastX = width - 1;
+        NSInteger lastY = height - 1;
+        const uchar *sourceBytes = firstLevel ? pixels : NULL;
+        const vector_float4 *sourcePixels = source;
+        vector_float4 *targetPixels = firstLevel ? source : target;
+        uchar *outputPixels = output;
+
+        mipWidth  = MAX(1, width  / 2);
+        mipHeight = MAX(1, height / 2);
+
+        forEachRow(mipHeight, mipWidth * mipHeight, ^(NSInteger y)
+        {
+            // a 2x2 box filter; for sides of a single pixel, that pixel is sampled twice
+            NSInteger y0 = MIN(2 * y,     lastY) * sourceWidth;
+            NSInteger y1 = MIN(2 * y + 1, lastY) * sourceWidth;
+
+            for (NSInteger x=0; x<mipWidth; ++x)
+            {
+                NSInteger x0 = MIN(2 * x, lastX);
+                NSInteger x1 = MIN(2 * x + 1, lastX);
+                vector_float4 value;
+
+                if (sourceBytes)
+                    value = loadLinear(sourceBytes + (y0 + x0) * 4, pma) +
+                            loadLinear(sourceBytes + (y0 + x1) * 4, pma) +
+                            loadLinear(sourceBytes + (y1 + x0) * 4, pma) +
+                            loadLinear(sourceBytes + (y1 + x1) * 4, pma);
+                else
+                    value = sourcePixels[y0 + x0] + sourcePixels[y0 + x1] +
+                            sourcePixels[y1 + x0] + sourcePixels[y1 + x1];
+
+                value *= 0.25f;
+                targetPixels[y * mipWidth + x] = value;
+                storeLinear(value, outputPixels + (y * mipWidth + x) * 4, pma);
+            }
+        });
+
+        output += mipWidth * mipHeight * 4;
+        width = mipWidth;
+        height = mipHeight;
+
+        // the first level was written to 'source' already
+        if (firstLevel) firstLevel = NO;
+        else
+        {
+            vector_float4 *swap = source;
+            source = target;
+            target = swap;
+        }
+    }
+
+    free(source);
+    free(target);
+}
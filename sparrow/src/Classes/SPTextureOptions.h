@@ -0,0 +1,99 @@
+//
+//  SPTextureOptions.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 17.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import <Sparrow/SparrowBase.h>
+#import <Sparrow/SPTextureConversion.h>
+
+@class SPDynamicAtlas;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// Describes how the alpha channel of a loaded texture is stored.
+typedef NS_ENUM(NSInteger, SPTextureAlphaMode)
+{
+    /// Images are premultiplied; PVR and KTX files keep the mode they were saved with.
+    SPTextureAlphaModeUnchanged,
+    /// The color channels are multiplied with the alpha value.
+    SPTextureAlphaModePremultiplied,
+    /// The color channels are stored independently of the alpha value.
+    SPTextureAlphaModeStraight
+};
+
+/** ------------------------------------------------------------------------------------------------
+
+ SPTextureOptions bundles the settings that control how a texture file is loaded.
+
+	SPTextureOptions *options = [SPTextureOptions textureOptions];
+	options.numSkippedMipmaps = 1; // a quarter of the memory, at half the resolution
+
+	SPTexture *texture = [SPTexture textureWithContentsOfFile:@"background.ktx" options:options];
+
+ Images can be converted into a format with fewer bits per pixel while they are loaded, which
+ saves memory without the need for an offline conversion step:
+
+	options.format = SPTextureFormat565;
+	options.dithering = SPTextureDitheringDiffusion;
+
+ Beware that textures are cached by their path: when the same file is loaded again while the
+ first texture is still alive, the existing texture is returned, regardless of the options.
+
+------------------------------------------------------------------------------------------------- */
+
+@interface SPTextureOptions : NSObject <NSCopying>
+
+/// --------------------
+/// @name Initialization
+/// --------------------
+
+/// Factory method.
++ (instancetype)textureOptions;
+
+/// ----------------
+/// @name Properties
+/// ----------------
+
+/// Indicates if mipmaps should be created for images that don't contain any. They are
+/// calculated on the CPU while the image is decoded, averaging colors in linear space and
+/// weighted by alpha; the image is enlarged to power-of-two dimensions. (Default: `NO`)
+@property (nonatomic, assign) BOOL generateMipmaps;
+
+/// The number of mipmap levels that are dropped from files that contain mipmaps (PVR, KTX);
+/// each skipped level halves width and height of the texture. The smallest level is always kept,
+/// and the size of the texture in points stays the same. (Default: 0)
+@property (nonatomic, assign) NSInteger numSkippedMipmaps;
+
+/// The format that images are converted into after decoding. Only uncompressed formats are
+/// supported; of the PVR and KTX files, only those with RGBA pixels (8 bits per channel) are
+/// converted. (Default: `SPTextureFormatRGBA`)
+@property (nonatomic, assign) SPTextureFormat format;
+
+/// The dithering that is applied when pixels are converted into a format with fewer bits per
+/// channel. (Default: `SPTextureDitheringNone`)
+@property (nonatomic, assign) SPTextureDithering dithering;
+
+/// Indicates if the color channels are premultiplied with the alpha value. Like `format`, this
+/// is applied to images and RGBA files. (Default: `SPTextureAlphaModeUnchanged`)
+@property (nonatomic, assign) SPTextureAlphaMode alphaMode;
+
+/// Indicates if the texture may be deleted from the GPU when textures exceed their memory budget
+/// or the app receives a memory warning. An evicted texture is reloaded from its file the next
+/// time it is rendered. (Default: `NO`)
+@property (nonatomic, assign) BOOL reloadable;
+
+/// If set, images are packed into this atlas instead of getting a texture of their own; the
+/// absolute path of the file is used as the key. Files that can't be packed (e.g. because they
+/// are too big or compressed) are loaded as usual. Ignored when mipmaps are generated; takes
+/// precedence over `reloadable`. (Default: `nil`)
+@property (nonatomic, retain, nullable) SPDynamicAtlas *atlas;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,45 @@
+//
+//  SPTextureOptions.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 17.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPDynamicAtlas.h"
+#import "SPTextureOptions.h"
+
+@implementation SPTextureOptions
+
+#pragma mark Initialization
+
++ (instancetype)textureOptions
+{
+    return [[[self alloc] init] autorelease];
+}
+
+- (void)dealloc
+{
+    [_atlas release];
+    [super dealloc];
+}
+
+#pragma mark NSCopying
+
+- (instancetype)copyWithZone:(NSZone *)zone
+{
+    SPTextureOptions *options = [[[self class] allocWithZone:zone] init];
+    options->_generateMipmaps = _generateMipmaps;
+    options->_numSkippedMipmaps = _numSkippedMipmaps;
+    options->_format = _format;
+    options->_dithering = _dithering;
+    options->_alphaMode = _alphaMode;
+    options->_reloadable = _reloadable;
+    options->_atlas = [_atlas retain];
+    return options;
+}
+
+@end
@@ -0,0 +1,56 @@
+//
+//  SPTexture_Internal.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 16.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPTexture.h"
+
+@class SPDynamicAtlas;
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// An SPDecodedTexture contains the pixels of a texture in main memory, ready for uploading.
+/// Decoding does not touch OpenGL, so it may happen on any thread; only `createTexture` requires
+/// a current context.
+@interface SPDecodedTexture : NSObject
+
+/// Decodes an image or PVR/KTX file. The path has to be absolute.
+- (instancetype)initWithContentsOfFile:(NSString *)path options:(nullable SPTextureOptions *)options;
+
+/// Draws into a new, transparent bitmap. Returns nil if the bitmap could not be created.
+- (nullable instancetype)initWithWidth:(float)width height:(float)height generateMipmaps:(BOOL)mipmaps
+                                 scale:(float)scale draw:(nullable SPTextureDrawingBlock)drawingBlock;
+
+/// Uploads the pixels to a new texture. Textures loaded with the `reloadable` option are
+/// registered for eviction; those loaded with an `atlas` are added to that atlas, if possible.
+- (SPTexture *)createTexture;
+
+/// Uploads the pixels to a new GL texture, without wrapping it into a sub texture.
+- (SPGLTexture *)createGLTexture;
+
+/// Adds the pixels to a dynamic atlas. Returns nil if they can't be packed (e.g. because they
+/// are compressed or contain mipmaps).
+- (nullable SPTexture *)addToAtlas:(SPDynamicAtlas *)atlas forKey:(NSString *)key;
+
+/// The size of the decoded data in bytes.
+@property (nonatomic, readonly) NSUInteger numBytes;
+
+@end
+
+@interface SPTexture (Internal)
+
+/// Returns the texture that was loaded from a certain path, if it is still alive.
++ (nullable SPTexture *)cachedTextureForPath:(NSString *)path;
+
+/// Makes a texture available to `initWithContentsOfFile:` calls with the same path.
++ (void)cacheTexture:(SPTexture *)texture forPath:(NSString *)path;
+
+@end
+
+NS_ASSUME_NONNULL_END
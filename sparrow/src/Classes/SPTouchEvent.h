@@ -54,6 +54,15 @@ SP_EXTERN NSString *const SPEventTypeTouch;
 	    }
 	}
 
+ Note that touch objects are updated in place while a finger moves over the screen. If you need
+ to store the state of a touch for later comparison, save its values or store a copy.
+
+ Touch objects belong to the touch processor. When a touch has ended or was cancelled, its
+ object is reused for one of the next touches, so a reference that is kept beyond that point
+ will suddenly describe a different finger. Keep a copy instead. The set returned by `touches`
+ is never changed after the event was dispatched; it's safe to keep it, but the same rule
+ applies to the touches it contains.
+
 ------------------------------------------------------------------------------------------------- */ 
  
 @interface SPTouchEvent : SPEvent
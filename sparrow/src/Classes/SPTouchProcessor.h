@@ -10,12 +10,12 @@
 //
 
 #import <Sparrow/SparrowBase.h>
+#import <Sparrow/SPTouch.h>
 
 NS_ASSUME_NONNULL_BEGIN
 
 @class SPDisplayObjectContainer;
 @class SPStage;
-@class SPTouch;
 
 /** ------------------------------------------------------------------------------------------------
  
@@ -32,6 +32,11 @@ NS_ASSUME_NONNULL_BEGIN
  happen several times in one "advanceTime" execution; no information is discarded). It's 
  responsible for dispatching the actual touch events to Sparrow's display tree.
  
+ To avoid allocations while processing input, the touch processor reuses its SPTouch and
+ SPTouchEvent objects: a touch object is updated in place for its complete life-cycle, and it is
+ recycled for a new finger once it has ended or was cancelled. The touch processor owns those
+ objects; see SPTouchEvent for what that means for listeners.
+ 
  Subclassing SPTouchProcesser:
  
  You can extend the SPTouchProcesser if you need to have more control over touch and mouse input. 
@@ -72,9 +77,17 @@ NS_ASSUME_NONNULL_BEGIN
 /// @param touches  A set of all touches that have changed just now.
 - (void)processTouches:(NSSet *)touches;
 
-/// Enqueues a new touch.
+/// Enqueues a new touch. Only the properties of the touch are stored; the object itself is
+/// not retained.
 - (void)enqueueTouch:(SPTouch *)touch;
 
+/// Enqueues the raw data of a new touch. Consecutive movements of the same touch that are
+/// enqueued within one frame are merged into a single update.
+- (void)enqueueTouchWithID:(size_t)touchID phase:(SPTouchPhase)phase
+                   globalX:(float)globalX globalY:(float)globalY
+           previousGlobalX:(float)previousGlobalX previousGlobalY:(float)previousGlobalY
+                  tapCount:(NSInteger)tapCount forceFactor:(float)forceFactor;
+
 /// Force-end all current touches. Changes the phase of all touches to '.Ended' and immediately
 /// dispatches a new TouchEvent (if touches are present). Called automatically when the app
 /// receives a 'UIApplicationWillResignActiveNotification' notification.
@@ -10,6 +10,7 @@
 //
 
 #import "SPDisplayObjectContainer.h"
+#import "SPEvent_Internal.h"
 #import "SPPoint.h"
 #import "SPMacros.h"
 #import "SPMatrix.h"
@@ -22,6 +23,34 @@
 #define MULTITAP_TIME 0.3f
 #define MULTITAP_DIST 25.0f
 
+#define MAX_TOUCHES    32
+#define MAX_TAPS       MAX_TOUCHES
+#define QUEUE_CAPACITY 64
+
+// --- helper structs ------------------------------------------------------------------------------
+
+typedef struct
+{
+    size_t touchID;
+    SPTouchPhase phase;
+    float globalX;
+    float globalY;
+    float previousGlobalX;
+    float previousGlobalY;
+    NSInteger tapCount;
+    float forceFactor;
+}
+SPTouchSample;
+
+typedef struct
+{
+    float globalX;
+    float globalY;
+    double timestamp;
+    NSInteger tapCount;
+}
+SPTap;
+
 // --- class implementation ------------------------------------------------------------------------
 
 @implementation SPTouchProcessor
@@ -29,11 +58,21 @@
     SPStage *_stage;
     SPDisplayObject *__weak _root;
 
-    NSMutableOrderedSet *_currentTouches;
-    NSMutableOrderedSet *_updatedTouches;
-    NSMutableArray *_queuedTouches;
-    NSMutableArray *_lastTaps;
+    SPTouch *_currentTouches[MAX_TOUCHES];
+    SPTouch *_touchPool[MAX_TOUCHES];
+    SPTap _lastTaps[MAX_TAPS];
+    SPTouchSample *_queuedSamples;
+
+    NSInteger _numCurrentTouches;
+    NSInteger _numPooledTouches;
+    NSInteger _numLastTaps;
+    NSInteger _numQueuedSamples;
+    NSInteger _queueCapacity;
+
+    SP_GENERIC(NSMutableSet, SPTouch*) *_currentTouchSet;
+    SP_GENERIC(NSMutableSet, SPTouch*) *_updatedTouches;
 
+    BOOL _touchSetShared;
     double _lastTouchTimestamp;
     double _elapsedTime;
     double _multitapTime;
@@ -49,10 +88,10 @@
         _root = _stage = stage;
         _multitapTime = MULTITAP_TIME;
         _multitapDistance = MULTITAP_DIST;
-        _currentTouches = [[NSMutableOrderedSet alloc] init];
-        _updatedTouches = [[NSMutableOrderedSet alloc] init];
-        _queuedTouches = [[NSMutableArray alloc] init];
-        _lastTaps = [[NSMutableArray alloc] init];
+        _queueCapacity = QUEUE_CAPACITY;
+        _queuedSamples = malloc(sizeof(SPTouchSample) * _queueCapacity);
+        _currentTouchSet = [[NSMutableSet alloc] initWithCapacity:MAX_TOUCHES];
+        _updatedTouches = [[NSMutableSet alloc] initWithCapacity:MAX_TOUCHES];
 
         [[NSNotificationCenter defaultCenter]
             addObserver:self selector:@selector(cancelCurrentTouches)
@@ -72,10 +111,12 @@
 {
     [[NSNotificationCenter defaultCenter] removeObserver:self];
 
-    [_currentTouches release];
+    for (NSInteger i=0; i<_numCurrentTouches; ++i) [_currentTouches[i] release];
+    for (NSInteger i=0; i<_numPooledTouches;  ++i) [_touchPool[i] release];
+
+    free(_queuedSamples);
+    [_currentTouchSet release];
     [_updatedTouches release];
-    [_queuedTouches release];
-    [_lastTaps release];
     [super dealloc];
 }
 
@@ -86,69 +127,134 @@
     _elapsedTime += seconds;
     
     // remove old taps
-    if (_lastTaps.count)
-    {
-        NSMutableArray *remainingTaps = [NSMutableArray array];
-        
-        for (SPTouch *touch in _lastTaps)
-            if (_elapsedTime - touch.timestamp <= _multitapTime)
-                [remainingTaps addObject:touch];
-        
-        SP_RELEASE_AND_RETAIN(_lastTaps, remainingTaps);
-    }
-    
-    while (_queuedTouches.count)
+    NSInteger numRemainingTaps = 0;
+    for (NSInteger i=0; i<_numLastTaps; ++i)
+        if (_elapsedTime - _lastTaps[i].timestamp <= _multitapTime)
+            _lastTaps[numRemainingTaps++] = _lastTaps[i];
+
+    _numLastTaps = numRemainingTaps;
+
+    while (_numQueuedSamples)
     {
-        NSMutableArray *excessTouches = [NSMutableArray array];
+        size_t batchIDs[MAX_TOUCHES];
+        NSInteger numBatchIDs = 0;
+        NSInteger numExcessSamples = 0;
         
         // set touches that were new or moving to phase 'SPTouchPhaseStationary'
-        for (SPTouch *touch in _currentTouches)
+        for (NSInteger i=0; i<_numCurrentTouches; ++i)
+        {
+            SPTouch *touch = _currentTouches[i];
             if (touch.phase == SPTouchPhaseBegan || touch.phase == SPTouchPhaseMoved)
                 touch.phase = SPTouchPhaseStationary;
+        }
         
-        // analyze new touches, but each ID only once
-        for (SPTouch *touch in _queuedTouches)
+        // analyze new touches, but each ID only once. Excess samples are moved to the front
+        // of the queue and processed in the next iteration.
+        for (NSInteger i=0; i<_numQueuedSamples; ++i)
         {
-            if (![_updatedTouches containsObject:touch])
+            SPTouchSample *sample = &_queuedSamples[i];
+            BOOL isExcess = numBatchIDs == MAX_TOUCHES;
+
+            for (NSInteger j=0; j<numBatchIDs && !isExcess; ++j)
+                if (batchIDs[j] == sample->touchID) isExcess = YES;
+
+            if (isExcess)
             {
-                [self addCurrentTouch:touch];
-                [_updatedTouches addObject:touch];
+                _queuedSamples[numExcessSamples++] = *sample;
             }
             else
             {
-                [excessTouches addObject:touch];
+                SPTouch *touch = [self addCurrentTouchWithSample:sample];
+                if (touch)
+                {
+                    batchIDs[numBatchIDs++] = sample->touchID;
+                    [_updatedTouches addObject:touch];
+                }
             }
         }
         
         // process the current set of touches (i.e. dispatch touch events)
-        [self processTouches:_updatedTouches.set];
+        [self processTouches:_updatedTouches];
         [_updatedTouches removeAllObjects];
         
         // remove ended touches
         [self removeEndedTouches];
         
         // switch to excess touches
-        SP_RELEASE_AND_RETAIN(_queuedTouches, excessTouches);
+        _numQueuedSamples = numExcessSamples;
     }
 }
 
 - (void)enqueueTouch:(SPTouch *)touch
 {
-    [_queuedTouches addObject:touch];
+    [self enqueueTouchWithID:touch.touchID phase:touch.phase
+                     globalX:touch.globalX globalY:touch.globalY
+             previousGlobalX:touch.previousGlobalX previousGlobalY:touch.previousGlobalY
+                    tapCount:touch.tapCount forceFactor:touch.forceFactor];
+}
+
+- (void)enqueueTouchWithID:(size_t)touchID phase:(SPTouchPhase)phase
+                   globalX:(float)globalX globalY:(float)globalY
+           previousGlobalX:(float)previousGlobalX previousGlobalY:(float)previousGlobalY
+                  tapCount:(NSInteger)tapCount forceFactor:(float)forceFactor
+{
+    // Several move samples of one finger that arrive within one frame are merged: only the most
+    // recent position is of interest, while the previous position is taken from the first sample.
+    // Thus, a fast moving finger causes just one touch event per frame.
+
+    if (phase == SPTouchPhaseMoved || phase == SPTouchPhaseStationary)
+    {
+        for (NSInteger i=_numQueuedSamples-1; i>=0; --i)
+        {
+            SPTouchSample *sample = &_queuedSamples[i];
+            if (sample->touchID != touchID) continue;
+
+            if (sample->phase == SPTouchPhaseMoved || sample->phase == SPTouchPhaseStationary)
+            {
+                if (phase == SPTouchPhaseMoved) sample->phase = SPTouchPhaseMoved;
+                sample->globalX = globalX;
+                sample->globalY = globalY;
+                sample->tapCount = tapCount;
+                sample->forceFactor = forceFactor;
+                return;
+            }
+            else break;
+        }
+    }
+
+    if (_numQueuedSamples == _queueCapacity)
+    {
+        // the queue only grows beyond its initial capacity in extreme situations (e.g. when the
+        // app stalled for a long time); its memory is then kept for the rest of its lifetime.
+        _queueCapacity *= 2;
+        _queuedSamples = realloc(_queuedSamples, sizeof(SPTouchSample) * _queueCapacity);
+    }
+
+    _queuedSamples[_numQueuedSamples++] = (SPTouchSample){
+        .touchID = touchID,
+        .phase = phase,
+        .globalX = globalX,
+        .globalY = globalY,
+        .previousGlobalX = previousGlobalX,
+        .previousGlobalY = previousGlobalY,
+        .tapCount = tapCount,
+        .forceFactor = forceFactor
+    };
 }
 
 #pragma mark Properties
 
 - (NSInteger)numCurrentTouches
 {
-    return _currentTouches.count;
+    return _numCurrentTouches;
 }
 
 #pragma mark Process Touches
 
 - (void)processTouches:(NSSet *)touches
 {
-    // hit test our updated touches
+    // hit test our updated touches. Moved and stationary touches keep the target
+    // they were assigned when they began.
     for (SPTouch *touch in touches)
     {
         if (touch.phase == SPTouchPhaseBegan)
@@ -159,13 +265,14 @@
     }
     
     // the same touch event will be dispatched to all targets
-    SPTouchEvent *touchEvent =
-        [[SPTouchEvent alloc] initWithType:SPEventTypeTouch touches:_currentTouches.set];
+    SPTouchEvent *touchEvent = [[SPTouchEvent allocFromPool]
+                                initWithType:SPEventTypeTouch touches:_currentTouchSet];
+    _touchSetShared = YES;
 
     // dispatch events for the rest of our updated touches
     for (SPTouch *touch in touches)
         [touch.target dispatchEvent:touchEvent];
-    
+
     [touchEvent release];
 }
 
@@ -175,39 +282,60 @@
     [self removeEndedTouches];
     
     double now = CACurrentMediaTime();
-    for (SPTouch *touch in _currentTouches)
+    for (NSInteger i=0; i<_numCurrentTouches; ++i)
     {
+        SPTouch *touch = _currentTouches[i];
         touch.phase = SPTouchPhaseCancelled;
         touch.timestamp = now;
     }
     
-    SPTouchEvent *touchEvent = [[SPTouchEvent alloc]
-    	initWithType:SPEventTypeTouch touches:_currentTouches.set];
+    SPTouchEvent *touchEvent = [[SPTouchEvent allocFromPool]
+                                initWithType:SPEventTypeTouch touches:_currentTouchSet];
+    _touchSetShared = YES;
 
-    for (SPTouch *touch in _currentTouches)
-        [touch.target dispatchEvent:touchEvent];
+    for (NSInteger i=0; i<_numCurrentTouches; ++i)
+        [_currentTouches[i].target dispatchEvent:touchEvent];
     
     [touchEvent release];
-    [_currentTouches removeAllObjects];
+    [self removeEndedTouches];
 }
 
 #pragma mark Update Touches
 
-- (void)addCurrentTouch:(SPTouch *)touch
+- (SPTouch *)addCurrentTouchWithSample:(SPTouchSample *)sample
 {
-    NSUInteger index = [_currentTouches indexOfObject:touch];
-    
-    // add/replace
-    if (index != NSNotFound)
+    SPTouch *touch = nil;
+
+    for (NSInteger i=0; i<_numCurrentTouches; ++i)
     {
-        SPTouch *currentTouch = _currentTouches[index];
-        touch.target = currentTouch.target; // save the target
-        [_currentTouches replaceObjectAtIndex:index withObject:touch];
+        if (_currentTouches[i].touchID == sample->touchID)
+        {
+            touch = _currentTouches[i];
+            break;
+        }
     }
-    else
+
+    if (!touch)
     {
-        [_currentTouches addObject:touch];
+        if (_numCurrentTouches == MAX_TOUCHES)
+            return nil;
+
+        touch = _numPooledTouches ? _touchPool[--_numPooledTouches] : [[SPTouch alloc] init];
+        touch.touchID = sample->touchID;
+
+        [self prepareTouchSetForMutation];
+        [_currentTouchSet addObject:touch];
+        _currentTouches[_numCurrentTouches++] = touch;
     }
+
+    // touches are updated in place, so the target is kept
+    touch.globalX = sample->globalX;
+    touch.globalY = sample->globalY;
+    touch.previousGlobalX = sample->previousGlobalX;
+    touch.previousGlobalY = sample->previousGlobalY;
+    touch.phase = sample->phase;
+    touch.tapCount = sample->tapCount;
+    touch.forceFactor = sample->forceFactor;
     
     // update timestamp
     touch.timestamp = _elapsedTime;
@@ -215,43 +343,98 @@
     // update taps
     if (touch.phase == SPTouchPhaseBegan)
         [self updateTapCount:touch];
+
+    return touch;
 }
 
 - (void)updateTapCount:(SPTouch *)touch
 {
-    SPTouch *nearbyTap = nil;
+    NSInteger nearbyTapIndex = -1;
     float minSqDist = SPSquare(_multitapDistance);
 
-    for (SPTouch *tap in _lastTaps)
+    for (NSInteger i=0; i<_numLastTaps; ++i)
     {
-        float sqDist = powf(tap.globalX - touch.globalX, 2) +
-                       powf(tap.globalY - touch.globalY, 2);
+        float sqDist = SPSquare(_lastTaps[i].globalX - touch.globalX) +
+                       SPSquare(_lastTaps[i].globalY - touch.globalY);
 
         if (sqDist <= minSqDist)
-            nearbyTap = tap;
+            nearbyTapIndex = i;
     }
 
-    if (nearbyTap)
+    if (nearbyTapIndex != -1)
     {
-        touch.tapCount = nearbyTap.tapCount + 1;
-        [_lastTaps removeObject:nearbyTap];
+        touch.tapCount = _lastTaps[nearbyTapIndex].tapCount + 1;
+        [self removeTapAtIndex:nearbyTapIndex];
     }
     else
     {
         touch.tapCount = 1;
     }
 
-    [_lastTaps addObject:[[touch copy] autorelease]];
+    if (_numLastTaps == MAX_TAPS)
+        [self removeTapAtIndex:0];
+
+    _lastTaps[_numLastTaps++] = (SPTap){
+        .globalX = touch.globalX,
+        .globalY = touch.globalY,
+        .timestamp = touch.timestamp,
+        .tapCount = touch.tapCount
+    };
+}
+
+- (void)removeTapAtIndex:(NSInteger)index
+{
+    memmove(&_lastTaps[index], &_lastTaps[index+1], sizeof(SPTap) * (_numLastTaps - index - 1));
+    --_numLastTaps;
 }
 
 - (void)removeEndedTouches
 {
-    [_currentTouches filterUsingPredicate:
-     [NSPredicate predicateWithBlock:^ BOOL (SPTouch *touch, NSDictionary *bindings)
-      {
-          return touch.phase != SPTouchPhaseEnded &&
-                 touch.phase != SPTouchPhaseCancelled;
-      }]];
+    NSInteger numRemainingTouches = 0;
+
+    for (NSInteger i=0; i<_numCurrentTouches; ++i)
+    {
+        SPTouch *touch = _currentTouches[i];
+
+        if (touch.phase != SPTouchPhaseEnded && touch.phase != SPTouchPhaseCancelled)
+        {
+            _currentTouches[numRemainingTouches++] = touch;
+        }
+        else
+        {
+            [self prepareTouchSetForMutation];
+            [_currentTouchSet removeObject:touch];
+            [self recycleTouch:touch];
+        }
+    }
+
+    _numCurrentTouches = numRemainingTouches;
+}
+
+#pragma mark Pooling
+
+- (void)recycleTouch:(SPTouch *)touch
+{
+    // All touches in the current list were created by the processor, which owns them; listeners
+    // that need a touch beyond its life-cycle have to copy it (see SPTouchEvent).
+    if (_numPooledTouches < MAX_TOUCHES)
+    {
+        touch.target = nil;
+        _touchPool[_numPooledTouches++] = touch;
+    }
+    else [touch release];
+}
+
+- (void)prepareTouchSetForMutation
+{
+    // The touch set is passed to every touch event, and a listener might keep a reference to the
+    // event or its touches. Once it was handed out, the set is left alone and replaced by a copy.
+
+    if (_touchSetShared)
+    {
+        SP_RELEASE_AND_COPY_MUTABLE(_currentTouchSet, _currentTouchSet);
+        _touchSetShared = NO;
+    }
 }
 
 @end
@@ -37,6 +37,47 @@ SP_EXTERN NSString *const SPTransitionEaseOutBounce;
 SP_EXTERN NSString *const SPTransitionEaseInOutBounce;
 SP_EXTERN NSString *const SPTransitionEaseOutInBounce;
 
+/// Identifies one of the built-in transitions for fast evaluation from C code.
+typedef NS_ENUM(NSInteger, SPTransitionID)
+{
+    SPTransitionIDNone = -1,
+    SPTransitionIDLinear,
+    SPTransitionIDEaseIn,
+    SPTransitionIDEaseOut,
+    SPTransitionIDEaseInOut,
+    SPTransitionIDEaseOutIn,
+    SPTransitionIDEaseInBack,
+    SPTransitionIDEaseOutBack,
+    SPTransitionIDEaseInOutBack,
+    SPTransitionIDEaseOutInBack,
+    SPTransitionIDEaseInElastic,
+    SPTransitionIDEaseOutElastic,
+    SPTransitionIDEaseInOutElastic,
+    SPTransitionIDEaseOutInElastic,
+    SPTransitionIDEaseInBounce,
+    SPTransitionIDEaseOutBounce,
+    SPTransitionIDEaseInOutBounce,
+    SPTransitionIDEaseOutInBounce,
+};
+
+/// The maximum difference between `SPTransitionEvaluate` and the corresponding class method.
+SP_EXTERN const float SPTransitionMaxError;
+
+/// Returns the ID of a built-in transition, or `SPTransitionIDNone` for `randomize` and for
+/// custom transitions.
+SP_EXTERN SPTransitionID SPTransitionIDFromName(NSString *name);
+
+/// Evaluates a built-in transition at a ratio between 0 and 1, without any message sends.
+/// Polynomial transitions (ease, back, bounce) are calculated directly; elastic transitions are
+/// read from a precomputed lookup table with linear interpolation, so they might differ from the
+/// class methods by up to `SPTransitionMaxError`.
+SP_EXTERN float SPTransitionEvaluate(SPTransitionID transitionID, float ratio);
+
+/// Evaluates a built-in transition for a number of ratios at once, using SIMD instructions where
+/// possible. `ratios` and `results` may point to the same array.
+SP_EXTERN void SPTransitionEvaluateBatch(SPTransitionID transitionID, const float *ratios,
+                                         float *results, NSInteger count);
+
 /** ------------------------------------------------------------------------------------------------
  
  The SPTransitions class contains static methods that define easing functions. Those functions
@@ -48,6 +89,9 @@ SP_EXTERN NSString *const SPTransitionEaseOutInBounce;
 
  You can define your own transitions by extending this class. The name of the method you declare 
  acts as the key that is used to identify the transition when you create the tween.
+
+ The class methods are the reference implementation. For the built-in transitions, the
+ `SPTransitionEvaluate` functions provide a faster alternative that tweens use by default.
  
 ------------------------------------------------------------------------------------------------- */
  
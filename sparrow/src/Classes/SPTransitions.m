@@ -15,6 +15,14 @@
 #import "SPTransitions.h"
 #import "SPUtils.h"
 
+#import <simd/simd.h>
+
+#define ELASTIC_TABLE_SIZE  2048
+#define ELASTIC_PERIOD      0.3
+#define BACK_OVERSHOOT      1.70158f
+#define BOUNCE_SCALE        7.5625f
+#define BOUNCE_PERIOD       2.75f
+
 // --- transition keys -----------------------------------------------------------------------------
 
 NSString *const SPTransitionLinear                  = @"linear";
@@ -40,6 +48,250 @@ NSString *const SPTransitionEaseOutBounce           = @"easeOutBounce";
 NSString *const SPTransitionEaseInOutBounce         = @"easeInOutBounce";
 NSString *const SPTransitionEaseOutInBounce         = @"easeOutInBounce";
 
+const float SPTransitionMaxError = 0.00002f;
+
+// --- scalar evaluators ---------------------------------------------------------------------------
+
+static float elasticTables[2][ELASTIC_TABLE_SIZE + 1];
+static dispatch_once_t elasticTablesOnce;
+
+static void createElasticTables(void *context)
+{
+    // the elastic functions jump to exactly 0 and 1 at their ends; the tables store the limits
+    // of the curves instead, so that interpolation close to the ends stays accurate.
+
+    double s = ELASTIC_PERIOD / 4.0;
+
+    for (int i=0; i<=ELASTIC_TABLE_SIZE; ++i)
+    {
+        double ratio = (double)i / ELASTIC_TABLE_SIZE;
+        double invRatio = ratio - 1.0;
+
+        elasticTables[0][i] = (float)(-pow(2.0, 10.0*invRatio) * sin((invRatio-s)*2.0*M_PI/ELASTIC_PERIOD));
+        elasticTables[1][i] = (float)( pow(2.0, -10.0*ratio) * sin((ratio-s)*2.0*M_PI/ELASTIC_PERIOD) + 1.0);
+    }
+}
+
+SP_INLINE float lookupElastic(const float *table, float ratio)
+{
+    if (ratio <= 0.0f) return 0.0f;
+    if (ratio >= 1.0f) return 1.0f;
+
+    dispatch_once_f(&elasticTablesOnce, NULL, createElasticTables);
+
+    float position = ratio * ELASTIC_TABLE_SIZE;
+    int index = (int)position;
+    float fraction = position - index;
+
+    return table[index] + (table[index+1] - table[index]) * fraction;
+}
+
+SP_INLINE float easeIn(float ratio)
+{
+    return ratio * ratio * ratio;
+}
+
+SP_INLINE float easeOut(float ratio)
+{
+    float invRatio = ratio - 1.0f;
+    return invRatio * invRatio * invRatio + 1.0f;
+}
+
+SP_INLINE float easeInBack(float ratio)
+{
+    return ratio * ratio * ((BACK_OVERSHOOT + 1.0f)*ratio - BACK_OVERSHOOT);
+}
+
+SP_INLINE float easeOutBack(float ratio)
+{
+    float invRatio = ratio - 1.0f;
+    return invRatio * invRatio * ((BACK_OVERSHOOT + 1.0f)*invRatio + BACK_OVERSHOOT) + 1.0f;
+}
+
+SP_INLINE float easeInElastic(float ratio)
+{
+    return lookupElastic(elasticTables[0], ratio);
+}
+
+SP_INLINE float easeOutElastic(float ratio)
+{
+    return lookupElastic(elasticTables[1], ratio);
+}
+
+SP_INLINE float easeOutBounce(float ratio)
+{
+    if (ratio < 1.0f / BOUNCE_PERIOD)
+        return BOUNCE_SCALE * ratio * ratio;
+
+    float offset;
+    if      (ratio < 2.0f / BOUNCE_PERIOD) { ratio -= 1.5f   / BOUNCE_PERIOD; offset = 0.75f;     }
+    else if (ratio < 2.5f / BOUNCE_PERIOD) { ratio -= 2.25f  / BOUNCE_PERIOD; offset = 0.9375f;   }
+    else                                   { ratio -= 2.625f / BOUNCE_PERIOD; offset = 0.984375f; }
+
+    return BOUNCE_SCALE * ratio * ratio + offset;
+}
+
+SP_INLINE float easeInBounce(float ratio)
+{
+    return 1.0f - easeOutBounce(1.0f - ratio);
+}
+
+#define COMBINE(first, second, ratio) \
+    ((ratio) < 0.5f ? 0.5f * first((ratio) * 2.0f) : 0.5f * second(((ratio) - 0.5f) * 2.0f) + 0.5f)
+
+// --- simd evaluators -----------------------------------------------------------------------------
+
+SP_INLINE vector_float4 easeIn4(vector_float4 ratio)
+{
+    return ratio * ratio * ratio;
+}
+
+SP_INLINE vector_float4 easeOut4(vector_float4 ratio)
+{
+    vector_float4 invRatio = ratio - 1.0f;
+    return invRatio * invRatio * invRatio + 1.0f;
+}
+
+SP_INLINE vector_float4 easeInBack4(vector_float4 ratio)
+{
+    return ratio * ratio * ((BACK_OVERSHOOT + 1.0f)*ratio - BACK_OVERSHOOT);
+}
+
+SP_INLINE vector_float4 easeOutBack4(vector_float4 ratio)
+{
+    vector_float4 invRatio = ratio - 1.0f;
+    return invRatio * invRatio * ((BACK_OVERSHOOT + 1.0f)*invRatio + BACK_OVERSHOOT) + 1.0f;
+}
+
+SP_INLINE vector_float4 easeOutBounce4(vector_float4 ratio)
+{
+    // evaluate all four parabolas and pick the right one per lane
+
+    vector_float4 r0 = ratio;
+    vector_float4 r1 = ratio - 1.5f   / BOUNCE_PERIOD;
+    vector_float4 r2 = ratio - 2.25f  / BOUNCE_PERIOD;
+    vector_float4 r3 = ratio - 2.625f / BOUNCE_PERIOD;
+
+    vector_float4 l0 = BOUNCE_SCALE * r0 * r0;
+    vector_float4 l1 = BOUNCE_SCALE * r1 * r1 + 0.75f;
+    vector_float4 l2 = BOUNCE_SCALE * r2 * r2 + 0.9375f;
+    vector_float4 l3 = BOUNCE_SCALE * r3 * r3 + 0.984375f;
+
+    vector_float4 result = vector_select(l3, l2, ratio < 2.5f / BOUNCE_PERIOD);
+    result = vector_select(result, l1, ratio < 2.0f / BOUNCE_PERIOD);
+    return   vector_select(result, l0, ratio < 1.0f / BOUNCE_PERIOD);
+}
+
+SP_INLINE vector_float4 easeInBounce4(vector_float4 ratio)
+{
+    return 1.0f - easeOutBounce4(1.0f - ratio);
+}
+
+#define COMBINE4(first, second, ratio) \
+    vector_select(0.5f * second(((ratio) - 0.5f) * 2.0f) + 0.5f, \
+                  0.5f * first((ratio) * 2.0f), (ratio) < 0.5f)
+
+// --- public functions ----------------------------------------------------------------------------
+
+SPTransitionID SPTransitionIDFromName(NSString *name)
+{
+    static NSDictionary *transitionIDs = nil;
+    static dispatch_once_t once;
+
+    dispatch_once(&once, ^
+    {
+        transitionIDs = [@{
+            SPTransitionLinear:             @(SPTransitionIDLinear),
+            SPTransitionEaseIn:             @(SPTransitionIDEaseIn),
+            SPTransitionEaseOut:            @(SPTransitionIDEaseOut),
+            SPTransitionEaseInOut:          @(SPTransitionIDEaseInOut),
+            SPTransitionEaseOutIn:          @(SPTransitionIDEaseOutIn),
+            SPTransitionEaseInBack:         @(SPTransitionIDEaseInBack),
+            SPTransitionEaseOutBack:        @(SPTransitionIDEaseOutBack),
+            SPTransitionEaseInOutBack:      @(SPTransitionIDEaseInOutBack),
+            SPTransitionEaseOutInBack:      @(SPTransitionIDEaseOutInBack),
+            SPTransitionEaseInElastic:      @(SPTransitionIDEaseInElastic),
+            SPTransitionEaseOutElastic:     @(SPTransitionIDEaseOutElastic),
+            SPTransitionEaseInOutElastic:   @(SPTransitionIDEaseInOutElastic),
+            SPTransitionEaseOutInElastic:   @(SPTransitionIDEaseOutInElastic),
+            SPTransitionEaseInBounce:       @(SPTransitionIDEaseInBounce),
+            SPTransitionEaseOutBounce:      @(SPTransitionIDEaseOutBounce),
+            SPTransitionEaseInOutBounce:    @(SPTransitionIDEaseInOutBounce),
+            SPTransitionEaseOutInBounce:    @(SPTransitionIDEaseOutInBounce),
+        } retain];
+    });
+
+    NSNumber *transitionID = transitionIDs[name];
+    return transitionID ? (SPTransitionID)[transitionID integerValue] : SPTransitionIDNone;
+}
+
+float SPTransitionEvaluate(SPTransitionID transitionID, float ratio)
+{
+    switch (transitionID)
+    {
+        case SPTransitionIDEaseIn:              return easeIn(ratio);
+        case SPTransitionIDEaseOut:             return easeOut(ratio);
+        case SPTransitionIDEaseInOut:           return COMBINE(easeIn, easeOut, ratio);
+        case SPTransitionIDEaseOutIn:           return COMBINE(easeOut, easeIn, ratio);
+        case SPTransitionIDEaseInBack:          return easeInBack(ratio);
+        case SPTransitionIDEaseOutBack:         return easeOutBack(ratio);
+        case SPTransitionIDEaseInOutBack:       return COMBINE(easeInBack, easeOutBack, ratio);
+        case SPTransitionIDEaseOutInBack:       return COMBINE(easeOutBack, easeInBack, ratio);
+        case SPTransitionIDEaseInElastic:       return easeInElastic(ratio);
+        case SPTransitionIDEaseOutElastic:      return easeOutElastic(ratio);
+        case SPTransitionIDEaseInOutElastic:    return COMBINE(easeInElastic, easeOutElastic, ratio);
+        case SPTransitionIDEaseOutInElastic:    return COMBINE(easeOutElastic, easeInElastic, ratio);
+        case SPTransitionIDEaseInBounce:        return easeInBounce(ratio);
+        case SPTransitionIDEaseOutBounce:       return easeOutBounce(ratio);
+        case SPTransitionIDEaseInOutBounce:     return COMBINE(easeInBounce, easeOutBounce, ratio);
+        case SPTransitionIDEaseOutInBounce:     return COMBINE(easeOutBounce, easeInBounce, ratio);
+        default:                                return ratio;
+    }
+}
+
+void SPTransitionEvaluateBatch(SPTransitionID transitionID, const float *ratios,
+                               float *results, NSInteger count)
+{
+    if (transitionID == SPTransitionIDLinear || transitionID == SPTransitionIDNone)
+    {
+        if (results != ratios) memmove(results, ratios, sizeof(float) * count);
+        return;
+    }
+
+    NSInteger i = 0;
+
+    // elastic transitions are table lookups, which don't benefit from simd (there's no gather).
+    if (transitionID < SPTransitionIDEaseInElastic || transitionID > SPTransitionIDEaseOutInElastic)
+    {
+        for (; i + 4 <= count; i += 4)
+        {
+            vector_float4 ratio, result;
+            memcpy(&ratio, ratios + i, sizeof(ratio));
+
+            switch (transitionID)
+            {
+                case SPTransitionIDEaseIn:          result = easeIn4(ratio); break;
+                case SPTransitionIDEaseOut:         result = easeOut4(ratio); break;
+                case SPTransitionIDEaseInOut:       result = COMBINE4(easeIn4, easeOut4, ratio); break;
+                case SPTransitionIDEaseOutIn:       result = COMBINE4(easeOut4, easeIn4, ratio); break;
+                case SPTransitionIDEaseInBack:      result = easeInBack4(ratio); break;
+                case SPTransitionIDEaseOutBack:     result = easeOutBack4(ratio); break;
+                case SPTransitionIDEaseInOutBack:   result = COMBINE4(easeInBack4, easeOutBack4, ratio); break;
+                case SPTransitionIDEaseOutInBack:   result = COMBINE4(easeOutBack4, easeInBack4, ratio); break;
+                case SPTransitionIDEaseInBounce:    result = easeInBounce4(ratio); break;
+                case SPTransitionIDEaseOutBounce:   result = easeOutBounce4(ratio); break;
+                case SPTransitionIDEaseInOutBounce: result = COMBINE4(easeInBounce4, easeOutBounce4, ratio); break;
+                default:                            result = COMBINE4(easeOutBounce4, easeInBounce4, ratio); break;
+            }
+
+            memcpy(results + i, &result, sizeof(result));
+        }
+    }
+
+    for (; i < count; ++i)
+        results[i] = SPTransitionEvaluate(transitionID, ratios[i]);
+}
+
 // --- class implementation ------------------------------------------------------------------------
 
 @implementation SPTransitions
@@ -117,6 +117,11 @@ typedef float (^SPTransitionBlock)(float);
 /// The transition method used for the animation.
 @property (nonatomic, copy) NSString *transition;
 
+/// Indicates if the class methods of `SPTransitions` are used to evaluate built-in transitions.
+/// By default, the faster `SPTransitionEvaluate` function is used instead, which approximates
+/// elastic transitions with a lookup table. (Default: `NO`)
+@property (nonatomic, assign) BOOL preciseTransition;
+
 /// The optional transition block used for the animation; if this is set 'transition' is ignored.
 @property (nonatomic, copy, nullable) SPTransitionBlock transitionBlock;
 
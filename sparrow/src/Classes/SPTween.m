@@ -9,6 +9,8 @@
 //  it under the terms of the Simplified BSD License.
 //
 
+#import "SPDisplayObject_Internal.h"
+#import "SPJuggler_Internal.h"
 #import "SPTransitions.h"
 #import "SPTween.h"
 #import "SPTweenedProperty.h"
@@ -19,13 +21,35 @@
 
 typedef float (*FnPtrTransition) (id, SEL, float);
 
+typedef struct
+{
+    float *storage;
+    SPDisplayObjectField field;
+    float startValue;
+    float endValue;
+} SPTweenChannel;
+
+// --- private interface ---------------------------------------------------------------------------
+
+@interface SPTween () <SPJugglerLinkable>
+
+@end
+
+// --- class implementation ------------------------------------------------------------------------
+
 @implementation SPTween
 {
+    SPJugglerLink _jugglerLink;
     id _target;
     SEL _transition;
     IMP _transitionFunc;
+    SPTransitionID _transitionID;
+    BOOL _preciseTransition;
     SPTransitionBlock _transitionBlock;
     SP_GENERIC(NSMutableArray, SPTweenedProperty*) *_properties;
+    SPTweenChannel *_channels;
+    NSInteger _numChannels;
+    BOOL _channelsChangeTransform;
     
     double _totalTime;
     double _currentTime;
@@ -45,6 +69,33 @@ typedef float (*FnPtrTransition) (id, SEL, float);
     SPTween *_nextTween;
 }
 
+// --- c functions ---
+
+static void updateChannels(SPTween *self, BOOL isStarting)
+{
+    float progress = self->_progress;
+    BOOL roundToInt = self->_roundToInt;
+
+    if (self->_channelsChangeTransform)
+        SPDisplayObjectWillChangeTransform(self->_target);
+
+    for (NSInteger i=0; i<self->_numChannels; ++i)
+    {
+        SPTweenChannel *channel = &self->_channels[i];
+        if (isStarting) channel->startValue = *channel->storage;
+
+        float value = channel->startValue + progress * (channel->endValue - channel->startValue);
+        if (roundToInt) value = roundf(value);
+
+        if (channel->field == SPDisplayObjectFieldRotation)
+            value = SPDisplayObjectNormalizeRotation(value);
+        else if (channel->field == SPDisplayObjectFieldAlpha)
+            value = SP_CLAMP(value, 0.0f, 1.0f);
+
+        *channel->storage = value;
+    }
+}
+
 #pragma mark Initialization
 
 - (instancetype)initWithTarget:(id)target time:(double)time transition:(NSString *)transition
@@ -79,6 +130,7 @@ typedef float (*FnPtrTransition) (id, SEL, float);
 {
     [_target release];
     [_properties release];
+    free(_channels);
     [_transitionBlock release];
     [_onStart release];
     [_onUpdate release];
@@ -103,7 +155,22 @@ typedef float (*FnPtrTransition) (id, SEL, float);
 - (void)animateProperty:(NSString *)property targetValue:(double)value
 {    
     if (!_target) return; // tweening nil just does nothing.
-    
+
+    if ([_target isKindOfClass:[SPDisplayObject class]])
+    {
+        // known display object fields are written directly, without going through the setters
+        SPDisplayObjectField field = [(SPDisplayObject *)_target fieldForProperty:property];
+        if (field != SPDisplayObjectFieldNone)
+        {
+            _channels = realloc(_channels, sizeof(SPTweenChannel) * (_numChannels + 1));
+            _channels[_numChannels++] = (SPTweenChannel){
+                [(SPDisplayObject *)_target storageOfField:field], field, 0.0f, value };
+
+            if (field != SPDisplayObjectFieldAlpha) _channelsChangeTransform = YES;
+            return;
+        }
+    }
+
     SPTweenedProperty *tweenedProp = [[SPTweenedProperty alloc] initWithTarget:_target name:property endValue:value];
     [_properties addObject:tweenedProp];
     [tweenedProp release];
@@ -134,6 +201,13 @@ typedef float (*FnPtrTransition) (id, SEL, float);
 
 - (float)endValueOfProperty:(NSString *)property
 {
+    if (_numChannels)
+    {
+        SPDisplayObjectField field = [(SPDisplayObject *)_target fieldForProperty:property];
+        for (NSInteger i=0; i<_numChannels; ++i)
+            if (_channels[i].field == field) return _channels[i].endValue;
+    }
+
     NSInteger index = [_properties indexOfObjectPassingTest:^BOOL (SPTweenedProperty *obj, NSUInteger idx, BOOL *stop)
     {
         if ([obj.name isEqualToString:property])
@@ -149,6 +223,13 @@ typedef float (*FnPtrTransition) (id, SEL, float);
     return [_properties[index] endValue];
 }
 
+#pragma mark SPJugglerLinkable
+
+- (SPJugglerLink *)jugglerLink
+{
+    return &_jugglerLink;
+}
+
 #pragma mark SPAnimatable
 
 - (void)advanceTime:(double)time
@@ -182,12 +263,20 @@ typedef float (*FnPtrTransition) (id, SEL, float);
         _progress = reversed ? _transitionBlock(1.0 - ratio) :
                                _transitionBlock(ratio);
     }
+    else if (_transitionID != SPTransitionIDNone && !_preciseTransition)
+    {
+        _progress = reversed ? SPTransitionEvaluate(_transitionID, 1.0 - ratio) :
+                               SPTransitionEvaluate(_transitionID, ratio);
+    }
     else
     {
         _progress = reversed ? transFunc(transClass, _transition, 1.0 - ratio) :
                                transFunc(transClass, _transition, ratio);
     }
     
+    if (_numChannels)
+        updateChannels(self, isStarting);
+
     for (SPTweenedProperty *prop in _properties)
     {
         if (isStarting) prop.startValue = prop.currentValue;
@@ -209,7 +298,9 @@ typedef float (*FnPtrTransition) (id, SEL, float);
         }
         else
         {
-            [self dispatchEventWithType:SPEventTypeRemoveFromJuggler];
+            [_jugglerLink.juggler objectDidComplete:self];
+            if ([self hasEventListenerForTypeID:SPEventTypeIDRemoveFromJuggler])
+                [self dispatchEventWithType:SPEventTypeRemoveFromJuggler];
             if (_onComplete) _onComplete();
         }
     }
@@ -234,6 +325,7 @@ typedef float (*FnPtrTransition) (id, SEL, float);
         [NSException raise:SPExceptionInvalidOperation
                     format:@"transition not found: '%@'", transition];
     _transitionFunc = [SPTransitions methodForSelector:_transition];
+    _transitionID = SPTransitionIDFromName(transition);
 }
 
 - (BOOL)isComplete
@@ -0,0 +1,116 @@
+//
+//  SPTweenSystem.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 02.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import <Sparrow/SparrowBase.h>
+#import <Sparrow/SPAnimatable.h>
+#import <Sparrow/SPMacros.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+@class SPDisplayObject;
+
+/// A handle that identifies a tween inside an `SPTweenSystem`. Handles of removed tweens become
+/// invalid and are never reused for other tweens.
+typedef uint64_t SPTweenHandle;
+
+/// A handle that never refers to a tween.
+SP_EXTERN const SPTweenHandle SPTweenHandleNone;
+
+/** ------------------------------------------------------------------------------------------------
+
+ An SPTweenSystem animates large numbers of display object properties at once.
+
+ Other than `SPTween`, a tween system does not create one object per animation. All tweens are
+ stored in flat arrays (start and end values, times, durations, transitions) that are advanced
+ in batches; the results are then written to the targets in a single pass. Adding and removing
+ tweens does not allocate memory (except when the arrays have to grow), which makes the system
+ ideal for particle-like effects with many thousands of simultaneous animations.
+
+ Each tween animates a single property of a display object: `x`, `y`, `scaleX`, `scaleY`,
+ `rotation`, `pivotX`, `pivotY`, `skewX`, `skewY` or `alpha`. Subclasses that override the
+ accessor of a property can't be animated that way; use an `SPTween` for those.
+
+ The system itself is an `SPAnimatable`; add it to a juggler to run all of its tweens:
+
+	SPTweenSystem *tweens = [SPTweenSystem tweenSystem];
+	[Sparrow.juggler addObject:tweens];
+
+	SPTweenHandle tween = [tweens addTweenWithTarget:particle property:@"alpha" endValue:0.0f
+	                                            time:1.5 transition:SPTransitionEaseOut];
+	[tweens setDelay:0.5 ofTween:tween];
+	[tweens setOnComplete:^{ [particle removeFromParent]; } ofTween:tween];
+
+ Unlike a juggler, the system stays active when it runs out of tweens; it's cheap to keep around.
+
+------------------------------------------------------------------------------------------------- */
+
+@interface SPTweenSystem : NSObject <SPAnimatable>
+
+/// --------------------
+/// @name Initialization
+/// --------------------
+
+/// Initializes a tween system with room for a certain number of tweens. _Designated Initializer_.
+- (instancetype)initWithCapacity:(NSInteger)capacity;
+
+/// Factory method.
++ (instancetype)tweenSystem;
+
+/// -------------
+/// @name Methods
+/// -------------
+
+/// Adds a tween that animates the property of a display object to an end value within `time`
+/// seconds, and returns its handle. The start value is read when the tween starts.
+- (SPTweenHandle)addTweenWithTarget:(SPDisplayObject *)target property:(NSString *)property
+                           endValue:(float)endValue time:(double)time transition:(NSString *)transition;
+
+/// Adds a tween with a linear transition.
+- (SPTweenHandle)addTweenWithTarget:(SPDisplayObject *)target property:(NSString *)property
+                           endValue:(float)endValue time:(double)time;
+
+/// Removes a tween. Its `onComplete` block will not be called.
+- (void)removeTween:(SPTweenHandle)tween;
+
+/// Removes all tweens animating a certain object.
+- (void)removeTweensWithTarget:(SPDisplayObject *)target;
+
+/// Removes all tweens at once.
+- (void)removeAllTweens;
+
+/// Indicates if a tween is still part of the system.
+- (BOOL)containsTween:(SPTweenHandle)tween;
+
+/// Sets the delay before a tween starts. Only has an effect before the tween has started.
+- (void)setDelay:(double)delay ofTween:(SPTweenHandle)tween;
+
+/// Sets the number of times a tween will be executed. Set to 0 to tween indefinitely. (Default: 1)
+- (void)setRepeatCount:(NSInteger)repeatCount ofTween:(SPTweenHandle)tween;
+
+/// Indicates if every second repetition of a tween should be reversed. (Default: `NO`)
+- (void)setReverse:(BOOL)reverse ofTween:(SPTweenHandle)tween;
+
+/// Indicates if the values of a tween should be rounded to integers. (Default: `NO`)
+- (void)setRoundToInt:(BOOL)roundToInt ofTween:(SPTweenHandle)tween;
+
+/// Sets a block that will be called when a tween has finished.
+- (void)setOnComplete:(nullable SPCallbackBlock)onComplete ofTween:(SPTweenHandle)tween;
+
+/// ----------------
+/// @name Properties
+/// ----------------
+
+/// The number of tweens currently in the system.
+@property (nonatomic, readonly) NSInteger numTweens;
+
+@end
+
+NS_ASSUME_NONNULL_END
@@ -0,0 +1,455 @@
+//
+//  SPTweenSystem.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 02.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPDisplayObject_Internal.h"
+#import "SPMacros.h"
+#import "SPTransitions.h"
+#import "SPTweenSystem.h"
+
+#define DEFAULT_CAPACITY    64
+#define MAX_TRANSITIONS     256
+#define TRANS_SUFFIX        @":"
+
+const SPTweenHandle SPTweenHandleNone = 0;
+
+typedef float (*FnPtrTransition) (id, SEL, float);
+
+typedef NS_OPTIONS(uint8_t, SPTweenFlags)
+{
+    SPTweenFlagStarted      = 1 << 0,
+    SPTweenFlagComplete     = 1 << 1,
+    SPTweenFlagReverse      = 1 << 2,
+    SPTweenFlagRoundToInt   = 1 << 3,
+};
+
+// --- class implementation ------------------------------------------------------------------------
+
+@implementation SPTweenSystem
+{
+    // per tween, indexed densely from 0 to _numTweens
+    SPDisplayObject **_targets;
+    float **_storages;
+    float *_startValues;
+    float *_endValues;
+    float *_ratios;
+    float *_progresses;
+    double *_times;
+    double *_totalTimes;
+    int32_t *_repeatCounts;
+    int32_t *_cycles;
+    uint8_t *_fields;
+    uint8_t *_transitions;
+    uint8_t *_flags;
+    uint32_t *_slots;
+    SPCallbackBlock *_onCompletes;
+    NSInteger _numTweens;
+    NSInteger _capacity;
+
+    // handle slots: a slot maps a handle to its dense index; free slots form a linked list
+    // (through '_indices') that ends with UINT32_MAX
+    uint32_t *_indices;
+    uint32_t *_generations;
+    uint32_t _numSlots;
+    uint32_t _freeSlot;
+
+    SEL _transitionSelectors[MAX_TRANSITIONS];
+    FnPtrTransition _transitionFuncs[MAX_TRANSITIONS];
+    SPTransitionID _builtInTransitions[MAX_TRANSITIONS];
+    SP_GENERIC(NSMutableDictionary, NSString*, NSNumber*) *_transitionIDs;
+
+    SPCallbackBlock *_completedBlocks;
+    NSInteger _completedCapacity;
+}
+
+// --- c functions ---
+
+static void growArrays(SPTweenSystem *self, NSInteger capacity)
+{
+    #define GROW(array) self->array = realloc(self->array, sizeof(*self->array) * capacity)
+
+    GROW(_targets);     GROW(_storages);     GROW(_startValues);  GROW(_endValues);
+    GROW(_ratios);      GROW(_times);        GROW(_totalTimes);   GROW(_repeatCounts);
+    GROW(_cycles);      GROW(_fields);       GROW(_transitions);  GROW(_flags);
+    GROW(_slots);       GROW(_onCompletes);  GROW(_indices);      GROW(_generations);
+    GROW(_progresses);
+
+    #undef GROW
+
+    self->_capacity = capacity;
+}
+
+static NSInteger indexOfTween(SPTweenSystem *self, SPTweenHandle tween)
+{
+    uint32_t slot = (uint32_t)(tween & 0xffffffff);
+    uint32_t generation = (uint32_t)(tween >> 32);
+
+    if (slot >= self->_numSlots || self->_generations[slot] != generation) return -1;
+    else return self->_indices[slot];
+}
+
+static void removeTweenAtIndex(SPTweenSystem *self, NSInteger index)
+{
+    uint32_t slot = self->_slots[index];
+    NSInteger last = --self->_numTweens;
+
+    [self->_targets[index] release];
+    [self->_onCompletes[index] release];
+
+    // invalidate the handle and put its slot on the free list
+    self->_generations[slot]++;
+    self->_indices[slot] = self->_freeSlot;
+    self->_freeSlot = slot;
+
+    if (index != last)
+    {
+        self->_targets[index]      = self->_targets[last];
+        self->_storages[index]     = self->_storages[last];
+        self->_startValues[index]  = self->_startValues[last];
+        self->_endValues[index]    = self->_endValues[last];
+        self->_ratios[index]       = self->_ratios[last];
+        self->_times[index]        = self->_times[last];
+        self->_totalTimes[index]   = self->_totalTimes[last];
+        self->_repeatCounts[index] = self->_repeatCounts[last];
+        self->_cycles[index]       = self->_cycles[last];
+        self->_fields[index]       = self->_fields[last];
+        self->_transitions[index]  = self->_transitions[last];
+        self->_flags[index]        = self->_flags[last];
+        self->_slots[index]        = self->_slots[last];
+        self->_onCompletes[index]  = self->_onCompletes[last];
+        self->_indices[self->_slots[index]] = (uint32_t)index;
+    }
+}
+
+static uint8_t transitionID(SPTweenSystem *self, NSString *transition)
+{
+    NSNumber *transitionID = self->_transitionIDs[transition];
+    if (transitionID) return [transitionID unsignedCharValue];
+
+    NSUInteger numTransitions = self->_transitionIDs.count;
+    if (numTransitions == MAX_TRANSITIONS)
+        [NSException raise:SPExceptionInvalidOperation format:@"too many different transitions"];
+
+    SEL selector = NSSelectorFromString([transition stringByAppendingString:TRANS_SUFFIX]);
+    if (![SPTransitions respondsToSelector:selector])
+        [NSException raise:SPExceptionInvalidOperation format:@"transition not found: '%@'", transition];
+
+    self->_transitionSelectors[numTransitions] = selector;
+    self->_transitionFuncs[numTransitions] = (FnPtrTransition)[SPTransitions methodForSelector:selector];
+    self->_builtInTransitions[numTransitions] = SPTransitionIDFromName(transition);
+    self->_transitionIDs[transition] = @(numTransitions);
+
+    return (uint8_t)numTransitions;
+}
+
+#pragma mark Initialization
+
+- (instancetype)initWithCapacity:(NSInteger)capacity
+{
+    if ((self = [super init]))
+    {
+        _transitionIDs = [[NSMutableDictionary alloc] init];
+        _freeSlot = UINT32_MAX;
+        growArrays(self, MAX(1, capacity));
+    }
+    return self;
+}
+
+- (instancetype)init
+{
+    return [self initWithCapacity:DEFAULT_CAPACITY];
+}
+
+- (void)dealloc
+{
+    for (NSInteger i=0; i<_numTweens; ++i)
+    {
+        [_targets[i] release];
+        [_onCompletes[i] release];
+    }
+
+    free(_targets);     free(_storages);     free(_startValues);  free(_endValues);
+    free(_ratios);      free(_times);        free(_totalTimes);   free(_repeatCounts);
+    free(_cycles);      free(_fields);       free(_transitions);  free(_flags);
+    free(_slots);       free(_onCompletes);  free(_indices);      free(_generations);
+    free(_progresses);  free(_completedBlocks);
+
+    [_transitionIDs release];
+    [super dealloc];
+}
+
++ (instancetype)tweenSystem
+{
+    return [[[self alloc] init] autorelease];
+}
+
+#pragma mark Methods
+
+- (SPTweenHandle)addTweenWithTarget:(SPDisplayObject *)target property:(NSString *)property
+                           endValue:(float)endValue time:(double)time transition:(NSString *)transition
+{
+    SPDisplayObjectField field = [target fieldForProperty:property];
+    if (field == SPDisplayObjectFieldNone)
+        [NSException raise:SPExceptionInvalidOperation
+                    format:@"property '%@' can't be animated by a tween system", property];
+
+    uint8_t transID = transitionID(self, transition);
+
+    if (_numTweens == _capacity)
+        growArrays(self, _capacity * 2);
+
+    uint32_t slot;
+    if (_freeSlot != UINT32_MAX)
+    {
+        slot = _freeSlot;
+        _freeSlot = _indices[slot];
+    }
+    else
+    {
+        slot = _numSlots++;
+        _generations[slot] = 1;
+    }
+
+    NSInteger index = _numTweens++;
+    _indices[slot] = (uint32_t)index;
+
+    _targets[index] = [target retain];
+    _storages[index] = [target storageOfField:field];
+    _startValues[index] = 0.0f;
+    _endValues[index] = endValue;
+    _ratios[index] = 0.0f; // evaluated in batches even before the tween starts
+    _times[index] = 0.0;
+    _totalTimes[index] = MAX(0.0001, time); // zero is not allowed
+    _repeatCounts[index] = 1;
+    _cycles[index] = 0;
+    _fields[index] = (uint8_t)field;
+    _transitions[index] = transID;
+    _flags[index] = 0;
+    _slots[index] = slot;
+    _onCompletes[index] = nil;
+
+    return ((SPTweenHandle)_generations[slot] << 32) | slot;
+}
+
+- (SPTweenHandle)addTweenWithTarget:(SPDisplayObject *)target property:(NSString *)property
+                           endValue:(float)endValue time:(double)time
+{
+    return [self addTweenWithTarget:target property:property endValue:endValue time:time
+                         transition:SPTransitionLinear];
+}
+
+- (void)removeTween:(SPTweenHandle)tween
+{
+    NSInteger index = indexOfTween(self, tween);
+    if (index >= 0) removeTweenAtIndex(self, index);
+}
+
+- (void)removeTweensWithTarget:(SPDisplayObject *)target
+{
+    for (NSInteger i=_numTweens-1; i>=0; --i)
+        if (_targets[i] == target) removeTweenAtIndex(self, i);
+}
+
+- (void)removeAllTweens
+{
+    for (NSInteger i=_numTweens-1; i>=0; --i)
+        removeTweenAtIndex(self, i);
+}
+
+- (BOOL)containsTween:(SPTweenHandle)tween
+{
+    return indexOfTween(self, tween) >= 0;
+}
+
+- (void)setDelay:(double)delay ofTween:(SPTweenHandle)tween
+{
+    NSInteger index = indexOfTween(self, tween);
+    if (index >= 0 && !(_flags[index] & SPTweenFlagStarted)) _times[index] = -delay;
+}
+
+- (void)setRepeatCount:(NSInteger)repeatCount ofTween:(SPTweenHandle)tween
+{
+    NSInteger index = indexOfTween(self, tween);
+    if (index >= 0) _repeatCounts[index] = (int32_t)MAX(0, repeatCount);
+}
+
+- (void)setReverse:(BOOL)reverse ofTween:(SPTweenHandle)tween
+{
+    NSInteger index = indexOfTween(self, tween);
+    if (index < 0) return;
+
+    if (reverse) _flags[index] |=  SPTweenFlagReverse;
+    else         _flags[index] &= ~SPTweenFlagReverse;
+}
+
+- (void)setRoundToInt:(BOOL)roundToInt ofTween:(SPTweenHandle)tween
+{
+    NSInteger index = indexOfTween(self, tween);
+    if (index < 0) return;
+
+    if (roundToInt) _flags[index] |=  SPTweenFlagRoundToInt;
+    else            _flags[index] &= ~SPTweenFlagRoundToInt;
+}
+
+- (void)setOnComplete:(SPCallbackBlock)onComplete ofTween:(SPTweenHandle)tween
+{
+    NSInteger index = indexOfTween(self, tween);
+    if (index >= 0) SP_RELEASE_AND_COPY(_onCompletes[index], onComplete);
+}
+
+#pragma mark SPAnimatable
+
+- (void)advanceTime:(double)seconds
+{
+    if (seconds < 0.0)
+        [NSException raise:SPExceptionInvalidOperation format:@"time must be positive"];
+
+    NSInteger numTweens = _numTweens;
+    if (seconds == 0.0 || numTweens == 0) return;
+
+    // pass 1: advance time, handle start, repetition and completion, and calculate the ratios.
+    // tweens that have not yet started (i.e. are in their delay) are skipped by all passes.
+
+    NSInteger numCompleted = 0;
+
+    for (NSInteger i=0; i<numTweens; ++i)
+    {
+        double totalTime = _totalTimes[i];
+        double time = _times[i] + seconds;
+        uint8_t flags = _flags[i];
+
+        if (time <= 0.0)
+        {
+            _times[i] = time;
+            continue;
+        }
+
+        if (!(flags & SPTweenFlagStarted))
+        {
+            flags |= SPTweenFlagStarted;
+            _startValues[i] = *_storages[i];
+        }
+
+        while (time >= totalTime)
+        {
+            if (_repeatCounts[i] == 1)
+            {
+                time = totalTime;
+                flags |= SPTweenFlagComplete;
+                ++numCompleted;
+                break;
+            }
+
+            if (_repeatCounts[i] > 1) --_repeatCounts[i];
+            ++_cycles[i];
+            time -= totalTime;
+        }
+
+        float ratio = (float)(time / totalTime);
+        if ((flags & SPTweenFlagReverse) && (_cycles[i] & 1)) ratio = 1.0f - ratio;
+
+        _times[i] = time;
+        _ratios[i] = ratio;
+        _flags[i] = flags;
+    }
+
+    // pass 2: run the ratios through the transition functions. Built-in transitions are evaluated
+    // in batches of neighbouring tweens that share the same transition; those batches include
+    // tweens that have not yet started, which keep the ratio they were added with.
+
+    Class transClass = [SPTransitions class];
+
+    for (NSInteger i=0; i<numTweens; )
+    {
+        uint8_t transID = _transitions[i];
+        NSInteger runEnd = i + 1;
+        while (runEnd < numTweens && _transitions[runEnd] == transID) ++runEnd;
+
+        SPTransitionID builtInID = _builtInTransitions[transID];
+
+        if (builtInID != SPTransitionIDNone)
+            SPTransitionEvaluateBatch(builtInID, _ratios + i, _progresses + i, runEnd - i);
+        else
+        {
+            FnPtrTransition transFunc = _transitionFuncs[transID];
+            SEL transSel = _transitionSelectors[transID];
+
+            for (NSInteger j=i; j<runEnd; ++j)
+                if (_flags[j] & SPTweenFlagStarted)
+                    _progresses[j] = transFunc(transClass, transSel, _ratios[j]);
+        }
+
+        i = runEnd;
+    }
+
+    // pass 3: interpolate the values and scatter them to the targets
+
+    for (NSInteger i=0; i<numTweens; ++i)
+    {
+        if (!(_flags[i] & SPTweenFlagStarted)) continue;
+
+        // note that transitions like 'easeInBack' return a negative progress
+        float progress = _progresses[i];
+        float startValue = _startValues[i];
+        float value = startValue + progress * (_endValues[i] - startValue);
+        uint8_t field = _fields[i];
+
+        if (_flags[i] & SPTweenFlagRoundToInt) value = roundf(value);
+
+        if (field == SPDisplayObjectFieldAlpha)
+            value = SP_CLAMP(value, 0.0f, 1.0f);
+        else
+        {
+            if (field == SPDisplayObjectFieldRotation)
+                value = SPDisplayObjectNormalizeRotation(value);
+
+            SPDisplayObjectWillChangeTransform(_targets[i]);
+        }
+
+        *_storages[i] = value;
+    }
+
+    // remove completed tweens before executing their callbacks, which may add or remove tweens
+
+    if (numCompleted)
+    {
+        if (_completedCapacity < numCompleted)
+        {
+            _completedCapacity = MAX(numCompleted, _completedCapacity * 2);
+            _completedBlocks = realloc(_completedBlocks, sizeof(SPCallbackBlock) * _completedCapacity);
+        }
+
+        NSInteger numBlocks = 0;
+
+        for (NSInteger i=numTweens-1; i>=0; --i)
+        {
+            if (_flags[i] & SPTweenFlagComplete)
+            {
+                if (_onCompletes[i]) _completedBlocks[numBlocks++] = [_onCompletes[i] retain];
+                removeTweenAtIndex(self, i);
+            }
+        }
+
+        for (NSInteger i=0; i<numBlocks; ++i)
+        {
+            _completedBlocks[i]();
+            [_completedBlocks[i] release];
+        }
+    }
+}
+
+#pragma mark Properties
+
+- (NSInteger)numTweens
+{
+    return _numTweens;
+}
+
+@end
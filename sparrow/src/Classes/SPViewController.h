@@ -76,6 +76,21 @@ SP_EXTERN NSString *const SPNotificationRootCreated;
  * Pause or restart Sparrow through the `paused` property
  * Stop or start rendering through the `rendering` property
 
+ **Fixed Time Step**
+
+ Per default, the stage and juggler are advanced once per frame by the time that has passed since
+ the last one. Physics simulations and networked games often need a constant step instead; set
+ `fixedUpdateRate` to the number of updates per second to get it. Each frame will then run as
+ many updates as are due (but at most `maxUpdatesPerFrame`; the rest is dropped to let a slow
+ device catch up), and the display list will be rendered between the last two simulated states:
+
+	viewController.fixedUpdateRate = 30; // simulation at 30 Hz, rendering at 60 Hz
+
+ Interpolation only affects the rendered transforms (position, scale, rotation, skew and pivot
+ point); the properties you read always contain the simulated values. Objects created during
+ the last update are shown in their simulated state. Disable interpolation through
+ `interpolatesRendering` if you want to see the simulated states exactly.
+
  **Accessing the current controller**
  
  As a convenience, you can access the view controller through a static method on the `Sparrow`
@@ -210,6 +225,28 @@ SP_EXTERN NSString *const SPNotificationRootCreated;
 /// The actual frames per second that was decided upon given the value for preferredFramesPerSecond.
 @property (nonatomic, readonly) NSInteger framesPerSecond;
 
+/// The number of fixed updates per second, or zero to advance the display tree once per frame by
+/// the passed time. (Default: 0)
+@property (nonatomic, assign) NSInteger fixedUpdateRate;
+
+/// The maximum number of fixed updates within one frame. When the app falls behind further,
+/// the surplus updates are dropped. (Default: 5)
+@property (nonatomic, assign) NSInteger maxUpdatesPerFrame;
+
+/// Indicates if the display tree is rendered between the last two fixed updates, so that
+/// motion stays smooth when the update rate is lower than the frame rate. (Default: YES)
+@property (nonatomic, assign) BOOL interpolatesRendering;
+
+/// The total number of fixed updates that were dropped to catch up with the display.
+@property (nonatomic, readonly) NSInteger numDroppedUpdates;
+
+/// The number of fixed updates that were executed in the last frame.
+@property (nonatomic, readonly) NSInteger numUpdatesInLastFrame;
+
+/// The position of the last rendered frame between the last two fixed updates, in the range
+/// [0, 1). Zero if no fixed update rate is set.
+@property (nonatomic, readonly) float interpolationAlpha;
+
 /// Indicates if multitouch input is enabled.
 @property (nonatomic, assign) BOOL multitouchEnabled;
 
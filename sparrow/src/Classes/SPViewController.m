@@ -11,6 +11,8 @@
 
 #import "SparrowClass_Internal.h"
 #import "SPContext_Internal.h"
+#import "SPDisplayObject_Internal.h"
+#import "SPDisplayObjectContainer.h"
 #import "SPEnterFrameEvent.h"
 #import "SPMatrix.h"
 #import "SPOpenGL.h"
@@ -25,9 +27,8 @@
 #import "SPResizeEvent.h"
 #import "SPStage_Internal.h"
 #import "SPStatsDisplay.h"
-#import "SPTexture.h"
+#import "SPGLTexture_Internal.h"
 #import "SPTouchProcessor.h"
-#import "SPTouch_Internal.h"
 #import "SPView_Internal.h"
 #import "SPViewController_Internal.h"
 
@@ -39,6 +40,13 @@ NSString *const SPNotificationRootCreated = @"SPNotificationRootCreated";
 @property (nonatomic, strong) SPContext *context;
 @end
 
+/// The transform of a display object at a certain point in time.
+typedef struct
+{
+    SPDisplayObject *object;
+    SPDisplayObjectTransform transform;
+} SPTransformSnapshot;
+
 // --- class implementation ------------------------------------------------------------------------
 
 @implementation SPViewController
@@ -61,17 +69,29 @@ NSString *const SPNotificationRootCreated = @"SPNotificationRootCreated";
     SPOverlayView *_overlayView;
     
     CADisplayLink *_displayLink;
+    double _accumulatedTime;
+    SPTransformSnapshot *_snapshots;         // objects changed in the last update, previous state
+    NSInteger _numSnapshots;
+    NSInteger _snapshotCapacity;
+    SPTransformSnapshot *_renderedStates;    // simulated states, restored after rendering
+    NSInteger _numRenderedStates;
+    NSInteger _renderedStateCapacity;
     dispatch_queue_t _resourceQueue;
     SPContext *_resourceContext;
     
     NSInteger _antiAliasing;
     NSInteger _preferredFramesPerSecond;
     NSInteger _frameInterval;
+    NSInteger _fixedUpdateRate;
+    NSInteger _maxUpdatesPerFrame;
+    NSInteger _numDroppedUpdates;
+    NSInteger _numUpdatesInLastFrame;
     double _lastFrameTimestamp;
     double _lastTouchTimestamp;
     double _rotationDuration;
     float _contentScaleFactor;
     float _viewScaleFactor;
+    float _interpolationAlpha;
     BOOL _isPad;
     BOOL _hasRenderedOnce;
     BOOL _supportHighResolutions;
@@ -80,10 +100,43 @@ NSString *const SPNotificationRootCreated = @"SPNotificationRootCreated";
     BOOL _started;
     BOOL _paused;
     BOOL _rendering;
+    BOOL _interpolatesRendering;
 }
 
 @dynamic view;
 
+static SPTransformSnapshot *appendSnapshot(SPTransformSnapshot **snapshots, NSInteger *count,
+                                           NSInteger *capacity)
+{
+    if (*count == *capacity)
+    {
+        *capacity = MAX(64, *capacity * 2);
+        *snapshots = realloc(*snapshots, sizeof(SPTransformSnapshot) * *capacity);
+    }
+
+    return &(*snapshots)[(*count)++];
+}
+
+static void clearSnapshots(SPViewController *self)
+{
+    for (NSInteger i=0; i<self->_numSnapshots; ++i)
+        [self->_snapshots[i].object release];
+
+    self->_numSnapshots = 0;
+}
+
+static void recordSnapshot(SPDisplayObject *object, const SPDisplayObjectTransform *transform,
+                           void *context)
+{
+    SPViewController *self = context;
+
+    // objects are retained, since the update might remove and release them
+    SPTransformSnapshot *snapshot = appendSnapshot(&self->_snapshots, &self->_numSnapshots,
+                                                   &self->_snapshotCapacity);
+    snapshot->object = [object retain];
+    snapshot->transform = *transform;
+}
+
 #pragma mark Initialization
 
 - (instancetype)initWithNibName:(NSString *)nibNameOrNil bundle:(NSBundle *)nibBundleOrNil
@@ -130,6 +183,10 @@ NSString *const SPNotificationRootCreated = @"SPNotificationRootCreated";
     [_previousViewPort release];
     [_overlayView release];
 
+    clearSnapshots(self);
+    free(_snapshots);
+    free(_renderedStates);
+
     [SPContext setCurrentContext:nil];
     [Sparrow setCurrentController:nil];
     [[NSNotificationCenter defaultCenter] removeObserver:self];
@@ -149,6 +206,8 @@ NSString *const SPNotificationRootCreated = @"SPNotificationRootCreated";
     _support = [[SPRenderSupport alloc] init];
     _viewPort = [[SPRectangle alloc] init];
     _previousViewPort = [[SPRectangle alloc] init];
+    _maxUpdatesPerFrame = 5;
+    _interpolatesRendering = YES;
     
     [self setPreferredFramesPerSecond:60];
     [self makeCurrent];
@@ -305,10 +364,49 @@ NSString *const SPNotificationRootCreated = @"SPNotificationRootCreated";
     if (passedTime > 1.0) passedTime = 1.0;
     if (passedTime < 0.0) passedTime = 1.0 / self.framesPerSecond;
     
-    [self advanceTime:passedTime];
+    if (_fixedUpdateRate > 0) [self advanceFixedTime:passedTime];
+    else                      [self advanceTime:passedTime];
+    
     [self render];
 }
 
+- (void)advanceFixedTime:(double)passedTime
+{
+    double timeStep = 1.0 / _fixedUpdateRate;
+    _accumulatedTime += passedTime;
+    
+    NSInteger numUpdates = (NSInteger)(_accumulatedTime / timeStep);
+    if (numUpdates > _maxUpdatesPerFrame)
+    {
+        // we can't keep up; skip the surplus instead of falling behind even further.
+        _numDroppedUpdates += numUpdates - _maxUpdatesPerFrame;
+        _accumulatedTime -= (numUpdates - _maxUpdatesPerFrame) * timeStep;
+        numUpdates = _maxUpdatesPerFrame;
+    }
+    
+    for (NSInteger i=0; i<numUpdates; ++i)
+    {
+        // only the objects that change in the last update are interpolated; their previous
+        // transforms are recorded right before the first change.
+        BOOL recordTransforms = i == numUpdates - 1 && _interpolatesRendering;
+
+        if (recordTransforms)
+        {
+            clearSnapshots(self);
+            SPDisplayObjectStartRecordingTransforms(recordSnapshot, self);
+        }
+        
+        [self advanceTime:timeStep];
+        _accumulatedTime -= timeStep;
+
+        if (recordTransforms)
+            SPDisplayObjectStopRecordingTransforms();
+    }
+    
+    _numUpdatesInLastFrame = numUpdates;
+    _interpolationAlpha = MAX(0.0f, MIN(_accumulatedTime / timeStep, 1.0f));
+}
+
 - (void)advanceTime:(double)passedTime
 {
     @autoreleasepool
@@ -357,6 +455,7 @@ NSString *const SPNotificationRootCreated = @"SPNotificationRootCreated";
                 glDepthMask(GL_FALSE);
                 glDepthFunc(GL_ALWAYS);
                 
+                [SPGLTexture nextFrame];
                 [_support nextFrame];
                 [_support setStencilReferenceValue:0];
                 [_support setRenderTarget:nil];
@@ -369,7 +468,13 @@ NSString *const SPNotificationRootCreated = @"SPNotificationRootCreated";
                                          cameraPos:_stage.cameraPosition];
                 
                 [_support clearWithColor:_stage.color alpha:1.0];
-                [_stage render:_support];
+                if (_numSnapshots)
+                {
+                    [self interpolateTransforms];
+                    [_stage render:_support];
+                    [self restoreTransforms];
+                }
+                else [_stage render:_support];
                 [_support finishQuadBatch];
                 
                 if (_statsDisplay)
@@ -537,6 +642,9 @@ NSString *const SPNotificationRootCreated = @"SPNotificationRootCreated";
 {
     [self purgePools];
     [_support purgeBuffers];
+
+    if ([_context makeCurrentContext])
+        [SPTexture evictReloadableTextures];
     
     [super didReceiveMemoryWarning];
 }
@@ -617,20 +725,13 @@ NSString *const SPNotificationRootCreated = @"SPNotificationRootCreated";
             float xConversion = _stage.width / viewSize.width;
             float yConversion = _stage.height / viewSize.height;
             
-            // convert to SPTouches and forward to stage
+            // forward touch data to the touch processor
             for (UITouch *uiTouch in [event touchesForView:_internalView])
             {
                 CGPoint location = [uiTouch locationInView:_internalView];
                 CGPoint previousLocation = [uiTouch previousLocationInView:_internalView];
 
-                SPTouch *touch = [SPTouch touch];
-                touch.globalX = location.x * xConversion;
-                touch.globalY = location.y * yConversion;
-                touch.previousGlobalX = previousLocation.x * xConversion;
-                touch.previousGlobalY = previousLocation.y * yConversion;
-                touch.tapCount = (int)uiTouch.tapCount;
-                touch.phase = (SPTouchPhase)uiTouch.phase;
-                touch.touchID = (size_t)uiTouch;
+                float forceFactor = 0.0f;
                 
               #pragma clang diagnostic push
               #pragma ide diagnostic ignored "UnavailableInDeploymentTarget"
@@ -638,16 +739,19 @@ NSString *const SPNotificationRootCreated = @"SPNotificationRootCreated";
                 if ([uiTouch respondsToSelector:@selector(force)] &&
                      uiTouch.maximumPossibleForce > 0)
                 {
-                    touch.forceFactor = uiTouch.force / uiTouch.maximumPossibleForce;
-                }
-                else
-                {
-                    touch.forceFactor = 0;
+                    forceFactor = uiTouch.force / uiTouch.maximumPossibleForce;
                 }
                 
               #pragma clang diagnostic pop
                 
-                [_touchProcessor enqueueTouch:touch];
+                [_touchProcessor enqueueTouchWithID:(size_t)uiTouch
+                                              phase:(SPTouchPhase)uiTouch.phase
+                                            globalX:location.x * xConversion
+                                            globalY:location.y * yConversion
+                                    previousGlobalX:previousLocation.x * xConversion
+                                    previousGlobalY:previousLocation.y * yConversion
+                                           tapCount:uiTouch.tapCount
+                                        forceFactor:forceFactor];
             }
 
             _lastTouchTimestamp = event.timestamp;
@@ -817,6 +921,29 @@ NSString *const SPNotificationRootCreated = @"SPNotificationRootCreated";
     }
 }
 
+- (void)setFixedUpdateRate:(NSInteger)fixedUpdateRate
+{
+    fixedUpdateRate = MAX(0, fixedUpdateRate);
+    if (fixedUpdateRate != _fixedUpdateRate)
+    {
+        _fixedUpdateRate = fixedUpdateRate;
+        _accumulatedTime = 0.0;
+        _interpolationAlpha = 0.0f;
+        clearSnapshots(self);
+    }
+}
+
+- (void)setMaxUpdatesPerFrame:(NSInteger)maxUpdatesPerFrame
+{
+    _maxUpdatesPerFrame = MAX(1, maxUpdatesPerFrame);
+}
+
+- (void)setInterpolatesRendering:(BOOL)interpolatesRendering
+{
+    _interpolatesRendering = interpolatesRendering;
+    if (!_interpolatesRendering) clearSnapshots(self);
+}
+
 #pragma mark Private
 
 - (void)purgePools
@@ -859,6 +986,50 @@ NSString *const SPNotificationRootCreated = @"SPNotificationRootCreated";
     [_viewPort copyFromRectangle:[SPRectangle rectangleWithCGRect:frame]];
 }
 
+- (void)interpolateTransforms
+{
+    float alpha = _interpolationAlpha;
+
+    for (NSInteger i=0; i<_numSnapshots; ++i)
+    {
+        SPDisplayObject *object = _snapshots[i].object;
+        SPDisplayObjectTransform *prev = &_snapshots[i].transform;
+        SPDisplayObjectTransform next;
+        SPDisplayObjectGetTransform(object, &next);
+
+        if (memcmp(prev, &next, sizeof(SPDisplayObjectTransform)) == 0)
+            continue;
+
+        SPTransformSnapshot *rendered = appendSnapshot(&_renderedStates, &_numRenderedStates,
+                                                       &_renderedStateCapacity);
+        rendered->object = object;
+        rendered->transform = next;
+
+        // rotation takes the shorter way around the circle
+        float rotationDelta = SPDisplayObjectNormalizeRotation(next.rotation - prev->rotation);
+
+        SPDisplayObjectTransform current;
+        current.x        = prev->x      + (next.x      - prev->x)      * alpha;
+        current.y        = prev->y      + (next.y      - prev->y)      * alpha;
+        current.scaleX   = prev->scaleX + (next.scaleX - prev->scaleX) * alpha;
+        current.scaleY   = prev->scaleY + (next.scaleY - prev->scaleY) * alpha;
+        current.rotation = prev->rotation + rotationDelta * alpha;
+        current.pivotX   = prev->pivotX + (next.pivotX - prev->pivotX) * alpha;
+        current.pivotY   = prev->pivotY + (next.pivotY - prev->pivotY) * alpha;
+        current.skewX    = prev->skewX  + (next.skewX  - prev->skewX)  * alpha;
+        current.skewY    = prev->skewY  + (next.skewY  - prev->skewY)  * alpha;
+        SPDisplayObjectSetTransform(object, &current);
+    }
+}
+
+- (void)restoreTransforms
+{
+    for (NSInteger i=0; i<_numRenderedStates; ++i)
+        SPDisplayObjectSetTransform(_renderedStates[i].object, &_renderedStates[i].transform);
+
+    _numRenderedStates = 0;
+}
+
 @end
 
 
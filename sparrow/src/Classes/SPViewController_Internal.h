@@ -15,4 +15,14 @@
 
 - (void)viewDidResize:(CGRect)frame;
 
+/// Advances the display tree by the given time in steps of `1 / fixedUpdateRate`, recording the
+/// transforms of the objects that change in the last step.
+- (void)advanceFixedTime:(double)passedTime;
+
+/// Moves the objects that changed in the last fixed update to their interpolated transforms.
+- (void)interpolateTransforms;
+
+/// Restores the simulated transforms after rendering.
+- (void)restoreTransforms;
+
 @end
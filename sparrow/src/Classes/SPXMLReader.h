@@ -0,0 +1,112 @@
+//
+//  SPXMLReader.h
+//  Sparrow
+//
+//  Created by Daniel Sperl on 15.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import <Sparrow/SparrowBase.h>
+
+NS_ASSUME_NONNULL_BEGIN
+
+/// A range of bytes within the data that is being parsed. Slices are not NUL-terminated, and
+/// entities (like `&amp;`) are not yet decoded.
+typedef struct
+{
+    const char *bytes;
+    NSUInteger length;
+} SPXMLSlice;
+
+typedef struct
+{
+    SPXMLSlice name;
+    SPXMLSlice value;
+} SPXMLAttribute;
+
+typedef struct
+{
+    SPXMLSlice name;
+    const SPXMLAttribute *attributes;
+    NSInteger numAttributes;
+} SPXMLElement;
+
+typedef void (^SPXMLReaderElementHandler)(const SPXMLElement *element, BOOL *stop);
+
+/// Indicates if an element has a certain name.
+SP_EXTERN BOOL SPXMLElementHasName(const SPXMLElement *element, const char *name);
+
+/// Returns the raw value of an attribute; its `bytes` are NULL if the attribute does not exist.
+SP_EXTERN SPXMLSlice SPXMLElementAttribute(const SPXMLElement *element, const char *name);
+
+/// Returns an attribute value as a float, or zero if the attribute does not exist.
+SP_EXTERN float SPXMLElementFloat(const SPXMLElement *element, const char *name);
+
+/// Returns an attribute value as an int, or zero if the attribute does not exist.
+SP_EXTERN int SPXMLElementInt(const SPXMLElement *element, const char *name);
+
+/// Returns an attribute value as a BOOL, following the rules of `-[NSString boolValue]`.
+SP_EXTERN BOOL SPXMLElementBool(const SPXMLElement *element, const char *name);
+
+/// Returns an attribute value as a string with decoded entities, or nil if the attribute does
+/// not exist. This is the only accessor that creates an object.
+SP_EXTERN NSString *_Nullable SPXMLElementString(const SPXMLElement *element, const char *name);
+
+/// Parses a decimal number like `-12.5e3` without creating any objects. Leading whitespace is
+/// skipped, and parsing stops at the first char that does not belong to the number.
+SP_EXTERN float SPXMLParseFloat(const char *bytes, NSUInteger length);
+
+/** ------------------------------------------------------------------------------------------------
+
+ SPXMLReader is a small, non-validating SAX-style XML parser, made for the data files Sparrow
+ reads at startup (texture atlases, bitmap fonts).
+
+ Unlike `NSXMLParser`, it does not create any objects while parsing. The handler receives each
+ start tag as an `SPXMLElement`, whose name and attributes are slices of the parsed data; the
+ accessor functions above convert them into numbers right from those bytes. Combined with
+ memory-mapped data, a file is parsed without copying it at all.
+
+	NSData *data = [NSData dataWithContentsOfFile:path options:NSDataReadingMappedIfSafe error:nil];
+	SPXMLReader *reader = [[SPXMLReader alloc] initWithData:data];
+
+	[reader parseElementsWithBlock:^(const SPXMLElement *element, BOOL *stop)
+	{
+	    if (SPXMLElementHasName(element, "SubTexture"))
+	        NSLog(@"x: %f", SPXMLElementFloat(element, "x"));
+	}];
+
+ Comments, processing instructions, DOCTYPE declarations, CDATA sections and text content are
+ skipped. The slices are only valid while the handler is executed.
+
+------------------------------------------------------------------------------------------------- */
+
+@interface SPXMLReader : NSObject
+
+/// --------------------
+/// @name Initialization
+/// --------------------
+
+/// Initializes a reader that parses the given data. _Designated Initializer_.
+- (instancetype)initWithData:(NSData *)data;
+
+/// -------------
+/// @name Methods
+/// -------------
+
+/// Parses the data, calling the block for each start tag. Set `*stop` to `YES` to abort parsing.
+/// Returns `NO` if the data is not well-formed; `errorMessage` then describes the problem.
+- (BOOL)parseElementsWithBlock:(SPXMLReaderElementHandler)elementHandler;
+
+/// ----------------
+/// @name Properties
+/// ----------------
+
+/// Describes why the last call to `parseElementsWithBlock:` failed, or nil if it succeeded.
+@property (nonatomic, readonly, nullable) NSString *errorMessage;
+
+@end
+
+NS_ASSUME_NONNULL_END
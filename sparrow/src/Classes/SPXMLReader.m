@@ -0,0 +1,431 @@
+//
+//  SPXMLReader.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 15.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPMacros.h"
+#import "SPXMLReader.h"
+
+#define MAX_MANTISSA_DIGITS 19
+
+// --- C functions ---------------------------------------------------------------------------------
+
+SP_INLINE BOOL isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+SP_INLINE BOOL isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+SP_INLINE BOOL isNameChar(char c)
+{
+    return !isSpace(c) && c != '=' && c != '>' && c != '<' && c != '/' && c != '"' && c != '\'';
+}
+
+SP_INLINE BOOL sliceEquals(SPXMLSlice slice, const char *string)
+{
+    return strlen(string) == slice.length && memcmp(slice.bytes, string, slice.length) == 0;
+}
+
+static const char *skipSpaces(const char *p, const char *end)
+{
+    while (p < end && isSpace(*p)) ++p;
+    return p;
+}
+
+static const char *findPast(const char *p, const char *end, const char *terminator)
+{
+    // returns the position after the terminator, or NULL if it is not found
+    size_t length = strlen(terminator);
+    const char *match = memmem(p, end - p, terminator, length);
+    return match ? match + length : NULL;
+}
+
+static BOOL startsWith(const char *p, const char *end, const char *prefix)
+{
+    size_t length = strlen(prefix);
+    return (size_t)(end - p) >= length && memcmp(p, prefix, length) == 0;
+}
+
+static double powerOfTen(int exponent)
+{
+    static const double powers[] = {
+        1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+    };
+
+    return exponent <= 22 ? powers[exponent] : pow(10.0, exponent);
+}
+
+float SPXMLParseFloat(const char *bytes, NSUInteger length)
+{
+    const char *p = skipSpaces(bytes, bytes + length);
+    const char *end = bytes + length;
+    BOOL negative = NO;
+
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+
+    uint64_t mantissa = 0;
+    int numDigits = 0;
+    int exponent = 0;
+
+    for (; p < end && isDigit(*p); ++p)
+    {
+        if (numDigits < MAX_MANTISSA_DIGITS)
+        {
+            mantissa = mantissa * 10 + (*p - '0');
+            if (mantissa) ++numDigits;
+        }
+        else ++exponent;
+    }
+
+    if (p < end && *p == '.')
+    {
+        for (++p; p < end && isDigit(*p); ++p)
+        {
+            if (numDigits < MAX_MANTISSA_DIGITS)
+            {
+                mantissa = mantissa * 10 + (*p - '0');
+                if (mantissa) ++numDigits;
+                --exponent;
+            }
+        }
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E'))
+    {
+        const char *q = p + 1;
+        BOOL negativeExponent = NO;
+
+        if (q < end && (*q == '-' || *q == '+'))
+            negativeExponent = *q++ == '-';
+
+        if (q < end && isDigit(*q))
+        {
+            int value = 0;
+            for (; q < end && isDigit(*q); ++q)
+                if (value < 1000) value = value * 10 + (*q - '0');
+
+            exponent += negativeExponent ? -value : value;
+        }
+    }
+
+    double value = (double)mantissa;
+
+    if (exponent < 0)      value /= powerOfTen(-exponent);
+    else if (exponent > 0) value *= powerOfTen(exponent);
+
+    return (float)(negative ? -value : value);
+}
+
+static int parseInt(const char *bytes, NSUInteger length)
+{
+    const char *p = skipSpaces(bytes, bytes + length);
+    const char *end = bytes + length;
+    BOOL negative = NO;
+
+    if (p < end && (*p == '-' || *p == '+'))
+        negative = *p++ == '-';
+
+    int64_t value = 0;
+    for (; p < end && isDigit(*p); ++p)
+        if (value <= INT_MAX) value = value * 10 + (*p - '0');
+
+    if (negative) return value > (int64_t)INT_MAX + 1 ? INT_MIN : (int)-value;
+    else          return value > INT_MAX ? INT_MAX : (int)value;
+}
+
+static void appendUTF8(NSMutableData *data, uint32_t c)
+{
+    uint8_t bytes[4];
+    NSUInteger length;
+
+    if (c < 0x80)         { bytes[0] = c; length = 1; }
+    else if (c < 0x800)   { bytes[0] = 0xc0 | (c >> 6);  bytes[1] = 0x80 | (c & 0x3f); length = 2; }
+    else if (c < 0x10000) { bytes[0] = 0xe0 | (c >> 12); bytes[1] = 0x80 | ((c >> 6) & 0x3f);
+                            bytes[2] = 0x80 | (c & 0x3f); length = 3; }
+    else                  { bytes[0] = 0xf0 | (c >> 18); bytes[1] = 0x80 | ((c >> 12) & 0x3f);
+                            bytes[2] = 0x80 | ((c >> 6) & 0x3f); bytes[3] = 0x80 | (c & 0x3f);
+                            length = 4; }
+
+    [data appendBytes:bytes length:length];
+}
+
+static NSString *decodeSlice(SPXMLSlice slice)
+{
+    if (!memchr(slice.bytes, '&', slice.length))
+        return [[[NSString alloc] initWithBytes:slice.bytes length:slice.length
+                                       encoding:NSUTF8StringEncoding] autorelease];
+
+    NSMutableData *decoded = [NSMutableData dataWithCapacity:slice.length];
+    const char *p = slice.bytes;
+    const char *end = p + slice.length;
+
+    while (p < end)
+    {
+        const char *entityEnd = *p == '&' ? memchr(p, ';', end - p) : NULL;
+        if (!entityEnd)
+        {
+            [decoded appendBytes:p++ length:1];
+            continue;
+        }
+
+        SPXMLSlice entity = { p + 1, entityEnd - p - 1 };
+        uint32_t c = 0;
+
+        if      (sliceEquals(entity, "lt"))   c = '<';
+        else if (sliceEquals(entity, "gt"))   c = '>';
+        else if (sliceEquals(entity, "amp"))  c = '&';
+        else if (sliceEquals(entity, "quot")) c = '"';
+        else if (sliceEquals(entity, "apos")) c = '\'';
+        else if (entity.length > 1 && entity.bytes[0] == '#')
+        {
+            BOOL hex = entity.bytes[1] == 'x' || entity.bytes[1] == 'X';
+            for (NSUInteger i = hex ? 2 : 1; i<entity.length && c <= 0x10ffff; ++i)
+            {
+                char digit = entity.bytes[i];
+                if (isDigit(digit))                             c = c * (hex ? 16 : 10) + (digit - '0');
+                else if (hex && digit >= 'a' && digit <= 'f')   c = c * 16 + (digit - 'a' + 10);
+                else if (hex && digit >= 'A' && digit <= 'F')   c = c * 16 + (digit - 'A' + 10);
+                else { c = 0; break; }
+            }
+        }
+
+        if (c && c <= 0x10ffff)
+        {
+            appendUTF8(decoded, c);
+            p = entityEnd + 1;
+        }
+        else [decoded appendBytes:p++ length:1];
+    }
+
+    return [[[NSString alloc] initWithData:decoded encoding:NSUTF8StringEncoding] autorelease];
+}
+
+BOOL SPXMLElementHasName(const SPXMLElement *element, const char *name)
+{
+    return sliceEquals(element->name, name);
+}
+
+SPXMLSlice SPXMLElementAttribute(const SPXMLElement *element, const char *name)
+{
+    for (NSInteger i=0; i<element->numAttributes; ++i)
+        if (sliceEquals(element->attributes[i].name, name))
+            return element->attributes[i].value;
+
+    return (SPXMLSlice){ NULL, 0 };
+}
+
+float SPXMLElementFloat(const SPXMLElement *element, const char *name)
+{
+    SPXMLSlice value = SPXMLElementAttribute(element, name);
+    return value.bytes ? SPXMLParseFloat(value.bytes, value.length) : 0.0f;
+}
+
+int SPXMLElementInt(const SPXMLElement *element, const char *name)
+{
+    SPXMLSlice value = SPXMLElementAttribute(element, name);
+    return value.bytes ? parseInt(value.bytes, value.length) : 0;
+}
+
+BOOL SPXMLElementBool(const SPXMLElement *element, const char *name)
+{
+    SPXMLSlice value = SPXMLElementAttribute(element, name);
+    if (!value.bytes) return NO;
+
+    const char *end = value.bytes + value.length;
+    const char *p = skipSpaces(value.bytes, end);
+
+    if (p < end && (*p == '-' || *p == '+')) ++p;
+    while (p < end && *p == '0') ++p;
+
+    return p < end && (*p == 'Y' || *p == 'y' || *p == 'T' || *p == 't' || (*p >= '1' && *p <= '9'));
+}
+
+NSString *SPXMLElementString(const SPXMLElement *element, const char *name)
+{
+    SPXMLSlice value = SPXMLElementAttribute(element, name);
+    return value.bytes ? decodeSlice(value) : nil;
+}
+
+// --- class implementation ------------------------------------------------------------------------
+
+@implementation SPXMLReader
+{
+    NSData *_data;
+    NSString *_errorMessage;
+    SPXMLAttribute *_attributes;
+    NSInteger _attributeCapacity;
+}
+
+static BOOL fail(SPXMLReader *self, const char *position, NSString *reason)
+{
+    NSInteger line = 1;
+    for (const char *p = self->_data.bytes; p < position; ++p)
+        if (*p == '\n') ++line;
+
+    SP_RELEASE_AND_RETAIN(self->_errorMessage,
+                          ([NSString stringWithFormat:@"line %ld: %@", (long)line, reason]));
+    return NO;
+}
+
+static void addAttribute(SPXMLReader *self, NSInteger index, SPXMLSlice name, SPXMLSlice value)
+{
+    if (index == self->_attributeCapacity)
+    {
+        self->_attributeCapacity = MAX(16, self->_attributeCapacity * 2);
+        self->_attributes = realloc(self->_attributes, sizeof(SPXMLAttribute) * self->_attributeCapacity);
+    }
+
+    self->_attributes[index] = (SPXMLAttribute){ name, value };
+}
+
+#pragma mark Initialization
+
+- (instancetype)initWithData:(NSData *)data
+{
+    if ((self = [super init]))
+    {
+        _data = [data retain];
+    }
+    return self;
+}
+
+- (instancetype)init
+{
+    SP_USE_DESIGNATED_INITIALIZER(initWithData:);
+    return nil;
+}
+
+- (void)dealloc
+{
+    [_data release];
+    [_errorMessage release];
+    free(_attributes);
+    [super dealloc];
+}
+
+#pragma mark Methods
+
+- (BOOL)parseElementsWithBlock:(SPXMLReaderElementHandler)elementHandler
+{
+    SP_RELEASE_AND_NIL(_errorMessage);
+
+    const char *p = _data.bytes;
+    const char *end = p + _data.length;
+    BOOL stop = NO;
+
+    while (!stop && (p = memchr(p, '<', end - p)))
+    {
+        if (++p == end)
+            return fail(self, p, @"unexpected end of data");
+
+        if (*p == '?')
+        {
+            if (!(p = findPast(p, end, "?>")))
+                return fail(self, end, @"unterminated processing instruction");
+        }
+        else if (startsWith(p, end, "!--"))
+        {
+            if (!(p = findPast(p, end, "-->")))
+                return fail(self, end, @"unterminated comment");
+        }
+        else if (startsWith(p, end, "![CDATA["))
+        {
+            if (!(p = findPast(p, end, "]]>")))
+                return fail(self, end, @"unterminated CDATA section");
+        }
+        else if (*p == '!')
+        {
+            // DOCTYPE, possibly with an internal subset in square brackets
+            int depth = 0;
+            for (; p < end && (*p != '>' || depth > 0); ++p)
+            {
+                if (*p == '[') ++depth;
+                else if (*p == ']') --depth;
+            }
+
+            if (p++ == end)
+                return fail(self, end, @"unterminated declaration");
+        }
+        else if (*p == '/')
+        {
+            if (!(p = findPast(p, end, ">")))
+                return fail(self, end, @"unterminated end tag");
+        }
+        else
+        {
+            const char *nameStart = p;
+            while (p < end && isNameChar(*p)) ++p;
+
+            if (p == nameStart)
+                return fail(self, p, @"invalid element name");
+
+            SPXMLSlice name = { nameStart, p - nameStart };
+            NSInteger numAttributes = 0;
+
+            while (YES)
+            {
+                p = skipSpaces(p, end);
+
+                if (p == end)
+                    return fail(self, p, @"unterminated start tag");
+                else if (*p == '>')
+                {
+                    ++p;
+                    break;
+                }
+                else if (*p == '/')
+                {
+                    if (p + 1 == end || p[1] != '>')
+                        return fail(self, p, @"expected '>' after '/'");
+
+                    p += 2;
+                    break;
+                }
+
+                const char *attributeStart = p;
+                while (p < end && isNameChar(*p)) ++p;
+
+                if (p == attributeStart)
+                    return fail(self, p, @"invalid attribute name");
+
+                SPXMLSlice attributeName = { attributeStart, p - attributeStart };
+                p = skipSpaces(p, end);
+
+                if (p == end || *p != '=')
+                    return fail(self, p, @"expected '=' after attribute name");
+
+                p = skipSpaces(p + 1, end);
+
+                if (p == end || (*p != '"' && *p != '\''))
+                    return fail(self, p, @"expected quoted attribute value");
+
+                const char *valueStart = ++p;
+                if (!(p = memchr(p, valueStart[-1], end - p)))
+                    return fail(self, end, @"unterminated attribute value");
+
+                SPXMLSlice value = { valueStart, p - valueStart };
+                addAttribute(self, numAttributes++, attributeName, value);
+                ++p;
+            }
+
+            SPXMLElement element = { name, _attributes, numAttributes };
+            elementHandler(&element, &stop);
+        }
+    }
+
+    return YES;
+}
+
+@end
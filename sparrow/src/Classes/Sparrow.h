@@ -22,6 +22,7 @@
 #import <Sparrow/SparrowClass.h>
 #import <Sparrow/SPALSound.h>
 #import <Sparrow/SPALSoundChannel.h>
+#import <Sparrow/SPAssetLoader.h>
 #import <Sparrow/SPAudioEngine.h>
 #import <Sparrow/SPAVSound.h>
 #import <Sparrow/SPAVSoundChannel.h>
@@ -40,6 +41,7 @@
 #import <Sparrow/SPDisplacementMapFilter.h>
 #import <Sparrow/SPDisplayObject.h>
 #import <Sparrow/SPDisplayObjectContainer.h>
+#import <Sparrow/SPDynamicAtlas.h>
 #import <Sparrow/SPEnterFrameEvent.h>
 #import <Sparrow/SPEvent.h>
 #import <Sparrow/SPEventDispatcher.h>
@@ -51,6 +53,7 @@
 #import <Sparrow/SPMatrix.h>
 #import <Sparrow/SPMatrix3D.h>
 #import <Sparrow/SPMovieClip.h>
+#import <Sparrow/SPMovieTimeline.h>
 #import <Sparrow/SPNSExtensions.h>
 #import <Sparrow/SPOpenGL.h>
 #import <Sparrow/SPOverlayView.h>
@@ -76,12 +79,16 @@
 #import <Sparrow/SPTextField.h>
 #import <Sparrow/SPTexture.h>
 #import <Sparrow/SPTextureAtlas.h>
+#import <Sparrow/SPTextureConversion.h>
+#import <Sparrow/SPTextureOptions.h>
 #import <Sparrow/SPTouchEvent.h>
 #import <Sparrow/SPTouchProcessor.h>
 #import <Sparrow/SPTransitions.h>
 #import <Sparrow/SPTween.h>
+#import <Sparrow/SPTweenSystem.h>
 #import <Sparrow/SPURLConnection.h>
 #import <Sparrow/SPUtils.h>
 #import <Sparrow/SPVertexData.h>
 #import <Sparrow/SPView.h>
 #import <Sparrow/SPViewController.h>
+#import <Sparrow/SPXMLReader.h>
@@ -0,0 +1,182 @@
+//
+//  SPAssetLoaderTest.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 16.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPTestCase.h"
+
+#define LOADER_TIMEOUT 5.0
+
+@interface SPAssetLoaderTest : SPTestCase
+
+@end
+
+@implementation SPAssetLoaderTest
+{
+    NSString *_folder;
+}
+
+- (void)setUp
+{
+    [super setUp];
+
+    _folder = [NSTemporaryDirectory() stringByAppendingPathComponent:[NSUUID UUID].UUIDString];
+    [[NSFileManager defaultManager] createDirectoryAtPath:_folder withIntermediateDirectories:YES
+                                               attributes:nil error:nil];
+}
+
+- (void)tearDown
+{
+    [[NSFileManager defaultManager] removeItemAtPath:_folder error:nil];
+    [super tearDown];
+}
+
+- (void)testLoadTextureAtlas
+{
+    NSString *xml = @"<TextureAtlas imagePath='atlas.png'>"
+                     "  <SubTexture name='a' x='0' y='0' width='16' height='16'/>"
+                     "  <SubTexture name='b' x='16' y='0' width='16' height='16'/>"
+                     "</TextureAtlas>";
+
+    [self createImageWithName:@"atlas.png" width:32 height:16];
+    NSString *path = [_folder stringByAppendingPathComponent:@"atlas.xml"];
+    [xml writeToFile:path atomically:YES encoding:NSUTF8StringEncoding error:nil];
+
+    __block SPTextureAtlas *atlas = nil;
+    __block int numProgressCalls = 0;
+
+    SPAssetLoader *loader = [SPAssetLoader assetLoader];
+    loader.onProgress = ^{ ++numProgressCalls; };
+
+    SPAssetRequest *request = [loader loadTextureAtlasFromFile:path priority:0
+                                                    onComplete:^(id asset, NSError *error)
+    {
+        XCTAssertTrue([NSThread isMainThread], @"callback not on main thread");
+        XCTAssertNil(error);
+        atlas = asset;
+    }];
+
+    XCTAssertEqual(1, loader.numPendingRequests);
+    XCTAssertEqual(0.0f, loader.progress);
+
+    [self waitForLoader:loader];
+
+    XCTAssertTrue(request.isComplete);
+    XCTAssertEqual(2, atlas.numTextures);
+    XCTAssertEqual(32.0f, atlas.texture.width);
+    XCTAssertEqual(1, numProgressCalls);
+    XCTAssertEqual(1.0f, loader.progress);
+    XCTAssertEqual(32 * 16 * 4, loader.numBytesUploaded);
+    XCTAssertGreaterThan(loader.numBytesDecoded, 0);
+
+    // the texture is now cached
+    SPTexture *texture = [SPTexture textureWithContentsOfFile:
+                          [_folder stringByAppendingPathComponent:@"atlas.png"]];
+    XCTAssertEqual(atlas.texture, texture, @"texture was not cached");
+}
+
+- (void)testPriorities
+{
+    NSMutableArray *paths = [NSMutableArray array];
+    NSMutableArray *completed = [NSMutableArray array];
+
+    for (int i=0; i<8; ++i)
+        [paths addObject:[self createImageWithName:[NSString stringWithFormat:@"image%d.png", i]
+                                             width:256 height:256]];
+
+    SPAssetLoader *loader = [[SPAssetLoader alloc] initWithNumWorkers:1];
+
+    for (int i=0; i<8; ++i)
+    {
+        [loader loadTextureFromFile:paths[i] generateMipmaps:NO priority:(i == 7 ? 10 : 0)
+                         onComplete:^(id asset, NSError *error)
+         {
+             XCTAssertNotNil(asset);
+             [completed addObject:@(i)];
+         }];
+    }
+
+    [self waitForLoader:loader];
+
+    XCTAssertEqual(8, completed.count);
+    XCTAssertLessThan([completed indexOfObject:@7], 7, @"priority was ignored");
+}
+
+- (void)testCancel
+{
+    NSString *path = [self createImageWithName:@"cancelled.png" width:64 height:64];
+    __block BOOL called = NO;
+
+    SPAssetLoader *loader = [SPAssetLoader assetLoader];
+    SPAssetRequest *request = [loader loadTextureFromFile:path onComplete:^(id asset, NSError *error)
+    {
+        called = YES;
+    }];
+
+    [request cancel];
+
+    XCTAssertTrue(request.isCancelled);
+    XCTAssertEqual(0, loader.numPendingRequests);
+
+    // give the worker time to finish the request anyway
+    for (int i=0; i<20; ++i)
+    {
+        [NSThread sleepForTimeInterval:0.01];
+        [loader advanceTime:0.01];
+    }
+
+    XCTAssertFalse(called, @"callback of cancelled request was executed");
+    XCTAssertFalse(request.isComplete);
+}
+
+- (void)testMissingFile
+{
+    __block NSError *loadingError = nil;
+
+    SPAssetLoader *loader = [SPAssetLoader assetLoader];
+    [loader loadTextureFromFile:@"missing.png" onComplete:^(id asset, NSError *error)
+    {
+        XCTAssertNil(asset);
+        loadingError = error;
+    }];
+
+    [self waitForLoader:loader];
+
+    XCTAssertEqualObjects(SPExceptionFileNotFound, loadingError.domain);
+}
+
+#pragma mark Helpers
+
+- (NSString *)createImageWithName:(NSString *)name width:(int)width height:(int)height
+{
+    UIGraphicsBeginImageContextWithOptions(CGSizeMake(width, height), NO, 1.0f);
+    [[UIColor redColor] setFill];
+    UIRectFill(CGRectMake(0, 0, width, height));
+    UIImage *image = UIGraphicsGetImageFromCurrentImageContext();
+    UIGraphicsEndImageContext();
+
+    NSString *path = [_folder stringByAppendingPathComponent:name];
+    [UIImagePNGRepresentation(image) writeToFile:path atomically:YES];
+    return path;
+}
+
+- (void)waitForLoader:(SPAssetLoader *)loader
+{
+    NSDate *timeout = [NSDate dateWithTimeIntervalSinceNow:LOADER_TIMEOUT];
+
+    while (loader.numPendingRequests && [timeout timeIntervalSinceNow] > 0)
+    {
+        [NSThread sleepForTimeInterval:0.005];
+        [loader advanceTime:0.005];
+    }
+
+    XCTAssertEqual(0, loader.numPendingRequests, @"loader timed out");
+}
+
+@end
@@ -0,0 +1,302 @@
+//
+//  SPBitmapFontTest.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 10.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPTestCase.h"
+
+#define BENCHMARK_TEXT_LENGTH 10240
+
+@interface SPBitmapFontTest : SPTestCase
+
+@end
+
+@implementation SPBitmapFontTest
+
+- (void)testCharLookup
+{
+    SPBitmapFont *font = [[SPBitmapFont alloc] initWithMiniFont];
+    SPTexture *texture = [[SPTexture alloc] initWithWidth:8 height:8];
+
+    XCTAssertNotNil([font charByID:'A'], @"char not found");
+    XCTAssertEqual('A', [font charByID:'A'].charID, @"wrong char");
+    XCTAssertNil([font charByID:0x4e2d], @"char should be missing");
+    XCTAssertNil([font charByID:-1], @"char should be missing");
+
+    SPBitmapChar *bmpChar = [[SPBitmapChar alloc] initWithID:0x4e2d texture:texture
+                                                     xOffset:0 yOffset:0 xAdvance:8];
+    SPBitmapChar *extraChar = [[SPBitmapChar alloc] initWithID:0x1f600 texture:texture
+                                                       xOffset:0 yOffset:0 xAdvance:8];
+    NSInteger numChars = font.allCharIDs.count;
+
+    [font addBitmapChar:bmpChar charID:0x4e2d];
+    [font addBitmapChar:extraChar charID:0x1f600];
+
+    XCTAssertEqual(bmpChar, [font charByID:0x4e2d], @"wrong char");
+    XCTAssertEqual(extraChar, [font charByID:0x1f600], @"wrong char");
+    XCTAssertEqual(numChars + 2, font.allCharIDs.count, @"wrong number of chars");
+    XCTAssertTrue([font.allCharIDs containsObject:@(0x1f600)], @"char ID missing");
+    XCTAssertTrue([font hasCharsInString:@"AB中"]);
+}
+
+- (void)testKerning
+{
+    SPBitmapFont *font = [[SPBitmapFont alloc] initWithMiniFont];
+    SPTexture *texture = [[SPTexture alloc] initWithWidth:8 height:8];
+
+    XCTAssertEqual(0.0f, [font kerningFromChar:'A' toChar:'V'], @"unexpected kerning");
+
+    [font addKerning:-2.0f fromChar:'A' toChar:'V'];
+    XCTAssertEqualWithAccuracy(-2.0f, [font kerningFromChar:'A' toChar:'V'], E, @"wrong kerning");
+    XCTAssertEqualWithAccuracy(-2.0f, [[font charByID:'V'] kerningToChar:'A'], E, @"char not updated");
+    XCTAssertEqual(0.0f, [font kerningFromChar:'V' toChar:'A'], @"kerning is not symmetric");
+
+    [font addKerning:-1.0f fromChar:'A' toChar:'V'];
+    XCTAssertEqualWithAccuracy(-1.0f, [font kerningFromChar:'A' toChar:'V'], E, @"kerning not replaced");
+
+    // kernings of a char are copied into the font when it is added
+    SPBitmapChar *bitmapChar = [[SPBitmapChar alloc] initWithID:0x4e2d texture:texture
+                                                        xOffset:0 yOffset:0 xAdvance:8];
+    [bitmapChar addKerning:3.0f toChar:'B'];
+    [bitmapChar addKerning:1.5f toChar:'A'];
+    XCTAssertEqualWithAccuracy(1.5f, [bitmapChar kerningToChar:'A'], E, @"wrong char kerning");
+    XCTAssertEqualWithAccuracy(3.0f, [bitmapChar kerningToChar:'B'], E, @"wrong char kerning");
+    XCTAssertEqual(0.0f, [bitmapChar kerningToChar:'C'], @"unexpected char kerning");
+
+    [font addBitmapChar:bitmapChar charID:0x4e2d];
+    XCTAssertEqualWithAccuracy(3.0f, [font kerningFromChar:'B' toChar:0x4e2d], E, @"kerning not copied");
+
+    // make sure the table survives growing
+    for (int i=0; i<1000; ++i)
+        [font addKerning:i fromChar:i toChar:i+1];
+
+    for (int i=0; i<1000; ++i)
+        XCTAssertEqual((float)i, [font kerningFromChar:i toChar:i+1], @"kerning lost");
+
+    XCTAssertEqualWithAccuracy(3.0f, [font kerningFromChar:'B' toChar:0x4e2d], E, @"kerning lost");
+}
+
+- (void)testXmlFontKerning
+{
+    NSData *xml = [[self sampleFontXml] dataUsingEncoding:NSUTF8StringEncoding];
+    SPTexture *texture = [[SPTexture alloc] initWithWidth:32 height:32];
+    SPBitmapFont *font = [[SPBitmapFont alloc] initWithContentsOfData:xml texture:texture];
+
+    XCTAssertEqualWithAccuracy(-2.0f, [font kerningFromChar:'A' toChar:'V'], E, @"wrong kerning");
+    XCTAssertEqualWithAccuracy(-2.0f, [[font charByID:'V'] kerningToChar:'A'], E,
+                               @"char not updated");
+    XCTAssertEqual(0.0f, [[font charByID:'A'] kerningToChar:'V'], @"kerning is not symmetric");
+}
+
+- (void)testKerningAffectsLayout
+{
+    SPBitmapFont *font = [[SPBitmapFont alloc] initWithMiniFont];
+    SPQuadBatch *quadBatch = [SPQuadBatch quadBatch];
+
+    [font fillQuadBatch:quadBatch withWidth:100 height:20 text:@"AV" fontSize:-1 color:0
+                 hAlign:SPHAlignLeft vAlign:SPVAlignTop autoScale:NO kerning:YES leading:0];
+    float defaultX = [quadBatch boundsOfQuadAtIndex:1].x;
+
+    [font addKerning:-2.0f fromChar:'A' toChar:'V'];
+    [quadBatch reset];
+    [font fillQuadBatch:quadBatch withWidth:100 height:20 text:@"AV" fontSize:-1 color:0
+                 hAlign:SPHAlignLeft vAlign:SPVAlignTop autoScale:NO kerning:YES leading:0];
+
+    XCTAssertEqualWithAccuracy(defaultX - 2.0f, [quadBatch boundsOfQuadAtIndex:1].x, E,
+                               @"kerning not applied");
+}
+
+- (void)testAutoScale
+{
+    SPBitmapFont *font = [[SPBitmapFont alloc] initWithMiniFont];
+    SPQuadBatch *quadBatch = [SPQuadBatch quadBatch];
+
+    [font fillQuadBatch:quadBatch withWidth:40 height:16 text:@"ABCD EFGH" fontSize:64 color:0
+                 hAlign:SPHAlignLeft vAlign:SPVAlignTop autoScale:YES kerning:NO leading:0];
+
+    SPRectangle *bounds = [quadBatch boundsInSpace:quadBatch];
+    XCTAssertEqual(8, quadBatch.numQuads, @"not all chars were arranged");
+    XCTAssertLessThanOrEqual(bounds.right, 40.0f + E, @"text exceeds width");
+
+    // one point more must not fit anymore
+    float fittingScale = [quadBatch boundsOfQuadAtIndex:0].height / [font charByID:'A'].height;
+    float fittingSize = roundf(fittingScale * font.size);
+
+    [quadBatch reset];
+    [font fillQuadBatch:quadBatch withWidth:40 height:16 text:@"ABCD EFGH" fontSize:fittingSize + 1
+                  color:0 hAlign:SPHAlignLeft vAlign:SPVAlignTop autoScale:NO kerning:NO leading:0];
+
+    XCTAssertLessThan(quadBatch.numQuads, 8, @"autoScale did not pick the biggest size");
+}
+
+- (void)testLayoutCacheInvalidation
+{
+    SPBitmapFont *font = [[SPBitmapFont alloc] initWithMiniFont];
+    SPQuadBatch *quadBatch = [SPQuadBatch quadBatch];
+
+    [font fillQuadBatch:quadBatch withWidth:100 height:20 text:@"AB" fontSize:-1 color:0
+                 hAlign:SPHAlignLeft vAlign:SPVAlignTop autoScale:NO kerning:YES leading:0];
+    float defaultX = [quadBatch boundsOfQuadAtIndex:1].x;
+
+    font.offsetX = 10;
+    [quadBatch reset];
+    [font fillQuadBatch:quadBatch withWidth:100 height:20 text:@"AB" fontSize:-1 color:0
+                 hAlign:SPHAlignLeft vAlign:SPVAlignTop autoScale:NO kerning:YES leading:0];
+
+    XCTAssertEqualWithAccuracy(defaultX + 10, [quadBatch boundsOfQuadAtIndex:1].x, E,
+                               @"cached layout was not invalidated");
+}
+
+- (void)testBinaryFont
+{
+    NSString *folder = [NSTemporaryDirectory() stringByAppendingPathComponent:
+                        [[NSProcessInfo processInfo] globallyUniqueString]];
+    NSString *xmlPath = [folder stringByAppendingPathComponent:@"font.fnt"];
+    NSString *xml = [self sampleFontXml];
+
+    [[NSFileManager defaultManager] createDirectoryAtPath:folder withIntermediateDirectories:YES
+                                               attributes:nil error:nil];
+    [xml writeToFile:xmlPath atomically:YES encoding:NSUTF8StringEncoding error:nil];
+    [SPBitmapFont convertXmlFile:xmlPath toBinaryFile:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:xmlPath error:nil];
+
+    SPTexture *texture = [[SPTexture alloc] initWithWidth:32 height:32];
+    SPBitmapFont *font = [[SPBitmapFont alloc] initWithContentsOfFile:xmlPath texture:texture];
+
+    XCTAssertEqualObjects(@"Test", font.name, @"wrong name");
+    XCTAssertEqual(16.0f, font.size, @"wrong size");
+    XCTAssertEqual(20.0f, font.lineHeight, @"wrong line height");
+    XCTAssertEqual(14.0f, font.baseline, @"wrong baseline");
+    XCTAssertEqual(SPTextureSmoothingNone, font.smoothing, @"wrong smoothing");
+    XCTAssertEqual(2, font.allCharIDs.count, @"wrong number of chars");
+
+    SPBitmapChar *charA = [font charByID:'A'];
+    XCTAssertEqual(1.0f, charA.xOffset, @"wrong x offset");
+    XCTAssertEqual(2.0f, charA.yOffset, @"wrong y offset");
+    XCTAssertEqual(9.0f, charA.xAdvance, @"wrong x advance");
+    XCTAssertEqual(8.0f, charA.width, @"wrong width");
+    XCTAssertEqualWithAccuracy(-2.0f, [font kerningFromChar:'A' toChar:'V'], E, @"wrong kerning");
+}
+
+- (void)testBinaryFontKerningsMatchXml
+{
+    NSString *folder = [NSTemporaryDirectory() stringByAppendingPathComponent:
+                        [[NSProcessInfo processInfo] globallyUniqueString]];
+    NSString *xmlPath = [folder stringByAppendingPathComponent:@"font.fnt"];
+
+    [[NSFileManager defaultManager] createDirectoryAtPath:folder withIntermediateDirectories:YES
+                                               attributes:nil error:nil];
+    [[self sampleFontXml] writeToFile:xmlPath atomically:YES
+                             encoding:NSUTF8StringEncoding error:nil];
+
+    SPTexture *texture = [[SPTexture alloc] initWithWidth:32 height:32];
+    SPBitmapFont *xmlFont = [[SPBitmapFont alloc] initWithContentsOfFile:xmlPath texture:texture];
+
+    [SPBitmapFont convertXmlFile:xmlPath toBinaryFile:nil];
+    [[NSFileManager defaultManager] removeItemAtPath:xmlPath error:nil];
+
+    SPBitmapFont *binaryFont = [[SPBitmapFont alloc] initWithContentsOfFile:xmlPath texture:texture];
+
+    for (NSNumber *first in xmlFont.allCharIDs)
+    {
+        for (NSNumber *second in xmlFont.allCharIDs)
+        {
+            int firstID = first.intValue;
+            int secondID = second.intValue;
+
+            XCTAssertEqual([[xmlFont charByID:secondID] kerningToChar:firstID],
+                           [[binaryFont charByID:secondID] kerningToChar:firstID],
+                           @"wrong char kerning from %d to %d", firstID, secondID);
+            XCTAssertEqual([xmlFont kerningFromChar:firstID toChar:secondID],
+                           [binaryFont kerningFromChar:firstID toChar:secondID],
+                           @"wrong kerning from %d to %d", firstID, secondID);
+        }
+    }
+
+    XCTAssertEqualWithAccuracy(-2.0f, [[binaryFont charByID:'V'] kerningToChar:'A'], E,
+                               @"char not updated");
+}
+
+#pragma mark Benchmarks
+
+- (void)testPerformanceOfLayout
+{
+    SPBitmapFont *font = [self benchmarkFont];
+    SPQuadBatch *quadBatch = [[SPQuadBatch alloc] init];
+    NSMutableString *text = [self benchmarkText];
+    __block int iteration = 0;
+
+    [self measureBlock:^
+    {
+        // a different text in each iteration, so that the layout cache is never hit
+        [text replaceCharactersInRange:NSMakeRange(0, 6)
+                            withString:[NSString stringWithFormat:@"%06d", ++iteration]];
+        [quadBatch reset];
+        [font fillQuadBatch:quadBatch withWidth:512 height:4096 text:text fontSize:-1 color:0
+                     hAlign:SPHAlignLeft vAlign:SPVAlignTop autoScale:NO kerning:YES leading:0];
+    }];
+
+    XCTAssertGreaterThan(quadBatch.numQuads, 0);
+}
+
+- (void)testPerformanceOfCachedLayout
+{
+    SPBitmapFont *font = [self benchmarkFont];
+    SPQuadBatch *quadBatch = [[SPQuadBatch alloc] init];
+    NSMutableString *text = [self benchmarkText];
+
+    [self measureBlock:^
+    {
+        [quadBatch reset];
+        [font fillQuadBatch:quadBatch withWidth:512 height:4096 text:text fontSize:-1 color:0
+                     hAlign:SPHAlignLeft vAlign:SPVAlignTop autoScale:NO kerning:YES leading:0];
+    }];
+
+    XCTAssertGreaterThan(quadBatch.numQuads, 0);
+}
+
+#pragma mark Helpers
+
+- (SPBitmapFont *)benchmarkFont
+{
+    SPBitmapFont *font = [[SPBitmapFont alloc] initWithMiniFont];
+
+    for (int first='A'; first<='z'; ++first)
+        for (int second='A'; second<='z'; ++second)
+            [font addKerning:(first + second) % 3 - 1 fromChar:first toChar:second];
+
+    return font;
+}
+
+- (NSMutableString *)benchmarkText
+{
+    NSString *line = @"To be, or not to be, that is the Question:\n";
+    NSMutableString *text = [NSMutableString stringWithString:@"000000\n"];
+
+    while (text.length < BENCHMARK_TEXT_LENGTH)
+        [text appendString:line];
+
+    return text;
+}
+
+- (NSString *)sampleFontXml
+{
+    return @"<font>"
+            "  <info face='Test' size='16' smooth='0'/>"
+            "  <common lineHeight='20' base='14'/>"
+            "  <pages><page id='0' file='font.png'/></pages>"
+            "  <chars>"
+            "    <char id='65' x='0' y='0' width='8' height='12' xoffset='1' yoffset='2' xadvance='9'/>"
+            "    <char id='86' x='8' y='0' width='8' height='12' xoffset='0' yoffset='2' xadvance='9'/>"
+            "  </chars>"
+            "  <kernings><kerning first='65' second='86' amount='-2'/></kernings>"
+            "</font>";
+}
+
+@end
@@ -433,6 +433,47 @@
     XCTAssertEqual(parent, _broadcastTarget, @"wrong event.target on broadcast");
 }
 
+- (void)testBroadcastAfterReparenting
+{
+    SPSprite *root = [SPSprite sprite];
+    SPSprite *branchA = [SPSprite sprite];
+    SPSprite *branchB = [SPSprite sprite];
+    SPSprite *leaf = [SPSprite sprite];
+    SPQuad *quad = [SPQuad quadWithWidth:10 height:10];
+    
+    [root addChild:branchA];
+    [root addChild:branchB];
+    [branchA addChild:leaf];
+    [leaf addChild:quad];
+    
+    [quad addEventListener:@selector(onChildEvent:) atObject:self forType:@"test"];
+    [root broadcastEventWithType:@"test"];
+    XCTAssertEqual(1, _eventCount, @"listener in subtree not reached");
+    
+    [branchB addChild:leaf];
+    [branchA broadcastEventWithType:@"test"];
+    XCTAssertEqual(1, _eventCount, @"listener reached in old subtree");
+    
+    [branchB broadcastEventWithType:@"test"];
+    [root broadcastEventWithType:@"test"];
+    XCTAssertEqual(3, _eventCount, @"listener not reached after reparenting");
+    
+    [leaf addEventListener:@selector(onChildEvent:) atObject:self forType:@"test"];
+    [root broadcastEventWithType:@"test"];
+    XCTAssertEqual(5, _eventCount, @"container listener not reached");
+    
+    [quad removeEventListenersAtObject:self forType:@"test"];
+    [leaf removeEventListenersAtObject:self forType:@"test"];
+    [root broadcastEventWithType:@"test"];
+    XCTAssertEqual(5, _eventCount, @"removed listener was called");
+    
+    [leaf removeFromParent];
+    [quad addEventListener:@selector(onChildEvent:) atObject:self forType:@"test"];
+    [root addChild:leaf];
+    [root broadcastEventWithType:@"test"];
+    XCTAssertEqual(6, _eventCount, @"listener added while detached not reached");
+}
+
 - (void)onBroadcastEvent:(SPEvent *)event
 {
     _broadcastTarget = event.target;
@@ -0,0 +1,171 @@
+//
+//  SPDynamicAtlasTest.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 18.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPTestCase.h"
+
+#define PAGE_SIZE 64
+
+@interface SPDynamicAtlasTest : SPTestCase
+
+@end
+
+@implementation SPDynamicAtlasTest
+{
+    uint32_t _pixels[PAGE_SIZE * PAGE_SIZE];
+}
+
+- (void)testPacking
+{
+    SPDynamicAtlas *atlas = [[SPDynamicAtlas alloc] initWithPageSize:PAGE_SIZE];
+    NSMutableArray *regions = [NSMutableArray array];
+
+    // 16 images of 14x14 pixels plus border fill the page exactly
+    for (int i=0; i<16; ++i)
+    {
+        SPSubTexture *texture = (SPSubTexture *)[self addPixelsWithSize:14 toAtlas:atlas
+                                                                 forKey:[@(i) stringValue]];
+        XCTAssertNotNil(texture, @"image not packed");
+        XCTAssertEqualWithAccuracy(14.0f, texture.width, E, @"wrong width");
+        [regions addObject:texture.region];
+    }
+
+    XCTAssertEqual(1, atlas.numPages, @"wrong number of pages");
+    XCTAssertEqual(16, atlas.numTextures, @"wrong number of textures");
+    XCTAssertEqualWithAccuracy(1.0f, atlas.fillRatio, E, @"wrong fill ratio");
+
+    for (NSInteger i=0; i<regions.count; ++i)
+        for (NSInteger j=i+1; j<regions.count; ++j)
+            XCTAssertFalse([regions[i] intersectsRectangle:regions[j]], @"regions overlap");
+
+    [self addPixelsWithSize:14 toAtlas:atlas forKey:@"overflow"];
+    XCTAssertEqual(2, atlas.numPages, @"wrong number of pages");
+}
+
+- (void)testRemoval
+{
+    SPDynamicAtlas *atlas = [[SPDynamicAtlas alloc] initWithPageSize:PAGE_SIZE];
+
+    [self addPixelsWithSize:30 toAtlas:atlas forKey:@"a"];
+    [self addPixelsWithSize:30 toAtlas:atlas forKey:@"b"];
+    [self addPixelsWithSize:30 toAtlas:atlas forKey:@"c"];
+    [self addPixelsWithSize:30 toAtlas:atlas forKey:@"d"];
+
+    XCTAssertEqual(1, atlas.numPages, @"wrong number of pages");
+
+    [atlas removeTextureForKey:@"a"];
+    [atlas removeTextureForKey:@"b"];
+
+    XCTAssertNil([atlas textureForKey:@"a"], @"texture not removed");
+    XCTAssertEqual(2, atlas.numTextures, @"wrong number of textures");
+
+    // the two free areas are merged and can hold a bigger image
+    XCTAssertNotNil([self addPixelsWithSize:62 height:30 toAtlas:atlas forKey:@"e"]);
+    XCTAssertEqual(1, atlas.numPages, @"area was not reused");
+
+    [atlas removeAllTextures];
+    XCTAssertEqual(0, atlas.numPages, @"wrong number of pages");
+    XCTAssertEqual(0, atlas.numTextures, @"wrong number of textures");
+}
+
+- (void)testReplaceKey
+{
+    SPDynamicAtlas *atlas = [[SPDynamicAtlas alloc] initWithPageSize:PAGE_SIZE];
+
+    SPTexture *texture1 = [self addPixelsWithSize:40 toAtlas:atlas forKey:@"a"];
+    SPTexture *texture2 = [self addPixelsWithSize:40 toAtlas:atlas forKey:@"a"];
+
+    XCTAssertNotEqual(texture1, texture2, @"texture not replaced");
+    XCTAssertEqual(texture2, [atlas textureForKey:@"a"], @"wrong texture");
+    XCTAssertEqual(1, atlas.numTextures, @"wrong number of textures");
+    XCTAssertEqual(1, atlas.numPages, @"old area was not freed");
+}
+
+- (void)testPagesPerFormat
+{
+    SPDynamicAtlas *atlas = [[SPDynamicAtlas alloc] initWithPageSize:PAGE_SIZE];
+
+    SPTexture *texture1 = [atlas addPixels:_pixels width:8 height:8 scale:1.0f
+                                    format:SPTextureFormatRGBA premultipliedAlpha:YES forKey:@"a"];
+    SPTexture *texture2 = [atlas addPixels:_pixels width:8 height:8 scale:1.0f
+                                    format:SPTextureFormatRGBA premultipliedAlpha:NO forKey:@"b"];
+    SPTexture *texture3 = [atlas addPixels:_pixels width:8 height:8 scale:1.0f
+                                    format:SPTextureFormat565 premultipliedAlpha:YES forKey:@"c"];
+    SPTexture *texture4 = [atlas addPixels:_pixels width:8 height:8 scale:2.0f
+                                    format:SPTextureFormat565 premultipliedAlpha:YES forKey:@"d"];
+
+    XCTAssertEqual(4, atlas.numPages, @"wrong number of pages");
+    XCTAssertFalse(texture2.premultipliedAlpha, @"wrong pma");
+    XCTAssertEqual(SPTextureFormat565, texture3.format, @"wrong format");
+    XCTAssertEqualWithAccuracy(4.0f, texture4.width, E, @"wrong width");
+    XCTAssertEqualWithAccuracy(8.0f, texture1.width, E, @"wrong width");
+}
+
+- (void)testUnpackableImages
+{
+    SPDynamicAtlas *atlas = [[SPDynamicAtlas alloc] initWithPageSize:PAGE_SIZE];
+
+    XCTAssertNil([self addPixelsWithSize:PAGE_SIZE toAtlas:atlas forKey:@"big"]);
+    XCTAssertNil([atlas addPixels:_pixels width:8 height:8 scale:1.0f format:SPTextureFormatPvrtcRGBA4
+               premultipliedAlpha:NO forKey:@"compressed"]);
+    XCTAssertEqual(0, atlas.numPages, @"wrong number of pages");
+}
+
+- (void)testDefragment
+{
+    SPDynamicAtlas *atlas = [[SPDynamicAtlas alloc] initWithPageSize:PAGE_SIZE];
+
+    for (int i=0; i<8; ++i)
+        [self addPixelsWithSize:30 toAtlas:atlas forKey:[@(i) stringValue]];
+
+    XCTAssertEqual(2, atlas.numPages, @"wrong number of pages");
+
+    // leave two textures on each page
+    [atlas removeTextureForKey:@"0"];
+    [atlas removeTextureForKey:@"1"];
+    [atlas removeTextureForKey:@"6"];
+    [atlas removeTextureForKey:@"7"];
+
+    XCTAssertEqual(2, atlas.numPages, @"wrong number of pages");
+
+    SPTexture *oldTexture = [atlas textureForKey:@"2"];
+    [atlas defragment];
+
+    XCTAssertEqual(1, atlas.numPages, @"atlas not defragmented");
+    XCTAssertEqual(4, atlas.numTextures, @"wrong number of textures");
+    XCTAssertNotEqual(oldTexture, [atlas textureForKey:@"2"], @"texture not recreated");
+    XCTAssertEqualWithAccuracy(30.0f, [atlas textureForKey:@"5"].width, E, @"wrong width");
+}
+
+- (void)testTextureOptions
+{
+    SPDynamicAtlas *atlas = [[SPDynamicAtlas alloc] initWithPageSize:PAGE_SIZE];
+    SPTextureOptions *options = [SPTextureOptions textureOptions];
+    options.atlas = atlas;
+
+    SPTextureOptions *copy = [options copy];
+    XCTAssertEqual(atlas, copy.atlas, @"atlas not copied");
+}
+
+#pragma mark Helpers
+
+- (SPTexture *)addPixelsWithSize:(NSInteger)size toAtlas:(SPDynamicAtlas *)atlas forKey:(NSString *)key
+{
+    return [self addPixelsWithSize:size height:size toAtlas:atlas forKey:key];
+}
+
+- (SPTexture *)addPixelsWithSize:(NSInteger)width height:(NSInteger)height
+                         toAtlas:(SPDynamicAtlas *)atlas forKey:(NSString *)key
+{
+    return [atlas addPixels:_pixels width:width height:height scale:1.0f
+                     format:SPTextureFormatRGBA premultipliedAlpha:YES forKey:key];
+}
+
+@end
@@ -20,11 +20,13 @@
 @implementation SPEventDispatcherTest
 {
     int _testCounter;
+    SPEvent *_keptEvent;
 }
 
 - (void)setUp
 {
     _testCounter = 0;
+    _keptEvent = nil;
 }
 
 - (void)testAddAndRemoveEventListener
@@ -130,6 +132,98 @@
     XCTAssertEqual(1, testCounter, @"event block was called, but shouldn't have been");
 }
 
+- (void)testEventTypeIDs
+{
+    XCTAssertEqual(SPEventTypeIDEnterFrame, SPEventTypeIDFromString(SPEventTypeEnterFrame), @"wrong built-in ID");
+    XCTAssertEqual(SPEventTypeIDTouch, SPEventTypeIDFromString(@"SPEventTypeTouch"), @"wrong built-in ID");
+    
+    SPEventTypeID customID = SPEventTypeIDFromString(EVENT_TYPE);
+    XCTAssertTrue(customID >= SPEventTypeIDFirstCustom, @"custom type got a built-in ID");
+    XCTAssertEqual(customID, SPEventTypeIDFromString([NSMutableString stringWithString:EVENT_TYPE]),
+                   @"equal strings must be mapped to the same ID");
+    XCTAssertEqualObjects(EVENT_TYPE, SPEventTypeStringFromID(customID), @"wrong type string");
+    XCTAssertEqual(customID, [SPEvent eventWithType:EVENT_TYPE].typeID, @"wrong event type ID");
+}
+
+- (void)testQueriedEventTypeIsNotRegistered
+{
+    SPEventDispatcher *dispatcher = [[SPEventDispatcher alloc] init];
+    [dispatcher addEventListener:@selector(onEvent:) atObject:self forType:EVENT_TYPE];
+
+    NSString *eventType = [NSUUID UUID].UUIDString;
+    XCTAssertFalse([dispatcher hasEventListenerForType:eventType], @"unknown type has a listener");
+    XCTAssertEqual(SPEventTypeIDNone, SPEventTypeIDFromRegisteredString(eventType),
+                   @"queried type was registered");
+    XCTAssertEqual(SPEventTypeIDFromString(EVENT_TYPE),
+                   SPEventTypeIDFromRegisteredString(EVENT_TYPE), @"wrong ID of registered type");
+}
+
+- (void)testManyEventTypes
+{
+    SPEventDispatcher *dispatcher = [[SPEventDispatcher alloc] init];
+    NSInteger numTypes = 10;
+    
+    for (int i=0; i<numTypes; ++i)
+        [dispatcher addEventListener:@selector(onEvent:) atObject:self
+                             forType:[NSString stringWithFormat:@"type%d", i]];
+    
+    for (int i=0; i<numTypes; ++i)
+        [dispatcher dispatchEventWithType:[NSString stringWithFormat:@"type%d", i]];
+    
+    XCTAssertEqual(numTypes, _testCounter, @"not all listeners were called");
+    
+    for (int i=0; i<numTypes; i+=2)
+        [dispatcher removeEventListenersAtObject:self forType:[NSString stringWithFormat:@"type%d", i]];
+    
+    for (int i=0; i<numTypes; ++i)
+        XCTAssertEqual((BOOL)(i % 2),
+                       [dispatcher hasEventListenerForType:[NSString stringWithFormat:@"type%d", i]],
+                       @"wrong listener state after removal");
+}
+
+- (void)testKeptEventIsNotReused
+{
+    SPEventDispatcher *dispatcher = [[SPEventDispatcher alloc] init];
+    [dispatcher addEventListener:@selector(keepEvent:) atObject:self forType:EVENT_TYPE];
+    [dispatcher dispatchEventWithType:EVENT_TYPE bubbles:NO data:@"first"];
+    
+    SPEvent *firstEvent = _keptEvent;
+    [dispatcher dispatchEventWithType:EVENT_TYPE bubbles:NO data:@"second"];
+    
+    XCTAssertNotEqual(firstEvent, _keptEvent, @"a retained event was reused");
+    XCTAssertEqualObjects(@"first", firstEvent.data, @"retained event was modified");
+    XCTAssertEqualObjects(EVENT_TYPE, firstEvent.type, @"retained event was modified");
+    XCTAssertEqualObjects(@"second", _keptEvent.data, @"wrong event data");
+    
+    [dispatcher removeEventListenersAtObject:self forType:EVENT_TYPE];
+}
+
+- (void)testWeaklyKeptEventIsNotReused
+{
+    SPEventDispatcher *dispatcher = [[SPEventDispatcher alloc] init];
+    __block __weak SPEvent *weakEvent = nil;
+
+    [dispatcher addEventListenerForType:EVENT_TYPE block:^(SPEvent *event)
+    {
+        if (!weakEvent) weakEvent = event;
+    }];
+
+    @autoreleasepool
+    {
+        [dispatcher dispatchEventWithType:EVENT_TYPE bubbles:NO data:@"first"];
+    }
+
+    XCTAssertNil(weakEvent, @"weak reference to a deallocated event was not cleared");
+
+    [dispatcher dispatchEventWithType:SPEventTypeTriggered bubbles:NO data:@"second"];
+    XCTAssertNil(weakEvent, @"weak reference points to a reused event");
+}
+
+- (void)keepEvent:(SPEvent *)event
+{
+    _keptEvent = event;
+}
+
 - (void)onEvent:(SPEvent *)event
 {
     _testCounter++;
@@ -73,6 +73,41 @@
     XCTAssertEqual(1.0f, quad2.rotation, @"wrong tween was removed");
 }
 
+- (void)testRemoveObjectsWithTweenedPoint
+{
+    // the hash of a point changes while it is tweened
+    SPJuggler *juggler = [SPJuggler juggler];
+    SPPoint *point = [SPPoint pointWithX:0.0f y:0.0f];
+    SPPoint *equalPoint = [SPPoint pointWithX:0.0f y:0.0f];
+
+    SPTween *tween1 = [SPTween tweenWithTarget:point time:1.0];
+    SPTween *tween2 = [SPTween tweenWithTarget:point time:2.0];
+    [tween1 animateProperty:@"x" targetValue:10.0f];
+    [tween2 animateProperty:@"y" targetValue:10.0f];
+
+    [juggler addObject:tween1];
+    [juggler addObject:tween2];
+    [juggler advanceTime:0.5];
+
+    [juggler removeObjectsWithTarget:equalPoint];
+    XCTAssertTrue([juggler containsObject:tween1], @"tween of an equal target was removed");
+
+    [juggler removeObjectsWithTarget:point];
+    XCTAssertFalse([juggler containsObject:tween1], @"tween not removed");
+    XCTAssertFalse([juggler containsObject:tween2], @"tween not removed");
+
+    float x = point.x;
+    [juggler advanceTime:0.5];
+    XCTAssertEqual(x, point.x, @"removed tween was advanced");
+
+    // the target can be linked again
+    SPTween *tween3 = [SPTween tweenWithTarget:point time:1.0];
+    [tween3 animateProperty:@"x" targetValue:0.0f];
+    [juggler addObject:tween3];
+    [juggler removeObjectsWithTarget:point];
+    XCTAssertFalse([juggler containsObject:tween3], @"tween not removed");
+}
+
 - (void)testRemovalOfTween
 {
     SPJuggler *juggler = [SPJuggler juggler];
@@ -144,4 +179,207 @@
     XCTAssertFalse([juggler containsObject:proxy], @"delayed call not removed from juggler");
 }
 
-@end
\ No newline at end of file
+- (void)testRemoveObjectWhileAdvancing
+{
+    SPJuggler *juggler = [SPJuggler juggler];
+    SPQuad *quad1 = [SPQuad quadWithWidth:100 height:100];
+    SPQuad *quad2 = [SPQuad quadWithWidth:100 height:100];
+
+    SPTween *tween1 = [SPTween tweenWithTarget:quad1 time:1.0];
+    SPTween *tween2 = [SPTween tweenWithTarget:quad2 time:2.0];
+    [tween2 animateProperty:@"x" targetValue:100];
+
+    __weak SPJuggler *weakJuggler = juggler;
+    tween1.onComplete = ^{ [weakJuggler removeObject:tween2]; };
+
+    [juggler addObject:tween1];
+    [juggler addObject:tween2];
+    [juggler advanceTime:1.0];
+
+    XCTAssertFalse([juggler containsObject:tween1], @"completed tween not removed");
+    XCTAssertFalse([juggler containsObject:tween2], @"tween not removed from within callback");
+    XCTAssertEqual(0.0f, quad2.x, @"removed tween was still advanced");
+
+    [juggler addObject:tween2];
+    XCTAssertTrue([juggler containsObject:tween2], @"tween could not be added again");
+
+    [juggler advanceTime:1.0];
+    XCTAssertEqual(50.0f, quad2.x, @"re-added tween was not advanced");
+}
+
+- (void)testRemoveFromJugglerEventIsDispatched
+{
+    __block int eventCount = 0;
+
+    SPJuggler *juggler = [SPJuggler juggler];
+    SPQuad *quad = [SPQuad quadWithWidth:100 height:100];
+    SPTween *tween = [SPTween tweenWithTarget:quad time:1.0];
+
+    [tween addEventListenerForType:SPEventTypeRemoveFromJuggler block:^(id event) { ++eventCount; }];
+    [juggler addObject:tween];
+    [juggler advanceTime:1.0];
+
+    XCTAssertEqual(1, eventCount, @"remove event was not dispatched");
+    XCTAssertFalse([juggler containsObject:tween], @"tween was not removed");
+}
+
+- (void)testTweenInTwoJugglers
+{
+    SPJuggler *juggler1 = [SPJuggler juggler];
+    SPJuggler *juggler2 = [SPJuggler juggler];
+    SPQuad *quad = [SPQuad quadWithWidth:100 height:100];
+    SPTween *tween = [SPTween tweenWithTarget:quad time:1.0];
+
+    [juggler1 addObject:tween];
+    [juggler2 addObject:tween];
+
+    XCTAssertTrue([juggler1 containsObject:tween]);
+    XCTAssertTrue([juggler2 containsObject:tween]);
+
+    [juggler1 advanceTime:1.0];
+
+    XCTAssertFalse([juggler1 containsObject:tween], @"tween was not removed from first juggler");
+    XCTAssertFalse([juggler2 containsObject:tween], @"tween was not removed from second juggler");
+}
+
+- (void)testDelayedSelector
+{
+    SPJuggler *juggler = [SPJuggler juggler];
+    SPSprite *sprite = [SPSprite sprite];
+    SPQuad *quad = [SPQuad quadWithWidth:100 height:100];
+
+    SPDelayedInvocation *delayedInv = [juggler delayInvocationOfSelector:@selector(addChild:)
+                                                                atTarget:sprite withObject:quad byTime:1.0];
+    [juggler advanceTime:0.75];
+    XCTAssertEqual(0, sprite.numChildren, @"method called too early");
+    XCTAssertEqualWithAccuracy(0.75, delayedInv.currentTime, 0.0001, @"wrong current time");
+
+    [juggler advanceTime:0.25];
+    XCTAssertEqual(quad, [sprite childAtIndex:0], @"method not called");
+    XCTAssertTrue(delayedInv.isComplete, @"invocation not complete");
+    XCTAssertFalse([juggler containsObject:delayedInv], @"invocation not removed");
+}
+
+- (void)testRepeatedSelector
+{
+    SPJuggler *juggler = [SPJuggler juggler];
+    SPSprite *sprite = [SPSprite sprite];
+
+    [juggler repeatInvocationOfSelector:@selector(addChild:) atTarget:sprite
+                             withObject:[SPQuad quadWithWidth:10 height:10]
+                               interval:0.5 repeatCount:3];
+
+    [juggler advanceTime:0.4];
+    XCTAssertEqual(0, sprite.numChildren);
+
+    [juggler advanceTime:0.2]; // -> 0.6
+    XCTAssertEqual(1, sprite.numChildren, @"first call missing");
+
+    [juggler advanceTime:0.4]; // -> 1.0
+    XCTAssertEqual(1, sprite.numChildren, @"adding the same child twice must not change anything");
+
+    [juggler removeObjectsWithTarget:sprite];
+    [juggler advanceTime:1.0];
+    XCTAssertEqual(1, sprite.numChildren, @"removed invocation was still executed");
+}
+
+- (void)testRepeatCountAndOrder
+{
+    NSMutableArray *calls = [NSMutableArray array];
+    SPJuggler *juggler = [SPJuggler juggler];
+
+    SPDelayedInvocation *repeated = [juggler repeatInvocationOfSelector:@selector(addObject:)
+                                     atTarget:calls withObject:@"r" interval:0.3 repeatCount:3];
+    [juggler delayInvocationOfSelector:@selector(addObject:) atTarget:calls withObject:@"a" byTime:0.5];
+    [juggler delayInvocationOfSelector:@selector(addObject:) atTarget:calls withObject:@"b" byTime:0.5];
+
+    for (int i=0; i<60; ++i)
+        [juggler advanceTime:1.0 / 60.0];
+
+    NSArray *expected = @[@"r", @"a", @"b", @"r", @"r"];
+    XCTAssertEqualObjects(expected, calls, @"wrong calls or order");
+    XCTAssertFalse([juggler containsObject:repeated], @"repeated invocation not removed");
+}
+
+- (void)testLongDelay
+{
+    __block int callCount = 0;
+    SPJuggler *juggler = [SPJuggler juggler];
+
+    // farther away than the timer wheel can reach at once
+    id delayedInv = [juggler delayInvocationByTime:100000.0 block:^{ ++callCount; }];
+
+    for (int i=0; i<99; ++i)
+        [juggler advanceTime:1000.0];
+
+    XCTAssertEqual(0, callCount, @"block called too early");
+    XCTAssertEqualWithAccuracy(99000.0, [delayedInv currentTime], 0.0001, @"wrong current time");
+
+    [delayedInv setCurrentTime:99999.0];
+    [juggler advanceTime:0.5];
+    XCTAssertEqual(0, callCount, @"block called too early");
+
+    [juggler advanceTime:0.5];
+    XCTAssertEqual(1, callCount, @"block not called");
+    XCTAssertFalse([juggler containsObject:delayedInv], @"invocation not removed");
+}
+
+- (void)testRemoveScheduledInvocations
+{
+    __block int callCount = 0;
+    SPJuggler *juggler = [SPJuggler juggler];
+
+    id delayedInv = [juggler delayInvocationByTime:1.0 block:^{ ++callCount; }];
+    [juggler delayInvocationByTime:2.0 block:^{ ++callCount; }];
+
+    [juggler removeObject:delayedInv];
+    XCTAssertFalse([juggler containsObject:delayedInv]);
+
+    [juggler advanceTime:1.0];
+    XCTAssertEqual(0, callCount, @"removed invocation executed");
+
+    [juggler removeAllObjects];
+    [juggler advanceTime:1.0];
+    XCTAssertEqual(0, callCount, @"removed invocation executed");
+}
+
+- (void)testPerformanceOfManyDelayedInvocations
+{
+    const int numInvocations = 50000;
+
+    SPJuggler *juggler = [SPJuggler juggler];
+    SPSprite *sprite = [SPSprite sprite];
+
+    for (int i=0; i<numInvocations; ++i)
+        [juggler delayInvocationOfSelector:@selector(removeFromParent) atTarget:sprite
+                                withObject:nil byTime:1.0 + i * 0.01];
+
+    [self measureBlock:^
+    {
+        for (int i=0; i<10; ++i)
+            [juggler advanceTime:1.0 / 60.0];
+    }];
+}
+
+- (void)testPerformanceOfManyTweens
+{
+    const int numTweens = 50000;
+
+    SPJuggler *juggler = [SPJuggler juggler];
+
+    for (int i=0; i<numTweens; ++i)
+    {
+        SPQuad *quad = [SPQuad quadWithWidth:10 height:10];
+        SPTween *tween = [SPTween tweenWithTarget:quad time:1000.0];
+        [tween animateProperty:@"x" targetValue:100];
+        [juggler addObject:tween];
+    }
+
+    [self measureBlock:^
+    {
+        for (int i=0; i<10; ++i)
+            [juggler advanceTime:1.0 / 60.0];
+    }];
+}
+
+@end
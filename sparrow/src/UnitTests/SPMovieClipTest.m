@@ -216,4 +216,65 @@
     XCTAssertEqual(4, _completedCount, @"wrong number of events dispatched");
 }
 
+- (void)testSharedTimeline
+{
+    SPTexture *frame0 = [[SPTexture alloc] init];
+    SPTexture *frame1 = [[SPTexture alloc] init];
+    SPTexture *frame2 = [[SPTexture alloc] init];
+
+    SPMovieTimeline *timeline = [SPMovieTimeline timelineWithTextures:@[frame0, frame1] fps:4.0f];
+    SPMovieClip *movie1 = [SPMovieClip movieWithTimeline:timeline];
+    SPMovieClip *movie2 = [SPMovieClip movieWithTimeline:timeline];
+
+    XCTAssertEqual(timeline, movie1.timeline, @"timeline not shared");
+    XCTAssertEqual(timeline, movie2.timeline, @"timeline not shared");
+    XCTAssertEqualWithAccuracy(4.0f, movie1.fps, E, @"wrong fps");
+
+    [movie1 advanceTime:0.3];
+    XCTAssertEqual(1, movie1.currentFrame, @"wrong current frame");
+    XCTAssertEqual(0, movie2.currentFrame, @"playback state is shared");
+
+    // editing a shared timeline must not affect the other clips
+    [movie1 addFrameWithTexture:frame2];
+    XCTAssertEqual(3, movie1.numFrames, @"frame not added");
+    XCTAssertEqual(2, movie2.numFrames, @"shared timeline was modified");
+    XCTAssertEqual(2, timeline.numFrames, @"shared timeline was modified");
+    XCTAssertNotEqual(timeline, movie1.timeline, @"timeline not copied on write");
+
+    movie2.fps = 2.0f;
+    XCTAssertEqualWithAccuracy(0.5, [movie2 durationAtIndex:0], E, @"fps not changed");
+    XCTAssertEqualWithAccuracy(0.25, [timeline durationAtIndex:0], E, @"shared timeline was modified");
+
+    // copies share their timeline, too
+    SPMovieClip *copy = [movie1 copy];
+    XCTAssertEqual(movie1.timeline, copy.timeline, @"copy does not share timeline");
+
+    [copy removeFrameAtIndex:0];
+    XCTAssertEqual(2, copy.numFrames, @"frame not removed");
+    XCTAssertEqual(3, movie1.numFrames, @"original modified by copy");
+}
+
+- (void)testTimelineFrameAtTime
+{
+    NSMutableArray *frames = [NSMutableArray array];
+    for (int i=0; i<100; ++i) [frames addObject:[[SPTexture alloc] init]];
+
+    SPMovieTimeline *timeline = [SPMovieTimeline timelineWithTextures:frames fps:10.0f];
+
+    XCTAssertEqualWithAccuracy(10.0, timeline.totalTime, E, @"wrong total time");
+    XCTAssertEqualWithAccuracy(4.2, [timeline startTimeAtIndex:42], E, @"wrong start time");
+
+    XCTAssertEqual(0,  [timeline frameAtTime:-1.0]);
+    XCTAssertEqual(0,  [timeline frameAtTime:0.0]);
+    XCTAssertEqual(0,  [timeline frameAtTime:0.05]);
+    XCTAssertEqual(42, [timeline frameAtTime:4.25]);
+    XCTAssertEqual(99, [timeline frameAtTime:9.95]);
+    XCTAssertEqual(99, [timeline frameAtTime:20.0]);
+
+    SPMovieClip *movie = [SPMovieClip movieWithTimeline:timeline];
+    [movie advanceTime:7.33];
+    XCTAssertEqual(73, movie.currentFrame, @"wrong current frame");
+    XCTAssertEqual(frames[73], movie.texture, @"wrong texture");
+}
+
 @end
\ No newline at end of file
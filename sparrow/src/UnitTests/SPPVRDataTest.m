@@ -0,0 +1,309 @@
+//
+//  SPPVRDataTest.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 17.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPTestCase.h"
+
+// ETC2 RGB, 8x8 pixels, 4 levels: 2x2 blocks, then a single block (8 bytes) for each level
+#define NUM_LEVELS 4
+static const uint32_t levelSizes[NUM_LEVELS] = { 32, 8, 8, 8 };
+
+@interface SPPVRDataTest : SPTestCase
+
+@end
+
+@implementation SPPVRDataTest
+
+- (void)testMappedFile
+{
+    NSString *path = [self fixturePath];
+    SPPVRData *expected = [[SPPVRData alloc] initWithData:[NSData dataWithContentsOfFile:path]];
+    SPPVRData *pvrData = [[SPPVRData alloc] initWithContentsOfFile:path];
+
+    [self comparePVRData:pvrData withPVRData:expected];
+}
+
+- (void)testCompressedFile
+{
+    NSString *path = [self fixturePath];
+    NSData *data = [NSData dataWithContentsOfFile:path];
+    NSString *compressedPath = [NSTemporaryDirectory() stringByAppendingPathComponent:@"pvr_test.pvr.gz"];
+    [[data gzipDeflate] writeToFile:compressedPath atomically:YES];
+
+    SPPVRData *expected = [[SPPVRData alloc] initWithData:data];
+    SPPVRData *pvrData = [[SPPVRData alloc] initWithContentsOfFile:compressedPath];
+
+    [self comparePVRData:pvrData withPVRData:expected];
+    [[NSFileManager defaultManager] removeItemAtPath:compressedPath error:nil];
+}
+
+- (void)testTruncatedData
+{
+    NSData *data = [NSData dataWithContentsOfFile:[self fixturePath]];
+    NSData *compressedData = [data gzipDeflate];
+    NSData *truncatedData = [compressedData subdataWithRange:NSMakeRange(0, compressedData.length / 2)];
+
+    XCTAssertThrowsSpecificNamed([[SPPVRData alloc] initWithData:truncatedData compressed:YES],
+                                 NSException, SPExceptionDataInvalid);
+    XCTAssertThrowsSpecificNamed([[SPPVRData alloc] initWithData:[data subdataWithRange:NSMakeRange(0, 100)]],
+                                 NSException, SPExceptionDataInvalid);
+}
+
+- (void)testKTX
+{
+    SPPVRData *pvrData = [[SPPVRData alloc] initWithData:[self createKTX]];
+
+    XCTAssertEqual(SPTextureFormatETC2RGB, pvrData.format);
+    XCTAssertEqual(8, pvrData.width);
+    XCTAssertEqual(8, pvrData.height);
+    XCTAssertEqual(NUM_LEVELS - 1, pvrData.numMipmaps);
+    XCTAssertEqual(56, pvrData.imageDataSize);
+    XCTAssertFalse(pvrData.premultipliedAlpha);
+    [self checkLevelsOfPVRData:pvrData firstLevel:0];
+}
+
+- (void)testKTXWithPaddedRows
+{
+    // the rows of 5x3 and 1x1 pixels are padded to 4 bytes in the file, those of 2x1 are not
+    SPPVRData *pvrData = [[SPPVRData alloc] initWithData:[self createKTX565WithWidth:5 height:3]];
+
+    XCTAssertEqual(SPTextureFormat565, pvrData.format);
+    XCTAssertEqual(2, pvrData.numMipmaps);
+    XCTAssertEqual((5 * 3 + 2 + 1) * 2, pvrData.imageDataSize);
+
+    for (int level=0; level<=pvrData.numMipmaps; ++level)
+    {
+        const uint16_t *pixels = [pvrData imageDataOfMipmap:level];
+        int width  = MAX(1, 5 >> level);
+        int height = MAX(1, 3 >> level);
+
+        for (int y=0; y<height; ++y)
+            for (int x=0; x<width; ++x)
+                XCTAssertEqual([self pixelAtX:x y:y level:level], pixels[y * width + x],
+                               @"wrong pixel %d/%d in level %d", x, y, level);
+    }
+
+    // a level must contain the padding of all rows, not just the pixels
+    NSMutableData *data = [[self createKTX565WithWidth:5 height:3] mutableCopy];
+    uint32_t size = 34;
+    [data replaceBytesInRange:NSMakeRange(64, 4) withBytes:&size];
+
+    XCTAssertThrowsSpecificNamed([[SPPVRData alloc] initWithData:data],
+                                 NSException, SPExceptionDataInvalid);
+}
+
+- (void)testKTX2
+{
+    SPPVRData *pvrData = [[SPPVRData alloc] initWithData:[self createKTX2WithSupercompression:0]];
+
+    XCTAssertEqual(SPTextureFormatETC2RGB, pvrData.format);
+    XCTAssertEqual(8, pvrData.width);
+    XCTAssertEqual(NUM_LEVELS - 1, pvrData.numMipmaps);
+    XCTAssertTrue(pvrData.premultipliedAlpha);
+    [self checkLevelsOfPVRData:pvrData firstLevel:0];
+
+    XCTAssertThrowsSpecificNamed([[SPPVRData alloc] initWithData:[self createKTX2WithSupercompression:1]],
+                                 NSException, SPExceptionDataInvalid);
+}
+
+- (void)testPVR3
+{
+    SPPVRData *pvrData = [[SPPVRData alloc] initWithData:[self createPVR3]];
+
+    XCTAssertEqual(SPTextureFormatETC2RGB, pvrData.format);
+    XCTAssertEqual(8, pvrData.width);
+    XCTAssertEqual(NUM_LEVELS - 1, pvrData.numMipmaps);
+    XCTAssertTrue(pvrData.premultipliedAlpha);
+    [self checkLevelsOfPVRData:pvrData firstLevel:0];
+}
+
+- (void)testSkipMipmaps
+{
+    SPPVRData *pvrData = [[SPPVRData alloc] initWithData:[self createKTX] compressed:NO
+                                       numSkippedMipmaps:2];
+
+    XCTAssertEqual(2, pvrData.numSkippedMipmaps);
+    XCTAssertEqual(2, pvrData.width);
+    XCTAssertEqual(2, pvrData.height);
+    XCTAssertEqual(1, pvrData.numMipmaps);
+    XCTAssertEqual(16, pvrData.imageDataSize);
+    [self checkLevelsOfPVRData:pvrData firstLevel:2];
+
+    // the smallest level is always kept
+    pvrData = [[SPPVRData alloc] initWithData:[self createPVR3] compressed:NO numSkippedMipmaps:10];
+
+    XCTAssertEqual(NUM_LEVELS - 1, pvrData.numSkippedMipmaps);
+    XCTAssertEqual(1, pvrData.width);
+    XCTAssertEqual(0, pvrData.numMipmaps);
+    [self checkLevelsOfPVRData:pvrData firstLevel:NUM_LEVELS - 1];
+}
+
+- (void)testTruncatedContainer
+{
+    NSData *data = [self createKTX];
+    NSData *truncatedData = [data subdataWithRange:NSMakeRange(0, data.length - 12)];
+
+    XCTAssertThrowsSpecificNamed([[SPPVRData alloc] initWithData:truncatedData],
+                                 NSException, SPExceptionDataInvalid);
+}
+
+#pragma mark Helpers
+
+- (NSString *)fixturePath
+{
+    return [[NSBundle bundleForClass:[self class]] pathForResource:@"pvrtc_image.pvr"];
+}
+
+- (void)comparePVRData:(SPPVRData *)pvrData withPVRData:(SPPVRData *)expected
+{
+    XCTAssertEqual(expected.width, pvrData.width, @"wrong width");
+    XCTAssertEqual(expected.height, pvrData.height, @"wrong height");
+    XCTAssertEqual(expected.format, pvrData.format, @"wrong format");
+    XCTAssertEqual(expected.numMipmaps, pvrData.numMipmaps, @"wrong number of mipmaps");
+    XCTAssertEqual(expected.imageDataSize, pvrData.imageDataSize, @"wrong image data size");
+    XCTAssertEqual(0, memcmp(expected.imageData, pvrData.imageData, expected.imageDataSize),
+                   @"wrong image data");
+}
+
+- (void)checkLevelsOfPVRData:(SPPVRData *)pvrData firstLevel:(int)firstLevel
+{
+    // each level is filled with its index + 1
+    for (int i=0; i<=pvrData.numMipmaps; ++i)
+    {
+        const uint8_t *level = [pvrData imageDataOfMipmap:i];
+        XCTAssertEqual((uint8_t)(firstLevel + i + 1), level[0], @"wrong data in level %d", i);
+        XCTAssertEqual((uint8_t)(firstLevel + i + 1), level[levelSizes[firstLevel + i] - 1]);
+    }
+
+    XCTAssertEqual(pvrData.imageData, [pvrData imageDataOfMipmap:0]);
+}
+
+- (void)appendLevel:(int)level toData:(NSMutableData *)data
+{
+    NSMutableData *levelData = [NSMutableData dataWithLength:levelSizes[level]];
+    memset(levelData.mutableBytes, level + 1, levelData.length);
+    [data appendData:levelData];
+}
+
+- (void)appendValues:(const uint32_t *)values count:(int)count toData:(NSMutableData *)data
+{
+    [data appendBytes:values length:count * sizeof(uint32_t)];
+}
+
+- (NSData *)createKTX
+{
+    static const uint8_t identifier[] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+    const uint32_t header[] = {
+        0x04030201, 0, 1, 0, GL_COMPRESSED_RGB8_ETC2, GL_RGB, 8, 8, 0, 0, 1, NUM_LEVELS, 8 };
+    const uint32_t keyValueData[] = { 0, 0 };
+
+    NSMutableData *data = [NSMutableData dataWithBytes:identifier length:sizeof(identifier)];
+    [self appendValues:header count:13 toData:data];
+    [self appendValues:keyValueData count:2 toData:data];
+
+    for (int i=0; i<NUM_LEVELS; ++i)
+    {
+        [self appendValues:&levelSizes[i] count:1 toData:data];
+        [self appendLevel:i toData:data];
+    }
+
+    return data;
+}
+
+- (uint16_t)pixelAtX:(int)x y:(int)y level:(int)level
+{
+    return (uint16_t)((level << 12) | (y << 8) | x);
+}
+
+- (NSData *)createKTX565WithWidth:(int)width height:(int)height
+{
+    static const uint8_t identifier[] = { 0xAB, 'K', 'T', 'X', ' ', '1', '1', 0xBB, '\r', '\n', 0x1A, '\n' };
+    const uint32_t numLevels = 3;
+    const uint32_t header[] = {
+        0x04030201, GL_UNSIGNED_SHORT_5_6_5, 2, GL_RGB, GL_RGB, GL_RGB, width, height, 0, 0, 1,
+        numLevels, 0 };
+
+    NSMutableData *data = [NSMutableData dataWithBytes:identifier length:sizeof(identifier)];
+    [self appendValues:header count:13 toData:data];
+
+    for (int level=0; level<numLevels; ++level)
+    {
+        int levelWidth  = MAX(1, width  >> level);
+        int levelHeight = MAX(1, height >> level);
+        uint32_t rowSize = (levelWidth * 2 + 3) & ~3;
+        uint32_t size = rowSize * levelHeight;
+
+        [self appendValues:&size count:1 toData:data];
+
+        for (int y=0; y<levelHeight; ++y)
+        {
+            // the padding is filled with a value that no pixel uses
+            NSMutableData *row = [NSMutableData dataWithLength:rowSize];
+            memset(row.mutableBytes, 0xee, rowSize);
+
+            for (int x=0; x<levelWidth; ++x)
+                ((uint16_t *)row.mutableBytes)[x] = [self pixelAtX:x y:y level:level];
+
+            [data appendData:row];
+        }
+    }
+
+    return data;
+}
+
+- (NSData *)createKTX2WithSupercompression:(uint32_t)supercompression
+{
+    static const uint8_t identifier[] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+    const uint32_t dfdOffset = 80 + NUM_LEVELS * 24;
+    const uint32_t header[] = {
+        147, 1, 8, 8, 0, 0, 1, NUM_LEVELS, supercompression, dfdOffset, 28, 0, 0, 0, 0, 0, 0 };
+
+    NSMutableData *data = [NSMutableData dataWithBytes:identifier length:sizeof(identifier)];
+    [self appendValues:header count:17 toData:data];
+
+    // the level index stores offset, size and uncompressed size of each level
+    uint64_t offset = dfdOffset + 28;
+
+    for (int i=0; i<NUM_LEVELS; ++i)
+    {
+        uint64_t index[] = { offset, levelSizes[i], levelSizes[i] };
+        [data appendBytes:index length:sizeof(index)];
+        offset += levelSizes[i];
+    }
+
+    // a data format descriptor with the 'premultiplied' flag
+    uint8_t dfd[28] = { 28 };
+    dfd[15] = 0x01;
+    [data appendBytes:dfd length:sizeof(dfd)];
+
+    for (int i=0; i<NUM_LEVELS; ++i)
+        [self appendLevel:i toData:data];
+
+    return data;
+}
+
+- (NSData *)createPVR3
+{
+    // version, flags (premultiplied), pixel format (64 bit), color space, channel type,
+    // height, width, depth, surfaces, faces, mipmaps, meta data size
+    const uint32_t header[] = { 0x03525650, 0x02, 22, 0, 0, 0, 8, 8, 1, 1, 1, NUM_LEVELS, 4 };
+    const uint32_t metaData = 0;
+
+    NSMutableData *data = [NSMutableData data];
+    [self appendValues:header count:13 toData:data];
+    [self appendValues:&metaData count:1 toData:data];
+
+    for (int i=0; i<NUM_LEVELS; ++i)
+        [self appendLevel:i toData:data];
+
+    return data;
+}
+
+@end
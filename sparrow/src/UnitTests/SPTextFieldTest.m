@@ -0,0 +1,181 @@
+//
+//  SPTextFieldTest.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 12.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPTestCase.h"
+
+@interface SPTextFieldTest : SPTestCase
+
+@end
+
+@implementation SPTextFieldTest
+
+- (void)testIncrementalUpdates
+{
+    SPTextField *textField = [self createTextFieldWithText:@"Score: 100"];
+    NSArray *texts = @[@"Score: 105", @"Score: 1050", @"Score: 105", @"Hi Score: 105",
+                       @"Hi Score:\n105", @"", @"Score: 100"];
+
+    for (NSString *text in texts)
+    {
+        textField.text = text;
+        [self compareTextField:textField withTextField:[self createTextFieldWithText:text]];
+    }
+}
+
+- (void)testAppendKeepsCapacity
+{
+    SPTextField *textField = [self createTextFieldWithText:@""];
+    NSMutableString *text = [NSMutableString string];
+
+    for (int i=0; i<100; ++i)
+    {
+        [text appendFormat:@"%d ", i];
+        textField.text = text;
+        [textField textBounds];
+    }
+
+    SPQuadBatch *quadBatch = (SPQuadBatch *)[textField childAtIndex:0];
+    NSInteger capacity = quadBatch.capacity;
+
+    textField.text = @"0";
+    [textField textBounds];
+
+    XCTAssertEqual(1, quadBatch.numQuads, @"wrong number of quads");
+    XCTAssertEqual(capacity, quadBatch.capacity, @"capacity changed");
+    [self compareTextField:textField withTextField:[self createTextFieldWithText:@"0"]];
+}
+
+- (void)testUnchangedLayoutKeepsQuads
+{
+    SPTextField *textField = [self createTextFieldWithText:@"Score: 100"];
+    SPQuadBatch *quadBatch = (SPQuadBatch *)[textField childAtIndex:0];
+
+    // a marker that any rebuild of the first quad would overwrite
+    [quadBatch setQuadColor:SPColorBlue atIndex:0];
+
+    // properties that are set back to their previous values lead to the cached layout
+    textField.text = [NSMutableString stringWithString:@"Score: 100"];
+    textField.fontSize = textField.fontSize * 2.0f;
+    textField.hAlign = SPHAlignRight;
+    textField.fontSize = textField.fontSize / 2.0f;
+    textField.hAlign = SPHAlignLeft;
+    textField.text = @"Score: 200";
+    textField.text = @"Score: 100";
+    [textField textBounds];
+
+    XCTAssertEqual(quadBatch, [textField childAtIndex:0], @"quad batch was replaced");
+    XCTAssertEqual(SPColorBlue, [quadBatch quadColorAtIndex:0], @"quads were rebuilt");
+
+    textField.text = @"Hi Score: 100";
+    [textField textBounds];
+
+    XCTAssertEqual(quadBatch, [textField childAtIndex:0], @"quad batch was replaced");
+    XCTAssertEqual(SPColorWhite, [quadBatch quadColorAtIndex:0], @"quads were not rebuilt");
+    [self compareTextField:textField withTextField:[self createTextFieldWithText:@"Hi Score: 100"]];
+}
+
+- (void)testTooManyGlyphs
+{
+    SPTextField *textField = [self createTextFieldWithText:@"Score: 100"];
+    textField.autoSize = SPTextFieldAutoSizeHorizontal;
+    textField.text = [@"" stringByPaddingToLength:8193 withString:@"A" startingAtIndex:0];
+
+    // the incremental update must not bypass the limit of the quad batch
+    XCTAssertThrows([textField textBounds], @"too many glyphs accepted");
+}
+
+- (void)testColorChange
+{
+    SPTextField *textField = [self createTextFieldWithText:@"ABC"];
+    textField.color = SPColorRed;
+    textField.text = @"ABCD";
+
+    SPTextField *expected = [self createTextFieldWithText:@"ABCD"];
+    expected.color = SPColorRed;
+
+    [self compareTextField:textField withTextField:expected];
+}
+
+- (void)testGlyphAtlas
+{
+    [SPTextField setUsesGlyphAtlas:YES];
+
+    SPTextField *textField1 = [SPTextField textFieldWithWidth:200 height:50 text:@"Hello"];
+    SPTextField *textField2 = [SPTextField textFieldWithWidth:200 height:50 text:@"World"];
+    [textField1 textBounds];
+    [textField2 textBounds];
+
+    SPQuadBatch *quadBatch1 = (SPQuadBatch *)[textField1 childAtIndex:0];
+    SPQuadBatch *quadBatch2 = (SPQuadBatch *)[textField2 childAtIndex:0];
+
+    XCTAssertTrue([quadBatch1 isKindOfClass:[SPQuadBatch class]], @"text not composed of glyphs");
+    XCTAssertEqual(5, quadBatch1.numQuads, @"wrong number of glyphs");
+    XCTAssertEqual(quadBatch1.texture.root, quadBatch2.texture.root, @"glyphs are not shared");
+
+    textField1.text = @"Hello World";
+    [textField1 textBounds];
+    XCTAssertEqual(10, quadBatch1.numQuads, @"wrong number of glyphs");
+
+    textField1.underline = YES;
+    [textField1 textBounds];
+    XCTAssertTrue([[textField1 childAtIndex:0] isKindOfClass:[SPImage class]], @"underline ignored");
+
+    textField2.text = @"مرحبا";
+    [textField2 textBounds];
+    XCTAssertTrue([[textField2 childAtIndex:0] isKindOfClass:[SPImage class]],
+                  @"complex script must not use the glyph atlas");
+
+    [SPTextField setUsesGlyphAtlas:NO];
+}
+
+- (void)testGlyphAtlasDisabled
+{
+    XCTAssertFalse([SPTextField usesGlyphAtlas], @"glyph atlas must be opt-in");
+
+    SPTextField *textField = [SPTextField textFieldWithWidth:200 height:50 text:@"Hello"];
+    [textField textBounds];
+    XCTAssertTrue([[textField childAtIndex:0] isKindOfClass:[SPImage class]], @"atlas not disabled");
+}
+
+#pragma mark Helpers
+
+- (SPTextField *)createTextFieldWithText:(NSString *)text
+{
+    SPTextField *textField = [SPTextField textFieldWithWidth:200 height:100 text:text
+                              fontName:SPBitmapFontMiniName fontSize:SPNativeFontSize color:SPColorWhite];
+    textField.hAlign = SPHAlignLeft;
+    textField.vAlign = SPVAlignTop;
+    [textField textBounds]; // forces a redraw
+    return textField;
+}
+
+- (void)compareTextField:(SPTextField *)textField withTextField:(SPTextField *)expected
+{
+    [textField textBounds];
+    [expected textBounds];
+
+    SPQuadBatch *quadBatch = (SPQuadBatch *)[textField childAtIndex:0];
+    SPQuadBatch *expectedQuadBatch = (SPQuadBatch *)[expected childAtIndex:0];
+
+    XCTAssertEqual(expectedQuadBatch.numQuads, quadBatch.numQuads, @"wrong number of quads");
+
+    for (NSInteger i=0; i<MIN(quadBatch.numQuads, expectedQuadBatch.numQuads); ++i)
+    {
+        SPRectangle *bounds = [quadBatch boundsOfQuadAtIndex:i];
+        SPRectangle *expectedBounds = [expectedQuadBatch boundsOfQuadAtIndex:i];
+
+        XCTAssertTrue([expectedBounds isEqualToRectangle:bounds], @"wrong quad at index %ld", (long)i);
+        XCTAssertEqual([expectedQuadBatch quadColorAtIndex:i], [quadBatch quadColorAtIndex:i],
+                       @"wrong color at index %ld", (long)i);
+    }
+}
+
+@end
@@ -10,6 +10,9 @@
 
 #import "SPTestCase.h"
 
+#define NUM_BENCHMARK_ANIMATIONS 200
+#define NUM_BENCHMARK_FRAMES 20
+
 @interface SPTextureAtlasTest : SPTestCase
 
 @end
@@ -57,4 +60,135 @@
     XCTAssertTrue([expectedNames isEqualToArray:names], @"wrong names array");
 }
 
-@end
\ No newline at end of file
+- (void)testNamesStartingWith
+{
+    SPTexture *texture = [[SPTexture alloc] initWithWidth:100 height:100];
+    SPTextureAtlas *atlas = [[SPTextureAtlas alloc] initWithTexture:texture];
+    SPRectangle *region = [SPRectangle rectangleWithX:0 y:0 width:10 height:10];
+
+    for (NSString *name in @[@"walk_10", @"walk_2", @"run_1", @"walk_1", @"walker", @"wal"])
+        [atlas addRegion:region withName:name];
+
+    NSArray *expectedNames = @[@"walk_1", @"walk_2", @"walk_10"];
+    XCTAssertEqualObjects(expectedNames, [atlas namesStartingWith:@"walk_"], @"wrong names");
+
+    expectedNames = @[@"run_1", @"wal", @"walk_1", @"walk_2", @"walk_10", @"walker"];
+    XCTAssertEqualObjects(expectedNames, atlas.names, @"wrong names");
+    XCTAssertEqual(0, [atlas namesStartingWith:@"x"].count, @"unexpected names");
+    XCTAssertEqual(0, [atlas namesStartingWith:@"a"].count, @"unexpected names");
+
+    [atlas removeRegion:@"walk_2"];
+    [atlas removeRegion:@"unknown"];
+    [atlas addRegion:region withName:@"walk_1"]; // replaces the existing region
+
+    expectedNames = @[@"walk_1", @"walk_10"];
+    XCTAssertEqualObjects(expectedNames, [atlas namesStartingWith:@"walk_"], @"wrong names");
+    XCTAssertEqual(5, atlas.numTextures, @"wrong texture count");
+    XCTAssertEqual(5, atlas.names.count, @"wrong names count");
+}
+
+- (void)testTextureCache
+{
+    SPTexture *texture = [[SPTexture alloc] initWithWidth:100 height:100];
+    SPTextureAtlas *atlas = [[SPTextureAtlas alloc] initWithTexture:texture];
+    [atlas addRegion:[SPRectangle rectangleWithX:0 y:0 width:10 height:10] withName:@"a"];
+
+    SPTexture *subTexture = [atlas textureByName:@"a"];
+    XCTAssertEqual(subTexture, [atlas textureByName:@"a"], @"texture was not cached");
+    XCTAssertEqual(subTexture, [atlas texturesStartingWith:@"a"][0], @"texture was not cached");
+
+    [atlas addRegion:[SPRectangle rectangleWithX:10 y:0 width:10 height:10] withName:@"a"];
+    XCTAssertNotEqual(subTexture, [atlas textureByName:@"a"], @"cached texture was not replaced");
+    XCTAssertEqualWithAccuracy(0.1f, ((SPSubTexture *)[atlas textureByName:@"a"]).clipping.x, E);
+}
+
+- (void)testBinaryAtlas
+{
+    NSString *folder = [self createTemporaryFolder];
+    NSString *xmlPath = [folder stringByAppendingPathComponent:@"atlas.xml"];
+    NSString *xml = @"<TextureAtlas imagePath='atlas.png'>"
+                     "  <SubTexture name='plain' x='10' y='20' width='30' height='40'/>"
+                     "  <SubTexture name='trimmed' x='0' y='0' width='10' height='10' rotated='true'"
+                     "              frameX='-5' frameY='-6' frameWidth='20' frameHeight='30'/>"
+                     "</TextureAtlas>";
+
+    [xml writeToFile:xmlPath atomically:YES encoding:NSUTF8StringEncoding error:nil];
+
+    NSString *binaryPath = [SPTextureAtlas convertXmlFile:xmlPath toBinaryFile:nil];
+    XCTAssertEqualObjects([folder stringByAppendingPathComponent:@"atlas.spb"], binaryPath);
+
+    SPTexture *texture = [[SPTexture alloc] initWithWidth:100 height:100];
+    SPTextureAtlas *xmlAtlas = [[SPTextureAtlas alloc] initWithContentsOfFile:xmlPath texture:texture];
+
+    // remove the XML file, so that only the binary file can be used
+    [[NSFileManager defaultManager] removeItemAtPath:xmlPath error:nil];
+    SPTextureAtlas *binaryAtlas = [[SPTextureAtlas alloc] initWithContentsOfFile:xmlPath texture:texture];
+
+    XCTAssertEqualObjects(xmlAtlas.names, binaryAtlas.names, @"wrong names");
+
+    for (NSString *name in xmlAtlas.names)
+    {
+        XCTAssertTrue([[xmlAtlas regionByName:name] isEqualToRectangle:[binaryAtlas regionByName:name]]);
+
+        SPRectangle *frame = [xmlAtlas frameByName:name];
+        if (frame) XCTAssertTrue([frame isEqualToRectangle:[binaryAtlas frameByName:name]]);
+        else       XCTAssertNil([binaryAtlas frameByName:name]);
+
+        SPSubTexture *xmlTexture = (SPSubTexture *)[xmlAtlas textureByName:name];
+        SPSubTexture *binaryTexture = (SPSubTexture *)[binaryAtlas textureByName:name];
+        XCTAssertEqual(xmlTexture.rotated, binaryTexture.rotated, @"wrong rotation");
+    }
+}
+
+- (void)testOutdatedBinaryAtlas
+{
+    NSString *folder = [self createTemporaryFolder];
+    NSString *xmlPath = [folder stringByAppendingPathComponent:@"atlas.xml"];
+    NSString *xml = @"<TextureAtlas><SubTexture name='a' x='0' y='0' width='10' height='10'/></TextureAtlas>";
+
+    [xml writeToFile:xmlPath atomically:YES encoding:NSUTF8StringEncoding error:nil];
+    [SPTextureAtlas convertXmlFile:xmlPath toBinaryFile:nil];
+
+    xml = @"<TextureAtlas><SubTexture name='b' x='0' y='0' width='10' height='10'/></TextureAtlas>";
+    [xml writeToFile:xmlPath atomically:YES encoding:NSUTF8StringEncoding error:nil];
+
+    SPTexture *texture = [[SPTexture alloc] initWithWidth:100 height:100];
+    SPTextureAtlas *atlas = [[SPTextureAtlas alloc] initWithContentsOfFile:xmlPath texture:texture];
+
+    XCTAssertEqualObjects(@[@"b"], atlas.names, @"outdated binary file was used");
+}
+
+#pragma mark Benchmarks
+
+- (void)testPerformanceOfPrefixQueries
+{
+    SPTexture *texture = [[SPTexture alloc] initWithWidth:100 height:100];
+    SPTextureAtlas *atlas = [[SPTextureAtlas alloc] initWithTexture:texture];
+    SPRectangle *region = [SPRectangle rectangleWithX:0 y:0 width:10 height:10];
+
+    for (int i=0; i<NUM_BENCHMARK_ANIMATIONS; ++i)
+        for (int j=0; j<NUM_BENCHMARK_FRAMES; ++j)
+            [atlas addRegion:region withName:[NSString stringWithFormat:@"anim_%d/%d", i, j]];
+
+    [self measureBlock:^
+    {
+        for (int i=0; i<NUM_BENCHMARK_ANIMATIONS; ++i)
+        {
+            NSString *prefix = [NSString stringWithFormat:@"anim_%d/", i];
+            XCTAssertEqual(NUM_BENCHMARK_FRAMES, [atlas texturesStartingWith:prefix].count);
+        }
+    }];
+}
+
+#pragma mark Helpers
+
+- (NSString *)createTemporaryFolder
+{
+    NSString *folder = [NSTemporaryDirectory() stringByAppendingPathComponent:
+                        [[NSProcessInfo processInfo] globallyUniqueString]];
+    [[NSFileManager defaultManager] createDirectoryAtPath:folder withIntermediateDirectories:YES
+                                               attributes:nil error:nil];
+    return folder;
+}
+
+@end
@@ -0,0 +1,268 @@
+//
+//  SPTextureConversionTest.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 19.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPTestCase.h"
+
+#define GRAY 100
+#define GRAY_SIZE 16
+
+@interface SPTextureConversionTest : SPTestCase
+
+@end
+
+@implementation SPTextureConversionTest
+
+- (void)testPremultiply
+{
+    // five pixels: four are processed with SIMD instructions, the last one without
+    uchar pixels[] = { 255, 128, 0, 128,   10, 20, 30, 255,   255, 255, 255, 0,
+                       200, 100, 50, 64,   255, 128, 0, 128 };
+
+    SPTexturePremultiplyPixels(pixels, 5);
+
+    uchar expected[] = { 128, 64, 0, 128,   10, 20, 30, 255,   0, 0, 0, 0,
+                         50, 25, 13, 64,    128, 64, 0, 128 };
+
+    for (int i=0; i<20; ++i)
+        XCTAssertEqual(expected[i], pixels[i], @"wrong value at index %d", i);
+}
+
+- (void)testUnpremultiply
+{
+    uchar straight[] = { 255, 128, 0, 128,   10, 20, 30, 255,   0, 0, 0, 0,
+                         200, 100, 50, 160,  33, 66, 99, 200 };
+    uchar pixels[20];
+
+    memcpy(pixels, straight, sizeof(pixels));
+    SPTexturePremultiplyPixels(pixels, 5);
+    SPTextureUnpremultiplyPixels(pixels, 5);
+
+    // the round trip loses precision at low alpha values
+    for (int i=0; i<20; ++i)
+        XCTAssertEqualWithAccuracy(straight[i], pixels[i], 1, @"wrong value at index %d", i);
+
+    // invalid colors of transparent pixels become black, with SIMD instructions or without
+    uchar transparent[] = { 10, 20, 30, 0,   0, 0, 0, 255,   0, 0, 0, 255,   0, 0, 0, 255,
+                            10, 20, 30, 0 };
+
+    SPTextureUnpremultiplyPixels(transparent, 5);
+
+    for (int i=0; i<3; ++i)
+    {
+        XCTAssertEqual(0, transparent[i],      @"wrong value in SIMD path at index %d", i);
+        XCTAssertEqual(0, transparent[i + 16], @"wrong value in scalar path at index %d", i);
+    }
+}
+
+- (void)testConvert565
+{
+    uchar pixels[] = { 255, 255, 255, 255,   255, 0, 0, 255,   0, 255, 0, 255,   0, 0, 255, 255 };
+    uint16_t output[4];
+
+    SPTextureConvertPixels(pixels, output, 4, 1, SPTextureFormat565, SPTextureDitheringNone, YES);
+
+    XCTAssertEqual(0xffff, output[0], @"wrong white");
+    XCTAssertEqual(0xf800, output[1], @"wrong red");
+    XCTAssertEqual(0x07e0, output[2], @"wrong green");
+    XCTAssertEqual(0x001f, output[3], @"wrong blue");
+}
+
+- (void)testConvert4444
+{
+    uchar pixels[] = { 255, 0, 255, 255,   9, 9, 9, 8 };
+    uint16_t output[2];
+
+    SPTextureConvertPixels(pixels, output, 2, 1, SPTextureFormat4444, SPTextureDitheringNone, YES);
+    XCTAssertEqual(0xf0ff, output[0], @"wrong color");
+    XCTAssertEqual(0x0000, output[1], @"color not clamped to alpha");
+
+    SPTextureConvertPixels(pixels, output, 2, 1, SPTextureFormat4444, SPTextureDitheringNone, NO);
+    XCTAssertEqual(0x1110, output[1], @"straight color was clamped");
+}
+
+- (void)testConvertLuminance
+{
+    uchar pixels[] = { 255, 255, 255, 255,   255, 0, 0, 128 };
+    uchar output[4];
+
+    SPTextureConvertPixels(pixels, output, 2, 1, SPTextureFormatAI88, SPTextureDitheringNone, NO);
+    XCTAssertEqual(255, output[0], @"wrong luminance");
+    XCTAssertEqual(255, output[1], @"wrong alpha");
+    XCTAssertEqual(76,  output[2], @"wrong luminance");
+    XCTAssertEqual(128, output[3], @"wrong alpha");
+
+    SPTextureConvertPixels(pixels, output, 2, 1, SPTextureFormatI8, SPTextureDitheringNone, NO);
+    XCTAssertEqual(255, output[0], @"wrong luminance");
+    XCTAssertEqual(76,  output[1], @"wrong luminance");
+
+    SPTextureConvertPixels(pixels, output, 2, 1, SPTextureFormatAlpha, SPTextureDitheringNone, NO);
+    XCTAssertEqual(255, output[0], @"wrong alpha");
+    XCTAssertEqual(128, output[1], @"wrong alpha");
+}
+
+- (void)testConvertRemainingPixels
+{
+    // seven pixels: four are converted with SIMD instructions, the last three are padded; both
+    // parts contain the same colors and get the same dithering offsets
+    uchar pixels[] = { 255, 128, 0, 128,   10, 20, 30, 255,   200, 100, 50, 64,   0, 0, 0, 0,
+                       255, 128, 0, 128,   10, 20, 30, 255,   200, 100, 50, 64 };
+    uint16_t output[7];
+
+    SPTextureFormat formats[] = { SPTextureFormat565, SPTextureFormat4444, SPTextureFormatAI88 };
+
+    for (int f=0; f<3; ++f)
+    {
+        for (int pma=0; pma<2; ++pma)
+        {
+            SPTextureConvertPixels(pixels, output, 7, 1, formats[f],
+                                   SPTextureDitheringOrdered, pma);
+
+            for (int i=0; i<3; ++i)
+                XCTAssertEqual(output[i], output[i + 4], @"wrong value at index %d", i + 4);
+        }
+    }
+
+    SPTextureConvertPixels(pixels, output, 7, 1, SPTextureFormat4444, SPTextureDitheringNone, YES);
+    XCTAssertEqual(0x8808, output[4], @"wrong color");
+    XCTAssertEqual(0x4434, output[6], @"color not clamped to alpha");
+}
+
+- (void)testOrderedDithering
+{
+    // on average, the dithered pixels must come closer to the original gray than rounding
+    float expected = GRAY * 31.0f / 255.0f;
+
+    float rounded  = [self averageRedOfGrayConvertedWithDithering:SPTextureDitheringNone];
+    float dithered = [self averageRedOfGrayConvertedWithDithering:SPTextureDitheringOrdered];
+
+    XCTAssertEqualWithAccuracy(expected, dithered, 1.0f / 16.0f, @"wrong average");
+    XCTAssertLessThan(fabsf(dithered - expected), fabsf(rounded - expected), @"no dithering");
+}
+
+- (void)testDiffusionDithering
+{
+    float expected = GRAY * 31.0f / 255.0f;
+    float dithered = [self averageRedOfGrayConvertedWithDithering:SPTextureDitheringDiffusion];
+
+    XCTAssertEqualWithAccuracy(expected, dithered, 1.0f / 16.0f, @"wrong average");
+}
+
+- (void)testConvertibleFormats
+{
+    XCTAssertTrue(SPTextureFormatIsConvertible(SPTextureFormat565));
+    XCTAssertTrue(SPTextureFormatIsConvertible(SPTextureFormatAI88));
+    XCTAssertFalse(SPTextureFormatIsConvertible(SPTextureFormatPvrtcRGBA4));
+    XCTAssertFalse(SPTextureFormatIsConvertible(SPTextureFormatETC2RGBA));
+
+    uchar pixel[4] = { 0 };
+    XCTAssertThrows(SPTextureConvertPixels(pixel, pixel, 1, 1, SPTextureFormatETC2RGB,
+                                           SPTextureDitheringNone, NO));
+}
+
+- (void)testNumMipmaps
+{
+    XCTAssertEqual(5, SPTextureNumMipmaps(32, 16));
+    XCTAssertEqual(2, SPTextureNumMipmaps(5, 3));
+    XCTAssertEqual(0, SPTextureNumMipmaps(1, 1));
+}
+
+- (void)testMipmapsWeightedByAlpha
+{
+    // the transparent pixels must not darken the white one
+    uchar pixels[5 * 4] = { 255, 255, 255, 255 };
+
+    SPTextureGenerateMipmaps(pixels, 2, 2, YES);
+    for (int i=16; i<20; ++i)
+        XCTAssertEqual(64, pixels[i], @"wrong value at index %d", i);
+
+    uchar straightPixels[5 * 4] = { 255, 255, 255, 255 };
+
+    SPTextureGenerateMipmaps(straightPixels, 2, 2, NO);
+    XCTAssertEqual(255, straightPixels[16], @"wrong color");
+    XCTAssertEqual(64,  straightPixels[19], @"wrong alpha");
+}
+
+- (void)testMipmapsGammaCorrect
+{
+    // black and white average to a linear gray of 0.5, which is 188 in sRGB (and not 128)
+    uchar pixels[5 * 4] = { 255, 255, 255, 255,   0, 0, 0, 255,
+                              0,   0,   0, 255,   255, 255, 255, 255 };
+
+    SPTextureGenerateMipmaps(pixels, 2, 2, YES);
+    XCTAssertEqualWithAccuracy(188, pixels[16], 1, @"wrong color");
+    XCTAssertEqual(255, pixels[19], @"wrong alpha");
+}
+
+- (void)testMipmapsOfOddSize
+{
+    // 5x3, 2x1, 1x1; the fourth column is white, the others are black
+    uchar pixels[(15 + 2 + 1) * 4];
+
+    for (int i=0; i<15; ++i)
+    {
+        uchar value = i % 5 == 3 ? 255 : 0;
+        memcpy(pixels + i * 4, (uchar[]){ value, value, value, 255 }, 4);
+    }
+
+    SPTextureGenerateMipmaps(pixels, 5, 3, YES);
+
+    XCTAssertEqual(0, pixels[15 * 4], @"wrong color in first pixel of level 1");
+    XCTAssertEqualWithAccuracy(188, pixels[16 * 4], 1, @"wrong color in last pixel of level 1");
+    XCTAssertEqual(255, pixels[16 * 4 + 3], @"wrong alpha");
+    XCTAssertEqualWithAccuracy(137, pixels[17 * 4], 1, @"wrong color in level 2");
+}
+
+- (void)testMipmapsOfBigTexture
+{
+    // big enough to be calculated on several threads
+    const NSInteger size = 256;
+    NSInteger numPixels = 0;
+
+    for (NSInteger level=0; level<=SPTextureNumMipmaps(size, size); ++level)
+        numPixels += (size >> level) * (size >> level);
+
+    uchar *pixels = malloc(numPixels * 4);
+    for (NSInteger i=0; i<size * size; ++i)
+        memcpy(pixels + i * 4, (uchar[]){ 200, 100, 50, 255 }, 4);
+
+    SPTextureGenerateMipmaps(pixels, size, size, YES);
+
+    // a flat color stays the same in every level
+    for (NSInteger i=size * size; i<numPixels; ++i)
+    {
+        XCTAssertEqualWithAccuracy(200, pixels[i * 4],     1, @"wrong red in pixel %ld", (long)i);
+        XCTAssertEqualWithAccuracy(100, pixels[i * 4 + 1], 1, @"wrong green in pixel %ld", (long)i);
+        XCTAssertEqualWithAccuracy(50,  pixels[i * 4 + 2], 1, @"wrong blue in pixel %ld", (long)i);
+        XCTAssertEqual(255, pixels[i * 4 + 3], @"wrong alpha in pixel %ld", (long)i);
+    }
+
+    free(pixels);
+}
+
+#pragma mark Helpers
+
+- (float)averageRedOfGrayConvertedWithDithering:(SPTextureDithering)dithering
+{
+    const int numPixels = GRAY_SIZE * GRAY_SIZE;
+    uchar pixels[numPixels * 4];
+    uint16_t output[numPixels];
+
+    memset(pixels, GRAY, sizeof(pixels));
+    SPTextureConvertPixels(pixels, output, GRAY_SIZE, GRAY_SIZE, SPTextureFormat565, dithering, NO);
+
+    float sum = 0.0f;
+    for (int i=0; i<numPixels; ++i)
+        sum += output[i] >> 11;
+
+    return sum / numPixels;
+}
+
+@end
@@ -10,11 +10,42 @@
 
 #import "SPTestCase.h"
 
+// private methods of SPGLTexture that these tests need access to
+@interface SPGLTexture (Testing)
+
+- (void)makeReloadableWithPath:(NSString *)path options:(SPTextureOptions *)options;
+- (void)evict;
++ (void)nextFrame;
++ (void)evictTexturesWithNumBytes:(uint64_t)numBytes;
+
+@end
+
 @interface SPTextureTest : SPTestCase
 
 @end
 
 @implementation SPTextureTest
+{
+    SPContext *_context;
+}
+
+- (void)setUp
+{
+    [super setUp];
+
+    // the textures are uploaded for real; a context without a sharegroup makes sure that
+    // deleting them can't affect the textures of any other context
+    _context = [[SPContext alloc] initWithShareContext:nil];
+    [SPContext setCurrentContext:_context];
+}
+
+- (void)tearDown
+{
+    [SPTexture setMemoryBudget:0];
+    [SPContext setCurrentContext:nil];
+    _context = nil;
+    [super tearDown];
+}
 
 - (void)testTextureCoordinates
 {
@@ -183,10 +214,165 @@
     XCTAssertEqualWithAccuracy(clipping.height, 0.5f, E, @"wrong clipping.x");
 }
 
+- (void)testNumBytes
+{
+    uint64_t numBytes = [SPTexture memoryStats].numBytes;
+    SPGLTexture *texture = [self GLTextureWithWidth:32 height:16 scale:2.0f];
+
+    XCTAssertEqual(32 * 16 * 2, texture.numBytes, @"wrong number of bytes");
+    XCTAssertEqual(numBytes + texture.numBytes, [SPTexture memoryStats].numBytes);
+    XCTAssertFalse(texture.isEvicted);
+
+    // 32x16, 16x8, 8x4, 4x2, 2x1, 1x1
+    SPTextureProperties properties = {
+        .format = SPTextureFormat4444, .scale = 1.0f, .width = 32, .height = 16, .numMipmaps = 5
+    };
+    SPGLTexture *mipmappedTexture = [[SPGLTexture alloc] initWithData:NULL properties:properties];
+
+    XCTAssertEqual(1366, mipmappedTexture.numBytes, @"wrong number of bytes with mipmaps");
+}
+
+- (void)testEvictionOrder
+{
+    SPGLTexture *texture1 = [self reloadableTexture];
+    SPGLTexture *texture2 = [self reloadableTexture];
+    SPGLTexture *texture3 = [self reloadableTexture];
+
+    // rendered in this order: texture3 (on creation), texture2, texture1
+    [SPGLTexture nextFrame];
+    [texture2 name];
+    [SPGLTexture nextFrame];
+    [texture1 name];
+    [SPGLTexture nextFrame];
+
+    [SPGLTexture evictTexturesWithNumBytes:1];
+    XCTAssertTrue(texture3.isEvicted, @"least recently rendered texture not evicted");
+    XCTAssertFalse(texture2.isEvicted, @"too many textures evicted");
+    XCTAssertFalse(texture1.isEvicted, @"too many textures evicted");
+
+    [SPGLTexture evictTexturesWithNumBytes:texture1.numBytes + 1];
+    XCTAssertTrue(texture2.isEvicted, @"texture not evicted");
+    XCTAssertTrue(texture1.isEvicted, @"texture not evicted");
+}
+
+- (void)testTexturesRenderedLastFrameAreNotEvicted
+{
+    SPGLTexture *renderedTexture = [self reloadableTexture];
+    SPGLTexture *unusedTexture = [self reloadableTexture];
+
+    [SPGLTexture nextFrame];
+    [renderedTexture name];
+
+    [SPTexture evictReloadableTextures];
+    XCTAssertTrue(unusedTexture.isEvicted, @"unused texture not evicted");
+    XCTAssertFalse(renderedTexture.isEvicted, @"rendered texture was evicted");
+
+    // textures that are not reloadable are never evicted
+    SPGLTexture *texture = [self GLTextureWithWidth:32 height:32 scale:1.0f];
+
+    [SPGLTexture nextFrame];
+    [SPTexture evictReloadableTextures];
+    XCTAssertTrue(renderedTexture.isEvicted, @"texture not evicted");
+    XCTAssertFalse(texture.isEvicted, @"texture without file was evicted");
+    XCTAssertNotEqual(0, texture.name, @"texture without file was evicted");
+}
+
+- (void)testMemoryBudget
+{
+    uint64_t numBytes = [SPTexture memoryStats].numBytes;
+    SPGLTexture *renderedTexture = [self reloadableTexture];
+    SPGLTexture *unusedTexture = [self reloadableTexture];
+
+    [SPGLTexture nextFrame];
+    [renderedTexture name];
+
+    // the budget is exceeded; only the texture that was not rendered may be evicted
+    [SPTexture setMemoryBudget:numBytes + renderedTexture.numBytes + 1];
+    [SPGLTexture nextFrame];
+
+    XCTAssertTrue(unusedTexture.isEvicted, @"budget not enforced");
+    XCTAssertFalse(renderedTexture.isEvicted, @"rendered texture was evicted");
+    XCTAssertEqual(numBytes + renderedTexture.numBytes, [SPTexture memoryStats].numBytes);
+
+    // within budget, nothing is evicted
+    [SPGLTexture nextFrame];
+    XCTAssertFalse(renderedTexture.isEvicted, @"texture evicted within budget");
+}
+
+- (void)testMemoryStats
+{
+    SPTextureMemoryStats stats = [SPTexture memoryStats];
+    SPGLTexture *texture = [self GLTextureWithWidth:32 height:32 scale:1.0f];
+    SPGLTexture *reloadableTexture = [self reloadableTexture];
+    uint64_t numBytes = reloadableTexture.numBytes;
+
+    SPTextureMemoryStats newStats = [SPTexture memoryStats];
+    XCTAssertEqual(stats.numTextures + 2, newStats.numTextures, @"wrong number of textures");
+    XCTAssertEqual(stats.numBytes + texture.numBytes + numBytes, newStats.numBytes);
+    XCTAssertEqual(stats.numReloadableBytes + numBytes, newStats.numReloadableBytes);
+    XCTAssertEqual(stats.numEvictedBytes, newStats.numEvictedBytes);
+
+    [reloadableTexture evict];
+
+    newStats = [SPTexture memoryStats];
+    XCTAssertEqual(stats.numBytes + texture.numBytes, newStats.numBytes, @"wrong number of bytes");
+    XCTAssertEqual(stats.numReloadableBytes, newStats.numReloadableBytes);
+    XCTAssertEqual(stats.numEvictedBytes + numBytes, newStats.numEvictedBytes);
+    XCTAssertEqual(stats.numEvictions + 1, newStats.numEvictions, @"wrong number of evictions");
+}
+
+- (void)testReloadOnName
+{
+    SPTextureOptions *options = [[SPTextureOptions alloc] init];
+    options.reloadable = YES;
+
+    SPTexture *texture = [[SPTexture alloc] initWithContentsOfFile:[self fixturePath]
+                                                           options:options];
+    SPGLTexture *root = texture.root;
+
+    XCTAssertNotEqual(0, root.name, @"texture not uploaded");
+
+    NSInteger numReloads = [SPTexture memoryStats].numReloads;
+    [root evict];
+
+    XCTAssertTrue(root.isEvicted, @"texture not evicted");
+    XCTAssertEqual(numReloads, [SPTexture memoryStats].numReloads, @"texture reloaded too early");
+    XCTAssertNotEqual(0, root.name, @"texture not reloaded");
+    XCTAssertFalse(root.isEvicted, @"texture still evicted");
+    XCTAssertEqual(numReloads + 1, [SPTexture memoryStats].numReloads, @"reload not counted");
+}
+
+- (void)testReloadOfMissingFile
+{
+    SPGLTexture *texture = [self GLTextureWithWidth:32 height:32 scale:1.0f];
+    [texture makeReloadableWithPath:@"/does/not/exist.pvr" options:[[SPTextureOptions alloc] init]];
+    [texture evict];
+
+    // the texture stays empty and is no longer reloadable
+    XCTAssertEqual(0, texture.name, @"texture without file was reloaded");
+    XCTAssertFalse(texture.isEvicted, @"texture still reloadable");
+}
+
 - (SPGLTexture *)GLTextureWithWidth:(float)width height:(float)height scale:(float)scale
 {
-    return [[SPGLTexture alloc] initWithName:1 format:SPTextureFormat4444 width:width height:height
-                             containsMipmaps:NO scale:scale premultipliedAlpha:NO];
+    SPTextureProperties properties = {
+        .format = SPTextureFormat4444, .scale = scale,
+        .width = (NSInteger)width, .height = (NSInteger)height
+    };
+    return [[SPGLTexture alloc] initWithData:NULL properties:properties];
+}
+
+- (SPGLTexture *)reloadableTexture
+{
+    // the texture is never actually reloaded, so its file doesn't have to match
+    SPGLTexture *texture = [self GLTextureWithWidth:32 height:32 scale:1.0f];
+    [texture makeReloadableWithPath:[self fixturePath] options:[[SPTextureOptions alloc] init]];
+    return texture;
+}
+
+- (NSString *)fixturePath
+{
+    return [[NSBundle bundleForClass:[self class]] pathForResource:@"pvrtc_image.pvr"];
 }
 
 - (SPVertexData *)standardVertexData
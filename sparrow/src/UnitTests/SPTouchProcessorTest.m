@@ -0,0 +1,161 @@
+//
+//  SPTouchProcessorTest.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 20.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPTestCase.h"
+
+@interface SPTouchProcessorTest : SPTestCase
+
+@end
+
+@implementation SPTouchProcessorTest
+{
+    SPStage *_stage;
+    SPTouchProcessor *_processor;
+    NSMutableArray *_events;
+}
+
+- (void)setUp
+{
+    [super setUp];
+
+    _events = [[NSMutableArray alloc] init];
+    _stage = [[SPStage alloc] initWithWidth:320 height:480];
+    _processor = [[SPTouchProcessor alloc] initWithStage:_stage];
+
+    __weak NSMutableArray *events = _events;
+    [_stage addEventListenerForType:SPEventTypeTouch block:^(SPTouchEvent *event)
+    {
+        [events addObject:[event.touches anyObject]];
+    }];
+}
+
+- (void)testMoveCoalescing
+{
+    [self enqueueTouchWithID:1 phase:SPTouchPhaseBegan x:10 y:10];
+    [_processor advanceTime:0.01];
+
+    [_processor enqueueTouchWithID:1 phase:SPTouchPhaseMoved globalX:20 globalY:20
+                   previousGlobalX:10 previousGlobalY:10 tapCount:1 forceFactor:1.0f];
+    [_processor enqueueTouchWithID:1 phase:SPTouchPhaseMoved globalX:30 globalY:30
+                   previousGlobalX:20 previousGlobalY:20 tapCount:1 forceFactor:1.0f];
+    [_processor enqueueTouchWithID:1 phase:SPTouchPhaseMoved globalX:40 globalY:40
+                   previousGlobalX:30 previousGlobalY:30 tapCount:1 forceFactor:1.0f];
+
+    [_events removeAllObjects];
+    [_processor advanceTime:0.01];
+
+    XCTAssertEqual(1, _events.count, @"moves were not merged");
+
+    SPTouch *touch = _events[0];
+    XCTAssertEqual(SPTouchPhaseMoved, touch.phase, @"wrong phase");
+    XCTAssertEqualWithAccuracy(40.0f, touch.globalX, E, @"wrong position");
+    XCTAssertEqualWithAccuracy(10.0f, touch.previousGlobalX, E, @"wrong previous position");
+}
+
+- (void)testSamplesOfOneTouchIDAreNotMerged
+{
+    [self enqueueTouchWithID:1 phase:SPTouchPhaseBegan x:10 y:10];
+    [self enqueueTouchWithID:1 phase:SPTouchPhaseEnded x:10 y:10];
+    [self enqueueTouchWithID:1 phase:SPTouchPhaseBegan x:50 y:50];
+    [_processor advanceTime:0.01];
+
+    XCTAssertEqual(3, _events.count, @"samples of different touches were merged");
+    XCTAssertEqual(1, _processor.numCurrentTouches, @"wrong number of touches");
+}
+
+- (void)testTapCount
+{
+    [self tapAtX:100 y:100];
+    XCTAssertEqual(1, [_events.lastObject tapCount], @"wrong tap count");
+
+    [self tapAtX:105 y:100];
+    XCTAssertEqual(2, [_events.lastObject tapCount], @"double tap not recognized");
+
+    [_processor advanceTime:1.0];
+    [self tapAtX:100 y:100];
+    XCTAssertEqual(1, [_events.lastObject tapCount], @"old tap was not removed");
+}
+
+- (void)testTapCountWithManyTaps
+{
+    // more taps than fit into the list of recent taps; the oldest ones are dropped
+    for (int i=0; i<40; ++i)
+        [self tapAtX:(i % 8) * 40 y:(i / 8) * 60];
+
+    [self tapAtX:0 y:0];
+    XCTAssertEqual(1, [_events.lastObject tapCount], @"oldest tap was not dropped");
+
+    [self tapAtX:280 y:240];
+    XCTAssertEqual(2, [_events.lastObject tapCount], @"recent tap was not found");
+}
+
+- (void)testTooManyTouches
+{
+    for (int i=0; i<40; ++i)
+        [self enqueueTouchWithID:i phase:SPTouchPhaseBegan x:i y:i];
+
+    [_processor advanceTime:0.01];
+    XCTAssertEqual(32, _processor.numCurrentTouches, @"wrong number of touches");
+
+    [_processor cancelCurrentTouches];
+    XCTAssertEqual(0, _processor.numCurrentTouches, @"touches not cancelled");
+}
+
+- (void)testTouchReuse
+{
+    [self tapAtX:10 y:10];
+    SPTouch *firstTouch = _events.lastObject;
+
+    [self enqueueTouchWithID:2 phase:SPTouchPhaseBegan x:200 y:200];
+    [_processor advanceTime:0.01];
+
+    SPTouch *secondTouch = _events.lastObject;
+    XCTAssertEqual(firstTouch, secondTouch, @"ended touch was not reused");
+    XCTAssertEqual(2, secondTouch.touchID, @"wrong touch ID");
+    XCTAssertEqual(SPTouchPhaseBegan, secondTouch.phase, @"wrong phase");
+    XCTAssertEqualWithAccuracy(200.0f, secondTouch.globalX, E, @"wrong position");
+}
+
+- (void)testKeptTouchSetIsNotChanged
+{
+    __block NSSet *keptTouches = nil;
+    [_stage addEventListenerForType:SPEventTypeTouch block:^(SPTouchEvent *event)
+    {
+        if (!keptTouches) keptTouches = event.touches;
+    }];
+
+    [self enqueueTouchWithID:1 phase:SPTouchPhaseBegan x:10 y:10];
+    [_processor advanceTime:0.01];
+
+    [self enqueueTouchWithID:2 phase:SPTouchPhaseBegan x:50 y:50];
+    [self enqueueTouchWithID:1 phase:SPTouchPhaseEnded x:10 y:10];
+    [_processor advanceTime:0.01];
+
+    XCTAssertEqual(1, keptTouches.count, @"touch set was changed after dispatching");
+    XCTAssertEqual(1, [keptTouches.anyObject touchID], @"wrong touch in kept set");
+}
+
+#pragma mark Helpers
+
+- (void)enqueueTouchWithID:(size_t)touchID phase:(SPTouchPhase)phase x:(float)x y:(float)y
+{
+    [_processor enqueueTouchWithID:touchID phase:phase globalX:x globalY:y
+                   previousGlobalX:x previousGlobalY:y tapCount:1 forceFactor:1.0f];
+}
+
+- (void)tapAtX:(float)x y:(float)y
+{
+    [self enqueueTouchWithID:1 phase:SPTouchPhaseBegan x:x y:y];
+    [self enqueueTouchWithID:1 phase:SPTouchPhaseEnded x:x y:y];
+    [_processor advanceTime:0.0];
+}
+
+@end
@@ -0,0 +1,117 @@
+//
+//  SPTransitionsTest.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 05.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPTestCase.h"
+
+#define NUM_SAMPLES 10000
+
+typedef float (*FnPtrTransition) (id, SEL, float);
+
+@interface SPTransitionsTest : SPTestCase
+
+@end
+
+@implementation SPTransitionsTest
+
+- (NSArray *)builtInTransitions
+{
+    return @[SPTransitionLinear,
+             SPTransitionEaseIn, SPTransitionEaseOut,
+             SPTransitionEaseInOut, SPTransitionEaseOutIn,
+             SPTransitionEaseInBack, SPTransitionEaseOutBack,
+             SPTransitionEaseInOutBack, SPTransitionEaseOutInBack,
+             SPTransitionEaseInElastic, SPTransitionEaseOutElastic,
+             SPTransitionEaseInOutElastic, SPTransitionEaseOutInElastic,
+             SPTransitionEaseInBounce, SPTransitionEaseOutBounce,
+             SPTransitionEaseInOutBounce, SPTransitionEaseOutInBounce];
+}
+
+- (float)evaluateExactly:(NSString *)transition ratio:(float)ratio
+{
+    SEL selector = NSSelectorFromString([transition stringByAppendingString:@":"]);
+    FnPtrTransition func = (FnPtrTransition)[SPTransitions methodForSelector:selector];
+    return func([SPTransitions class], selector, ratio);
+}
+
+- (void)testTransitionIDs
+{
+    for (NSString *transition in [self builtInTransitions])
+        XCTAssertNotEqual(SPTransitionIDNone, SPTransitionIDFromName(transition), @"%@", transition);
+
+    XCTAssertEqual(SPTransitionIDNone, SPTransitionIDFromName(SPTransitionRandomize));
+    XCTAssertEqual(SPTransitionIDNone, SPTransitionIDFromName(@"myCustomTransition"));
+}
+
+- (void)testErrorBounds
+{
+    for (NSString *transition in [self builtInTransitions])
+    {
+        SPTransitionID transitionID = SPTransitionIDFromName(transition);
+        float maxError = 0.0f;
+
+        for (int i=0; i<=NUM_SAMPLES; ++i)
+        {
+            float ratio = (float)i / NUM_SAMPLES;
+            float error = fabsf(SPTransitionEvaluate(transitionID, ratio) -
+                                [self evaluateExactly:transition ratio:ratio]);
+            maxError = MAX(maxError, error);
+        }
+
+        XCTAssertLessThanOrEqual(maxError, SPTransitionMaxError, @"error too big: %@", transition);
+    }
+}
+
+- (void)testExactEndValues
+{
+    for (NSString *transition in [self builtInTransitions])
+    {
+        SPTransitionID transitionID = SPTransitionIDFromName(transition);
+        XCTAssertEqualWithAccuracy([self evaluateExactly:transition ratio:0.0f],
+                                   SPTransitionEvaluate(transitionID, 0.0f), 0.000001f,
+                                   @"wrong start: %@", transition);
+        XCTAssertEqualWithAccuracy([self evaluateExactly:transition ratio:1.0f],
+                                   SPTransitionEvaluate(transitionID, 1.0f), 0.000001f,
+                                   @"wrong end: %@", transition);
+    }
+}
+
+- (void)testBatchEvaluation
+{
+    const int numRatios = 1001; // not a multiple of the simd width
+    float ratios[numRatios];
+    float results[numRatios];
+
+    for (int i=0; i<numRatios; ++i)
+        ratios[i] = (float)i / (numRatios - 1);
+
+    for (NSString *transition in [self builtInTransitions])
+    {
+        SPTransitionID transitionID = SPTransitionIDFromName(transition);
+        SPTransitionEvaluateBatch(transitionID, ratios, results, numRatios);
+
+        for (int i=0; i<numRatios; ++i)
+            XCTAssertEqualWithAccuracy(SPTransitionEvaluate(transitionID, ratios[i]), results[i],
+                                       0.000001f, @"%@ at %f", transition, ratios[i]);
+    }
+}
+
+- (void)testPreciseTween
+{
+    SPQuad *quad = [SPQuad quadWithWidth:100 height:100];
+    SPTween *tween = [SPTween tweenWithTarget:quad time:1.0 transition:SPTransitionEaseOutElastic];
+    tween.preciseTransition = YES;
+    [tween advanceTime:0.3];
+
+    XCTAssertEqual([SPTransitions easeOutElastic:0.3f], (float)tween.progress,
+                   @"precise transition not evaluated with class method");
+}
+
+@end
@@ -0,0 +1,261 @@
+//
+//  SPTweenSystemTest.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 02.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPTestCase.h"
+
+#define E 0.0001f
+#define NUM_BENCHMARK_TWEENS 20000
+#define NUM_BENCHMARK_FRAMES 10
+
+@interface SPTweenSystemTest : SPTestCase
+
+@end
+
+@implementation SPTweenSystemTest
+
+- (void)testBasicTween
+{
+    __block int completedCount = 0;
+
+    SPSprite *sprite = [SPSprite sprite];
+    sprite.x = 10.0f;
+
+    SPTweenSystem *system = [SPTweenSystem tweenSystem];
+    SPTweenHandle tween = [system addTweenWithTarget:sprite property:@"x" endValue:110.0f time:1.0];
+    [system setOnComplete:^{ ++completedCount; } ofTween:tween];
+
+    XCTAssertTrue([system containsTween:tween], @"tween not found");
+    XCTAssertEqual(1, system.numTweens, @"wrong number of tweens");
+
+    [system advanceTime:0.25];
+    XCTAssertEqualWithAccuracy(35.0f, sprite.x, E, @"wrong value");
+    XCTAssertEqualWithAccuracy(35.0f, sprite.transformationMatrix.tx, E, @"matrix not updated");
+
+    [system advanceTime:0.75];
+    XCTAssertEqualWithAccuracy(110.0f, sprite.x, E, @"wrong end value");
+    XCTAssertEqual(1, completedCount, @"onComplete not called");
+    XCTAssertFalse([system containsTween:tween], @"completed tween not removed");
+    XCTAssertEqual(0, system.numTweens, @"wrong number of tweens");
+}
+
+- (void)testDelay
+{
+    SPSprite *sprite = [SPSprite sprite];
+    SPTweenSystem *system = [SPTweenSystem tweenSystem];
+    SPTweenHandle tween = [system addTweenWithTarget:sprite property:@"alpha" endValue:0.0f time:1.0];
+    [system setDelay:0.5 ofTween:tween];
+
+    [system advanceTime:0.4];
+    XCTAssertEqualWithAccuracy(1.0f, sprite.alpha, E, @"tween started too early");
+
+    sprite.alpha = 0.5f; // start value is read when the tween starts
+    [system advanceTime:0.6];
+    XCTAssertEqualWithAccuracy(0.25f, sprite.alpha, E, @"wrong value after delay");
+}
+
+- (void)testDelayInBatch
+{
+    // the delayed tween is evaluated together with the running one, but must not be changed
+    SPSprite *sprite1 = [SPSprite sprite];
+    SPSprite *sprite2 = [SPSprite sprite];
+    SPTweenSystem *system = [SPTweenSystem tweenSystem];
+
+    [system addTweenWithTarget:sprite1 property:@"x" endValue:100.0f time:1.0
+                    transition:SPTransitionEaseInElastic];
+    SPTweenHandle tween = [system addTweenWithTarget:sprite2 property:@"x" endValue:100.0f
+                                                time:1.0 transition:SPTransitionEaseInElastic];
+    [system setDelay:2.0 ofTween:tween];
+
+    [system advanceTime:1.0];
+    XCTAssertEqualWithAccuracy(100.0f, sprite1.x, E, @"wrong value");
+    XCTAssertEqual(0.0f, sprite2.x, @"delayed tween was applied");
+}
+
+- (void)testRepeatAndReverse
+{
+    SPSprite *sprite = [SPSprite sprite];
+    SPTweenSystem *system = [SPTweenSystem tweenSystem];
+    SPTweenHandle tween = [system addTweenWithTarget:sprite property:@"y" endValue:100.0f time:1.0];
+    [system setRepeatCount:3 ofTween:tween];
+    [system setReverse:YES ofTween:tween];
+
+    [system advanceTime:0.5];
+    XCTAssertEqualWithAccuracy(50.0f, sprite.y, E, @"wrong value in first cycle");
+
+    [system advanceTime:0.75];
+    XCTAssertEqualWithAccuracy(75.0f, sprite.y, E, @"second cycle not reversed");
+
+    [system advanceTime:1.0];
+    XCTAssertEqualWithAccuracy(25.0f, sprite.y, E, @"wrong value in third cycle");
+    XCTAssertTrue([system containsTween:tween], @"tween removed too early");
+
+    [system advanceTime:1.0];
+    XCTAssertEqualWithAccuracy(100.0f, sprite.y, E, @"wrong end value");
+    XCTAssertFalse([system containsTween:tween], @"tween not removed");
+}
+
+- (void)testRoundToInt
+{
+    SPSprite *sprite = [SPSprite sprite];
+    SPTweenSystem *system = [SPTweenSystem tweenSystem];
+    SPTweenHandle tween = [system addTweenWithTarget:sprite property:@"x" endValue:3.0f time:1.0];
+    [system setRoundToInt:YES ofTween:tween];
+
+    [system advanceTime:0.4];
+    XCTAssertEqual(1.0f, sprite.x, @"value not rounded");
+}
+
+- (void)testRemoveTweens
+{
+    SPSprite *sprite1 = [SPSprite sprite];
+    SPSprite *sprite2 = [SPSprite sprite];
+    SPTweenSystem *system = [SPTweenSystem tweenSystem];
+
+    SPTweenHandle tween1 = [system addTweenWithTarget:sprite1 property:@"x" endValue:100 time:1.0];
+    SPTweenHandle tween2 = [system addTweenWithTarget:sprite1 property:@"y" endValue:100 time:1.0];
+    SPTweenHandle tween3 = [system addTweenWithTarget:sprite2 property:@"x" endValue:100 time:1.0];
+
+    [system removeTween:tween1];
+    XCTAssertFalse([system containsTween:tween1], @"tween not removed");
+    XCTAssertTrue([system containsTween:tween2], @"wrong tween removed");
+
+    // a new tween reuses the slot, but must get a different handle
+    SPTweenHandle tween4 = [system addTweenWithTarget:sprite2 property:@"y" endValue:100 time:1.0];
+    XCTAssertNotEqual(tween1, tween4, @"handle was reused");
+    XCTAssertFalse([system containsTween:tween1], @"stale handle is valid again");
+
+    [system removeTweensWithTarget:sprite1];
+    XCTAssertFalse([system containsTween:tween2], @"tween with target not removed");
+    XCTAssertTrue([system containsTween:tween3], @"wrong tween removed");
+    XCTAssertTrue([system containsTween:tween4], @"wrong tween removed");
+
+    [system advanceTime:0.5];
+    XCTAssertEqualWithAccuracy(0.0f, sprite1.y, E, @"removed tween was advanced");
+    XCTAssertEqualWithAccuracy(50.0f, sprite2.x, E, @"tween not advanced");
+    XCTAssertEqualWithAccuracy(50.0f, sprite2.y, E, @"tween not advanced");
+
+    XCTAssertFalse([system containsTween:SPTweenHandleNone]);
+}
+
+- (void)testAddTweenInCallback
+{
+    SPSprite *sprite = [SPSprite sprite];
+    SPTweenSystem *system = [SPTweenSystem tweenSystem];
+    SPTweenHandle tween = [system addTweenWithTarget:sprite property:@"x" endValue:100 time:1.0];
+
+    __weak SPTweenSystem *weakSystem = system;
+    [system setOnComplete:^
+    {
+        [weakSystem addTweenWithTarget:sprite property:@"x" endValue:0 time:1.0];
+    } ofTween:tween];
+
+    [system advanceTime:1.0];
+    XCTAssertEqual(1, system.numTweens, @"tween added in callback is missing");
+
+    [system advanceTime:0.5];
+    XCTAssertEqualWithAccuracy(50.0f, sprite.x, E, @"second tween not advanced");
+}
+
+- (void)testUnsupportedProperty
+{
+    SPQuad *quad = [SPQuad quadWithWidth:100 height:100];
+    SPTweenSystem *system = [SPTweenSystem tweenSystem];
+
+    XCTAssertThrows([system addTweenWithTarget:quad property:@"width" endValue:10 time:1.0]);
+    XCTAssertThrows([system addTweenWithTarget:quad property:@"alpha" endValue:0 time:1.0],
+                    @"overridden setter must not be bypassed");
+}
+
+- (void)testInJuggler
+{
+    SPSprite *sprite = [SPSprite sprite];
+    SPJuggler *juggler = [SPJuggler juggler];
+    SPTweenSystem *system = [SPTweenSystem tweenSystem];
+    [system addTweenWithTarget:sprite property:@"rotation" endValue:1.0f time:1.0
+                    transition:SPTransitionEaseIn];
+
+    [juggler addObject:system];
+    [juggler advanceTime:0.5];
+
+    XCTAssertEqualWithAccuracy([SPTransitions easeIn:0.5f], sprite.rotation, E, @"wrong transition");
+}
+
+- (void)testNegativeProgress
+{
+    SPSprite *sprite = [SPSprite sprite];
+    SPTweenSystem *system = [SPTweenSystem tweenSystem];
+    [system addTweenWithTarget:sprite property:@"x" endValue:100.0f time:1.0
+                    transition:SPTransitionEaseInBack];
+
+    [system advanceTime:0.25];
+    XCTAssertEqualWithAccuracy(100.0f * [SPTransitions easeInBack:0.25f], sprite.x, E,
+                               @"negative progress was not applied");
+    XCTAssertLessThan(sprite.x, 0.0f);
+}
+
+#pragma mark Benchmarks
+
+- (void)testPerformanceOfTweenSystem
+{
+    NSMutableArray *sprites = [self createSprites];
+
+    [self measureBlock:^
+    {
+        SPTweenSystem *system = [[SPTweenSystem alloc] initWithCapacity:NUM_BENCHMARK_TWEENS * 2];
+
+        for (SPSprite *sprite in sprites)
+        {
+            [system addTweenWithTarget:sprite property:@"x" endValue:100 time:10.0];
+            [system addTweenWithTarget:sprite property:@"alpha" endValue:0 time:10.0
+                            transition:SPTransitionEaseOut];
+        }
+
+        for (int i=0; i<NUM_BENCHMARK_FRAMES; ++i)
+            [system advanceTime:1.0 / 60.0];
+    }];
+}
+
+- (void)testPerformanceOfTweenObjects
+{
+    NSMutableArray *sprites = [self createSprites];
+
+    [self measureBlock:^
+    {
+        SPJuggler *juggler = [[SPJuggler alloc] init];
+
+        for (SPSprite *sprite in sprites)
+        {
+            SPTween *tween = [SPTween tweenWithTarget:sprite time:10.0];
+            [tween animateProperty:@"x" targetValue:100];
+            [juggler addObject:tween];
+
+            tween = [SPTween tweenWithTarget:sprite time:10.0 transition:SPTransitionEaseOut];
+            [tween fadeTo:0];
+            [juggler addObject:tween];
+        }
+
+        for (int i=0; i<NUM_BENCHMARK_FRAMES; ++i)
+            [juggler advanceTime:1.0 / 60.0];
+    }];
+}
+
+#pragma mark Helpers
+
+- (NSMutableArray *)createSprites
+{
+    NSMutableArray *sprites = [NSMutableArray array];
+    for (int i=0; i<NUM_BENCHMARK_TWEENS; ++i)
+        [sprites addObject:[SPSprite sprite]];
+
+    return sprites;
+}
+
+@end
@@ -13,6 +13,26 @@
 
 #define E 0.0001f
 
+// --- helper class --------------------------------------------------------------------------------
+
+@interface SPCountingSprite : SPSprite
+
+@property (nonatomic, readonly) int numXChanges;
+
+@end
+
+@implementation SPCountingSprite
+
+- (void)setX:(float)value
+{
+    [super setX:value];
+    ++_numXChanges;
+}
+
+@end
+
+// --- class implementation ------------------------------------------------------------------------
+
 @interface SPTweenTest : SPTestCase
 
 @property (nonatomic, assign) int intProperty;
@@ -362,4 +382,40 @@
     [self makeTweenWithTime:0.0f andAdvanceBy:0.1f];
 }
 
-@end
\ No newline at end of file
+- (void)testDisplayObjectFieldTween
+{
+    SPSprite *sprite = [SPSprite sprite];
+    SPTween *tween = [SPTween tweenWithTarget:sprite time:1.0];
+    [tween moveToX:100 y:50];
+    [tween animateProperty:@"rotation" targetValue:3 * PI];
+    [tween fadeTo:2.0f];
+
+    XCTAssertEqualWithAccuracy(0.0f, sprite.transformationMatrix.tx, E, @"wrong initial matrix");
+
+    [tween advanceTime:0.5];
+    XCTAssertEqualWithAccuracy(50.0f, sprite.x, E, @"wrong x");
+    XCTAssertEqualWithAccuracy(25.0f, sprite.y, E, @"wrong y");
+    XCTAssertEqualWithAccuracy(-0.5f * PI, sprite.rotation, E, @"rotation not normalized");
+    XCTAssertEqualWithAccuracy(1.0f, sprite.alpha, E, @"alpha not clamped");
+    XCTAssertEqualWithAccuracy(50.0f, sprite.transformationMatrix.tx, E, @"matrix not updated");
+    XCTAssertEqualWithAccuracy(100.0f, [tween endValueOfProperty:@"x"], E, @"wrong end value");
+
+    [tween advanceTime:0.5];
+    XCTAssertEqualWithAccuracy(100.0f, sprite.x, E, @"wrong x");
+    XCTAssertEqualWithAccuracy(100.0f, sprite.transformationMatrix.tx, E, @"matrix not updated");
+}
+
+- (void)testOverriddenSetterIsCalled
+{
+    SPCountingSprite *sprite = [[SPCountingSprite alloc] init];
+    SPTween *tween = [SPTween tweenWithTarget:sprite time:1.0];
+    [tween animateProperty:@"x" targetValue:100];
+
+    [tween advanceTime:0.5];
+    [tween advanceTime:0.5];
+
+    XCTAssertEqual(2, sprite.numXChanges, @"overridden setter was bypassed");
+    XCTAssertEqualWithAccuracy(100.0f, sprite.x, E, @"wrong x");
+}
+
+@end
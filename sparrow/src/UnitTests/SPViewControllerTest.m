@@ -0,0 +1,164 @@
+//
+//  SPViewControllerTest.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 20.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPTestCase.h"
+
+// private methods of SPViewController that these tests need access to
+@interface SPViewController (Testing)
+
+- (void)advanceFixedTime:(double)passedTime;
+- (void)interpolateTransforms;
+- (void)restoreTransforms;
+
+@end
+
+@interface SPViewControllerTest : SPTestCase
+
+@end
+
+@implementation SPViewControllerTest
+{
+    SPViewController *_controller;
+}
+
+- (void)setUp
+{
+    [super setUp];
+
+    _controller = [[SPViewController alloc] init];
+    _controller.fixedUpdateRate = 10;
+}
+
+- (void)tearDown
+{
+    _controller = nil;
+    [super tearDown];
+}
+
+- (void)testFixedTimeStep
+{
+    [_controller advanceFixedTime:0.35];
+
+    XCTAssertEqual(3, _controller.numUpdatesInLastFrame, @"wrong number of updates");
+    XCTAssertEqualWithAccuracy(0.3, _controller.juggler.elapsedTime, E, @"wrong juggler time");
+    XCTAssertEqualWithAccuracy(0.5f, _controller.interpolationAlpha, E, @"wrong alpha");
+
+    // the remaining time is carried over to the next frame
+    [_controller advanceFixedTime:0.04];
+
+    XCTAssertEqual(0, _controller.numUpdatesInLastFrame, @"wrong number of updates");
+    XCTAssertEqualWithAccuracy(0.9f, _controller.interpolationAlpha, E, @"wrong alpha");
+
+    [_controller advanceFixedTime:0.06];
+
+    XCTAssertEqual(1, _controller.numUpdatesInLastFrame, @"wrong number of updates");
+    XCTAssertEqualWithAccuracy(0.4, _controller.juggler.elapsedTime, E, @"wrong juggler time");
+    XCTAssertEqualWithAccuracy(0.5f, _controller.interpolationAlpha, E, @"wrong alpha");
+}
+
+- (void)testDroppedUpdates
+{
+    _controller.maxUpdatesPerFrame = 5;
+    [_controller advanceFixedTime:1.05];
+
+    XCTAssertEqual(5, _controller.numUpdatesInLastFrame, @"wrong number of updates");
+    XCTAssertEqual(5, _controller.numDroppedUpdates, @"wrong number of dropped updates");
+    XCTAssertEqualWithAccuracy(0.5, _controller.juggler.elapsedTime, E, @"wrong juggler time");
+    XCTAssertEqualWithAccuracy(0.5f, _controller.interpolationAlpha, E, @"wrong alpha");
+}
+
+- (void)testInterpolation
+{
+    SPSprite *movingSprite = [self addSpriteAtX:0.0f];
+    SPSprite *staticSprite = [self addSpriteAtX:20.0f];
+
+    SPTween *tween = [SPTween tweenWithTarget:movingSprite time:1.0];
+    [tween animateProperty:@"x" targetValue:100.0f];
+    [_controller.juggler addObject:tween];
+
+    // two updates; interpolation happens between the last two of them
+    [_controller advanceFixedTime:0.25];
+    XCTAssertEqualWithAccuracy(20.0f, movingSprite.x, E, @"wrong simulated position");
+
+    [_controller interpolateTransforms];
+    XCTAssertEqualWithAccuracy(15.0f, movingSprite.x, E, @"wrong interpolated position");
+    XCTAssertEqualWithAccuracy(20.0f, staticSprite.x, E, @"static object was moved");
+
+    [_controller restoreTransforms];
+    XCTAssertEqualWithAccuracy(20.0f, movingSprite.x, E, @"position not restored");
+    XCTAssertEqualWithAccuracy(20.0f, staticSprite.x, E, @"static object was moved");
+}
+
+- (void)testInterpolationOfRotation
+{
+    SPSprite *sprite = [self addSpriteAtX:0.0f];
+    sprite.rotation = 3.0f;
+
+    // crosses PI; the shorter way leads over PI, not back over zero
+    SPTween *tween = [SPTween tweenWithTarget:sprite time:0.1];
+    [tween animateProperty:@"rotation" targetValue:3.4f];
+    [_controller.juggler addObject:tween];
+
+    [_controller advanceFixedTime:0.15];
+    [_controller interpolateTransforms];
+
+    XCTAssertEqualWithAccuracy(cosf(3.2f), cosf(sprite.rotation), E, @"wrong rotation");
+    XCTAssertEqualWithAccuracy(sinf(3.2f), sinf(sprite.rotation), E, @"wrong rotation");
+
+    [_controller restoreTransforms];
+    XCTAssertEqualWithAccuracy(3.4f - TWO_PI, sprite.rotation, E, @"rotation not restored");
+}
+
+- (void)testNewObjectsAreNotInterpolated
+{
+    __block SPSprite *sprite = nil;
+
+    [_controller.juggler delayInvocationByTime:0.05 block:^
+    {
+        sprite = [self addSpriteAtX:0.0f];
+        sprite.x = 50.0f;
+    }];
+
+    [_controller advanceFixedTime:0.15];
+    [_controller interpolateTransforms];
+
+    XCTAssertNotNil(sprite, @"invocation not executed");
+    XCTAssertEqualWithAccuracy(50.0f, sprite.x, E, @"new object was interpolated");
+
+    [_controller restoreTransforms];
+}
+
+- (void)testDisabledInterpolation
+{
+    SPSprite *sprite = [self addSpriteAtX:0.0f];
+
+    SPTween *tween = [SPTween tweenWithTarget:sprite time:1.0];
+    [tween animateProperty:@"x" targetValue:100.0f];
+    [_controller.juggler addObject:tween];
+
+    _controller.interpolatesRendering = NO;
+    [_controller advanceFixedTime:0.15];
+    [_controller interpolateTransforms];
+
+    XCTAssertEqualWithAccuracy(10.0f, sprite.x, E, @"object was interpolated");
+}
+
+#pragma mark Helpers
+
+- (SPSprite *)addSpriteAtX:(float)x
+{
+    SPSprite *sprite = [SPSprite sprite];
+    sprite.x = x;
+    [_controller.stage addChild:sprite];
+    return sprite;
+}
+
+@end
@@ -0,0 +1,173 @@
+//
+//  SPXMLReaderTest.m
+//  Sparrow
+//
+//  Created by Daniel Sperl on 15.11.15.
+//  Copyright 2011-2015 Gamua. All rights reserved.
+//
+//  This program is free software; you can redistribute it and/or modify
+//  it under the terms of the Simplified BSD License.
+//
+
+#import "SPTestCase.h"
+
+#define NUM_BENCHMARK_REGIONS 5000
+
+@interface SPXMLReaderTest : SPTestCase
+
+@end
+
+@implementation SPXMLReaderTest
+
+- (void)testElementsAndAttributes
+{
+    NSString *xml = @"<?xml version='1.0' encoding='UTF-8'?>\n"
+                     "<!DOCTYPE font [ <!ELEMENT font ANY> ]>\n"
+                     "<!-- <ignored x='1'/> -->\n"
+                     "<font>\n"
+                     "  <info face=\"Sans &amp; Serif\" size = '12.5' smooth='0'/>\n"
+                     "  <![CDATA[ <ignored/> ]]>\n"
+                     "  <char id='-65' x='1e2' rotated='true'>text</char>\n"
+                     "</font>";
+
+    NSMutableArray *names = [NSMutableArray array];
+    SPXMLReader *reader = [[SPXMLReader alloc] initWithData:[xml dataUsingEncoding:NSUTF8StringEncoding]];
+
+    BOOL success = [reader parseElementsWithBlock:^(const SPXMLElement *element, BOOL *stop)
+    {
+        [names addObject:[[NSString alloc] initWithBytes:element->name.bytes length:element->name.length
+                                                encoding:NSUTF8StringEncoding]];
+
+        if (SPXMLElementHasName(element, "info"))
+        {
+            XCTAssertEqual(3, element->numAttributes);
+            XCTAssertEqualObjects(@"Sans & Serif", SPXMLElementString(element, "face"));
+            XCTAssertEqualWithAccuracy(12.5f, SPXMLElementFloat(element, "size"), E);
+            XCTAssertFalse(SPXMLElementBool(element, "smooth"));
+            XCTAssertNil(SPXMLElementString(element, "missing"));
+            XCTAssertEqual(0.0f, SPXMLElementFloat(element, "missing"));
+        }
+        else if (SPXMLElementHasName(element, "char"))
+        {
+            XCTAssertEqual(-65, SPXMLElementInt(element, "id"));
+            XCTAssertEqualWithAccuracy(100.0f, SPXMLElementFloat(element, "x"), E);
+            XCTAssertTrue(SPXMLElementBool(element, "rotated"));
+        }
+    }];
+
+    XCTAssertTrue(success, @"parsing failed: %@", reader.errorMessage);
+    XCTAssertEqualObjects((@[@"font", @"info", @"char"]), names, @"wrong elements");
+}
+
+- (void)testStop
+{
+    NSString *xml = @"<a><b/><c/></a>";
+    __block int numElements = 0;
+    SPXMLReader *reader = [[SPXMLReader alloc] initWithData:[xml dataUsingEncoding:NSUTF8StringEncoding]];
+
+    [reader parseElementsWithBlock:^(const SPXMLElement *element, BOOL *stop)
+    {
+        ++numElements;
+        *stop = SPXMLElementHasName(element, "b");
+    }];
+
+    XCTAssertEqual(2, numElements, @"parsing was not stopped");
+}
+
+- (void)testNamesArePrefixes
+{
+    NSString *xml = @"<kerning first='1'/>";
+    SPXMLReader *reader = [[SPXMLReader alloc] initWithData:[xml dataUsingEncoding:NSUTF8StringEncoding]];
+
+    [reader parseElementsWithBlock:^(const SPXMLElement *element, BOOL *stop)
+    {
+        XCTAssertTrue(SPXMLElementHasName(element, "kerning"));
+        XCTAssertFalse(SPXMLElementHasName(element, "kern"), @"prefix of name matched");
+        XCTAssertFalse(SPXMLElementHasName(element, "kernings"), @"longer name matched");
+        XCTAssertEqual(1, SPXMLElementInt(element, "first"));
+        XCTAssertEqual(0, SPXMLElementInt(element, "firstChar"), @"longer attribute name matched");
+    }];
+}
+
+- (void)testMalformedData
+{
+    for (NSString *xml in @[@"<a x='1", @"<a x=1/>", @"<a x/>", @"<a><!-- comment", @"<a /x>"])
+    {
+        SPXMLReader *reader = [[SPXMLReader alloc] initWithData:[xml dataUsingEncoding:NSUTF8StringEncoding]];
+        XCTAssertFalse([reader parseElementsWithBlock:^(const SPXMLElement *element, BOOL *stop) {}],
+                       @"malformed XML was accepted: %@", xml);
+        XCTAssertNotNil(reader.errorMessage);
+    }
+}
+
+- (void)testParseFloat
+{
+    NSArray *strings = @[@"0", @"-0.5", @"  42", @"3.14159", @"1e-3", @"-2.5E+2", @"0.000123",
+                         @"123456789.123", @"7.", @".25", @"12px", @"1e"];
+
+    for (NSString *string in strings)
+    {
+        const char *bytes = string.UTF8String;
+        XCTAssertEqualWithAccuracy(string.floatValue, SPXMLParseFloat(bytes, strlen(bytes)),
+                                   fabsf(string.floatValue) * 1e-6f, @"wrong value for '%@'", string);
+    }
+}
+
+#pragma mark Benchmarks
+
+- (void)testPerformanceOfAtlasLoading
+{
+    NSString *path = [self createBenchmarkAtlas];
+    SPTexture *texture = [[SPTexture alloc] initWithWidth:16 height:16];
+
+    [self measureBlock:^
+    {
+        SPTextureAtlas *atlas = [[SPTextureAtlas alloc] initWithContentsOfFile:path texture:texture];
+        XCTAssertEqual(NUM_BENCHMARK_REGIONS, atlas.numTextures);
+    }];
+}
+
+- (void)testPerformanceOfNSXMLParserReference
+{
+    // parses the same file the way SPTextureAtlas did before it used SPXMLReader
+    NSString *path = [self createBenchmarkAtlas];
+
+    [self measureBlock:^
+    {
+        __block int numRegions = 0;
+        NSXMLParser *parser = [[NSXMLParser alloc] initWithData:[NSData dataWithContentsOfFile:path]];
+
+        [parser parseElementsWithBlock:^(NSString *elementName, NSDictionary *attributes)
+        {
+            if ([elementName isEqualToString:@"SubTexture"])
+            {
+                SPRectangle *region = [SPRectangle rectangleWithX:[attributes[@"x"] floatValue]
+                                                                y:[attributes[@"y"] floatValue]
+                                                            width:[attributes[@"width"] floatValue]
+                                                           height:[attributes[@"height"] floatValue]];
+                if (region && attributes[@"name"]) ++numRegions;
+            }
+        }];
+
+        XCTAssertEqual(NUM_BENCHMARK_REGIONS, numRegions);
+    }];
+}
+
+#pragma mark Helpers
+
+- (NSString *)createBenchmarkAtlas
+{
+    NSString *path = [NSTemporaryDirectory() stringByAppendingPathComponent:@"xml_benchmark_atlas.xml"];
+    NSMutableString *xml = [NSMutableString stringWithString:@"<TextureAtlas imagePath='atlas.png'>\n"];
+
+    for (int i=0; i<NUM_BENCHMARK_REGIONS; ++i)
+        [xml appendFormat:@"  <SubTexture name='region_%04d' x='%d' y='%d' width='%d' height='%d' "
+                           "frameX='-%d' frameY='-%d' frameWidth='%d' frameHeight='%d'/>\n",
+                          i, i % 64 * 32, i / 64 * 32, 30, 31, i % 3, i % 5, 32, 33];
+
+    [xml appendString:@"</TextureAtlas>"];
+    [xml writeToFile:path atomically:YES encoding:NSUTF8StringEncoding error:nil];
+    return path;
+}
+
+@end